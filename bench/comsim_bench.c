@@ -0,0 +1,1436 @@
+/* File: comsim_bench.c
+ * Description: Throughput and cache micro-benchmarks of the ComSim kernels
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Usage: comsim_bench [-o out.json] [-k kernel] [-min log2] [-max log2]
+ *                     [-t seconds]
+ *        comsim_bench -noise
+ *   Every kernel is swept over problem sizes 2^min .. 2^max (step x4),
+ *   i.e. from L1 resident to DRAM sized working sets. Results are written
+ *   as JSON (stdout by default), a readable table goes to stderr.
+ *   -noise prints the BER of the noise pool against exact AWGN instead.
+ */
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include "comSim_types.h"
+#include "comMath.h"
+#include "constel.h"
+#include "compBuf.h"
+#include "symMapper.h"
+#include "dataGen.h"
+#include "prbs.h"
+#include "bitGroup.h"
+#include "awgn.h"
+#include "fir.h"
+#include "nco.h"
+#include "pipeline.h"
+#include "fading.h"
+#include "convCode.h"
+#include "ldpc.h"
+#include "crc.h"
+#include "fft.h"
+#include "ofdm.h"
+#include "iqFile.h"
+#include "timing.h"
+#include "carrier.h"
+#include "halfband.h"
+#include "resample.h"
+#include "equalizer.h"
+#include "stats.h"
+
+/* Defines */
+#define BENCH_NUM_TAPS		32		/* FIR length of conv/intpl_fir */
+#define BENCH_CORR_LEN		64		/* local sequence of the correlators */
+#define BENCH_UP_RATE		4
+#define BENCH_SPS			8		/* samples per symbol of timing recovery and pulses */
+#define BENCH_SPAN			10		/* pulse span in symbols */
+#define BENCH_HB_K			6		/* half-band taps per side, 23 taps */
+#define BENCH_HB_STAGES		3		/* half-band cascade, rate change 8 */
+#define BENCH_EQ_TAPS		11		/* adaptive equalizer taps */
+#define BENCH_NOISE_FRM		512		/* symbols per frame of the noise report */
+#define BENCH_NOISE_SYM		(1L << 22)	/* symbols per noise report point */
+#define BENCH_LUT_SIZE		(1 << (QT_PHASE_ACC_BITS - 2))
+#define BENCH_CONV_MAX		(1L << 18)	/* longest block of the Viterbi runs */
+
+/* One measurement */
+typedef struct{
+	const char *kernel;
+	const char *unit;			// "samples" or "bits"
+	long n;						// problem size in units
+	long bytes;					// working set
+	long reps;
+	double nsPerOp;				// one call of the kernel
+	double unitsPerSec;
+	double cacheRefPerUnit;		// < 0: not available
+	double cacheMissPerUnit;
+} benchRes_str;
+
+/* Variables */
+static double benchMinTime = 0.2;
+static int benchMinLog2 = 8, benchMaxLog2 = 22;
+static const char *benchFilter = NULL;
+static FILE *benchJson;
+static int benchNumRes = 0;
+static int perfFd[2] = {-1, -1};
+static char tapFile[64];
+volatile unsigned int benchSink;	// results of pure kernels, kept live
+
+/* Functions */
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/***********************************
+ * Cache Counters                  *
+ ***********************************/
+
+#ifdef __linux__
+static int perf_open(unsigned long long config)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/* last level cache references/misses; silently unavailable in containers
+   or with perf_event_paranoid > 2 */
+static void perf_init(void)
+{
+#ifdef __linux__
+	perfFd[0] = perf_open(PERF_COUNT_HW_CACHE_REFERENCES);
+	perfFd[1] = perf_open(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+}
+
+static void perf_start(void)
+{
+#ifdef __linux__
+	int i;
+
+	for(i = 0; i < 2; i++)
+		if(perfFd[i] >= 0){
+			ioctl(perfFd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(perfFd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+}
+
+static void perf_stop(long long cnt[2])
+{
+	int i;
+
+	for(i = 0; i < 2; i++){
+		cnt[i] = -1;
+#ifdef __linux__
+		if(perfFd[i] >= 0){
+			ioctl(perfFd[i], PERF_EVENT_IOC_DISABLE, 0);
+			if(read(perfFd[i], &cnt[i], sizeof(long long)) != sizeof(long long))
+				cnt[i] = -1;
+		}
+#endif
+	}
+}
+
+/***********************************
+ * Reporting                       *
+ ***********************************/
+
+static void bench_report(benchRes_str *res)
+{
+	if(benchNumRes++ > 0)
+		fprintf(benchJson, ",\n");
+
+	fprintf(benchJson, "    {\"kernel\": \"%s\", \"unit\": \"%s\", \"n\": %ld, "
+			"\"bytes\": %ld, \"reps\": %ld, \"ns_per_op\": %.3f, "
+			"\"ns_per_unit\": %.4f, \"%s_per_s\": %.6e",
+			res->kernel, res->unit, res->n, res->bytes, res->reps,
+			res->nsPerOp, res->nsPerOp / res->n, res->unit, res->unitsPerSec);
+	if(res->cacheMissPerUnit >= 0.)
+		fprintf(benchJson, ", \"llc_ref_per_unit\": %.5f, \"llc_miss_per_unit\": %.5f}",
+				res->cacheRefPerUnit, res->cacheMissPerUnit);
+	else
+		fprintf(benchJson, ", \"llc_ref_per_unit\": null, \"llc_miss_per_unit\": null}");
+	fflush(benchJson);
+
+	fprintf(stderr, "%-18s n=%-9ld %9.1f KiB %12.1f ns/op %10.3f ns/%s %10.3e %s/s",
+			res->kernel, res->n, res->bytes / 1024., res->nsPerOp,
+			res->nsPerOp / res->n, res->unit[0] == 'b' ? "bit" : "smp",
+			res->unitsPerSec, res->unit);
+	if(res->cacheMissPerUnit >= 0.)
+		fprintf(stderr, "  llc miss/%s %.4f", res->unit[0] == 'b' ? "bit" : "smp",
+				res->cacheMissPerUnit);
+	fprintf(stderr, "\n");
+}
+
+/* Run body repeatedly for at least benchMinTime (and twice) after one
+   untimed warm-up call, then report; units is the work of one call */
+#define BENCH_RUN(name, unitName, units, wsBytes, body)						\
+	do{																		\
+		benchRes_str _r;													\
+		long long _cnt[2];													\
+		double _t0, _el;													\
+		long _rep = 0;														\
+		body;																\
+		perf_start();														\
+		_t0 = bench_now();													\
+		do{																	\
+			body;															\
+			_rep++;															\
+			_el = bench_now() - _t0;										\
+		}while(_el < benchMinTime || _rep < 2);								\
+		perf_stop(_cnt);													\
+		_r.kernel = name;													\
+		_r.unit = unitName;													\
+		_r.n = (units);														\
+		_r.bytes = (wsBytes);												\
+		_r.reps = _rep;														\
+		_r.nsPerOp = _el * 1e9 / _rep;										\
+		_r.unitsPerSec = (double)(units) * _rep / _el;						\
+		_r.cacheRefPerUnit = (_cnt[0] < 0)? -1. :							\
+			(double)_cnt[0] / ((double)(units) * _rep);						\
+		_r.cacheMissPerUnit = (_cnt[1] < 0)? -1. :							\
+			(double)_cnt[1] / ((double)(units) * _rep);						\
+		bench_report(&_r);													\
+	}while(0)
+
+static int bench_enabled(const char *name)
+{
+	return benchFilter == NULL || strstr(name, benchFilter) != NULL;
+}
+
+/***********************************
+ * Kernels                         *
+ ***********************************/
+
+static void bench_filters(long n)
+{
+	double h[BENCH_NUM_TAPS], *x, *y;
+	compBuf_str cx, cy;
+	int i;
+
+	x = (double *)malloc(sizeof(double)*n*BENCH_UP_RATE);
+	y = (double *)malloc(sizeof(double)*(n*BENCH_UP_RATE + BENCH_NUM_TAPS));
+	for(i = 0; i < BENCH_NUM_TAPS; i++)
+		h[i] = 1. / (i + 1);
+	for(i = 0; i < n; i++)
+		x[i] = rnd() - 0.5;
+
+	if(bench_enabled("conv"))
+		BENCH_RUN("conv", "samples", n, (2*n + BENCH_NUM_TAPS) * 8,
+			memset(y, 0, sizeof(double)*(n + BENCH_NUM_TAPS - 1));
+			conv(y, n + BENCH_NUM_TAPS - 1, h, BENCH_NUM_TAPS, x, n));
+
+	if(bench_enabled("intpl_fir"))
+		BENCH_RUN("intpl_fir", "samples", n, (n + 2*n*BENCH_UP_RATE) * 8,
+			memset(y, 0, sizeof(double)*(n*BENCH_UP_RATE + BENCH_NUM_TAPS - 1));
+			intpl_fir(y, n*BENCH_UP_RATE + BENCH_NUM_TAPS - 1, tapFile,
+				BENCH_NUM_TAPS, x, n, BENCH_UP_RATE));
+
+	if(bench_enabled("compBuf_fir") && compBuf_alloc(&cx, n) == 0){
+		compBuf_alloc(&cy, n + BENCH_NUM_TAPS - 1);
+		for(i = 0; i < n; i++)
+			cx.re[i] = cx.im[i] = x[i];
+		BENCH_RUN("compBuf_fir", "samples", n, (4*n + 2*BENCH_NUM_TAPS) * 8,
+			compBuf_fir(&cy, h, BENCH_NUM_TAPS, &cx, n));
+		compBuf_free(&cx);
+		compBuf_free(&cy);
+	}
+
+	free(x);
+	free(y);
+}
+
+/* RRC shaping and matched filtering, BENCH_SPS samples per symbol over
+   BENCH_SPAN symbols; the folded kernel against the plain pipeline FIR */
+static void bench_pulse(long n)
+{
+	const double *h;
+	complex *x, *y;
+	pipeFir_str pf;
+	pipeBlk_str blk;
+	firSym_str fs;
+	int lenH, len, i;
+
+	if((h = pulse_get(PULSE_RRC, BENCH_SPS, BENCH_SPAN, 0.35, &lenH)) == NULL)
+		return;
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*n*BENCH_SPS);
+	if(x == NULL || y == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++){
+		x[i].re = rnd() - 0.5;
+		x[i].im = rnd() - 0.5;
+	}
+
+	memset(&blk, 0, sizeof(pipeBlk_str));
+	blk.sym = x;
+	blk.lenSym = (int)n;
+	if(pipeFir_init(&pf, h, lenH, (int)n) == 0){
+		if(bench_enabled("pipeStage_fir/rrc")){
+			pf.sym = 0;
+			BENCH_RUN("pipeStage_fir/rrc", "samples", n, n*32 + lenH*8,
+				pipeStage_fir(&pf, &blk));
+		}
+		if(bench_enabled("pipeStage_fir/rrcSym")){
+			pf.sym = 1;
+			BENCH_RUN("pipeStage_fir/rrcSym", "samples", n, n*32 + lenH*8,
+				pipeStage_fir(&pf, &blk));
+		}
+		pipeFir_free(&pf);
+	}
+
+	if(bench_enabled("firSym/rrcDown") && firSym_init(&fs, h, lenH, 1, BENCH_SPS, (int)n) == 0){
+		BENCH_RUN("firSym/rrcDown", "samples", n, n*16 + n*16/BENCH_SPS,
+			firSym_run(y, &len, x, (int)n, &fs));
+		firSym_free(&fs);
+	}
+	if(bench_enabled("firSym/rrcUp") && firSym_init(&fs, h, lenH, BENCH_SPS, 1,
+				(int)n/BENCH_SPS) == 0){
+		BENCH_RUN("firSym/rrcUp", "samples", n, n*32 + n*16/BENCH_SPS,
+			firSym_run(y, &len, x, (int)n/BENCH_SPS, &fs));
+		firSym_free(&fs);
+	}
+
+cleanup:
+	free(x);
+	free(y);
+}
+
+/* 8x half-band cascades against three generic folded FIR stages on the
+   full 4K-1 taps; samples are the high rate side */
+static void bench_halfband(long n)
+{
+	halfband_str hb;
+	hbCascade_str hc;
+	firSym_str fs[BENCH_HB_STAGES];
+	double h[4*BENCH_HB_K - 1];
+	complex *x, *y;
+	float *fRe, *fIm, *gRe, *gIm;
+	sfxp_t *qRe, *qIm, *pRe, *pIm;
+	int i, s, len, ok;
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*n);
+	fRe = (float *)malloc(sizeof(float)*n);
+	fIm = (float *)malloc(sizeof(float)*n);
+	gRe = (float *)malloc(sizeof(float)*n);
+	gIm = (float *)malloc(sizeof(float)*n);
+	qRe = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	qIm = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	pRe = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	pIm = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	if(x == NULL || y == NULL || fRe == NULL || fIm == NULL || gRe == NULL
+			|| gIm == NULL || qRe == NULL || qIm == NULL || pRe == NULL || pIm == NULL
+			|| halfband_design(&hb, BENCH_HB_K, 60.) < 0)
+		goto cleanup;
+	halfband_taps(h, &hb);
+	for(i = 0; i < n; i++){
+		x[i].re = rnd() - 0.5;
+		x[i].im = rnd() - 0.5;
+		fRe[i] = (float)x[i].re;
+		fIm[i] = (float)x[i].im;
+		qRe[i] = REAL2FXPROUND(x[i].re, 13);
+		qIm[i] = REAL2FXPROUND(x[i].im, 13);
+	}
+
+	if(bench_enabled("firSym/hbDecim8")){
+		for(s = ok = 0; s < BENCH_HB_STAGES; s++)
+			ok |= firSym_init(&fs[s], h, 4*BENCH_HB_K - 1, 1, 2, (int)n >> s);
+		if(ok == 0)
+			BENCH_RUN("firSym/hbDecim8", "samples", n, n*32,
+				firSym_run(y, &len, x, (int)n, &fs[0]);
+				for(s = 1; s < BENCH_HB_STAGES; s++)
+					firSym_run(y, &len, y, len, &fs[s]));
+		for(s = 0; s < BENCH_HB_STAGES; s++)
+			firSym_free(&fs[s]);
+	}
+	if(bench_enabled("hbCascade/decim8") && hbCascade_init(&hc, &hb, HB_DOUBLE,
+				HB_DECIM, BENCH_HB_STAGES, (int)n, 0) == 0){
+		BENCH_RUN("hbCascade/decim8", "samples", n, n*32,
+			hbCascade_run(y, &len, x, (int)n, &hc));
+		hbCascade_free(&hc);
+	}
+	if(bench_enabled("hbCascade/decim8F") && hbCascade_init(&hc, &hb, HB_FLOAT,
+				HB_DECIM, BENCH_HB_STAGES, (int)n, 0) == 0){
+		BENCH_RUN("hbCascade/decim8F", "samples", n, n*16,
+			hbCascade_runSplit(gRe, gIm, &len, fRe, fIm, (int)n, &hc));
+		hbCascade_free(&hc);
+	}
+	if(bench_enabled("hbCascade/decim8Fxp") && hbCascade_init(&hc, &hb, HB_FXP,
+				HB_DECIM, BENCH_HB_STAGES, (int)n, 16) == 0){
+		BENCH_RUN("hbCascade/decim8Fxp", "samples", n, n*16,
+			hbCascade_runSplit(pRe, pIm, &len, qRe, qIm, (int)n, &hc));
+		hbCascade_free(&hc);
+	}
+	if(bench_enabled("hbCascade/interp8") && hbCascade_init(&hc, &hb, HB_DOUBLE,
+				HB_INTERP, BENCH_HB_STAGES, (int)n >> BENCH_HB_STAGES, 0) == 0){
+		BENCH_RUN("hbCascade/interp8", "samples", n, n*32,
+			hbCascade_run(y, &len, x, (int)n >> BENCH_HB_STAGES, &hc));
+		hbCascade_free(&hc);
+	}
+
+cleanup:
+	free(x);
+	free(y);
+	free(fRe);
+	free(fIm);
+	free(gRe);
+	free(gIm);
+	free(qRe);
+	free(qIm);
+	free(pRe);
+	free(pIm);
+}
+
+/* rational and Farrow resampling of n input samples; the zero stuffing
+   chain upSamp + conv + downSamp runs one real lane at 3/2 for scale */
+static void bench_resample(long n)
+{
+	static const int ratio[][2] = {{3, 2}, {160, 147}, {147, 160}};
+	char name[64];
+	resamp_str rs;
+	resampFrac_str rf;
+	complex *x, *y;
+	double *xr, *u, *c, *yr;
+	int i, r, len, lenH;
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*(2*n + 2));
+	if(x == NULL || y == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++){
+		x[i].re = rnd() - 0.5;
+		x[i].im = rnd() - 0.5;
+	}
+
+	for(r = 0; r < (int)(sizeof(ratio)/sizeof(ratio[0])); r++){
+		snprintf(name, sizeof(name), "resamp/%d_%d", ratio[r][0], ratio[r][1]);
+		if(bench_enabled(name) && resamp_init(&rs, ratio[r][0], ratio[r][1], 0, (int)n) == 0){
+			BENCH_RUN(name, "samples", n, n*16 + rs.L*rs.P*8,
+				resamp_run(y, &len, x, (int)n, &rs));
+			resamp_free(&rs);
+		}
+	}
+
+	if(bench_enabled("resampFrac") && resampFrac_init(&rf, M_SQRT2, 1., (int)n) == 0){
+		BENCH_RUN("resampFrac", "samples", n, n*28,
+			resampFrac_run(y, &len, x, (int)n, &rf));
+		resampFrac_free(&rf);
+	}
+
+	if(bench_enabled("upSamp+conv/3_2") && resamp_init(&rs, 3, 2, 0, (int)n) == 0){
+		lenH = rs.L*rs.P;
+		xr = (double *)malloc(sizeof(double)*n);
+		u = (double *)malloc(sizeof(double)*3*n);
+		c = (double *)malloc(sizeof(double)*(3*n + lenH));
+		yr = (double *)malloc(sizeof(double)*(3*n/2 + 1));
+		if(xr != NULL && u != NULL && c != NULL && yr != NULL){
+			for(i = 0; i < n; i++)
+				xr[i] = x[i].re;
+			BENCH_RUN("upSamp+conv/3_2", "samples", n, n*8*(1 + 3 + 3) + lenH*8,
+				upSamp(u, 3*(int)n, xr, 3);
+				memset(c, 0, sizeof(double)*(3*n + lenH - 1));
+				conv(c, 3*(int)n + lenH - 1, rs.bank, lenH, u, 3*(int)n);
+				downSamp(yr, c, 3*(int)n, 2, 0));
+		}
+		free(xr);
+		free(u);
+		free(c);
+		free(yr);
+		resamp_free(&rs);
+	}
+
+cleanup:
+	free(x);
+	free(y);
+}
+
+static void bench_correlators(long n)
+{
+	double local[BENCH_CORR_LEN], *rev, *out;
+	complex lc[BENCH_CORR_LEN], *rc, *oc;
+	compBuf_str sr, sl, so;
+	long len_out = n + BENCH_CORR_LEN - 1;
+	int i;
+
+	rev = (double *)malloc(sizeof(double)*n);
+	out = (double *)malloc(sizeof(double)*len_out);
+	rc = (complex *)malloc(sizeof(complex)*n);
+	oc = (complex *)malloc(sizeof(complex)*len_out);
+	for(i = 0; i < n; i++){
+		rev[i] = rnd() - 0.5;
+		rc[i] = genComp(rev[i], rnd() - 0.5);
+	}
+	for(i = 0; i < BENCH_CORR_LEN; i++){
+		local[i] = rnd() - 0.5;
+		lc[i] = genComp(local[i], rnd() - 0.5);
+	}
+
+	if(bench_enabled("xcorr_range"))
+		BENCH_RUN("xcorr_range", "samples", n, (2*n) * 8,
+			xcorr_range(out, len_out, rev, n, local, BENCH_CORR_LEN,
+				MAX_MAGIC, MIN_MAGIC));
+
+	if(bench_enabled("xcorr_rangeComp"))
+		BENCH_RUN("xcorr_rangeComp", "samples", n, (2*n) * 16,
+			xcorr_rangeComp(oc, len_out, rc, n, lc, BENCH_CORR_LEN,
+				MAX_MAGIC, MIN_MAGIC));
+
+	if(bench_enabled("compBuf_xcorr") && compBuf_alloc(&sr, n) == 0){
+		compBuf_alloc(&sl, BENCH_CORR_LEN);
+		compBuf_alloc(&so, len_out);
+		compBuf_fromComp(&sr, rc, n);
+		compBuf_fromComp(&sl, lc, BENCH_CORR_LEN);
+		BENCH_RUN("compBuf_xcorr", "samples", n, (2*n) * 16,
+			compBuf_xcorr(&so, &sr, n, &sl, BENCH_CORR_LEN));
+		compBuf_free(&sr);
+		compBuf_free(&sl);
+		compBuf_free(&so);
+	}
+
+	free(rev);
+	free(out);
+	free(rc);
+	free(oc);
+}
+
+static void bench_nco(long n)
+{
+	double *lut, *ys, *yc;
+	int i;
+
+	if(!bench_enabled("nco_complex"))
+		return;
+
+	lut = (double *)malloc(sizeof(double)*BENCH_LUT_SIZE);
+	ys = (double *)malloc(sizeof(double)*n);
+	yc = (double *)malloc(sizeof(double)*n);
+	for(i = 0; i < BENCH_LUT_SIZE; i++)
+		lut[i] = sin(M_PI/2 * i / BENCH_LUT_SIZE);
+
+	BENCH_RUN("nco_complex", "samples", n, 2*n*8 + BENCH_LUT_SIZE*8,
+		nco_complex(ys, yc, n, lut, BENCH_LUT_SIZE, 0x01234567u, 0));
+
+	free(lut);
+	free(ys);
+	free(yc);
+}
+
+/* timing recovery of n samples at BENCH_SPS samples per symbol, QPSK
+   through a raised cosine-like pulse; the loop state carries over */
+static void bench_timing(long n)
+{
+	static const struct{
+		const char *name, *fxpName;
+		int ted, interp;
+	} cfg[] = {
+		{"timing/gardnerCubic", "timingFxp/gardnerCubic", TIMING_GARDNER, FARROW_CUBIC},
+		{"timing/mmParabolic", "timingFxp/mmParabolic", TIMING_MM, FARROW_PARABOLIC},
+	};
+	complex *x, *y;
+	sfxp_t *xRe, *xIm, *yRe, *yIm;
+	timing_str tr;
+	timingFxp_str tf;
+	double ph;
+	long i;
+	int k, len;
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*(n/BENCH_SPS + 2));
+	xRe = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	xIm = (sfxp_t *)malloc(sizeof(sfxp_t)*n);
+	yRe = (sfxp_t *)malloc(sizeof(sfxp_t)*(n/BENCH_SPS + 2));
+	yIm = (sfxp_t *)malloc(sizeof(sfxp_t)*(n/BENCH_SPS + 2));
+	if(x == NULL || y == NULL || xRe == NULL || xIm == NULL || yRe == NULL || yIm == NULL)
+		goto cleanup;
+
+	for(i = 0; i < n; i++){
+		ph = M_PI * i / BENCH_SPS;
+		x[i].re = ((rand() & 1) ? 1. : -1.) * sin(ph) * sin(ph);
+		x[i].im = ((rand() & 1) ? 1. : -1.) * sin(ph) * sin(ph);
+		xRe[i] = REAL2FXPROUND(x[i].re, 11);
+		xIm[i] = REAL2FXPROUND(x[i].im, 11);
+	}
+
+	for(k = 0; k < (int)(sizeof(cfg)/sizeof(cfg[0])); k++){
+		if(bench_enabled(cfg[k].name) && timing_init(&tr, BENCH_SPS, cfg[k].ted,
+					cfg[k].interp) == 0)
+			BENCH_RUN(cfg[k].name, "samples", n, n*16,
+				timing_run(y, &len, x, n, &tr));
+		if(bench_enabled(cfg[k].fxpName) && timingFxp_init(&tf, BENCH_SPS, cfg[k].ted,
+					cfg[k].interp, 16, 11) == 0)
+			BENCH_RUN(cfg[k].fxpName, "samples", n, n*8,
+				timingFxp_run(yRe, yIm, &len, xRe, xIm, n, &tf));
+	}
+
+cleanup:
+	free(x);
+	free(y);
+	free(xRe);
+	free(xIm);
+	free(yRe);
+	free(yIm);
+}
+
+/* carrier offset impairment, estimation and tracking on n QPSK symbols */
+static void bench_carrier(long n)
+{
+	complex *x;
+	carrierImp_str ci;
+	costas_str pll;
+	rng_str rng;
+	unsigned int acc = 0;
+	long i;
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	if(x == NULL)
+		return;
+	for(i = 0; i < n; i++){
+		x[i].re = (rand() & 1) ? M_SQRT1_2 : -M_SQRT1_2;
+		x[i].im = (rand() & 1) ? M_SQRT1_2 : -M_SQRT1_2;
+	}
+	rng_init(&rng, 1, 0);
+
+	if(bench_enabled("nco_mix"))
+		BENCH_RUN("nco_mix", "samples", n, n*32,
+			nco_mix(x, n, &acc, 0x01234567u));
+	if(bench_enabled("carrier_impair/pn")){
+		carrier_impInit(&ci, 1e-3, 0., 1e-5, &rng);
+		BENCH_RUN("carrier_impair/pn", "samples", n, n*32,
+			carrier_impair(x, n, &ci));
+	}
+	if(bench_enabled("carrier_estPower"))
+		BENCH_RUN("carrier_estPower", "samples", n, n*16,
+			benchSink = (unsigned int)(carrier_estPower(x, n, CARRIER_QPSK) * 1e9));
+	if(bench_enabled("costas_run") && costas_init(&pll, CARRIER_QPSK) == 0)
+		BENCH_RUN("costas_run", "samples", n, n*32,
+			costas_run(x, n, &pll));
+
+	free(x);
+}
+
+/* adaptive and frequency domain equalizers on n QPSK symbols */
+static void bench_equalizer(long n)
+{
+	static const char *algName[NUM_EQ_ALG] = {"lms", "nlms", "cma", "rls"};
+	static const complex ch[3] = {{1., 0.}, {0.35, 0.2}, {-0.15, 0.1}};
+	const constel_str *cons = constel_get(CONSTEL_PSK, 4);
+	char name[64];
+	complex *x, *y;
+	eq_str eq;
+	fde_str fde;
+	int alg, len;
+	long i;
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*(n + 1));
+	if(cons == NULL || x == NULL || y == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++){
+		x[i] = cons->point[rand() & 3];
+		if(i > 0){
+			x[i].re += ch[1].re*x[i-1].re - ch[1].im*x[i-1].im;
+			x[i].im += ch[1].re*x[i-1].im + ch[1].im*x[i-1].re;
+		}
+	}
+
+	for(alg = 0; alg < NUM_EQ_ALG; alg++){
+		snprintf(name, sizeof(name), "eq/%s%d", algName[alg], BENCH_EQ_TAPS);
+		if(bench_enabled(name) && eq_init(&eq, alg, BENCH_EQ_TAPS, 1,
+					(alg == EQ_NLMS) ? 0.1 : 0.005, cons, (int)n) == 0){
+			BENCH_RUN(name, "symbols", n, n*32,
+				eq_run(y, &len, x, (int)n, &eq));
+			eq_free(&eq);
+		}
+	}
+
+	if(bench_enabled("fde/mmse64") && fde_init(&fde, ch, 3, 0.01, FDE_MMSE, 64, 17, (int)n) == 0){
+		BENCH_RUN("fde/mmse64", "samples", n, n*32,
+			fde_run(y, x, (int)n, &fde));
+		fde_free(&fde);
+	}
+
+cleanup:
+	free(x);
+	free(y);
+}
+
+/* link statistics against the bit error count they ride along with */
+static void bench_stats(long n)
+{
+	const constel_str *cons = constel_get(CONSTEL_QAM, 16);
+	const int m = 4;
+	complex *s, *r;
+	int *bits, *label;
+	stats_str st;
+	volatile long numErr = 0;
+	long i;
+	int b;
+
+	s = (complex *)malloc(sizeof(complex)*n);
+	r = (complex *)malloc(sizeof(complex)*n);
+	bits = (int *)malloc(sizeof(int)*n*m);
+	label = (int *)malloc(sizeof(int)*n);
+	if(cons == NULL || s == NULL || r == NULL || bits == NULL || label == NULL
+			|| stats_init(&st, cons, 0.) < 0)
+		goto cleanup;
+	for(i = 0; i < n; i++){
+		label[i] = rand() & 15;
+		for(b = 0; b < m; b++)
+			bits[i*m + b] = (label[i] >> (m-1-b)) & 1;
+		s[i] = cons->point[label[i]];
+		r[i] = genComp(s[i].re + 0.1*(rand()/(double)RAND_MAX - 0.5),
+				s[i].im + 0.1*(rand()/(double)RAND_MAX - 0.5));
+	}
+
+	if(bench_enabled("stats/run"))
+		BENCH_RUN("stats/run", "symbols", n, n*36,
+			stats_run(&st, r, s, label, n));
+	if(bench_enabled("stats/runBits"))
+		BENCH_RUN("stats/runBits", "symbols", n, n*32,
+			stats_runBits(&st, r, bits, n));
+	if(bench_enabled("xorInt"))
+		BENCH_RUN("xorInt", "symbols", n, n*32,
+			numErr += xorInt(bits, bits + 1, (int)(n*m - 1)));
+	stats_free(&st);
+
+cleanup:
+	free(s);
+	free(r);
+	free(bits);
+	free(label);
+}
+
+static void bench_channel(long n)
+{
+	complex *sig;
+	compBuf_str sb;
+	rng_str rng;
+	int i;
+
+	sig = (complex *)malloc(sizeof(complex)*n);
+	for(i = 0; i < n; i++)
+		sig[i] = genComp(0., 0.);
+
+	if(bench_enabled("ch_awgn_complex"))
+		BENCH_RUN("ch_awgn_complex", "samples", n, n*16,
+			ch_awgn_complex(sig, n, 0.1));
+
+	if(bench_enabled("compBuf_chAwgn") && compBuf_alloc(&sb, n) == 0){
+		BENCH_RUN("compBuf_chAwgn", "samples", n, n*16,
+			compBuf_chAwgn(&sb, n, 0.1));
+		compBuf_free(&sb);
+	}
+
+	if(bench_enabled("ch_awgn_complexRng")){
+		rng_init(&rng, 1, 0);
+		BENCH_RUN("ch_awgn_complexRng", "samples", n, n*16,
+			ch_awgn_complexRng(sig, n, 0.1, &rng));
+	}
+
+	if(bench_enabled("ch_awgn_complexPool") && awgn_poolGet() != NULL){
+		rng_init(&rng, 1, 0);
+		BENCH_RUN("ch_awgn_complexPool", "samples", n, n*16,
+			ch_awgn_complexPool(sig, n, 0.1, &rng));
+	}
+
+	free(sig);
+}
+
+/* fading channels at 30.72 MHz with 300 Hz Doppler, in place */
+static void bench_fading(long n)
+{
+	static const struct{
+		const char *name;
+		int profile;
+	} chan[] = {
+		{"fade/flat", FADE_FLAT},
+		{"fade/EPA", FADE_EPA},
+		{"fade/ETU", FADE_ETU},
+		{"fade/TDL-A", FADE_TDLA},
+	};
+	compBuf_str sb;
+	fade_str fade;
+	int k, i;
+
+	if(compBuf_alloc(&sb, n) < 0)
+		return;
+	for(i = 0; i < n; i++)
+		sb.re[i] = 1.;
+
+	for(k = 0; k < (int)(sizeof(chan)/sizeof(chan[0])); k++){
+		if(!bench_enabled(chan[k].name)
+				|| fade_init(&fade, chan[k].profile, 30.72e6, 300., 300., 0., 1) < 0)
+			continue;
+		BENCH_RUN(chan[k].name, "samples", n, n*16,
+			fade_apply(&fade, &sb, &sb, n));
+		fade_free(&fade);
+	}
+
+	compBuf_free(&sb);
+}
+
+/* encoder and soft Viterbi decoder over one terminated block of n bits,
+   LLRs of the noiseless BPSK codeword with a little jitter */
+static void bench_convCode(long n)
+{
+	static const struct{
+		const char *encName;
+		const char *decName;
+		int preset;
+	} code[] = {
+		{"convEnc/K7R12", "convDec/K7R12", CONV_K7_R12},
+		{"convEnc/K7R34", "convDec/K7R34", CONV_K7_R34},
+		{"convEnc/K9R13", "convDec/K9R13", CONV_K9_R13},
+	};
+	conv_str conv;
+	int *bits, *coded, *dec, k, i, len, lenOut;
+	double *llr;
+
+	if(n > BENCH_CONV_MAX)
+		return;
+
+	bits = (int *)malloc(sizeof(int)*n);
+	dec = (int *)malloc(sizeof(int)*n);
+	coded = (int *)malloc(sizeof(int)*(CONV_MAX_N*(n + CONV_MAX_K)));
+	llr = (double *)malloc(sizeof(double)*(CONV_MAX_N*(n + CONV_MAX_K)));
+	if(bits == NULL || dec == NULL || coded == NULL || llr == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++)
+		bits[i] = rand() & 1;
+
+	for(k = 0; k < (int)(sizeof(code)/sizeof(code[0])); k++){
+		if(convCode_initPreset(&conv, code[k].preset) < 0)
+			continue;
+		convCode_enc(&len, coded, (int)n, bits, &conv);
+		for(i = 0; i < len; i++)
+			llr[i] = (coded[i] ? -4. : 4.) + (rand() % 200 - 100) * 0.02;
+
+		if(bench_enabled(code[k].encName))
+			BENCH_RUN(code[k].encName, "bits", n, n*4 + len*4,
+				convCode_enc(&len, coded, (int)n, bits, &conv));
+		if(bench_enabled(code[k].decName))
+			BENCH_RUN(code[k].decName, "bits", n, len*8 + n*4,
+				convCode_dec(&lenOut, dec, len, llr, &conv));
+		convCode_free(&conv);
+	}
+
+cleanup:
+	free(bits);
+	free(dec);
+	free(coded);
+	free(llr);
+}
+
+/* LDPC over the codewords that fit in n bits, one at a time and in
+   batches; the LLRs carry about 10% sign errors, so a decode takes a few
+   iterations */
+static void bench_ldpc(long n)
+{
+	ldpc_str ldpc;
+	int *bits = NULL, *coded = NULL, *dec = NULL, i, len, lenOut, numCw, cw;
+	double *llr = NULL;
+
+	if(n > BENCH_CONV_MAX || ldpc_initPreset(&ldpc, LDPC_WIFI_648_R12) < 0)
+		return;
+	if((numCw = (int)(n / ldpc.K)) == 0)
+		goto cleanup;
+
+	bits = (int *)malloc(sizeof(int)*numCw*ldpc.K);
+	dec = (int *)malloc(sizeof(int)*numCw*ldpc.K);
+	coded = (int *)malloc(sizeof(int)*numCw*ldpc.N);
+	llr = (double *)malloc(sizeof(double)*numCw*ldpc.N);
+	if(bits == NULL || dec == NULL || coded == NULL || llr == NULL)
+		goto cleanup;
+	for(i = 0; i < numCw*ldpc.K; i++)
+		bits[i] = rand() & 1;
+	ldpc_enc(&len, coded, numCw*ldpc.K, bits, &ldpc);
+	for(i = 0; i < len; i++)
+		llr[i] = (coded[i] ? -2. : 2.) + (rand() % 500 - 250) * 0.01;
+
+	if(bench_enabled("ldpcEnc/WiFi648R12"))
+		BENCH_RUN("ldpcEnc/WiFi648R12", "bits", (long)numCw*ldpc.K, (long)len*8,
+			ldpc_enc(&len, coded, numCw*ldpc.K, bits, &ldpc));
+	if(bench_enabled("ldpcDec1/WiFi648R12"))
+		BENCH_RUN("ldpcDec1/WiFi648R12", "bits", (long)numCw*ldpc.K, (long)len*12,
+			for(cw = 0; cw < numCw; cw++)
+				ldpc_decBatch(&dec[cw*ldpc.K], &llr[(long)cw*ldpc.N], 1, &ldpc));
+	if(bench_enabled("ldpcDec16/WiFi648R12"))
+		BENCH_RUN("ldpcDec16/WiFi648R12", "bits", (long)numCw*ldpc.K, (long)len*12,
+			ldpc_dec(&lenOut, dec, len, llr, &ldpc));
+
+cleanup:
+	free(bits);
+	free(dec);
+	free(coded);
+	free(llr);
+	ldpc_free(&ldpc);
+}
+
+/* CRC of n bits, one per int and packed into bytes */
+static void bench_crc(long n)
+{
+	static const struct{
+		const char *bitName, *byteName;
+		int preset;
+	} crc[] = {
+		{"crcBits/CRC24A", "crcBytes/CRC24A", CRC_24A},
+		{"crcBits/CRC32", "crcBytes/CRC32", CRC_32},
+	};
+	const crc_str *c;
+	unsigned char *bytes;
+	int *bits, k;
+	long i;
+
+	bits = (int *)malloc(sizeof(int)*n);
+	bytes = (unsigned char *)malloc(n/8 + 1);
+	if(bits == NULL || bytes == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++)
+		bits[i] = rand() & 1;
+	for(i = 0; i < n/8; i++)
+		bytes[i] = (unsigned char)rand();
+
+	for(k = 0; k < (int)(sizeof(crc)/sizeof(crc[0])); k++){
+		if((c = crc_get(crc[k].preset)) == NULL)
+			continue;
+		if(bench_enabled(crc[k].bitName))
+			BENCH_RUN(crc[k].bitName, "bits", n, n*4,
+				benchSink = crc_calcBits(c, bits, n));
+		if(bench_enabled(crc[k].byteName))
+			BENCH_RUN(crc[k].byteName, "bits", n, n/8,
+				benchSink = crc_calcBytes(c, bytes, n/8));
+	}
+
+cleanup:
+	free(bits);
+	free(bytes);
+}
+
+/* n/1024 transforms of 1024 points, batched and one by one, and OFDM
+   symbols of 1024 bins (600 data subcarriers, 72 sample prefix) */
+static void bench_fft(long n)
+{
+	const fftPlan_str *plan;
+	ofdm_str ofdm;
+	complex *x = NULL, *y = NULL, *sym = NULL;
+	int numVec = (int)(n / 1024), numSym, v;
+	long i;
+
+	if(numVec == 0 || (plan = fft_getPlan(1024)) == NULL)
+		return;
+	if(ofdm_init(&ofdm, 1024, 72, 600, NULL, 1) < 0)
+		return;
+	numSym = (int)(n / ofdm.lenSym);
+
+	x = (complex *)malloc(sizeof(complex)*n);
+	y = (complex *)malloc(sizeof(complex)*n);
+	sym = (complex *)malloc(sizeof(complex)*(numSym*ofdm.numData + 1));
+	if(x == NULL || y == NULL || sym == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++){
+		x[i].re = rand() / (double)RAND_MAX - 0.5;
+		x[i].im = rand() / (double)RAND_MAX - 0.5;
+	}
+	for(i = 0; i < (long)numSym*ofdm.numData; i++)
+		sym[i] = x[i];
+
+	if(bench_enabled("fftBatch/1024"))
+		BENCH_RUN("fftBatch/1024", "samples", (long)numVec*1024, n*32,
+			fft_batch(plan, y, 1024, x, 1024, numVec, FFT_FORWARD, 1));
+	if(bench_enabled("fft/1024"))
+		BENCH_RUN("fft/1024", "samples", (long)numVec*1024, n*32,
+			for(v = 0; v < numVec; v++)
+				fft_exec(plan, y + (long)v*1024, x + (long)v*1024, FFT_FORWARD));
+	if(numSym > 0 && bench_enabled("ofdmMod/1024"))
+		BENCH_RUN("ofdmMod/1024", "samples", (long)numSym*ofdm.lenSym, n*32,
+			ofdm_mod(y, sym, numSym, &ofdm));
+	if(numSym > 0 && bench_enabled("ofdmDemod/1024"))
+		BENCH_RUN("ofdmDemod/1024", "samples", (long)numSym*ofdm.lenSym, n*32,
+			ofdm_demod(sym, y, numSym, &ofdm));
+
+cleanup:
+	free(x);
+	free(y);
+	free(sym);
+	ofdm_free(&ofdm);
+}
+
+/* n samples to a capture file and back; the writes include the final
+   flush, the reads walk the mapping chunk by chunk */
+static void bench_iqWrite(const char *fName, int fmt, const complex *x, long n)
+{
+	iqSink_str sink;
+	long i;
+
+	if(iqSink_open(&sink, fName, fmt, 0., 0.) < 0)
+		return;
+	for(i = 0; i < n; i += 4096)
+		iqSink_write(&sink, x + i, (n - i < 4096) ? n - i : 4096);
+	iqSink_close(&sink);
+}
+
+static void bench_iqRead(const char *fName, int fmt)
+{
+	iqSrc_str src;
+	complex *chunk;
+	double acc = 0.;
+	int len;
+
+	if(iqSrc_open(&src, fName, fmt, 0., 4096) < 0)
+		return;
+	while((len = iqSrc_next(&src, &chunk, 4096)) > 0)
+		acc += chunk[len-1].re;
+	iqSrc_close(&src);
+	benchSink = (unsigned int)acc;
+}
+
+static void bench_iqFile(long n)
+{
+	static const struct{
+		const char *writeName, *readName;
+		int fmt;
+	} iq[] = {
+		{"iqSink/ci16", "iqSource/ci16", IQ_CI16},
+		{"iqSink/cf32", "iqSource/cf32", IQ_CF32},
+		{"iqSink/cf64", "iqSource/cf64", IQ_CF64},
+	};
+	char fName[64];
+	complex *x;
+	long i;
+	int k, fd;
+
+	strcpy(fName, "/tmp/comsim_bench_iqXXXXXX");
+	if((x = (complex *)malloc(sizeof(complex)*n)) == NULL
+			|| (fd = mkstemp(fName)) < 0){
+		free(x);
+		return;
+	}
+	close(fd);
+	for(i = 0; i < n; i++){
+		x[i].re = rand() / (double)RAND_MAX - 0.5;
+		x[i].im = rand() / (double)RAND_MAX - 0.5;
+	}
+
+	for(k = 0; k < (int)(sizeof(iq)/sizeof(iq[0])); k++){
+		if(bench_enabled(iq[k].writeName))
+			BENCH_RUN(iq[k].writeName, "samples", n, n*16,
+				bench_iqWrite(fName, iq[k].fmt, x, n));
+		if(bench_enabled(iq[k].readName)){
+			bench_iqWrite(fName, iq[k].fmt, x, n);
+			BENCH_RUN(iq[k].readName, "samples", n, n*16,
+				bench_iqRead(fName, iq[k].fmt));
+		}
+	}
+
+	unlink(fName);
+	free(x);
+}
+
+/* mappers and demappers; n is the number of bits */
+static void bench_mappers(long n)
+{
+	static const struct{
+		const char *mapName, *hdName;
+		int order, isQam;
+	} mod[] = {
+		{"mapPsk/8PSK", "PskHd/8PSK", PSK8, 0},
+		{"mapQam/QAM16", "QamHd/QAM16", QAM16, 1},
+		{"mapQam/QAM64", "QamHd/QAM64", QAM64, 1},
+		{"mapQam/QAM1024", "QamHd/QAM1024", 1024, 1},
+	};
+	int *bits, *dec, lenSym, lenBit, i, k, m;
+	complex *sym;
+	long nb;
+
+	bits = (int *)malloc(sizeof(int)*n);
+	dec = (int *)malloc(sizeof(int)*n);
+	sym = (complex *)malloc(sizeof(complex)*n);
+	for(i = 0; i < n; i++)
+		bits[i] = rand() & 1;
+
+	for(k = 0; k < (int)(sizeof(mod)/sizeof(mod[0])); k++){
+		m = (int)log2(mod[k].order);
+		nb = n / m * m;
+		lenSym = nb / m;
+
+		if(bench_enabled(mod[k].mapName)){
+			if(mod[k].isQam)
+				BENCH_RUN(mod[k].mapName, "bits", nb, nb*4 + lenSym*16,
+					mapQam(&lenSym, sym, nb, bits, mod[k].order, 1.0));
+			else
+				BENCH_RUN(mod[k].mapName, "bits", nb, nb*4 + lenSym*16,
+					mapPsk(&lenSym, sym, nb, bits, mod[k].order, 1.0));
+		} else if(mod[k].isQam)
+			mapQam(&lenSym, sym, nb, bits, mod[k].order, 1.0);
+		else
+			mapPsk(&lenSym, sym, nb, bits, mod[k].order, 1.0);
+
+		if(bench_enabled(mod[k].hdName)){
+			if(mod[k].isQam)
+				BENCH_RUN(mod[k].hdName, "bits", nb, nb*4 + lenSym*16,
+					QamHd(&lenBit, dec, lenSym, sym, mod[k].order));
+			else
+				BENCH_RUN(mod[k].hdName, "bits", nb, nb*4 + lenSym*16,
+					PskHd(&lenBit, dec, lenSym, sym, mod[k].order));
+		}
+	}
+
+	free(bits);
+	free(dec);
+	free(sym);
+}
+
+/* packed grouping and its int per bit front ends, then the table mapper
+   and slicer built on them */
+static void bench_bitGroup(long n)
+{
+	static const int bitsPerIdx[] = {2, 4, 6, 10};
+	constel_str *cons = constel_get(CONSTEL_QAM, 64);
+	unsigned char *packed;
+	int *bits, *idx, lenSym, lenBit, i, k, m;
+	complex *sym;
+	long num;
+	char name[64];
+
+	bits = (int *)malloc(sizeof(int)*n);
+	idx = (int *)malloc(sizeof(int)*n);
+	packed = (unsigned char *)malloc(n/8 + 16);
+	sym = (complex *)malloc(sizeof(complex)*n);
+	if(bits == NULL || idx == NULL || packed == NULL || sym == NULL || cons == NULL)
+		goto cleanup;
+	for(i = 0; i < n; i++)
+		bits[i] = rand() & 1;
+	bitGroup_pack(packed, bits, n);
+
+	if(bench_enabled("bitGroup/pack"))
+		BENCH_RUN("bitGroup/pack", "bits", n, n*4 + n/8, bitGroup_pack(packed, bits, n));
+	if(bench_enabled("bitGroup/unpack"))
+		BENCH_RUN("bitGroup/unpack", "bits", n, n*4 + n/8, bitGroup_unpack(bits, packed, n));
+
+	for(k = 0; k < (int)(sizeof(bitsPerIdx)/sizeof(bitsPerIdx[0])); k++){
+		m = bitsPerIdx[k];
+		num = n / m;
+		sprintf(name, "bitGroup/index%d", m);
+		if(bench_enabled(name))
+			BENCH_RUN(name, "bits", num*m, num*m/8 + num*4,
+				bitGroup_index(idx, packed, num, m));
+		sprintf(name, "bitGroup/scatter%d", m);
+		if(bench_enabled(name))
+			BENCH_RUN(name, "bits", num*m, num*m/8 + num*4,
+				bitGroup_scatter(packed, idx, num, m));
+		sprintf(name, "bitGroup/fromBits%d", m);
+		if(bench_enabled(name))
+			BENCH_RUN(name, "bits", num*m, num*m*4 + num*4,
+				bitGroup_fromBits(idx, bits, num, m));
+	}
+
+	lenBit = (int)(n / 6 * 6);
+	if(bench_enabled("mapConstel/QAM64"))
+		BENCH_RUN("mapConstel/QAM64", "bits", lenBit, lenBit*4 + lenBit/6*16,
+			mapConstel(&lenSym, sym, lenBit, bits, cons));
+	if(bench_enabled("ConstelHd/QAM64")){
+		mapConstel(&lenSym, sym, lenBit, bits, cons);
+		BENCH_RUN("ConstelHd/QAM64", "bits", lenBit, lenBit*4 + lenBit/6*16,
+			ConstelHd(&lenBit, idx, lenSym, sym, cons));
+	}
+
+cleanup:
+	free(bits);
+	free(idx);
+	free(packed);
+	free(sym);
+}
+
+static void bench_source(long n)
+{
+	prbs_str pr;
+	rng_str rng;
+	int *bits;
+	long k = 0;
+
+	bits = (int *)malloc(sizeof(int)*n);
+	if(bits == NULL)
+		return;
+
+	if(bench_enabled("genBitSource"))
+		BENCH_RUN("genBitSource", "bits", n, n*4, genBitSource(bits, n));
+	if(bench_enabled("genBitSourceRng")){
+		rng_init(&rng, 1, 0);
+		BENCH_RUN("genBitSourceRng", "bits", n, n*4,
+			genBitSourceRng(bits, n, &rng));
+	}
+	if(prbs_getGen(PRBS_31) != NULL){
+		prbs_init(&pr, prbs_getGen(PRBS_31), 0);
+		if(bench_enabled("prbs/prbs31"))
+			BENCH_RUN("prbs/prbs31", "bits", n, n*4, prbs_bits(&pr, bits, n));
+		/* a seek per frame of n bits to an arbitrary frame */
+		if(bench_enabled("prbs/seek"))
+			BENCH_RUN("prbs/seek", "bits", n, n*4,
+				prbs_seek(&pr, (unsigned long long)(k++ * 7919) * n);
+				prbs_bits(&pr, bits, n));
+	}
+	free(bits);
+}
+
+/* source -> mapper -> AWGN -> demapper -> error count over n QPSK symbols:
+   one full pass over memory per stage against the block pipeline */
+static void bench_chainFull(int *bits, complex *sym, int *dec, long n,
+		const constel_str *cons)
+{
+	rng_str rng;
+	int len, i;
+	long numErr = 0;
+
+	for(i = 0; i < 2*n; i++)
+		bits[i] = rand() & 1;
+	mapConstel(&len, sym, 2*n, bits, cons);
+	rng_init(&rng, 1, 0);
+	ch_awgn_complexRng(sym, n, 0.1, &rng);
+	ConstelHd(&len, dec, n, sym, cons);
+	for(i = 0; i < 2*n; i++)
+		numErr += bits[i] ^ dec[i];
+}
+
+static void bench_pipeline(long n)
+{
+	constel_str *cons = constel_get(CONSTEL_QAM, 4);
+	int *bits, *dec;
+	complex *sym;
+	pipe_str pipe;
+	pipeErr_str err;
+	pipeAwgn_str awgn = {0.1, 1, 0};
+
+	if(bench_enabled("chain/fullPass")){
+		bits = (int *)malloc(sizeof(int)*2*n);
+		dec = (int *)malloc(sizeof(int)*2*n);
+		sym = (complex *)malloc(sizeof(complex)*n);
+		BENCH_RUN("chain/fullPass", "samples", n, n*(16 + 16),
+			bench_chainFull(bits, sym, dec, n, cons));
+		free(bits);
+		free(dec);
+		free(sym);
+	}
+
+	if(!bench_enabled("chain/pipe") || pipe_init(&pipe, 0, 2) < 0)
+		return;
+	pipeErr_init(&err, 2*n);
+	pipe_addStage(&pipe, "source", pipeStage_source, cons, PIPE_NO_PROF);
+	pipe_addStage(&pipe, "mapper", pipeStage_mapper, cons, PIPE_NO_PROF);
+	pipe_addStage(&pipe, "channel", pipeStage_awgn, &awgn, PIPE_NO_PROF);
+	pipe_addStage(&pipe, "demapper", pipeStage_hd, cons, PIPE_NO_PROF);
+	pipe_addStage(&pipe, "countErr", pipeStage_countErr, &err, PIPE_NO_PROF);
+
+	BENCH_RUN("chain/pipe", "samples", n, PIPE_NUM_BLOCKS * PIPE_BLOCK_SYM * 32,
+		pipe_run(&pipe, n, 1));
+	BENCH_RUN("chain/pipe2T", "samples", n, PIPE_NUM_BLOCKS * PIPE_BLOCK_SYM * 32,
+		pipe_run(&pipe, n, 2));
+	pipe_free(&pipe);
+}
+
+/***********************************
+ * Main                            *
+ ***********************************/
+
+static int bench_writeTaps(void)
+{
+	FILE *file;
+	int fd, i;
+
+	strcpy(tapFile, "/tmp/comsim_bench_tapsXXXXXX");
+	if((fd = mkstemp(tapFile)) < 0 || (file = fdopen(fd, "w")) == NULL){
+		printf("Unable to create tap file\n");
+		return -1;
+	}
+	for(i = 0; i < BENCH_NUM_TAPS; i++)
+		fprintf(file, "%.17g\n", 1. / (i + 1));
+	fclose(file);
+
+	return 0;
+}
+
+/* BER of hard decisions with exact and with pool noise at two SNR points
+   per modulation; frame k of a point draws its bits and noise from stream
+   k, so both runs see the same bits. dev is the relative BER deviation,
+   z the deviation in standard deviations of the difference of two
+   independent binomial estimates. */
+static int bench_noiseReport()
+{
+	static const struct{
+		const char *name;
+		int family, order;
+		double snr[2];
+	} mod[] = {
+		{"BPSK", CONSTEL_PSK, 2, {4., 7.}},
+		{"QPSK", CONSTEL_QAM, 4, {7., 10.}},
+		{"8PSK", CONSTEL_PSK, 8, {12., 15.}},
+		{"16QAM", CONSTEL_QAM, 16, {14., 17.}},
+		{"16APSK", CONSTEL_APSK, 16, {15., 18.}},
+		{"64QAM", CONSTEL_QAM, 64, {20., 23.}},
+		{"256QAM", CONSTEL_QAM, 256, {26., 29.}},
+	};
+	const constel_str *cons;
+	complex sym[BENCH_NOISE_FRM], y[BENCH_NOISE_FRM];
+	int bits[BENCH_NOISE_FRM*8], dec[BENCH_NOISE_FRM*8];
+	long numErr[2], numBit, f;
+	double var, ber[2], sd;
+	rng_str rng;
+	int k, s, pool, len, lenBit;
+
+	if(awgn_poolGet() == NULL)
+		return -1;
+
+	printf("# noise pool of 2^%d samples against exact AWGN, %ld symbols per point\n",
+			AWGN_POOL_LOG2, BENCH_NOISE_SYM);
+	printf("%-8s %6s %12s %12s %9s %7s\n", "mod", "EsN0", "BER awgn", "BER pool",
+			"dev", "z");
+
+	for(k = 0; k < (int)(sizeof(mod)/sizeof(mod[0])); k++){
+		if((cons = constel_get(mod[k].family, mod[k].order)) == NULL)
+			continue;
+		lenBit = BENCH_NOISE_FRM * cons->bitsPerSym;
+
+		for(s = 0; s < 2; s++){
+			var = cons->avePow / pow(10., mod[k].snr[s]/10.);
+			for(pool = 0; pool < 2; pool++){
+				numErr[pool] = 0;
+				for(f = 0; f < BENCH_NOISE_SYM / BENCH_NOISE_FRM; f++){
+					rng_init(&rng, 1, f);
+					genBitSourceRng(bits, lenBit, &rng);
+					mapConstel(&len, sym, lenBit, bits, cons);
+					memcpy(y, sym, sizeof(complex)*BENCH_NOISE_FRM);
+					if(pool)
+						ch_awgn_complexPool(y, BENCH_NOISE_FRM, var, &rng);
+					else
+						ch_awgn_complexRng(y, BENCH_NOISE_FRM, var, &rng);
+					ConstelHd(&len, dec, BENCH_NOISE_FRM, y, cons);
+					numErr[pool] += xorInt(bits, dec, lenBit);
+				}
+			}
+
+			numBit = BENCH_NOISE_SYM * cons->bitsPerSym;
+			ber[0] = (double)numErr[0] / numBit;
+			ber[1] = (double)numErr[1] / numBit;
+			sd = sqrt((ber[0]*(1. - ber[0]) + ber[1]*(1. - ber[1])) / numBit);
+			printf("%-8s %6.1f %12.4e %12.4e %+8.2f%% %+7.2f\n", mod[k].name,
+					mod[k].snr[s], ber[0], ber[1],
+					(ber[0] > 0.) ? 100. * (ber[1] - ber[0]) / ber[0] : 0.,
+					(sd > 0.) ? (ber[1] - ber[0]) / sd : 0.);
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *outName = NULL;
+	long n;
+	int i;
+
+	for(i = 1; i < argc; i++){
+		if(!strcmp(argv[i], "-o") && i+1 < argc)
+			outName = argv[++i];
+		else if(!strcmp(argv[i], "-k") && i+1 < argc)
+			benchFilter = argv[++i];
+		else if(!strcmp(argv[i], "-min") && i+1 < argc)
+			benchMinLog2 = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-max") && i+1 < argc)
+			benchMaxLog2 = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i+1 < argc)
+			benchMinTime = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-noise"))
+			return bench_noiseReport() < 0 ? 1 : 0;
+		else {
+			fprintf(stderr, "usage: %s [-o out.json] [-k kernel] [-min log2] "
+					"[-max log2] [-t seconds]\n       %s -noise\n", argv[0], argv[0]);
+			return 1;
+		}
+	}
+
+	if(outName == NULL)
+		benchJson = stdout;
+	else if((benchJson = fopen(outName, "w")) == NULL){
+		fprintf(stderr, "Unable to open %s\n", outName);
+		return 1;
+	}
+
+	if(bench_writeTaps() < 0)
+		return 1;
+	perf_init();
+
+	fprintf(benchJson, "{\n  \"suite\": \"comsim_bench\",\n"
+			"  \"min_time_s\": %.3f,\n  \"cache_counters\": %s,\n  \"results\": [\n",
+			benchMinTime, perfFd[1] >= 0 ? "true" : "false");
+
+	for(n = 1L << benchMinLog2; n <= 1L << benchMaxLog2; n <<= 2){
+		bench_filters(n);
+		bench_pulse(n);
+		bench_halfband(n);
+		bench_resample(n);
+		bench_correlators(n);
+		bench_nco(n);
+		bench_channel(n);
+		bench_timing(n);
+		bench_carrier(n);
+		bench_equalizer(n);
+		bench_stats(n);
+		bench_fading(n);
+		bench_convCode(n);
+		bench_ldpc(n);
+		bench_crc(n);
+		bench_fft(n);
+		bench_iqFile(n);
+		bench_mappers(n);
+		bench_bitGroup(n);
+		bench_source(n);
+		bench_pipeline(n);
+	}
+
+	fprintf(benchJson, "\n  ]\n}\n");
+	if(benchJson != stdout)
+		fclose(benchJson);
+	unlink(tapFile);
+
+	return 0;
+}
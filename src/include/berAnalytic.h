@@ -0,0 +1,616 @@
+/* File: berAnalytic.h
+ *
+ * Description: Semi-analytic BER estimation for linear AWGN links
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#ifndef __BERANALYTIC_H__
+#define __BERANALYTIC_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "comMath.h"
+#include "constel.h"
+#include "awgn.h"
+
+/* Defines */
+#define SA_GL_ORDER		8		/* Gauss-Legendre nodes per sub-interval */
+#define SA_GL_SPLIT		8		/* sub-intervals of the PSK phase integral */
+#define SA_TAIL_EXP		80.		/* skip regions below exp(-SA_TAIL_EXP) */
+#define SA_MEMO_SNR		64		/* noise levels remembered per label */
+
+/* 8 point Gauss-Legendre nodes and weights on [-1, 1] */
+static const double saGlNode[SA_GL_ORDER] = {
+	-0.96028985649753623, -0.79666647741362674,
+	-0.52553240991632899, -0.18343464249564980,
+	 0.18343464249564980,  0.52553240991632899,
+	 0.79666647741362674,  0.96028985649753623};
+static const double saGlWeight[SA_GL_ORDER] = {
+	 0.10122853629037626,  0.22238103445337447,
+	 0.31370664587788729,  0.36268378337836198,
+	 0.36268378337836198,  0.31370664587788729,
+	 0.22238103445337447,  0.10122853629037626};
+
+/* Functions */
+
+/* Gaussian tail probability */
+static inline double Qfunc(double x)
+{
+	return 0.5 * erfc(x / sqrt(2.));
+}
+
+/* P(x + n in [lo, hi]), n ~ N(0, sigma^2) */
+static inline double sa_intervalProb(double x, double lo, double hi, double sigma)
+{
+	/* evaluate on the tail side to keep relative accuracy at 1e-12 */
+	if(x < lo)
+		return Qfunc((lo - x) / sigma) - Qfunc((hi - x) / sigma);
+	if(x > hi)
+		return Qfunc((x - hi) / sigma) - Qfunc((x - lo) / sigma);
+
+	return 1. - Qfunc((x - lo) / sigma) - Qfunc((hi - x) / sigma);
+}
+
+/* add P(bit b of the decided PAM label differs from txLab) to pe[] */
+static void sa_pamBitErr(double pe[], double x, int txLab, const constel_str *cons,
+		int L, const int *lvLabel, int nb, double sigma)
+{
+	double half = 0.5 * cons->lvStep, c, p;
+	int k, b, diff;
+
+	for(k = 0; k < L; k++){
+		if((diff = lvLabel[k] ^ txLab) == 0)
+			continue;
+
+		c = (k - 0.5*(L-1)) * cons->lvStep;
+		p = sa_intervalProb(x, (k == 0)? -HUGE_VAL : c - half,
+				(k == L-1)? HUGE_VAL : c + half, sigma);
+
+		for(b = 0; b < nb; b++)
+			if((diff >> (nb-1-b)) & 1)
+				pe[b] += p;
+	}
+}
+
+/* Pawula's form of the phase distribution of a signal point in Gaussian
+   noise, rho = |s|^2 / (2 sigma^2):
+     P(arg(s + n) - arg(s) in [psi, pi]) =
+         1/(2 pi) int_0^(pi - psi) exp(-rho sin^2(psi) / sin^2(t)) dt
+   The integrand is smooth and bounded, so composite Gauss-Legendre is
+   accurate in the far tail as well. */
+static double sa_phaseTail(double psi, double rho)
+{
+	double x = rho * pow(sin(psi), 2), h, mid, st, sum = 0.;
+	int i, k;
+
+	if(psi >= M_PI)
+		return 0.;
+	if(x > SA_TAIL_EXP && psi <= M_PI/2)
+		return 0.;
+
+	h = (M_PI - psi) / SA_GL_SPLIT;
+	for(i = 0; i < SA_GL_SPLIT; i++){
+		mid = (i + 0.5) * h;
+		for(k = 0; k < SA_GL_ORDER; k++){
+			st = sin(mid + 0.5*h*saGlNode[k]);
+			sum += saGlWeight[k] * exp(-x / (st*st));
+		}
+	}
+
+	return 0.25 * h * sum / M_PI;
+}
+
+/* M-PSK: probability of every wrong decision wedge from the phase tail
+   probabilities of its two boundaries */
+static void sa_pskBitErr(double pe[], complex s, int txLab,
+		const constel_str *cons, double sigma)
+{
+	double bound[MAX_CONSTEL_ORDER+1], tail[MAX_CONSTEL_ORDER+1];
+	double rho = absSqrComp(s) / (2*sigma*sigma);
+	double phi = atan2(s.im, s.re), width = 2*M_PI / cons->order;
+	double p, lo, hi;
+	int k, b, diff, m = cons->bitsPerSym;
+
+	/* decision boundaries relative to the received phase, in (-pi, pi] */
+	for(k = 0; k <= cons->order; k++){
+		bound[k] = remainder(cons->phOffset + (k - 0.5) * width - phi, 2*M_PI);
+		tail[k] = sa_phaseTail(fabs(bound[k]), rho);
+	}
+
+	for(k = 0; k < cons->order; k++){
+		if((diff = grayEnc(k) ^ txLab) == 0)
+			continue;
+
+		lo = bound[k];
+		hi = bound[k+1];
+		if(lo >= 0. && hi > lo)				/* [lo, hi] above arg(s) */
+			p = tail[k] - tail[k+1];
+		else if(hi <= 0. && hi > lo)		/* [lo, hi] below arg(s) */
+			p = tail[k+1] - tail[k];
+		else if(lo > 0. && hi < 0.)			/* wraps around pi */
+			p = tail[k] + tail[k+1];
+		else								/* holds arg(s) itself */
+			p = 1. - tail[k] - tail[k+1];
+
+		for(b = 0; b < m; b++)
+			if((diff >> (m-1-b)) & 1)
+				pe[b] += p;
+	}
+}
+
+/* Per constellation state, kept until another constellation is asked for:
+   - the decision regions of the minimum distance slicer of APSK and cross
+     QAM, i.e. the Voronoi cells, as convex polygons with counter-clockwise
+     vertices; unbounded cells are closed by a box far enough out that its
+     edges carry no probability,
+   - the expected bit errors of every nominal point at the last
+     SA_MEMO_SNR noise levels, since every frame repeats the SNR grid. */
+typedef struct{
+	int order;
+	complex *point;				// constellation the state belongs to
+	int *first;					// vertices of cell k: first[k] .. first[k+1]-1
+	double *vx, *vy;
+	int numSigma;				// noise levels seen, the slot is modulo SA_MEMO_SNR
+	double sigma[SA_MEMO_SNR];
+	double *memo;				// [slot][label], NAN until computed
+} saCache_str;
+
+static saCache_str saCache;
+
+static void sa_cacheFree(void)
+{
+	free(saCache.point);
+	free(saCache.first);
+	free(saCache.vx);
+	free(saCache.vy);
+	free(saCache.memo);
+	memset(&saCache, 0, sizeof(saCache_str));
+}
+
+/* clip the polygon (x, y, n) to the half-plane ax*X + ay*Y <= c */
+static int sa_clip(double ox[], double oy[], const double x[], const double y[],
+		int n, double ax, double ay, double c)
+{
+	double d0, d1, t;
+	int i, k = 0;
+
+	for(i = 0; i < n; i++){
+		d0 = ax*x[i] + ay*y[i] - c;
+		d1 = ax*x[(i+1)%n] + ay*y[(i+1)%n] - c;
+		if(d0 <= 0.){
+			ox[k] = x[i];
+			oy[k++] = y[i];
+		}
+		if((d0 < 0. && d1 > 0.) || (d0 > 0. && d1 < 0.)){
+			t = d0 / (d0 - d1);
+			ox[k] = x[i] + t*(x[(i+1)%n] - x[i]);
+			oy[k++] = y[i] + t*(y[(i+1)%n] - y[i]);
+		}
+	}
+
+	return k;
+}
+
+/* function sa_cacheInit()
+
+	Description: state of cons, the Voronoi cells by half-plane clipping
+	             for the constellations without a separable or phase
+	             slicer
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+
+	Caution:
+		not thread safe
+ */
+
+static int sa_cacheInit(const constel_str *cons)
+{
+	const int M = cons->order;
+	double *bx = NULL, *by = NULL, *cx = NULL, *cy = NULL, *tmp, box = 0.;
+	complex pk, pj;
+	int k, j, n, total = 0, cap = 8*M;
+
+	if(saCache.order == M && !memcmp(saCache.point, cons->point, sizeof(complex)*M)
+			&& (saCache.first != NULL || cons->isSep || cons->family == CONSTEL_PSK))
+		return 0;
+	sa_cacheFree();
+
+	saCache.point = (complex *)malloc(sizeof(complex)*M);
+	saCache.memo = (double *)malloc(sizeof(double)*SA_MEMO_SNR*M);
+	if(!saCache.point || !saCache.memo)
+		goto fail;
+	memcpy(saCache.point, cons->point, sizeof(complex)*M);
+	if(cons->isSep || cons->family == CONSTEL_PSK){
+		saCache.order = M;
+		return 0;
+	}
+
+	saCache.first = (int *)malloc(sizeof(int)*(M+1));
+	saCache.vx = (double *)malloc(sizeof(double)*cap);
+	saCache.vy = (double *)malloc(sizeof(double)*cap);
+	bx = (double *)malloc(sizeof(double)*(M+4));
+	by = (double *)malloc(sizeof(double)*(M+4));
+	cx = (double *)malloc(sizeof(double)*(M+4));
+	cy = (double *)malloc(sizeof(double)*(M+4));
+	if(!saCache.first || !saCache.vx || !saCache.vy || !bx || !by || !cx || !cy)
+		goto fail;
+
+	for(k = 0; k < M; k++)
+		box = fmax(box, fabs(cons->point[k].re) + fabs(cons->point[k].im));
+	box = 1e4 * (box + 1.);
+
+	for(k = 0; k < M; k++){
+		pk = cons->point[k];
+		bx[0] = -box; by[0] = -box;
+		bx[1] = box; by[1] = -box;
+		bx[2] = box; by[2] = box;
+		bx[3] = -box; by[3] = box;
+		n = 4;
+
+		/* closer to pk than to pj */
+		for(j = 0; j < M && n > 0; j++){
+			if(j == k)
+				continue;
+			pj = cons->point[j];
+			n = sa_clip(cx, cy, bx, by, n, pj.re - pk.re, pj.im - pk.im,
+					0.5 * (absSqrComp(pj) - absSqrComp(pk)));
+			tmp = bx; bx = cx; cx = tmp;
+			tmp = by; by = cy; cy = tmp;
+		}
+
+		if(total + n > cap){
+			cap = 2*(total + n);
+			if((tmp = (double *)realloc(saCache.vx, sizeof(double)*cap)) == NULL)
+				goto fail;
+			saCache.vx = tmp;
+			if((tmp = (double *)realloc(saCache.vy, sizeof(double)*cap)) == NULL)
+				goto fail;
+			saCache.vy = tmp;
+		}
+		saCache.first[k] = total;
+		memcpy(&saCache.vx[total], bx, sizeof(double)*n);
+		memcpy(&saCache.vy[total], by, sizeof(double)*n);
+		total += n;
+	}
+	saCache.first[M] = total;
+	saCache.order = M;
+
+	free(bx);
+	free(by);
+	free(cx);
+	free(cy);
+	return 0;
+
+fail:
+	printf("[semiAnalytic] fail to mem alloc\n");
+	sa_cacheFree();
+	free(bx);
+	free(by);
+	free(cx);
+	free(cy);
+	return -1;
+}
+
+/* memo row of noise level sigma, reusing the oldest slot for a new one */
+static double *sa_memoRow(double sigma)
+{
+	double *row;
+	int k, slot;
+
+	for(k = 0; k < SA_MEMO_SNR && k < saCache.numSigma; k++)
+		if(saCache.sigma[k] == sigma)
+			return &saCache.memo[k * saCache.order];
+
+	slot = saCache.numSigma++ % SA_MEMO_SNR;
+	saCache.sigma[slot] = sigma;
+	row = &saCache.memo[slot * saCache.order];
+	for(k = 0; k < saCache.order; k++)
+		row[k] = NAN;
+
+	return row;
+}
+
+/* 1/(2 pi) int_0^beta exp(-H / cos^2(t)) dt, 0 <= beta <= pi/2: the
+   probability that a Gaussian at distance h = sigma sqrt(2H) from a line
+   falls beyond it inside a wedge of angle beta from the foot of the
+   perpendicular (Owen's T(h/sigma, tan(beta)) in angular form) */
+static double sa_wedgeTail(double H, double beta)
+{
+	double h, mid, t, sum = 0.;
+	int i, k;
+
+	if(H > SA_TAIL_EXP)
+		return 0.;
+	if(H > 0.)
+		beta = fmin(beta, atan(sqrt((SA_TAIL_EXP - H) / H)));
+
+	h = beta / SA_GL_SPLIT;
+	for(i = 0; i < SA_GL_SPLIT; i++){
+		mid = (i + 0.5) * h;
+		for(k = 0; k < SA_GL_ORDER; k++){
+			t = tan(mid + 0.5*h*saGlNode[k]);
+			sum += saGlWeight[k] * exp(-H * t*t);
+		}
+	}
+
+	return exp(-H) * 0.25 * h * sum / M_PI;
+}
+
+/* Gaussian probability of cell k, centred at s outside of it: the fan of
+   triangles from s to the edges adds up to the cell, and their angular
+   parts cancel, leaving minus the sum of the edge terms, each signed by
+   the direction the edge turns around s */
+static double sa_cellProb(int k, complex s, double sigma)
+{
+	const double *x = &saCache.vx[saCache.first[k]], *y = &saCache.vy[saCache.first[k]];
+	const int n = saCache.first[k+1] - saCache.first[k];
+	double dx, dy, len, nx, ny, h, ta, tb, H, sum = 0.;
+	int i, i1;
+
+	for(i = 0; i < n; i++){
+		i1 = (i + 1 == n)? 0 : i + 1;
+		dx = x[i1] - x[i];
+		dy = y[i1] - y[i];
+		len = sqrt(dx*dx + dy*dy);
+		if(len == 0.)
+			continue;
+		dx /= len;
+		dy /= len;
+
+		/* foot of the perpendicular from s, then the offsets of the end
+		   points along the normal turned counter-clockwise */
+		h = (x[i] - s.re)*dy - (y[i] - s.im)*dx;
+		nx = dy;
+		ny = -dx;
+		if(h < 0.){
+			h = -h;
+			nx = -nx;
+			ny = -ny;
+		}
+		if(h == 0.)
+			continue;
+		ta = (x[i] - s.re)*(-ny) + (y[i] - s.im)*nx;
+		tb = (x[i1] - s.re)*(-ny) + (y[i1] - s.im)*nx;
+
+		H = h*h / (2*sigma*sigma);
+		sum += copysign(sa_wedgeTail(H, atan(fabs(tb) / h)), tb)
+			- copysign(sa_wedgeTail(H, atan(fabs(ta) / h)), ta);
+	}
+
+	return -sum;
+}
+
+/* Other constellations: the Gaussian integrated over every Voronoi cell
+   that is not negligibly far; the slicer's own cell takes the rest */
+static void sa_cellBitErr(double pe[], complex s, int txLab,
+		const constel_str *cons, double sigma)
+{
+	int k, b, diff, c = constel_hdLabel(cons, s), m = cons->bitsPerSym;
+	complex pc = cons->point[c], pk;
+	double dx, dy, dist, p, rest = 1.;
+
+	for(k = 0; k < cons->order; k++){
+		if(k == c)
+			continue;
+
+		/* cell k lies beyond the bisector of pc and pk */
+		pk = cons->point[k];
+		dx = pk.re - pc.re;
+		dy = pk.im - pc.im;
+		dist = (0.5*(absSqrComp(pk) - absSqrComp(pc)) - dx*s.re - dy*s.im)
+			/ sqrt(dx*dx + dy*dy);
+		if(dist * dist > 2*SA_TAIL_EXP * sigma*sigma)
+			continue;
+
+		p = sa_cellProb(k, s, sigma);
+		rest -= p;
+		if((diff = k ^ txLab) == 0)
+			continue;
+		for(b = 0; b < m; b++)
+			if((diff >> (m-1-b)) & 1)
+				pe[b] += p;
+	}
+
+	if((diff = c ^ txLab) != 0)
+		for(b = 0; b < m; b++)
+			if((diff >> (m-1-b)) & 1)
+				pe[b] += rest;
+}
+
+/* function semiAnalytic_errExp()
+
+	Description: expected number of bit errors of a noiseless received
+	             symbol stream under complex AWGN, per SNR grid point
+
+	Output parameters:
+		expErr[]			expected bit errors are ADDED to expErr[p]
+	input parameters:
+		numSnr				number of SNR points
+		snrLin[]			Es/N0 (linear) of each point, Es = cons->avePow
+		txSym[]				transmitted symbols after every deterministic
+							stage (filters, quantisation), as seen by the
+							hard decision slicer when the noise is zero
+		txLabel[]			bit label of each transmitted symbol
+		lenSym				length of txSym
+		*cons				Constellation used by the slicer (ConstelHd)
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+
+	Comment:
+		1. the Gaussian is integrated over the true decision regions of
+		   ConstelHd(): Q-function per axis for separable QAM, phase pdf
+		   per wedge for PSK and Voronoi cells for APSK and cross QAM. The
+		   result is exact, not a bound, at any SNR and accurate down to
+		   BER 1e-12 and below
+		2. symbols equal to their nominal point are evaluated once per
+		   label and noise level, across calls
+
+	Caution:
+		not thread safe, the cells and the memo are shared
+ */
+
+int semiAnalytic_errExp(double expErr[],
+		int numSnr,
+		const double snrLin[],
+		complex txSym[],
+		int txLabel[],
+		int lenSym,
+		const constel_str *cons)
+{
+	double pe[MAX_CONSTEL_BITS], sigma, sum, *memo;
+	int m = cons->bitsPerSym;
+	int p, i, b, nominal;
+
+	if(sa_cacheInit(cons) < 0)
+		return -1;
+
+	for(p = 0; p < numSnr; p++){
+		/* per-dimension std of ch_awgn_complex(var = Es/snr) */
+		sigma = sqrt(0.5 * cons->avePow / snrLin[p]);
+		sum = 0.;
+		memo = sa_memoRow(sigma);
+
+		for(i = 0; i < lenSym; i++){
+			nominal = (txSym[i].re == cons->point[txLabel[i]].re
+					&& txSym[i].im == cons->point[txLabel[i]].im);
+			if(nominal && !isnan(memo[txLabel[i]])){
+				sum += memo[txLabel[i]];
+				continue;
+			}
+
+			for(b = 0; b < m; b++)
+				pe[b] = 0.;
+
+			if(cons->isSep){
+				sa_pamBitErr(pe, txSym[i].re, txLabel[i] >> cons->bitsQ, cons,
+						cons->numLvI, cons->lvLabelI, cons->bitsI, sigma);
+				sa_pamBitErr(&pe[cons->bitsI], txSym[i].im,
+						txLabel[i] & ((1 << cons->bitsQ) - 1), cons,
+						cons->numLvQ, cons->lvLabelQ, cons->bitsQ, sigma);
+			} else if(cons->family == CONSTEL_PSK)
+				sa_pskBitErr(pe, txSym[i], txLabel[i], cons, sigma);
+			else
+				sa_cellBitErr(pe, txSym[i], txLabel[i], cons, sigma);
+
+			for(b = 1; b < m; b++)
+				pe[0] += pe[b];
+			if(nominal)
+				memo[txLabel[i]] = pe[0];
+			sum += pe[0];
+		}
+
+		expErr[p] += sum;
+	}
+
+	return 0;
+}
+
+/* function semiAnalytic_crossCheck()
+
+	Description: compare the semi-analytic estimate with a Monte Carlo run
+	             of the same ideal link (mapConstel -> AWGN -> ConstelHd)
+
+	Output parameters:
+		berSa[]				semi-analytic BER per SNR point
+		berMc[]				Monte Carlo BER per SNR point
+	input parameters:
+		*snr				SNR grid, Es/N0 in dB
+		*cons				Constellation
+		lenSym				symbols per Monte Carlo frame
+		numIter				number of Monte Carlo frames per point
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+ */
+
+int semiAnalytic_crossCheck(double berSa[],
+		double berMc[],
+		snr_str *snr,
+		const constel_str *cons,
+		int lenSym,
+		int numIter)
+{
+	int numSnr = snr_numPoints(snr), m = cons->bitsPerSym;
+	int *bits, *dec, *lab, lenOut, p, it, i, b, ret = 0;
+	complex *tx, *rx;
+	double *snrLin;
+	long long numErr;
+
+	bits = (int *)malloc(sizeof(int)*lenSym*m);
+	dec = (int *)malloc(sizeof(int)*lenSym*m);
+	lab = (int *)malloc(sizeof(int)*lenSym);
+	tx = (complex *)malloc(sizeof(complex)*lenSym);
+	rx = (complex *)malloc(sizeof(complex)*lenSym);
+	snrLin = (double *)malloc(sizeof(double)*numSnr);
+	if(!bits || !dec || !lab || !tx || !rx || !snrLin){
+		printf("[semiAnalytic] fail to mem alloc\n");
+		ret = -1;
+		goto END;
+	}
+
+	for(p = 0; p < numSnr; p++){
+		snr_setPoint(snr, p);
+		snrLin[p] = snr->snrLin;
+		berSa[p] = 0.;
+		numErr = 0;
+
+		for(it = 0; it < numIter; it++){
+			for(i = 0; i < lenSym*m; i++)
+				bits[i] = rand() & 1;
+			mapConstel(&lenOut, tx, lenSym*m, bits, cons);
+			for(i = 0; i < lenSym; i++){
+				for(lab[i] = 0, b = 0; b < m; b++)
+					lab[i] = (lab[i] << 1) | bits[m*i+b];
+				rx[i] = tx[i];
+			}
+
+			if(semiAnalytic_errExp(&berSa[p], 1, &snrLin[p], tx, lab, lenSym, cons) < 0){
+				ret = -1;
+				goto END;
+			}
+
+			ch_awgn_complex(rx, lenSym, cons->avePow / snrLin[p]);
+			ConstelHd(&lenOut, dec, lenSym, rx, cons);
+			numErr += xorInt(bits, dec, lenOut);
+		}
+
+		berSa[p] /= (double)numIter * lenSym * m;
+		berMc[p] = (double)numErr / ((double)numIter * lenSym * m);
+	}
+
+END:
+	free(bits);
+	free(dec);
+	free(lab);
+	free(tx);
+	free(rx);
+	free(snrLin);
+	return ret;
+}
+
+#endif /* __BERANALYTIC_H__ */
@@ -0,0 +1,387 @@
+/* File: bitGroup.h
+ *
+ * Description: Grouping of bit streams into M-bit indices and back
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The front and back ends of the table driven mappers and demappers: an
+ * index of M bits (M = 1 .. 12) takes the first of its bits as the MSB,
+ * as mapConstel() reads the labels. Packed streams are bytes, the first
+ * bit in the MSB of the first byte, so eight indices always fill exactly
+ * M bytes. A group of eight is one big endian load, shifted to the top;
+ * with BMI2 one PDEP spreads it into byte (M <= 8) or 16-bit (M > 8)
+ * lanes and one PEXT gathers the lanes back. Without BMI2 the same lanes
+ * are cut out with constant shifts.
+ */
+
+#ifndef __BITGROUP_H__
+#define __BITGROUP_H__
+
+/* Headers */
+#include <string.h>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+/* Defines */
+#define BITGROUP_MAX_M		12		/* bits per index */
+#define BITGROUP_BLK		256		/* indices per packed block of the int paths */
+
+/* Functions */
+
+static inline unsigned long long bitGroup_load(const unsigned char *p)
+{
+	unsigned long long w;
+
+	memcpy(&w, p, 8);
+	return __builtin_bswap64(w);
+}
+
+static inline void bitGroup_store(unsigned char *p, unsigned long long w)
+{
+	w = __builtin_bswap64(w);
+	memcpy(p, &w, 8);
+}
+
+/* eight indices of m bits from the m bytes at p, read as 16 bytes */
+static inline __attribute__((always_inline)) void bitGroup_idx8(int idx[],
+		const unsigned char *p, int m)
+{
+	const unsigned long long mask = (1ULL << m) - 1;
+	unsigned long long hi, lo, x0, x1;
+#ifdef __BMI2__
+	unsigned char b8[8];
+	unsigned short b16[8];
+#endif
+	int k;
+
+	hi = bitGroup_load(p);
+	if(m <= 8){
+		x0 = hi >> (64 - 8*m);
+#ifdef __BMI2__
+		/* lane 7 - k of the deposit holds index k */
+		x0 = __builtin_bswap64(_pdep_u64(x0, mask * 0x0101010101010101ULL));
+		memcpy(b8, &x0, 8);
+		for(k = 0; k < 8; k++)
+			idx[k] = b8[k];
+#else
+		for(k = 0; k < 8; k++)
+			idx[k] = (int)((x0 >> (m*(7 - k))) & mask);
+#endif
+		return;
+	}
+
+	lo = bitGroup_load(p + 8);
+	x0 = hi >> (64 - 4*m);
+	x1 = ((hi << (4*m)) | (lo >> (64 - 4*m))) >> (64 - 4*m);
+#ifdef __BMI2__
+	x0 = _pdep_u64(x0, mask * 0x0001000100010001ULL);
+	x1 = _pdep_u64(x1, mask * 0x0001000100010001ULL);
+	for(k = 0; k < 4; k++){
+		b16[k] = (unsigned short)(x0 >> (16*(3 - k)));
+		b16[4 + k] = (unsigned short)(x1 >> (16*(3 - k)));
+	}
+	for(k = 0; k < 8; k++)
+		idx[k] = b16[k];
+#else
+	for(k = 0; k < 4; k++){
+		idx[k] = (int)((x0 >> (m*(3 - k))) & mask);
+		idx[4 + k] = (int)((x1 >> (m*(3 - k))) & mask);
+	}
+#endif
+}
+
+/* eight indices of m bits into the m bytes at p, written as 16 bytes */
+static inline __attribute__((always_inline)) void bitGroup_put8(unsigned char *p,
+		const int idx[], int m)
+{
+	const unsigned long long mask = (1ULL << m) - 1;
+	unsigned long long x0 = 0, x1 = 0;
+	unsigned char b8[8];
+	unsigned short b16[8];
+	int k;
+
+	if(m <= 8){
+		for(k = 0; k < 8; k++)
+			b8[k] = (unsigned char)idx[k];
+#ifdef __BMI2__
+		memcpy(&x0, b8, 8);
+		x0 = _pext_u64(__builtin_bswap64(x0), mask * 0x0101010101010101ULL);
+#else
+		for(k = 0; k < 8; k++)
+			x0 |= (b8[k] & mask) << (m*(7 - k));
+#endif
+		bitGroup_store(p, x0 << (64 - 8*m));
+		return;
+	}
+
+	for(k = 0; k < 8; k++)
+		b16[k] = (unsigned short)idx[k];
+#ifdef __BMI2__
+	for(k = 0; k < 4; k++){
+		x0 |= (unsigned long long)b16[k] << (16*(3 - k));
+		x1 |= (unsigned long long)b16[4 + k] << (16*(3 - k));
+	}
+	x0 = _pext_u64(x0, mask * 0x0001000100010001ULL);
+	x1 = _pext_u64(x1, mask * 0x0001000100010001ULL);
+#else
+	for(k = 0; k < 4; k++){
+		x0 |= (b16[k] & mask) << (m*(3 - k));
+		x1 |= (b16[4 + k] & mask) << (m*(3 - k));
+	}
+#endif
+	bitGroup_store(p, (x0 << (64 - 4*m)) | (x1 >> (8*m - 64)));
+	bitGroup_store(p + 8, x1 << (128 - 8*m));
+}
+
+/* num indices from packed[], of which lenByte bytes may be read */
+static inline __attribute__((always_inline)) void bitGroup_idxRun(int idx[],
+		const unsigned char packed[], long num, int m, long lenByte)
+{
+	unsigned char buf[16];
+	int last[8];
+	long g, n, numFast;
+
+	/* the 16-byte reads stay inside the lenByte bytes */
+	numFast = (lenByte >= 16) ? (lenByte - 16)/m + 1 : 0;
+	if(numFast > num/8)
+		numFast = num/8;
+	for(g = 0; g < numFast; g++)
+		bitGroup_idx8(&idx[8*g], &packed[g*m], m);
+
+	for(; 8*g < num; g++){
+		n = ((num - 8*g)*m + 7)/8;
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf, &packed[g*m], (n < m) ? n : m);
+		bitGroup_idx8(last, buf, m);
+		n = (num - 8*g < 8) ? num - 8*g : 8;
+		memcpy(&idx[8*g], last, sizeof(int)*n);
+	}
+}
+
+/* num indices into packed[], of which lenByte bytes may be written */
+static inline __attribute__((always_inline)) void bitGroup_putRun(unsigned char packed[],
+		const int idx[], long num, int m, long lenByte)
+{
+	unsigned char buf[16];
+	int last[8];
+	long g, n, numFast;
+
+	/* the 16-byte writes stay inside the lenByte bytes, the next group
+	   overwrites the ones past m */
+	numFast = (lenByte >= 16) ? (lenByte - 16)/m + 1 : 0;
+	if(numFast > num/8)
+		numFast = num/8;
+	for(g = 0; g < numFast; g++)
+		bitGroup_put8(&packed[g*m], &idx[8*g], m);
+
+	for(; 8*g < num; g++){
+		n = (num - 8*g < 8) ? num - 8*g : 8;
+		memset(last, 0, sizeof(last));
+		memcpy(last, &idx[8*g], sizeof(int)*n);
+		bitGroup_put8(buf, last, m);
+		memcpy(&packed[g*m], buf, (n*m + 7)/8);
+	}
+}
+
+/* function bitGroup_index()
+
+	Description: num indices of m bits, m = 1 .. BITGROUP_MAX_M, from a
+	             packed stream of num*m bits
+
+	Output parameters:
+		idx[]				indices, 0 .. 2^m - 1
+ */
+
+void bitGroup_index(int idx[], const unsigned char packed[], long num, int m)
+{
+	const long len = (num*m + 7)/8;
+
+	/* a constant m turns the shifts and masks into immediates */
+	switch(m){
+	case 1:		bitGroup_idxRun(idx, packed, num, 1, len);	break;
+	case 2:		bitGroup_idxRun(idx, packed, num, 2, len);	break;
+	case 3:		bitGroup_idxRun(idx, packed, num, 3, len);	break;
+	case 4:		bitGroup_idxRun(idx, packed, num, 4, len);	break;
+	case 6:		bitGroup_idxRun(idx, packed, num, 6, len);	break;
+	case 8:		bitGroup_idxRun(idx, packed, num, 8, len);	break;
+	case 10:	bitGroup_idxRun(idx, packed, num, 10, len);	break;
+	case 12:	bitGroup_idxRun(idx, packed, num, 12, len);	break;
+	default:	bitGroup_idxRun(idx, packed, num, m, len);	break;
+	}
+}
+
+/* function bitGroup_scatter()
+
+	Description: inverse of bitGroup_index(): num indices of m bits into
+	             a packed stream of num*m bits; the bits of a partial last
+	             byte beyond the stream are zero
+
+	Output parameters:
+		packed[]			(num*m + 7)/8 bytes
+ */
+
+void bitGroup_scatter(unsigned char packed[], const int idx[], long num, int m)
+{
+	const long len = (num*m + 7)/8;
+
+	switch(m){
+	case 1:		bitGroup_putRun(packed, idx, num, 1, len);	break;
+	case 2:		bitGroup_putRun(packed, idx, num, 2, len);	break;
+	case 3:		bitGroup_putRun(packed, idx, num, 3, len);	break;
+	case 4:		bitGroup_putRun(packed, idx, num, 4, len);	break;
+	case 6:		bitGroup_putRun(packed, idx, num, 6, len);	break;
+	case 8:		bitGroup_putRun(packed, idx, num, 8, len);	break;
+	case 10:	bitGroup_putRun(packed, idx, num, 10, len);	break;
+	case 12:	bitGroup_putRun(packed, idx, num, 12, len);	break;
+	default:	bitGroup_putRun(packed, idx, num, m, len);	break;
+	}
+}
+
+/* function bitGroup_pack()
+
+	Description: lenBit bits of one int each into a packed stream, the
+	             first bit in the MSB of the first byte; the bits of a
+	             partial last byte beyond the stream are zero
+
+	Output parameters:
+		packed[]			(lenBit + 7)/8 bytes
+ */
+
+void bitGroup_pack(unsigned char packed[], const int bits[], long lenBit)
+{
+	unsigned long long w;
+	unsigned char b8[8];
+	long i;
+	int b;
+
+	/* eight 0/1 bytes times 2^(9k): byte j lands on bit 63 - j */
+	for(i = 0; i < lenBit/8; i++){
+		for(b = 0; b < 8; b++)
+			b8[b] = (unsigned char)bits[8*i + b];
+		memcpy(&w, b8, 8);
+		packed[i] = (unsigned char)((w * 0x8040201008040201ULL) >> 56);
+	}
+	if(lenBit & 7){
+		for(w = 0, b = 0; b < 8; b++)
+			w = (w << 1) | ((8*i + b < lenBit) ? (unsigned)bits[8*i + b] : 0);
+		packed[i] = (unsigned char)w;
+	}
+}
+
+/* function bitGroup_unpack()
+
+	Description: inverse of bitGroup_pack()
+
+	Output parameters:
+		bits[]				lenBit bits, 0 or 1
+ */
+
+void bitGroup_unpack(int bits[], const unsigned char packed[], long lenBit)
+{
+	unsigned long long w;
+	unsigned char b8[8];
+	long i;
+	int b;
+
+	/* the byte in every lane, lane j keeps bit 7 - j, then 0/1 per lane */
+	for(i = 0; i < lenBit/8; i++){
+		w = (packed[i] * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+		w = ((w + 0x7f7f7f7f7f7f7f7fULL) >> 7) & 0x0101010101010101ULL;
+		memcpy(b8, &w, 8);
+		for(b = 0; b < 8; b++)
+			bits[8*i + b] = b8[b];
+	}
+	for(i = lenBit & ~7L; i < lenBit; i++)
+		bits[i] = (packed[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+/* through a packed block in L1, BITGROUP_BLK indices at a time */
+static inline __attribute__((always_inline)) void bitGroup_fromBitsRun(int idx[],
+		const int bits[], long num, int m)
+{
+	unsigned char buf[BITGROUP_BLK*BITGROUP_MAX_M/8 + 16];
+	long i, n;
+
+	for(i = 0; i < num; i += n){
+		n = (num - i < BITGROUP_BLK) ? num - i : BITGROUP_BLK;
+		bitGroup_pack(buf, &bits[m*i], n*m);
+		bitGroup_idxRun(&idx[i], buf, n, m, sizeof(buf));
+	}
+}
+
+static inline __attribute__((always_inline)) void bitGroup_toBitsRun(int bits[],
+		const int idx[], long num, int m)
+{
+	unsigned char buf[BITGROUP_BLK*BITGROUP_MAX_M/8 + 16];
+	long i, n;
+
+	for(i = 0; i < num; i += n){
+		n = (num - i < BITGROUP_BLK) ? num - i : BITGROUP_BLK;
+		bitGroup_putRun(buf, &idx[i], n, m, sizeof(buf));
+		bitGroup_unpack(&bits[m*i], buf, n*m);
+	}
+}
+
+/* function bitGroup_fromBits()
+
+	Description: bitGroup_index() on a stream of one int (0 or 1) per bit
+
+	Output parameters:
+		idx[]				num indices, 0 .. 2^m - 1
+ */
+
+void bitGroup_fromBits(int idx[], const int bits[], long num, int m)
+{
+	switch(m){
+	case 1:		bitGroup_fromBitsRun(idx, bits, num, 1);	break;
+	case 2:		bitGroup_fromBitsRun(idx, bits, num, 2);	break;
+	case 3:		bitGroup_fromBitsRun(idx, bits, num, 3);	break;
+	case 4:		bitGroup_fromBitsRun(idx, bits, num, 4);	break;
+	case 6:		bitGroup_fromBitsRun(idx, bits, num, 6);	break;
+	case 8:		bitGroup_fromBitsRun(idx, bits, num, 8);	break;
+	case 10:	bitGroup_fromBitsRun(idx, bits, num, 10);	break;
+	case 12:	bitGroup_fromBitsRun(idx, bits, num, 12);	break;
+	default:	bitGroup_fromBitsRun(idx, bits, num, m);	break;
+	}
+}
+
+/* function bitGroup_toBits()
+
+	Description: inverse of bitGroup_fromBits()
+
+	Output parameters:
+		bits[]				num*m bits, 0 or 1
+ */
+
+void bitGroup_toBits(int bits[], const int idx[], long num, int m)
+{
+	switch(m){
+	case 1:		bitGroup_toBitsRun(bits, idx, num, 1);	break;
+	case 2:		bitGroup_toBitsRun(bits, idx, num, 2);	break;
+	case 3:		bitGroup_toBitsRun(bits, idx, num, 3);	break;
+	case 4:		bitGroup_toBitsRun(bits, idx, num, 4);	break;
+	case 6:		bitGroup_toBitsRun(bits, idx, num, 6);	break;
+	case 8:		bitGroup_toBitsRun(bits, idx, num, 8);	break;
+	case 10:	bitGroup_toBitsRun(bits, idx, num, 10);	break;
+	case 12:	bitGroup_toBitsRun(bits, idx, num, 12);	break;
+	default:	bitGroup_toBitsRun(bits, idx, num, m);	break;
+	}
+}
+
+#endif /* __BITGROUP_H__ */
@@ -0,0 +1,396 @@
+/* File: carrier.h
+ *
+ * Description: Carrier frequency/phase offset impairment, estimation and
+ *              tracking
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Frequencies are in cycles per sample and phases in cycles, so a phase
+ * maps onto the 32-bit NCO accumulator of nco.h without scaling by pi.
+ *
+ * The impairment rotates the samples in place by a frequency offset plus
+ * Wiener phase noise. Without phase noise it is one nco_mix() pass; with
+ * it the phase walk of CARRIER_CHUNK samples is drawn into a small stack
+ * buffer first, then the chunk is rotated, so the signal is read and
+ * written once.
+ *
+ * The estimators are single lag autocorrelations with the lag convention
+ * of xcorr_rangeComp(), x[n+lag] times conj(x[n]): on a repeated preamble
+ * or an OFDM cyclic prefix (blind), on the M-th power of PSK symbols
+ * (blind) or on symbols with their pilots removed (data aided). Their
+ * correction goes back through nco_mix().
+ *
+ * The tracking loop is a second order PLL, or a Costas loop for BPSK and
+ * QPSK symbols, derotating each sample in place before its phase detector.
+ */
+
+#ifndef __CARRIER_H__
+#define __CARRIER_H__
+
+/* Headers */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "rng.h"
+#include "nco.h"
+
+/* Defines */
+#define CARRIER_CHUNK		256		/* samples per phase noise walk */
+
+enum{
+	CARRIER_PLL = 1,			// unmodulated carrier or pilots removed
+	CARRIER_BPSK = 2,			// Costas loop, decisions on I
+	CARRIER_QPSK = 4			// Costas loop, decisions on I and Q
+};
+
+typedef struct{
+	double freq;				// frequency offset, cycles per sample
+	double pnVar;				// phase noise increment variance per sample,
+								// in rad^2: 2 pi linewidth / sample rate
+	/* state */
+	double phase;				// carrier phase of the next sample, cycles
+	rng_str rng;				// phase noise stream
+} carrierImp_str;
+
+typedef struct{
+	int order;					// CARRIER_PLL, CARRIER_BPSK or CARRIER_QPSK
+	double kp, ki;				// PI loop filter, in cycles per unit error
+	/* state */
+	double phase;				// phase estimate at the next sample, cycles
+	double freq;				// frequency estimate, cycles per sample
+	double err;					// last phase detector output
+	double adj;					// loop filter output, applied at the next sample
+	long numSym;
+} costas_str;
+
+/* Functions */
+
+/***********************************
+ * Impairment                      *
+ ***********************************/
+
+/* function carrier_impInit()
+
+	Description: frequency offset freq (cycles per sample), initial phase
+	             phase (cycles) and phase noise of linewidth lwT (per
+	             sample), drawn from the stream rng
+ */
+
+void carrier_impInit(carrierImp_str *ci, double freq, double phase, double lwT,
+		const rng_str *rng)
+{
+	memset(ci, 0, sizeof(carrierImp_str));
+	ci->freq = freq;
+	ci->pnVar = 2.*M_PI*lwT;
+	ci->phase = phase - floor(phase);
+	ci->rng = *rng;
+}
+
+/* function carrier_impair()
+
+	Description: rotate the samples in place by the carrier offset of ci
+
+	Output parameters:
+		x[]					impaired signal
+	input parameters:
+		len					signal length
+
+	Return indicator:
+		0					Success
+ */
+
+int carrier_impair(complex x[], int len, carrierImp_str *ci)
+{
+	double ph[CARRIER_CHUNK], g0, g1, p, sn, cs, re;
+	const double sd = sqrt(ci->pnVar) / (2.*M_PI);
+	unsigned int acc;
+	int i, k, num;
+
+	if(ci->pnVar <= 0.){
+		acc = nco_freq2inc(ci->phase);
+		nco_mix(x, len, &acc, nco_freq2inc(ci->freq));
+		ci->phase = (double)acc * NCO_2POW_M32;
+		return 0;
+	}
+
+	p = ci->phase;
+	for(k = 0; k < len; k += num){
+		num = (len - k < CARRIER_CHUNK) ? len - k : CARRIER_CHUNK;
+
+		/* increments, then their running sum kept in [0, 1) */
+		for(i = 0; i < num; i += 2){
+			rng_gaussAt(ci->rng.key, ci->rng.ctr + i, &g0, &g1);
+			ph[i] = ci->freq + sd*g0;
+			ph[i+1] = ci->freq + sd*g1;
+		}
+		ci->rng.ctr += (num + 1) & ~1;
+
+		for(i = 0; i < num; i++){
+			g0 = p;
+			p += ph[i];
+			p -= (p >= 1.) ? 1. : ((p < 0.) ? -1. : 0.);
+			ph[i] = g0;
+		}
+
+		for(i = 0; i < num; i++){
+			rng_sincos2pi(ph[i], &sn, &cs);
+			re = x[k+i].re;
+			x[k+i].re = re*cs - x[k+i].im*sn;
+			x[k+i].im = re*sn + x[k+i].im*cs;
+		}
+	}
+	ci->phase = p;
+
+	return 0;
+}
+
+/***********************************
+ * Estimation                      *
+ ***********************************/
+
+/* sum of x[n+lag] conj(x[n]) over n = 0 .. len-lag-1 */
+complex carrier_corrLag(const complex x[], int len, int lag)
+{
+	complex acc = {0., 0.};
+	int n;
+
+	for(n = 0; n + lag < len; n++){
+		acc.re += x[n+lag].re*x[n].re + x[n+lag].im*x[n].im;
+		acc.im += x[n+lag].im*x[n].re - x[n+lag].re*x[n].im;
+	}
+
+	return acc;
+}
+
+/* function carrier_estLag()
+
+	Description: frequency offset of a signal repeating every lag samples,
+	             |freq| < 1 / (2 lag); on one OFDM symbol with its cyclic
+	             prefix, x[0 .. lenCp+nFft-1] and lag nFft, the sum runs
+	             over the prefix and its copy. Add carrier_corrLag() of
+	             several symbols before the angle to average them.
+
+	Return indicator:
+		frequency offset in cycles per sample
+ */
+
+double carrier_estLag(const complex x[], int len, int lag)
+{
+	complex c = carrier_corrLag(x, len, lag);
+
+	return atan2(c.im, c.re) / (2.*M_PI*lag);
+}
+
+/* function carrier_estPower()
+
+	Description: blind frequency offset of symbol spaced M-PSK samples,
+	             M = order (2 for BPSK, 4 for QPSK): the M-th power strips
+	             the modulation, |freq| < 1 / (2 M)
+
+	Return indicator:
+		frequency offset in cycles per symbol
+ */
+
+double carrier_estPower(const complex x[], int len, int order)
+{
+	complex acc = {0., 0.}, y, yPrev = {0., 0.}, t;
+	int n, m;
+
+	for(n = 0; n < len; n++){
+		y = x[n];
+		for(m = 1; m < order; m++){
+			t.re = y.re*x[n].re - y.im*x[n].im;
+			t.im = y.re*x[n].im + y.im*x[n].re;
+			y = t;
+		}
+		acc.re += y.re*yPrev.re + y.im*yPrev.im;
+		acc.im += y.im*yPrev.re - y.re*yPrev.im;
+		yPrev = y;
+	}
+
+	return atan2(acc.im, acc.re) / (2.*M_PI*order);
+}
+
+/* function carrier_estPilot()
+
+	Description: data aided frequency and phase offset of len symbols with
+	             known pilots, |freq| < 1/2 per symbol
+
+	Output parameters:
+		*freq				frequency offset in cycles per symbol
+		*phase				carrier phase at x[0] in cycles, NULL to skip
+
+	Return indicator:
+		0					Success
+ */
+
+int carrier_estPilot(double *freq, double *phase, const complex x[],
+		const complex pilot[], int len)
+{
+	complex acc = {0., 0.}, sum = {0., 0.}, z, zPrev = {0., 0.};
+	double f, sn, cs;
+	int n;
+
+	for(n = 0; n < len; n++){
+		z.re = x[n].re*pilot[n].re + x[n].im*pilot[n].im;
+		z.im = x[n].im*pilot[n].re - x[n].re*pilot[n].im;
+		acc.re += z.re*zPrev.re + z.im*zPrev.im;
+		acc.im += z.im*zPrev.re - z.re*zPrev.im;
+		zPrev = z;
+	}
+	f = atan2(acc.im, acc.re) / (2.*M_PI);
+	*freq = f;
+
+	/* phase at x[0] after removing the frequency ramp */
+	if(phase != NULL){
+		for(n = 0; n < len; n++){
+			rng_sincos2pi((double)nco_freq2inc(-f * n) * NCO_2POW_M32, &sn, &cs);
+			z.re = x[n].re*pilot[n].re + x[n].im*pilot[n].im;
+			z.im = x[n].im*pilot[n].re - x[n].re*pilot[n].im;
+			sum.re += z.re*cs - z.im*sn;
+			sum.im += z.re*sn + z.im*cs;
+		}
+		*phase = atan2(sum.im, sum.re) / (2.*M_PI);
+	}
+
+	return 0;
+}
+
+/***********************************
+ * Tracking                        *
+ ***********************************/
+
+/* function costas_setLoop()
+
+	Description: loop noise bandwidth bnT (normalised to the sample rate),
+	             damping zeta and phase detector slope kd (error per rad
+	             at the loop's signal level, 1 for unit power symbols)
+ */
+
+void costas_setLoop(costas_str *pll, double bnT, double zeta, double kd)
+{
+	double th = bnT / (zeta + 0.25/zeta), d = 1. + 2.*zeta*th + th*th;
+
+	pll->kp = 4.*zeta*th / (d * kd * 2.*M_PI);
+	pll->ki = 4.*th*th / (d * kd * 2.*M_PI);
+}
+
+/* function costas_init()
+
+	Description: PLL (order CARRIER_PLL) or Costas loop (CARRIER_BPSK,
+	             CARRIER_QPSK); the loop starts at zero phase and frequency
+	             with bnT 0.01 and zeta 1/sqrt(2), see costas_setLoop()
+
+	Return indicator:
+		0					Success
+		-1					Unsupported order
+ */
+
+int costas_init(costas_str *pll, int order)
+{
+	if(order != CARRIER_PLL && order != CARRIER_BPSK && order != CARRIER_QPSK){
+		printf("[carrier] unsupported loop order(%d)\n", order);
+		return -1;
+	}
+
+	memset(pll, 0, sizeof(costas_str));
+	pll->order = order;
+	costas_setLoop(pll, 0.01, M_SQRT1_2, 1.);
+
+	return 0;
+}
+
+/* sin and cos of a phase step x (rad), |x| < 1: Taylor to the 9th power */
+static inline void carrier_stepSincos(double x, double *sn, double *cs)
+{
+	double x2 = x*x;
+
+	*sn = x*(1. + x2*(-1./6 + x2*(1./120 + x2*(-1./5040 + x2*(1./362880)))));
+	*cs = 1. + x2*(-0.5 + x2*(1./24 + x2*(-1./720 + x2*(1./40320))));
+}
+
+/* function costas_run()
+
+	Description: track the carrier of len samples and derotate them in
+	             place; the state carries over to the next call. A residual
+	             phase theta gives an error of sin(theta) at unit power.
+
+	             The derotating phasor steps by a complex multiply per
+	             sample and is resynchronised to the phase accumulator with
+	             a full sincos every CARRIER_CHUNK samples. As in timing.h
+	             the loop output of a sample steps the phasor after next,
+	             so the phase detector is off the phasor's feedback path.
+
+	Output parameters:
+		x[]					derotated signal
+
+	Return indicator:
+		0					Success
+ */
+
+int costas_run(complex x[], int len, costas_str *pll)
+{
+	double p = pll->phase, f = pll->freq, e = pll->err, adj = pll->adj;
+	double si, co, ds, dc, t, re, im, step;
+	const double kp = pll->kp, ki = pll->ki;
+	const int order = pll->order;
+	int i, k, num;
+
+	for(k = 0; k < len; k += num){
+		num = (len - k < CARRIER_CHUNK) ? len - k : CARRIER_CHUNK;
+		rng_sincos2pi(p, &si, &co);
+
+		for(i = k; i < k + num; i++){
+			/* rotate by -phase */
+			re = x[i].re*co + x[i].im*si;
+			im = x[i].im*co - x[i].re*si;
+			x[i].re = re;
+			x[i].im = im;
+
+			if(order == CARRIER_PLL)
+				e = im;
+			else if(order == CARRIER_BPSK)
+				e = (re >= 0.) ? im : -im;
+			else
+				e = M_SQRT1_2 * (((re >= 0.) ? im : -im) - ((im >= 0.) ? re : -re));
+
+			/* step by the loop output of the previous sample */
+			step = adj;
+			f += ki*e;
+			adj = f + kp*e;
+
+			carrier_stepSincos(2.*M_PI*step, &ds, &dc);
+			t = co*dc - si*ds;
+			si = si*dc + co*ds;
+			co = t;
+			p += step;
+			p -= (p >= 1.) ? 1. : ((p < 0.) ? -1. : 0.);
+		}
+	}
+
+	pll->phase = p;
+	pll->freq = f;
+	pll->err = e;
+	pll->adj = adj;
+	pll->numSym += len;
+
+	return 0;
+}
+
+#endif /* __CARRIER_H__ */
@@ -2,7 +2,7 @@
  *
  * Description: Math library used by ComSim
  * Copyright (C) 2011-2013, Jonghun John Park
- * Last updated on June. 28, 2013
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -24,6 +24,7 @@
 #define __COMMATH_H__
 
 /* Headers */
+#include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
 #include "comSim_types.h"
@@ -40,6 +41,21 @@ int GRAY_MAPPING[16] = {0, 1, 3, 2, 6, 7, 5, 4, 12, 13, 15, 14, 10, 11, 9, 8};
 /***********************************
  * Integer Operations              *
  ***********************************/
+
+/* Binary reflected Gray code of k, and its inverse */
+static inline int grayEnc(int k)
+{
+	return k ^ (k >> 1);
+}
+
+static inline int grayDec(int g)
+{
+	int k = g;
+	while(g >>= 1)
+		k ^= g;
+	return k;
+}
+
 int xorInt(int a[], int b[], int len)
 {
 	int i;
@@ -102,6 +118,28 @@ complex addComp(complex a, complex b)
 	return genComp(a.re+b.re, a.im+b.im);
 }
 
+/***********************************
+ * SNR Operations                  *
+ ***********************************/
+
+/* number of points on the [min, max] grid of snr */
+int snr_numPoints(snr_str *snr)
+{
+	if(snr->step <= 0. || snr->max < snr->min)
+		return 1;
+
+	return (int)floor((snr->max - snr->min) / snr->step + 1e-9) + 1;
+}
+
+/* set snrdB/snrLin to the idx-th grid point and return snrdB */
+double snr_setPoint(snr_str *snr, int idx)
+{
+	snr->snrdB = snr->min + idx * snr->step;
+	snr->snrLin = pow(10., snr->snrdB / 10.);
+
+	return snr->snrdB;
+}
+
 /***********************************
  * Correlation Funcations          *
  ***********************************/
@@ -173,8 +211,7 @@ int xcorr_range(
 			} else if(oBuff >= len_rev){
 				len_win = len_out - oBuff;
 				for(i = 0; i < len_win; i++)
-					output[oBuff] += rev[len_rev-len_win+i] * local[len_local
-						- len_win - 1 + i];
+					output[oBuff] += rev[len_rev-len_win+i] * local[i];
 			} else {
 				len_win = len_local;
 				for(i = 0; i < len_win; i++)
@@ -338,8 +375,7 @@ int xcorr_rangeComp(
 				len_win = len_out - oBuff;
 				for(i = 0; i < len_win; i++)
 					output[oBuff] = addComp(output[oBuff],
-							mulComp(rev[len_rev-len_win+i],
-								compLocal[len_local - len_win - 1 + i]));
+							mulComp(rev[len_rev-len_win+i], compLocal[i]));
 			} else {
 				len_win = len_local;
 				for(i = 0; i < len_win; i++)
@@ -2,7 +2,7 @@
  *
  * Description: Data type definitions for ComSim
  * Copyright (C) 2011-2014, Jonghun John Park
- * Last updated on Dec. 07, 2014
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -27,6 +27,14 @@
 
 /* Defines */
 #define MAX_SRC_LENGTH	1024
+#define MAX_CODED_LENGTH	(4*MAX_SRC_LENGTH + 64)	// rate 1/4 code and its tail
+#define MAX_SNR_POINTS	128
+
+/* Simulation modes */
+enum{
+	SIM_MONTECARLO = 0,			// noise is generated and errors counted
+	SIM_SEMIANALYTIC,			// expected errors from the noiseless stream
+};
 
 // Complex Variable
 typedef struct{
@@ -47,20 +55,42 @@ typedef struct {
 typedef struct {
 	int	numIter;				// # of simulation iterations
 	int modType;				// Modulation Type
+	int modFamily;				// Constellation family, CONSTEL_*
 	int lenSrc;					// length of source bit length
 	int lenFrm;					// length of a frame
 	snr_str	snr;				// SNR related parameters
+	int simMode;				// SIM_MONTECARLO or SIM_SEMIANALYTIC
+	int crossCheck;				// semi-analytic: also run Monte Carlo
+	int pipeBlk;				// symbols per pipeline block, 0: frame by frame
+	int pipeThreads;			// pipeline threads, 1: inline
+	unsigned long long seed;	// seed of the per-frame random streams
+	int codeType;				// CONV_* code preset, 0: uncoded
+	int ldpcType;				// LDPC_* code preset, 0: none
+	int crcType;				// CRC_* preset closing every frame, 0: none
+	int frmBatch;				// frames processed together, 1: frame by frame
+	int noisePool;				// approximate AWGN from the shared noise pool
+	int stats;					// EVM/MER statistics of the channel output
+	int prbsType;				// PRBS_* source instead of random bits, 0: none
+	int twin;					// fixed-point twin of the chain, 2: inline
+	int twinWL;					// twin word length
+	int twinFL;					// twin fractional bits
 	//
 } simParam_str;
 
 // Data Paths
 typedef struct{
 	int src[MAX_SRC_LENGTH];	// Source Data
-	complex mapperOut[MAX_SRC_LENGTH];
-	complex chanOut[MAX_SRC_LENGTH];
+	int coded[MAX_CODED_LENGTH];	// Encoder Output
+	complex mapperOut[MAX_CODED_LENGTH];
+	complex chanOut[MAX_CODED_LENGTH];
+	double llr[MAX_CODED_LENGTH];	// Soft Demapper Output
 	int dec[MAX_SRC_LENGTH];	// Decision Output
-	int numBitErr;
-	int numFrmErr;
+	long numBitErr;
+	long numFrmErr;
+	long numFrm;				// frames counted
+	long numCrcFail;			// frames failing the CRC check
+	long numCrcMiss;			// frame errors passing the CRC check
+	double expBitErr;			// semi-analytic expected bit errors
 } dataPath_str;
 
 /* Functions */
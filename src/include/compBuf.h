@@ -0,0 +1,651 @@
+/* File: compBuf.h
+ *
+ * Description: Split (structure of arrays) complex buffers and kernels
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#ifndef __COMPBUF_H__
+#define __COMPBUF_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "comMath.h"
+#include "constel.h"
+#include "awgn.h"
+
+/* Defines */
+#define COMPBUF_ALIGN	64		/* cache line, also the widest vector */
+#define COMPBUF_BLOCK	512		/* output block of the FIR kernels */
+
+/* Split complex buffers: re[] and im[] are separate aligned arrays so the
+   kernels below vectorise without shuffles. compBuf_str holds double,
+   compBufF_str single precision samples. */
+typedef struct{
+	double *re;
+	double *im;
+	int len;
+} compBuf_str;
+
+typedef struct{
+	float *re;
+	float *im;
+	int len;
+} compBufF_str;
+
+/* Functions */
+
+/***********************************
+ * Allocation and Conversion       *
+ ***********************************/
+
+static void *compBuf_alignedAlloc(size_t size)
+{
+	void *ptr = NULL;
+
+	size = (size + COMPBUF_ALIGN - 1) / COMPBUF_ALIGN * COMPBUF_ALIGN;
+	if(posix_memalign(&ptr, COMPBUF_ALIGN, size ? size : COMPBUF_ALIGN) != 0)
+		return NULL;
+
+	return ptr;
+}
+
+/* function compBuf_alloc()
+
+	Description: allocate an aligned, zeroed split complex buffer
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+ */
+
+int compBuf_alloc(compBuf_str *buf, int len)
+{
+	buf->re = (double *)compBuf_alignedAlloc(sizeof(double)*len);
+	buf->im = (double *)compBuf_alignedAlloc(sizeof(double)*len);
+	buf->len = len;
+
+	if(buf->re == NULL || buf->im == NULL){
+		printf("[compBuf] fail to mem alloc\n");
+		free(buf->re);
+		free(buf->im);
+		buf->re = buf->im = NULL;
+		buf->len = 0;
+		return -1;
+	}
+
+	memset(buf->re, 0, sizeof(double)*len);
+	memset(buf->im, 0, sizeof(double)*len);
+	return 0;
+}
+
+int compBufF_alloc(compBufF_str *buf, int len)
+{
+	buf->re = (float *)compBuf_alignedAlloc(sizeof(float)*len);
+	buf->im = (float *)compBuf_alignedAlloc(sizeof(float)*len);
+	buf->len = len;
+
+	if(buf->re == NULL || buf->im == NULL){
+		printf("[compBuf] fail to mem alloc\n");
+		free(buf->re);
+		free(buf->im);
+		buf->re = buf->im = NULL;
+		buf->len = 0;
+		return -1;
+	}
+
+	memset(buf->re, 0, sizeof(float)*len);
+	memset(buf->im, 0, sizeof(float)*len);
+	return 0;
+}
+
+void compBuf_free(compBuf_str *buf)
+{
+	free(buf->re);
+	free(buf->im);
+	buf->re = buf->im = NULL;
+	buf->len = 0;
+}
+
+void compBufF_free(compBufF_str *buf)
+{
+	free(buf->re);
+	free(buf->im);
+	buf->re = buf->im = NULL;
+	buf->len = 0;
+}
+
+/* interleaved complex[] <-> split buffer; len samples */
+void compBuf_fromComp(compBuf_str *out, const complex *in, int len)
+{
+	double * restrict re = out->re, * restrict im = out->im;
+	int i;
+
+	for(i = 0; i < len; i++){
+		re[i] = in[i].re;
+		im[i] = in[i].im;
+	}
+}
+
+void compBuf_toComp(complex *out, const compBuf_str *in, int len)
+{
+	int i;
+
+	for(i = 0; i < len; i++){
+		out[i].re = in->re[i];
+		out[i].im = in->im[i];
+	}
+}
+
+void compBufF_fromComp(compBufF_str *out, const complex *in, int len)
+{
+	float * restrict re = out->re, * restrict im = out->im;
+	int i;
+
+	for(i = 0; i < len; i++){
+		re[i] = (float)in[i].re;
+		im[i] = (float)in[i].im;
+	}
+}
+
+void compBufF_toComp(complex *out, const compBufF_str *in, int len)
+{
+	int i;
+
+	for(i = 0; i < len; i++){
+		out[i].re = in->re[i];
+		out[i].im = in->im[i];
+	}
+}
+
+/***********************************
+ * Element-wise Operations         *
+ ***********************************/
+
+/* y[i] = a[i] * b[i] (conjB != 0: a[i] * conj(b[i])), y may alias a or b */
+void compBuf_mul(compBuf_str *y, const compBuf_str *a, const compBuf_str *b,
+		int len, int conjB)
+{
+	double sgn = conjB ? -1. : 1., ar, ai, br, bi;
+	int i;
+
+	for(i = 0; i < len; i++){
+		ar = a->re[i]; ai = a->im[i];
+		br = b->re[i]; bi = sgn * b->im[i];
+		y->re[i] = ar*br - ai*bi;
+		y->im[i] = ar*bi + ai*br;
+	}
+}
+
+void compBufF_mul(compBufF_str *y, const compBufF_str *a, const compBufF_str *b,
+		int len, int conjB)
+{
+	float sgn = conjB ? -1.f : 1.f, ar, ai, br, bi;
+	int i;
+
+	for(i = 0; i < len; i++){
+		ar = a->re[i]; ai = a->im[i];
+		br = b->re[i]; bi = sgn * b->im[i];
+		y->re[i] = ar*br - ai*bi;
+		y->im[i] = ar*bi + ai*br;
+	}
+}
+
+/***********************************
+ * Channel                         *
+ ***********************************/
+
+/* function compBuf_chAwgn()
+
+	Description: add complex AWGN of total variance var to a split buffer
+ */
+
+int compBuf_chAwgn(compBuf_str *buf, int len, double var)
+{
+	double scale = sqrt(0.5 * var);
+	double * restrict re = buf->re, * restrict im = buf->im;
+	int i;
+
+	for(i = 0; i < len; i++){
+		re[i] += scale * GaussRand();
+		im[i] += scale * GaussRand();
+	}
+
+	return 0;
+}
+
+int compBufF_chAwgn(compBufF_str *buf, int len, double var)
+{
+	float scale = (float)sqrt(0.5 * var);
+	float * restrict re = buf->re, * restrict im = buf->im;
+	int i;
+
+	for(i = 0; i < len; i++){
+		re[i] += scale * (float)GaussRand();
+		im[i] += scale * (float)GaussRand();
+	}
+
+	return 0;
+}
+
+/***********************************
+ * Mapper and Demappers            *
+ ***********************************/
+
+/* function compBuf_map()
+
+	Description: constellation mapper writing a split buffer; same bit
+	             order as mapConstel()
+
+	Return indicator:
+		0					Success
+ */
+
+int compBuf_map(int *lenSym, compBuf_str *sym, int lenBit, int bitStream[],
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n;
+
+	*lenSym = lenBit / m;
+
+	for(i = 0; i < *lenSym; i += n){
+		n = (*lenSym - i < BITGROUP_BLK) ? *lenSym - i : BITGROUP_BLK;
+		bitGroup_fromBits(lab, &bitStream[m*i], n, m);
+		for(k = 0; k < n; k++){
+			sym->re[i+k] = cons->point[lab[k]].re;
+			sym->im[i+k] = cons->point[lab[k]].im;
+		}
+	}
+
+	return 0;
+}
+
+int compBufF_map(int *lenSym, compBufF_str *sym, int lenBit, int bitStream[],
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n;
+
+	*lenSym = lenBit / m;
+
+	for(i = 0; i < *lenSym; i += n){
+		n = (*lenSym - i < BITGROUP_BLK) ? *lenSym - i : BITGROUP_BLK;
+		bitGroup_fromBits(lab, &bitStream[m*i], n, m);
+		for(k = 0; k < n; k++){
+			sym->re[i+k] = (float)cons->point[lab[k]].re;
+			sym->im[i+k] = (float)cons->point[lab[k]].im;
+		}
+	}
+
+	return 0;
+}
+
+/* function compBuf_hd()
+
+	Description: hard demapper on a split buffer; same result as ConstelHd()
+
+	Comment:
+		1. separable QAM slices the re[] and im[] arrays independently with
+		   a branch free level index, which is what makes the SoA layout pay
+ */
+
+int compBuf_hd(int *lenBit, int bitStream[], const compBuf_str *sym, int lenSym,
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n, kI, kQ;
+
+	*lenBit = lenSym * m;
+
+	for(i = 0; i < lenSym; i += n){
+		n = (lenSym - i < BITGROUP_BLK) ? lenSym - i : BITGROUP_BLK;
+		if(!cons->isSep)
+			for(k = 0; k < n; k++)
+				lab[k] = constel_hdLabel(cons, genComp(sym->re[i+k], sym->im[i+k]));
+		else
+			for(k = 0; k < n; k++){
+				kI = constel_pamSlice(sym->re[i+k], cons->lvStep, cons->numLvI);
+				kQ = constel_pamSlice(sym->im[i+k], cons->lvStep, cons->numLvQ);
+				lab[k] = (cons->lvLabelI[kI] << cons->bitsQ) | cons->lvLabelQ[kQ];
+			}
+		bitGroup_toBits(&bitStream[m*i], lab, n, m);
+	}
+
+	return 0;
+}
+
+int compBufF_hd(int *lenBit, int bitStream[], const compBufF_str *sym, int lenSym,
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n, kI, kQ;
+
+	*lenBit = lenSym * m;
+
+	for(i = 0; i < lenSym; i += n){
+		n = (lenSym - i < BITGROUP_BLK) ? lenSym - i : BITGROUP_BLK;
+		if(!cons->isSep)
+			for(k = 0; k < n; k++)
+				lab[k] = constel_hdLabel(cons, genComp(sym->re[i+k], sym->im[i+k]));
+		else
+			for(k = 0; k < n; k++){
+				kI = constel_pamSlice(sym->re[i+k], cons->lvStep, cons->numLvI);
+				kQ = constel_pamSlice(sym->im[i+k], cons->lvStep, cons->numLvQ);
+				lab[k] = (cons->lvLabelI[kI] << cons->bitsQ) | cons->lvLabelQ[kQ];
+			}
+		bitGroup_toBits(&bitStream[m*i], lab, n, m);
+	}
+
+	return 0;
+}
+
+/* function compBuf_sd()
+
+	Description: max-log soft demapper on a split buffer, see ConstelSd()
+ */
+
+int compBuf_sd(int *lenLlr, double llr[], const compBuf_str *sym, int lenSym,
+		const constel_str *cons, double noiseVar)
+{
+	double invN0 = (noiseVar > 0.)? 1./noiseVar : 1.;
+	complex s;
+	int m = cons->bitsPerSym;
+	int i, len;
+
+	*lenLlr = lenSym * m;
+
+	for(i = 0; i < lenSym; i++){
+		if(cons->isSep){
+			constel_pamLlr(&llr[m*i], sym->re[i], cons, cons->numLvI,
+					cons->lvLabelI, cons->bitsI, invN0);
+			constel_pamLlr(&llr[m*i+cons->bitsI], sym->im[i], cons, cons->numLvQ,
+					cons->lvLabelQ, cons->bitsQ, invN0);
+		} else {
+			s = genComp(sym->re[i], sym->im[i]);
+			ConstelSd(&len, &llr[m*i], 1, &s, cons, noiseVar);
+		}
+	}
+
+	return 0;
+}
+
+int compBufF_sd(int *lenLlr, double llr[], const compBufF_str *sym, int lenSym,
+		const constel_str *cons, double noiseVar)
+{
+	double invN0 = (noiseVar > 0.)? 1./noiseVar : 1.;
+	complex s;
+	int m = cons->bitsPerSym;
+	int i, len;
+
+	*lenLlr = lenSym * m;
+
+	for(i = 0; i < lenSym; i++){
+		if(cons->isSep){
+			constel_pamLlr(&llr[m*i], sym->re[i], cons, cons->numLvI,
+					cons->lvLabelI, cons->bitsI, invN0);
+			constel_pamLlr(&llr[m*i+cons->bitsI], sym->im[i], cons, cons->numLvQ,
+					cons->lvLabelQ, cons->bitsQ, invN0);
+		} else {
+			s = genComp(sym->re[i], sym->im[i]);
+			ConstelSd(&len, &llr[m*i], 1, &s, cons, noiseVar);
+		}
+	}
+
+	return 0;
+}
+
+/***********************************
+ * FIR Filter                      *
+ ***********************************/
+
+/* function compBuf_fir()
+
+	Description: full convolution of a split complex input with real taps,
+	             y[n] = sum_k h[k] x[n-k], n = 0 .. len_x+len_h-2
+
+	Output parameters:
+		*y					len_x + len_h - 1 samples, overwritten
+
+	Return indicator:
+		0					Success
+		-1					Short output buffer
+
+	Comment:
+		1. the output is produced in COMPBUF_BLOCK sized blocks; within a
+		   block every tap is a scaled add of a shifted input row, so the
+		   inner loop is a reduction free vector FMA stream on data that
+		   stays in L1
+ */
+
+int compBuf_fir(compBuf_str *y, const double *h, int len_h,
+		const compBuf_str *x, int len_x)
+{
+	int len_y = len_x + len_h - 1;
+	int n0, n1, k, n, lo, hi;
+	double * restrict yr = y->re, * restrict yi = y->im;
+	const double * restrict xr = x->re, * restrict xi = x->im;
+
+	if(y->len < len_y){
+		printf("[fir]Invalid output length\n");
+		return -1;
+	}
+
+	for(n0 = 0; n0 < len_y; n0 += COMPBUF_BLOCK){
+		n1 = (n0 + COMPBUF_BLOCK < len_y)? n0 + COMPBUF_BLOCK : len_y;
+		memset(&yr[n0], 0, sizeof(double)*(n1 - n0));
+		memset(&yi[n0], 0, sizeof(double)*(n1 - n0));
+
+		for(k = 0; k < len_h; k++){
+			lo = (n0 > k)? n0 : k;
+			hi = (n1 < len_x + k)? n1 : len_x + k;
+			for(n = lo; n < hi; n++){
+				yr[n] += h[k] * xr[n-k];
+				yi[n] += h[k] * xi[n-k];
+			}
+		}
+	}
+
+	return 0;
+}
+
+int compBufF_fir(compBufF_str *y, const float *h, int len_h,
+		const compBufF_str *x, int len_x)
+{
+	int len_y = len_x + len_h - 1;
+	int n0, n1, k, n, lo, hi;
+	float * restrict yr = y->re, * restrict yi = y->im;
+	const float * restrict xr = x->re, * restrict xi = x->im;
+
+	if(y->len < len_y){
+		printf("[fir]Invalid output length\n");
+		return -1;
+	}
+
+	for(n0 = 0; n0 < len_y; n0 += COMPBUF_BLOCK){
+		n1 = (n0 + COMPBUF_BLOCK < len_y)? n0 + COMPBUF_BLOCK : len_y;
+		memset(&yr[n0], 0, sizeof(float)*(n1 - n0));
+		memset(&yi[n0], 0, sizeof(float)*(n1 - n0));
+
+		for(k = 0; k < len_h; k++){
+			lo = (n0 > k)? n0 : k;
+			hi = (n1 < len_x + k)? n1 : len_x + k;
+			for(n = lo; n < hi; n++){
+				yr[n] += h[k] * xr[n-k];
+				yi[n] += h[k] * xi[n-k];
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* function compBuf_firComp()
+
+	Description: full convolution with complex taps (hr + j hi), e.g. a
+	             multipath channel; same output convention and blocking as
+	             compBuf_fir()
+ */
+
+int compBuf_firComp(compBuf_str *y, const double *hr, const double *hi_, int len_h,
+		const compBuf_str *x, int len_x)
+{
+	int len_y = len_x + len_h - 1;
+	int n0, n1, k, n, lo, hi;
+	double * restrict yr = y->re, * restrict yi = y->im;
+	const double * restrict xr = x->re, * restrict xi = x->im;
+
+	if(y->len < len_y){
+		printf("[fir]Invalid output length\n");
+		return -1;
+	}
+
+	for(n0 = 0; n0 < len_y; n0 += COMPBUF_BLOCK){
+		n1 = (n0 + COMPBUF_BLOCK < len_y)? n0 + COMPBUF_BLOCK : len_y;
+		memset(&yr[n0], 0, sizeof(double)*(n1 - n0));
+		memset(&yi[n0], 0, sizeof(double)*(n1 - n0));
+
+		for(k = 0; k < len_h; k++){
+			lo = (n0 > k)? n0 : k;
+			hi = (n1 < len_x + k)? n1 : len_x + k;
+			for(n = lo; n < hi; n++){
+				yr[n] += hr[k] * xr[n-k] - hi_[k] * xi[n-k];
+				yi[n] += hr[k] * xi[n-k] + hi_[k] * xr[n-k];
+			}
+		}
+	}
+
+	return 0;
+}
+
+int compBufF_firComp(compBufF_str *y, const float *hr, const float *hi_, int len_h,
+		const compBufF_str *x, int len_x)
+{
+	int len_y = len_x + len_h - 1;
+	int n0, n1, k, n, lo, hi;
+	float * restrict yr = y->re, * restrict yi = y->im;
+	const float * restrict xr = x->re, * restrict xi = x->im;
+
+	if(y->len < len_y){
+		printf("[fir]Invalid output length\n");
+		return -1;
+	}
+
+	for(n0 = 0; n0 < len_y; n0 += COMPBUF_BLOCK){
+		n1 = (n0 + COMPBUF_BLOCK < len_y)? n0 + COMPBUF_BLOCK : len_y;
+		memset(&yr[n0], 0, sizeof(float)*(n1 - n0));
+		memset(&yi[n0], 0, sizeof(float)*(n1 - n0));
+
+		for(k = 0; k < len_h; k++){
+			lo = (n0 > k)? n0 : k;
+			hi = (n1 < len_x + k)? n1 : len_x + k;
+			for(n = lo; n < hi; n++){
+				yr[n] += hr[k] * xr[n-k] - hi_[k] * xi[n-k];
+				yi[n] += hr[k] * xi[n-k] + hi_[k] * xr[n-k];
+			}
+		}
+	}
+
+	return 0;
+}
+
+/***********************************
+ * Correlation                     *
+ ***********************************/
+
+/* function compBuf_xcorr()
+
+	Description: full cross correlation of split buffers,
+	             output[k] = sum_n rev[n] * conj(local[n + len_local-1 - k])
+	             i.e. the same lag convention as xcorr_rangeComp()
+
+	Output parameters:
+		*output				len_rev + len_local - 1 samples
+
+	Return indicator:
+		0					Success
+		-1					Short output buffer or memory error
+
+	Comment:
+		1. computed as compBuf_firComp() of rev with the conjugated,
+		   time reversed local sequence as taps
+ */
+
+int compBuf_xcorr(compBuf_str *output, const compBuf_str *rev, int len_rev,
+		const compBuf_str *local, int len_local)
+{
+	double *hr, *hi;
+	int k, ret;
+
+	hr = (double *)malloc(sizeof(double)*len_local);
+	hi = (double *)malloc(sizeof(double)*len_local);
+	if(hr == NULL || hi == NULL){
+		printf("[xcorr] fail to mem alloc\n");
+		free(hr);
+		free(hi);
+		return -1;
+	}
+
+	for(k = 0; k < len_local; k++){
+		hr[k] = local->re[len_local-1-k];
+		hi[k] = -local->im[len_local-1-k];
+	}
+
+	ret = compBuf_firComp(output, hr, hi, len_local, rev, len_rev);
+
+	free(hr);
+	free(hi);
+	return ret;
+}
+
+int compBufF_xcorr(compBufF_str *output, const compBufF_str *rev, int len_rev,
+		const compBufF_str *local, int len_local)
+{
+	float *hr, *hi;
+	int k, ret;
+
+	hr = (float *)malloc(sizeof(float)*len_local);
+	hi = (float *)malloc(sizeof(float)*len_local);
+	if(hr == NULL || hi == NULL){
+		printf("[xcorr] fail to mem alloc\n");
+		free(hr);
+		free(hi);
+		return -1;
+	}
+
+	for(k = 0; k < len_local; k++){
+		hr[k] = local->re[len_local-1-k];
+		hi[k] = -local->im[len_local-1-k];
+	}
+
+	ret = compBufF_firComp(output, hr, hi, len_local, rev, len_rev);
+
+	free(hr);
+	free(hi);
+	return ret;
+}
+
+#endif /* __COMPBUF_H__ */
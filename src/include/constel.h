@@ -0,0 +1,655 @@
+/* File: constel.h
+ *
+ * Description: Generic Gray labelled PSK/QAM/APSK constellations
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#ifndef __CONSTEL_H__
+#define __CONSTEL_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "comMath.h"
+#include "bitGroup.h"
+
+/* Defines */
+#define MAX_CONSTEL_BITS	12
+#define MAX_CONSTEL_ORDER	(1<<MAX_CONSTEL_BITS)
+#define MAX_APSK_RINGS		8
+#define MAX_BSA_ORDER		256		/* largest APSK relabelled by BSA */
+
+#ifndef M_PI
+#define M_PI	3.14159265358979323846
+#endif
+
+/* Constellation families */
+enum{
+	CONSTEL_PSK = 0,
+	CONSTEL_QAM,
+	CONSTEL_APSK,
+	NUM_CONSTEL_FAMILY,
+};
+
+/* Constellation object
+
+	point[] is indexed by the bit label, i.e. the first bit of a symbol in
+	the bit stream is the MSB of the label. Separable (square/rectangular)
+	QAM additionally keeps its per-axis PAM so that the demappers do not
+	need to search the whole constellation.
+ */
+typedef struct{
+	int family;
+	int order;					// M
+	int bitsPerSym;				// log2(M)
+	double avePow;				// average symbol energy
+	double minDist;				// minimum Euclidean distance
+	complex *point;				// point[label]
+
+	/* separable QAM only */
+	int isSep;
+	int bitsI, bitsQ;			// label bits carried by I and Q
+	int numLvI, numLvQ;			// PAM levels on I and Q
+	double lvStep;				// distance between adjacent levels
+	int *lvLabelI, *lvLabelQ;	// axis label of level k (ascending)
+
+	/* PSK only */
+	double phOffset;			// phase of point with angle index 0
+} constel_str;
+
+/* Functions */
+
+/* Axis label of PAM level k out of L levels (ascending amplitude).
+   The XOR keeps the QAM16/QAM64 labelling of the former closed-form
+   mappers, in which the leading bit is the sign and '1' means a positive
+   amplitude. */
+static inline int constel_pamLabel(int k, int L)
+{
+	return (L < 2)? 0 : grayEnc(k) ^ ((L >> 1) - 1);
+}
+
+static int constel_alloc(constel_str *cons, int family, int order)
+{
+	int m = 0;
+
+	while((1 << m) < order)
+		m++;
+
+	if(order < 2 || (1 << m) != order || m > MAX_CONSTEL_BITS){
+		printf("[constel] unsupported order %d\n", order);
+		return -1;
+	}
+
+	memset(cons, 0, sizeof(constel_str));
+	cons->family = family;
+	cons->order = order;
+	cons->bitsPerSym = m;
+
+	if((cons->point = (complex *)malloc(sizeof(complex)*order)) == NULL){
+		printf("[constel] fail to mem alloc\n");
+		return -2;
+	}
+
+	return 0;
+}
+
+/* scale to the requested average power and find d_min */
+static void constel_normalise(constel_str *cons, double avePow)
+{
+	double energy = 0., scale, d;
+	int i, j;
+
+	for(i = 0; i < cons->order; i++)
+		energy += absSqrComp(cons->point[i]);
+	energy /= cons->order;
+
+	scale = sqrt(avePow / energy);
+	for(i = 0; i < cons->order; i++){
+		cons->point[i].re *= scale;
+		cons->point[i].im *= scale;
+	}
+	cons->lvStep *= scale;
+	cons->avePow = avePow;
+
+	if(cons->isSep){
+		cons->minDist = cons->lvStep;
+		return;
+	}
+
+	cons->minDist = HUGE_VAL;
+	for(i = 0; i < cons->order; i++)
+		for(j = i + 1; j < cons->order; j++){
+			d = absSqrComp(genComp(cons->point[i].re - cons->point[j].re,
+						cons->point[i].im - cons->point[j].im));
+			if(d < cons->minDist)
+				cons->minDist = d;
+		}
+	cons->minDist = sqrt(cons->minDist);
+}
+
+/* function constel_initPsk()
+
+	Description: M-PSK with Gray labelled phase index, rotated by pi/M
+	             for M > 2 (QPSK lies on the diagonals)
+
+	Return indicator:
+		0					Success
+		< 0					Unsupported order or memory error
+ */
+
+int constel_initPsk(constel_str *cons, int order, double avePow)
+{
+	int k;
+
+	if(constel_alloc(cons, CONSTEL_PSK, order) < 0)
+		return -1;
+
+	cons->phOffset = (order > 2)? M_PI / order : 0.;
+	for(k = 0; k < order; k++)
+		cons->point[grayEnc(k)] = genComp(cos(2*M_PI*k/order + cons->phOffset),
+				sin(2*M_PI*k/order + cons->phOffset));
+
+	constel_normalise(cons, avePow);
+	return 0;
+}
+
+/* function constel_initQam()
+
+	Description: Gray labelled square QAM for even bits per symbol,
+	             rectangular QAM for 2 and 8 points and quasi-Gray cross QAM
+	             (32, 128, 512, 2048) for the other odd cases
+
+	Comment:
+		1. the cross constellation is built from a 2n x n rectangular Gray
+		   grid whose outer columns, |I| > 3n/2, are folded onto the
+		   missing rows as (I,Q) -> (sgn(I)(n-|Q|), sgn(Q)(|I|-n/2))
+ */
+
+int constel_initQam(constel_str *cons, int order, double avePow)
+{
+	int kI, kQ, lab, n, I, Q, tmp;
+
+	if(constel_alloc(cons, CONSTEL_QAM, order) < 0)
+		return -1;
+
+	cons->bitsI = (cons->bitsPerSym + 1) / 2;
+	cons->bitsQ = cons->bitsPerSym / 2;
+	cons->numLvI = 1 << cons->bitsI;
+	cons->numLvQ = 1 << cons->bitsQ;
+	cons->isSep = (cons->bitsI == cons->bitsQ || cons->bitsPerSym < 5);
+	cons->lvStep = 2.;
+	n = cons->numLvQ;
+
+	for(kI = 0; kI < cons->numLvI; kI++)
+		for(kQ = 0; kQ < cons->numLvQ; kQ++){
+			lab = (constel_pamLabel(kI, cons->numLvI) << cons->bitsQ)
+				| constel_pamLabel(kQ, cons->numLvQ);
+			I = 2*kI - cons->numLvI + 1;
+			Q = 2*kQ - cons->numLvQ + 1;
+
+			if(!cons->isSep && abs(I) > 3*n/2){
+				tmp = I;
+				I = (tmp > 0 ? 1 : -1) * (n - abs(Q));
+				Q = (Q > 0 ? 1 : -1) * (abs(tmp) - n/2);
+			}
+			cons->point[lab] = genComp(I, Q);
+		}
+
+	if(cons->isSep){
+		if((cons->lvLabelI = (int *)malloc(sizeof(int)*cons->numLvI)) == NULL ||
+		   (cons->lvLabelQ = (int *)malloc(sizeof(int)*cons->numLvQ)) == NULL){
+			printf("[constel] fail to mem alloc\n");
+			return -2;
+		}
+		for(kI = 0; kI < cons->numLvI; kI++)
+			cons->lvLabelI[kI] = constel_pamLabel(kI, cons->numLvI);
+		for(kQ = 0; kQ < cons->numLvQ; kQ++)
+			cons->lvLabelQ[kQ] = constel_pamLabel(kQ, cons->numLvQ);
+	}
+
+	constel_normalise(cons, avePow);
+	return 0;
+}
+
+/* Gray penalty of label assignment: Hamming distance weighted by the
+   proximity of the two points */
+static double constel_bsaDelta(const double *w, const int *lab, int M, int a, int b)
+{
+	double delta = 0.;
+	int j;
+
+	for(j = 0; j < M; j++){
+		if(j == a || j == b)
+			continue;
+		delta += w[a*M+j] * (__builtin_popcount(lab[b] ^ lab[j])
+				- __builtin_popcount(lab[a] ^ lab[j]));
+		delta += w[b*M+j] * (__builtin_popcount(lab[a] ^ lab[j])
+				- __builtin_popcount(lab[b] ^ lab[j]));
+	}
+
+	return delta;
+}
+
+/* function constel_initApsk()
+
+	Description: APSK from an arbitrary ring description (DVB-S2 style)
+
+	input parameters:
+		numRing				number of rings, inner first
+		numPts[]			points on each ring; must sum to a power of two
+		radius[]			ring radii (only the ratios matter)
+		phase[]				phase of the first point on each ring
+		avePow				average symbol energy
+
+	Comment:
+		1. rings with a different number of points can not be Gray labelled
+		   exactly, so the ring-major natural labelling is refined by the
+		   binary switching algorithm (pairwise label swaps that lower the
+		   Hamming distance between close neighbours) for M <= MAX_BSA_ORDER
+ */
+
+int constel_initApsk(constel_str *cons,
+		int numRing,
+		const int numPts[],
+		const double radius[],
+		const double phase[],
+		double avePow)
+{
+	complex pos[MAX_CONSTEL_ORDER];
+	int *lab = NULL;
+	double *w = NULL, d2, dmin2 = HUGE_VAL, delta;
+	int M = 0, r, k, i, j, improved, ret = 0;
+
+	if(numRing < 1 || numRing > MAX_APSK_RINGS){
+		printf("[constel] invalid number of APSK rings(%d)\n", numRing);
+		return -1;
+	}
+	for(r = 0; r < numRing; r++)
+		M += numPts[r];
+	if(constel_alloc(cons, CONSTEL_APSK, M) < 0)
+		return -1;
+
+	for(r = 0, i = 0; r < numRing; r++)
+		for(k = 0; k < numPts[r]; k++, i++)
+			pos[i] = genComp(radius[r]*cos(2*M_PI*k/numPts[r] + phase[r]),
+					radius[r]*sin(2*M_PI*k/numPts[r] + phase[r]));
+
+	if((lab = (int *)malloc(sizeof(int)*M)) == NULL){
+		ret = -2;
+		goto ERR_MEM;
+	}
+	for(i = 0; i < M; i++)
+		lab[i] = i;
+
+	if(M <= MAX_BSA_ORDER){
+		if((w = (double *)malloc(sizeof(double)*M*M)) == NULL){
+			ret = -2;
+			goto ERR_MEM;
+		}
+		for(i = 0; i < M; i++)
+			for(j = 0; j < M; j++){
+				d2 = pow(pos[i].re - pos[j].re, 2) + pow(pos[i].im - pos[j].im, 2);
+				w[i*M+j] = d2;
+				if(i != j && d2 < dmin2)
+					dmin2 = d2;
+			}
+		for(i = 0; i < M*M; i++)
+			w[i] = exp(-w[i] / dmin2);
+
+		do{
+			improved = 0;
+			for(i = 0; i < M; i++)
+				for(j = i + 1; j < M; j++){
+					delta = constel_bsaDelta(w, lab, M, i, j);
+					if(delta < -1e-12){
+						k = lab[i]; lab[i] = lab[j]; lab[j] = k;
+						improved = 1;
+					}
+				}
+		}while(improved);
+	}
+
+	for(i = 0; i < M; i++)
+		cons->point[lab[i]] = pos[i];
+
+	constel_normalise(cons, avePow);
+
+	free(w);
+	free(lab);
+	return 0;
+
+ERR_MEM:
+	printf("[constel] fail to mem alloc\n");
+	free(w);
+	free(lab);
+	return ret;
+}
+
+/* DVB-S2 16APSK(4+12) and 32APSK(4+12+16) with the rate 3/4 ring ratios */
+int constel_initDvbApsk(constel_str *cons, int order, double avePow)
+{
+	const int pts16[2] = {4, 12};
+	const double rad16[2] = {1., 2.85};
+	const double ph16[2] = {M_PI/4, M_PI/12};
+	const int pts32[3] = {4, 12, 16};
+	const double rad32[3] = {1., 2.84, 5.27};
+	const double ph32[3] = {M_PI/4, M_PI/12, 0.};
+
+	switch(order){
+		case 16:
+			return constel_initApsk(cons, 2, pts16, rad16, ph16, avePow);
+		case 32:
+			return constel_initApsk(cons, 3, pts32, rad32, ph32, avePow);
+		default:
+			printf("[constel] no default APSK ring set for order %d\n", order);
+			return -1;
+	}
+}
+
+/* function constel_init()
+
+	Description: build a constellation of the given family and order
+
+	Return indicator:
+		0					Success
+		< 0					Unsupported family/order or memory error
+ */
+
+int constel_init(constel_str *cons, int family, int order, double avePow)
+{
+	switch(family){
+		case CONSTEL_PSK:
+			return constel_initPsk(cons, order, avePow);
+		case CONSTEL_QAM:
+			return constel_initQam(cons, order, avePow);
+		case CONSTEL_APSK:
+			return constel_initDvbApsk(cons, order, avePow);
+		default:
+			printf("[constel] unknown family %d\n", family);
+			return -1;
+	}
+}
+
+void constel_free(constel_str *cons)
+{
+	free(cons->point);
+	free(cons->lvLabelI);
+	free(cons->lvLabelQ);
+	memset(cons, 0, sizeof(constel_str));
+}
+
+/* function constel_get()
+
+	Description: unit power constellation generated once on first use
+
+	Return indicator:
+		!NULL				Cached constellation
+		NULL				Unsupported family/order
+
+	Caution:
+		first use of each (family, order) is not thread safe; touch the
+		constellation before spawning worker threads
+ */
+
+static constel_str *constelCache[NUM_CONSTEL_FAMILY][MAX_CONSTEL_BITS+1];
+
+constel_str *constel_get(int family, int order)
+{
+	constel_str *cons;
+	int m = 0;
+
+	while((1 << m) < order && m <= MAX_CONSTEL_BITS)
+		m++;
+	if(family < 0 || family >= NUM_CONSTEL_FAMILY || m > MAX_CONSTEL_BITS
+			|| (1 << m) != order)
+		return NULL;
+
+	if(constelCache[family][m] != NULL)
+		return constelCache[family][m];
+
+	if((cons = (constel_str *)calloc(1, sizeof(constel_str))) == NULL)
+		return NULL;
+	if(constel_init(cons, family, order, 1.0) < 0){
+		constel_free(cons);
+		free(cons);
+		return NULL;
+	}
+
+	return constelCache[family][m] = cons;
+}
+
+/* nearest PAM level of x among L levels spaced by step */
+static inline int constel_pamSlice(double x, double step, int L)
+{
+	int k = (int)floor(x / step + 0.5*L);
+
+	return (k < 0)? 0 : (k >= L)? L-1 : k;
+}
+
+/* function constel_hdLabel()
+
+	Description: minimum distance decision of a single symbol
+
+	Return indicator:
+		label of the nearest constellation point
+ */
+
+static inline int constel_hdLabel(const constel_str *cons, complex sym)
+{
+	double d, dmin;
+	int k, best = 0;
+
+	if(cons->isSep)
+		return (cons->lvLabelI[constel_pamSlice(sym.re, cons->lvStep, cons->numLvI)]
+				<< cons->bitsQ)
+			| cons->lvLabelQ[constel_pamSlice(sym.im, cons->lvStep, cons->numLvQ)];
+
+	if(cons->family == CONSTEL_PSK){
+		k = (int)floor((atan2(sym.im, sym.re) - cons->phOffset)
+				* cons->order / (2*M_PI) + 0.5);
+		k = ((k % cons->order) + cons->order) % cons->order;
+		return grayEnc(k);
+	}
+
+	dmin = HUGE_VAL;
+	for(k = 0; k < cons->order; k++){
+		d = pow(sym.re - cons->point[k].re, 2) + pow(sym.im - cons->point[k].im, 2);
+		if(d < dmin){
+			dmin = d;
+			best = k;
+		}
+	}
+
+	return best;
+}
+
+/* function mapConstel()
+
+	Description: table driven bit to symbol mapper
+
+	Output parameters:
+		*lenSym				The final length of mapped symbol vector
+		symVec[]			The output symbol vector, whose length is *lenSym
+
+	Input parameters:
+		lenBit				The number of input bits
+		bitStream[]			The input bitstream
+		*cons				Constellation
+
+	Return indicator:
+		0					Success
+ */
+
+int mapConstel(int *lenSym,
+		complex symVec[],
+		int lenBit,
+		int bitStream[],
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n;
+
+	*lenSym = lenBit / m;
+
+	for(i = 0; i < *lenSym; i += n){
+		n = (*lenSym - i < BITGROUP_BLK) ? *lenSym - i : BITGROUP_BLK;
+		bitGroup_fromBits(lab, &bitStream[m*i], n, m);
+		for(k = 0; k < n; k++)
+			symVec[i+k] = cons->point[lab[k]];
+	}
+
+	return 0;
+}
+
+/* function ConstelHd()
+
+	Description: minimum distance symbol to bit demapper
+
+	Output parameters:
+		*lenBit				The number of output bits
+		bitStream[]			The output bitstream
+
+	Input parameters:
+		lenSym				The length of received symbol vector
+		symVec[]			The input symbol vector
+		*cons				Constellation
+
+	Return indicator:
+		0					Success
+ */
+
+int ConstelHd(
+		int *lenBit,
+		int bitStream[],
+		int lenSym,
+		complex symVec[],
+		const constel_str *cons)
+{
+	int m = cons->bitsPerSym;
+	int lab[BITGROUP_BLK];
+	int i, k, n;
+
+	*lenBit = lenSym * m;
+
+	for(i = 0; i < lenSym; i += n){
+		n = (lenSym - i < BITGROUP_BLK) ? lenSym - i : BITGROUP_BLK;
+		for(k = 0; k < n; k++)
+			lab[k] = constel_hdLabel(cons, symVec[i+k]);
+		bitGroup_toBits(&bitStream[m*i], lab, n, m);
+	}
+
+	return 0;
+}
+
+/* per-axis max-log LLRs of a separable QAM: bits [b0, b0+nb) of llr[] */
+static void constel_pamLlr(double llr[], double x, const constel_str *cons,
+		int L, const int *lvLabel, int nb, double invN0)
+{
+	double min0[MAX_CONSTEL_BITS], min1[MAX_CONSTEL_BITS], d;
+	int k, b;
+
+	for(b = 0; b < nb; b++)
+		min0[b] = min1[b] = HUGE_VAL;
+
+	for(k = 0; k < L; k++){
+		d = x - (k - 0.5*(L-1)) * cons->lvStep;
+		d *= d;
+		for(b = 0; b < nb; b++){
+			if((lvLabel[k] >> (nb-1-b)) & 1){
+				if(d < min1[b])
+					min1[b] = d;
+			} else if(d < min0[b])
+				min0[b] = d;
+		}
+	}
+
+	for(b = 0; b < nb; b++)
+		llr[b] = (min1[b] - min0[b]) * invN0;
+}
+
+/* function ConstelSd()
+
+	Description: max-log soft demapper
+
+	Output parameters:
+		*lenLlr				The number of output LLRs
+		llr[]				log(P(b=0)/P(b=1)), positive favours '0'
+
+	Input parameters:
+		lenSym				The length of received symbol vector
+		symVec[]			The input symbol vector
+		*cons				Constellation
+		noiseVar			complex noise variance N0; <= 0 gives raw
+							squared distance differences
+
+	Return indicator:
+		0					Success
+ */
+
+int ConstelSd(
+		int *lenLlr,
+		double llr[],
+		int lenSym,
+		complex symVec[],
+		const constel_str *cons,
+		double noiseVar)
+{
+	double min0[MAX_CONSTEL_BITS], min1[MAX_CONSTEL_BITS], d;
+	double invN0 = (noiseVar > 0.)? 1./noiseVar : 1.;
+	int m = cons->bitsPerSym;
+	int i, k, b;
+
+	*lenLlr = lenSym * m;
+
+	for(i = 0; i < lenSym; i++){
+		if(cons->isSep){
+			constel_pamLlr(&llr[m*i], symVec[i].re, cons, cons->numLvI,
+					cons->lvLabelI, cons->bitsI, invN0);
+			constel_pamLlr(&llr[m*i+cons->bitsI], symVec[i].im, cons, cons->numLvQ,
+					cons->lvLabelQ, cons->bitsQ, invN0);
+			continue;
+		}
+
+		for(b = 0; b < m; b++)
+			min0[b] = min1[b] = HUGE_VAL;
+
+		for(k = 0; k < cons->order; k++){
+			d = pow(symVec[i].re - cons->point[k].re, 2)
+				+ pow(symVec[i].im - cons->point[k].im, 2);
+			for(b = 0; b < m; b++){
+				if((k >> (m-1-b)) & 1){
+					if(d < min1[b])
+						min1[b] = d;
+				} else if(d < min0[b])
+					min0[b] = d;
+			}
+		}
+
+		for(b = 0; b < m; b++)
+			llr[m*i+b] = (min1[b] - min0[b]) * invN0;
+	}
+
+	return 0;
+}
+
+#endif /* __CONSTEL_H__ */
@@ -0,0 +1,521 @@
+/* File: convCode.h
+ *
+ * Description: Convolutional encoder and soft-input Viterbi decoder
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Rate 1/n codes of constraint length K <= 9, zero terminated, with an
+ * optional puncturing pattern. The state holds the last K-1 input bits,
+ * the newest in the MSB; generators are given in the usual octal form
+ * whose MSB taps the current input. The decoder quantises the LLRs to
+ * int8 and runs the add-compare-select on int16 path metrics, one
+ * radix-2 butterfly per pair of states, and keeps one survivor bit per
+ * state and step. With AVX-512BW the metrics of codes with 64 or more
+ * states stay in registers for the whole block; otherwise flat loops over
+ * the states are left to the auto-vectoriser. Renormalisation keeps the
+ * metrics far from the int16 limits, so no saturation is needed.
+ */
+
+#ifndef __CONVCODE_H__
+#define __CONVCODE_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#ifdef __AVX512BW__
+#include <immintrin.h>
+#endif
+
+/* Defines */
+#define CONV_MAX_K			9
+#define CONV_MAX_N			4
+#define CONV_MAX_STATES		(1 << (CONV_MAX_K - 1))
+#define CONV_MAX_PERIOD		16
+#define CONV_LLR_Q			24.		/* int8 level of the mean |LLR| */
+#define CONV_MIN_METRIC		-8192
+
+/* Preset codes */
+enum{
+	CONV_NONE = 0,
+	CONV_K7_R12,				// (133, 171), IEEE 802.11
+	CONV_K7_R23,				// 802.11 puncturing
+	CONV_K7_R34,				// 802.11 puncturing
+	CONV_K7_R13,				// (133, 171, 165), LTE
+	CONV_K9_R12,				// (561, 753), IS-95/3GPP
+	CONV_K9_R13,				// (557, 663, 711), 3GPP
+	NUM_CONV_PRESET,
+};
+
+typedef struct{
+	int K;						// constraint length
+	int n;						// outputs per input bit
+	int poly[CONV_MAX_N];		// generators, octal notation
+	int numStates;
+	int period;					// puncturing period, 1: none
+	int punc[CONV_MAX_N][CONV_MAX_PERIOD];	// 1 keeps the output bit
+	int keepPerPeriod;
+	int sym;					// every generator taps input and oldest bit
+	unsigned char out[CONV_MAX_STATES][2];	// output bits of (state, input)
+	/* decoder: sign (+1 for a '0' output) of output i on the butterfly
+	   transitions even/odd state x input 0/1, indexed by butterfly */
+	short sgn[4][CONV_MAX_N][CONV_MAX_STATES/2];
+	/* decoder workspace */
+	unsigned long long *dec;	// survivor bits, one per state and step
+	long decCap;
+	short *llrQ;				// depunctured, quantised LLRs
+	long llrCap;
+} conv_str;
+
+/* Functions */
+
+static inline int conv_parity(unsigned x)
+{
+	return __builtin_parity(x);
+}
+
+/* function convCode_init()
+
+	Description: build a rate 1/n code
+
+	input parameters:
+		K					constraint length, 3..CONV_MAX_K
+		n					outputs per input bit, 1..CONV_MAX_N
+		poly[]				n generators (octal notation as an int, e.g. 0133)
+		period				puncturing period, 0 or 1 for none
+		punc				n x period keep pattern, row major; NULL for none
+
+	Return indicator:
+		0					Success
+		-1					Invalid code
+ */
+
+int convCode_init(conv_str *conv, int K, int n, const int poly[], int period,
+		const int *punc)
+{
+	int s, b, i, j, t, reg, c, cls;
+
+	memset(conv, 0, sizeof(conv_str));
+	if(K < 3 || K > CONV_MAX_K || n < 1 || n > CONV_MAX_N
+			|| period > CONV_MAX_PERIOD){
+		printf("[conv] unsupported code K=%d n=%d\n", K, n);
+		return -1;
+	}
+
+	conv->K = K;
+	conv->n = n;
+	conv->numStates = 1 << (K - 1);
+	conv->period = (period > 1 && punc != NULL) ? period : 1;
+	for(i = 0; i < n; i++){
+		conv->poly[i] = poly[i];
+		for(t = 0; t < conv->period; t++){
+			conv->punc[i][t] = (conv->period > 1) ? punc[i*period + t] : 1;
+			conv->keepPerPeriod += conv->punc[i][t];
+		}
+	}
+
+	for(s = 0; s < conv->numStates; s++)
+		for(b = 0; b < 2; b++){
+			reg = (b << (K - 1)) | s;
+			for(c = 0, i = 0; i < n; i++)
+				c |= conv_parity(reg & poly[i]) << i;
+			conv->out[s][b] = (unsigned char)c;
+		}
+
+	/* butterfly j: old states 2j, 2j+1 -> new states j (input 0) and
+	   j + numStates/2 (input 1). When every generator taps both ends of
+	   the register, the four branches of a butterfly are +-one metric. */
+	conv->sym = 1;
+	for(i = 0; i < n; i++)
+		if(!((poly[i] >> (K - 1)) & 1) || !(poly[i] & 1))
+			conv->sym = 0;
+
+	for(j = 0; j < conv->numStates/2; j++)
+		for(cls = 0; cls < 4; cls++){
+			s = 2*j + (cls & 1);
+			b = cls >> 1;
+			for(i = 0; i < n; i++)
+				conv->sgn[cls][i][j] = ((conv->out[s][b] >> i) & 1) ? -1 : 1;
+		}
+
+	return 0;
+}
+
+int convCode_initPreset(conv_str *conv, int preset)
+{
+	static const int p12[2] = {0133, 0171}, p13[3] = {0133, 0171, 0165};
+	static const int p912[2] = {0561, 0753}, p913[3] = {0557, 0663, 0711};
+	static const int punc23[2*2] = {1, 1,  1, 0};
+	static const int punc34[2*3] = {1, 1, 0,  1, 0, 1};
+
+	switch(preset){
+		case CONV_K7_R12:	return convCode_init(conv, 7, 2, p12, 1, NULL);
+		case CONV_K7_R23:	return convCode_init(conv, 7, 2, p12, 2, punc23);
+		case CONV_K7_R34:	return convCode_init(conv, 7, 2, p12, 3, punc34);
+		case CONV_K7_R13:	return convCode_init(conv, 7, 3, p13, 1, NULL);
+		case CONV_K9_R12:	return convCode_init(conv, 9, 2, p912, 1, NULL);
+		case CONV_K9_R13:	return convCode_init(conv, 9, 3, p913, 1, NULL);
+		default:
+			printf("[conv] unknown preset %d\n", preset);
+			return -1;
+	}
+}
+
+void convCode_free(conv_str *conv)
+{
+	free(conv->dec);
+	free(conv->llrQ);
+	conv->dec = NULL;
+	conv->llrQ = NULL;
+	conv->decCap = conv->llrCap = 0;
+}
+
+/* coded (transmitted) bits of lenIn information bits, tail included */
+int convCode_lenCoded(const conv_str *conv, int lenIn)
+{
+	int steps = lenIn + conv->K - 1, t, i, len = 0;
+
+	len = steps / conv->period * conv->keepPerPeriod;
+	for(t = 0; t < steps % conv->period; t++)
+		for(i = 0; i < conv->n; i++)
+			len += conv->punc[i][t];
+
+	return len;
+}
+
+/* function convCode_enc()
+
+	Description: encode and terminate with K-1 zeros, then puncture
+
+	Output parameters:
+		*lenOut				convCode_lenCoded(lenIn) coded bits
+		out[]				coded bits, output i of step t before i+1
+ */
+
+int convCode_enc(int *lenOut, int out[], int lenIn, const int in[],
+		const conv_str *conv)
+{
+	int steps = lenIn + conv->K - 1, t, i, b, s = 0, c, len = 0, ph = 0;
+
+	for(t = 0; t < steps; t++){
+		b = (t < lenIn) ? (in[t] & 1) : 0;
+		c = conv->out[s][b];
+		for(i = 0; i < conv->n; i++)
+			if(conv->punc[i][ph])
+				out[len++] = (c >> i) & 1;
+		s = (b << (conv->K - 2)) | (s >> 1);
+		if(++ph == conv->period)
+			ph = 0;
+	}
+
+	*lenOut = len;
+	return 0;
+}
+
+/* one trellis step: path metrics om -> nm, survivor bits to d; inlined
+   with a constant number of butterflies and outputs so that every loop is
+   a few full vectors and the branch metrics stay in registers */
+static inline __attribute__((always_inline)) void convCode_acsHalf(
+		short * restrict nm, unsigned long long * restrict d,
+		const short * restrict om, const conv_str *conv, const short *L,
+		const int half, const int n, const int sym)
+{
+	short bm[4][CONV_MAX_STATES/2] __attribute__((aligned(64)));
+	short oe[CONV_MAX_STATES/2] __attribute__((aligned(64))) = {0};
+	short oo[CONV_MAX_STATES/2] __attribute__((aligned(64))) = {0};
+	unsigned char db[CONV_MAX_STATES] __attribute__((aligned(64)));
+	unsigned long long w;
+	short a0, a1, c0, c1, ref;
+	int cls, i, j;
+
+	for(cls = 0; cls < (sym ? 1 : 4); cls++)
+		for(j = 0; j < half; j++){
+			bm[cls][j] = conv->sgn[cls][0][j] * L[0];
+			for(i = 1; i < n; i++)
+				bm[cls][j] += conv->sgn[cls][i][j] * L[i];
+		}
+
+	for(j = 0; j < half; j++){
+		oe[j] = om[2*j];
+		oo[j] = om[2*j+1];
+	}
+
+	/* new metric of state 0, subtracted from all so they stay bounded */
+	a0 = oe[0] + bm[0][0];
+	a1 = oo[0] + (sym ? -bm[0][0] : bm[1][0]);
+	ref = (a1 > a0) ? a1 : a0;
+
+	if(sym)
+		for(j = 0; j < half; j++){
+			a0 = oe[j] + bm[0][j];
+			a1 = oo[j] - bm[0][j];
+			c0 = oe[j] - bm[0][j];
+			c1 = oo[j] + bm[0][j];
+			nm[j] = ((a1 > a0) ? a1 : a0) - ref;
+			db[j] = (a1 > a0);
+			nm[j + half] = ((c1 > c0) ? c1 : c0) - ref;
+			db[j + half] = (c1 > c0);
+		}
+	else
+		for(j = 0; j < half; j++){
+			a0 = oe[j] + bm[0][j];
+			a1 = oo[j] + bm[1][j];
+			c0 = oe[j] + bm[2][j];
+			c1 = oo[j] + bm[3][j];
+			nm[j] = ((a1 > a0) ? a1 : a0) - ref;
+			db[j] = (a1 > a0);
+			nm[j + half] = ((c1 > c0) ? c1 : c0) - ref;
+			db[j + half] = (c1 > c0);
+		}
+
+	/* pack the 0/1 bytes eight at a time, bit j of byte group g -> j */
+	for(i = 0; i < (2*half + 63)/64; i++)
+		d[i] = 0;
+	for(j = 0; j < 2*half; j += 8){
+		memcpy(&w, &db[j], 8);
+		d[j >> 6] |= ((w * 0x0102040810204080ULL) >> 56) << (j & 63);
+	}
+}
+
+#define CONV_ACS_LOOP(half, n, sym) \
+	for(t = 0; t < steps; t++, cur ^= 1) \
+		convCode_acsHalf(pm[cur ^ 1], &dec[(long)t*W], pm[cur], conv, \
+				&L[t*N], half, n, sym)
+
+/* portable ACS over steps trellis steps, metrics go through memory */
+static void convCode_acsRunC(unsigned long long *dec, const short *L,
+		int steps, const conv_str *conv)
+{
+	short pm[2][CONV_MAX_STATES] __attribute__((aligned(64)));
+	int S = conv->numStates, N = conv->n, W = (S + 63)/64, t, s, cur = 0;
+
+	for(s = 0; s < S; s++)
+		pm[0][s] = CONV_MIN_METRIC;
+	pm[0][0] = 0;
+
+	switch(((S*2 + conv->sym) << 3) | N){
+		case ((64*2 + 1) << 3) | 2:		CONV_ACS_LOOP(32, 2, 1); break;
+		case ((64*2 + 1) << 3) | 3:		CONV_ACS_LOOP(32, 3, 1); break;
+		case ((256*2 + 1) << 3) | 2:	CONV_ACS_LOOP(128, 2, 1); break;
+		case ((256*2 + 1) << 3) | 3:	CONV_ACS_LOOP(128, 3, 1); break;
+		default:						CONV_ACS_LOOP(S/2, N, conv->sym); break;
+	}
+}
+
+#ifdef __AVX512BW__
+/* The S = 32*nv metrics stay in nv zmm registers for the whole block; the
+   even/odd predecessors of 32 new states are one two-source word permute
+   each, and the survivors come straight out of the compare masks. The
+   metrics are renormalised every 8 steps, when they have grown by at most
+   8*CONV_MAX_N*127. */
+static inline __attribute__((always_inline)) void convCode_acsAvx512(
+		unsigned long long *dec, const short *L, int steps,
+		const conv_str *conv, const int nv, const int n, const int sym)
+{
+	__m512i pm[CONV_MAX_STATES/32], nm[CONV_MAX_STATES/32];
+	__m512i idxE, idxO, e, o, b0, b1, b2, b3, lb[CONV_MAX_N];
+	__mmask32 m0, m1;
+	unsigned long long w[CONV_MAX_STATES/64];
+	short ie[32], io[32];
+	int hv = nv/2, W = nv/2, t, u, i, j;
+
+	for(j = 0; j < 32; j++){
+		ie[j] = 2*j;
+		io[j] = 2*j + 1;
+	}
+	idxE = _mm512_loadu_si512(ie);
+	idxO = _mm512_loadu_si512(io);
+
+	for(u = 0; u < nv; u++)
+		pm[u] = _mm512_set1_epi16(CONV_MIN_METRIC);
+	pm[0] = _mm512_mask_mov_epi16(pm[0], 1, _mm512_setzero_si512());
+
+	for(t = 0; t < steps; t++){
+		for(i = 0; i < n; i++)
+			lb[i] = _mm512_set1_epi16(L[t*n + i]);
+		for(u = 0; u < W; u++)
+			w[u] = 0;
+
+		for(u = 0; u < hv; u++){
+#define CONV_BM(cls) ({ \
+			__m512i acc_ = _mm512_mullo_epi16(lb[0], \
+					_mm512_loadu_si512(&conv->sgn[cls][0][32*u])); \
+			for(i = 1; i < n; i++) \
+				acc_ = _mm512_add_epi16(acc_, _mm512_mullo_epi16(lb[i], \
+						_mm512_loadu_si512(&conv->sgn[cls][i][32*u]))); \
+			acc_; })
+			e = _mm512_permutex2var_epi16(pm[2*u], idxE, pm[2*u + 1]);
+			o = _mm512_permutex2var_epi16(pm[2*u], idxO, pm[2*u + 1]);
+			b0 = CONV_BM(0);
+			if(sym){
+				b1 = _mm512_sub_epi16(o, b0);
+				b2 = _mm512_sub_epi16(e, b0);
+				b3 = _mm512_add_epi16(o, b0);
+				b0 = _mm512_add_epi16(e, b0);
+			} else {
+				b1 = _mm512_add_epi16(o, CONV_BM(1));
+				b2 = _mm512_add_epi16(e, CONV_BM(2));
+				b3 = _mm512_add_epi16(o, CONV_BM(3));
+				b0 = _mm512_add_epi16(e, b0);
+			}
+#undef CONV_BM
+			m0 = _mm512_cmpgt_epi16_mask(b1, b0);
+			m1 = _mm512_cmpgt_epi16_mask(b3, b2);
+			nm[u] = _mm512_max_epi16(b0, b1);
+			nm[u + hv] = _mm512_max_epi16(b2, b3);
+			/* new states 32u.. and S/2 + 32u.. */
+			w[u >> 1] |= (unsigned long long)m0 << (32*(u & 1));
+			w[(u + hv) >> 1] |= (unsigned long long)m1 << (32*((u + hv) & 1));
+		}
+
+		if((t & 7) == 7){
+			e = _mm512_broadcastw_epi16(_mm512_castsi512_si128(nm[0]));
+			for(u = 0; u < nv; u++)
+				nm[u] = _mm512_sub_epi16(nm[u], e);
+		}
+		for(u = 0; u < nv; u++)
+			pm[u] = nm[u];
+		for(u = 0; u < W; u++)
+			dec[(long)t*W + u] = w[u];
+	}
+}
+
+static void convCode_acsRunAvx512(unsigned long long *dec, const short *L,
+		int steps, const conv_str *conv)
+{
+	int nv = conv->numStates/32;
+
+	switch(((nv*2 + conv->sym) << 3) | conv->n){
+		case ((2*2 + 1) << 3) | 2:	convCode_acsAvx512(dec, L, steps, conv, 2, 2, 1); break;
+		case ((2*2 + 1) << 3) | 3:	convCode_acsAvx512(dec, L, steps, conv, 2, 3, 1); break;
+		case ((8*2 + 1) << 3) | 2:	convCode_acsAvx512(dec, L, steps, conv, 8, 2, 1); break;
+		case ((8*2 + 1) << 3) | 3:	convCode_acsAvx512(dec, L, steps, conv, 8, 3, 1); break;
+		default:	convCode_acsAvx512(dec, L, steps, conv, nv, conv->n, conv->sym); break;
+	}
+}
+#endif
+
+/* function convCode_dec()
+
+	Description: soft-input Viterbi decoding of one terminated block
+
+	Output parameters:
+		*lenOut				information bits
+		out[]				decoded bits
+
+	Input parameters:
+		lenLlr				received (punctured) LLRs, convCode_lenCoded()
+		llr[]				log(P(b=0)/P(b=1)), e.g. from ConstelSd()
+
+	Return indicator:
+		0					Success
+		-1					Invalid length or memory allocation error
+ */
+
+int convCode_dec(int *lenOut, int out[], int lenLlr, const double llr[],
+		conv_str *conv)
+{
+	int n = conv->n, S = conv->numStates, K = conv->K, W = (S + 63)/64;
+	int steps, rem, t, i, k = 0, ph = 0, s;
+	double acc[4] = {0., 0., 0., 0.}, meanAbs, scale, q;
+	unsigned long long *d;
+	short *L;
+
+	/* number of trellis steps from the punctured length */
+	steps = lenLlr / conv->keepPerPeriod * conv->period;
+	rem = lenLlr % conv->keepPerPeriod;
+	for(t = 0; rem > 0 && t < conv->period; t++, steps++)
+		for(i = 0; i < n; i++)
+			rem -= conv->punc[i][t];
+	if(rem != 0 || steps < K - 1){
+		printf("[conv] invalid coded length %d\n", lenLlr);
+		return -1;
+	}
+
+	if(conv->llrCap < (long)steps * n){
+		free(conv->llrQ);
+		conv->llrQ = (short *)malloc(sizeof(short)*steps*n);
+		conv->llrCap = conv->llrQ ? (long)steps * n : 0;
+	}
+	if(conv->decCap < (long)steps * W){
+		free(conv->dec);
+		conv->dec = (unsigned long long *)malloc(sizeof(unsigned long long)*steps*W);
+		conv->decCap = conv->dec ? (long)steps * W : 0;
+	}
+	if(conv->llrQ == NULL || conv->dec == NULL){
+		printf("[conv] fail to mem alloc\n");
+		return -1;
+	}
+
+	/* int8 quantisation, the mean |LLR| maps to CONV_LLR_Q; four partial
+	   sums keep the additions off one dependency chain */
+	for(i = 0; i + 4 <= lenLlr; i += 4)
+		for(k = 0; k < 4; k++)
+			acc[k] += fabs(llr[i + k]);
+	for(; i < lenLlr; i++)
+		acc[0] += fabs(llr[i]);
+	meanAbs = acc[0] + acc[1] + acc[2] + acc[3];
+	k = 0;
+	scale = (meanAbs > 0.) ? CONV_LLR_Q * lenLlr / meanAbs : 0.;
+
+	/* quantise in place at the end of the buffer, then depuncture in front
+	   of it: erased outputs get a zero LLR */
+	L = &conv->llrQ[(long)steps*n - lenLlr];
+	for(i = 0; i < lenLlr; i++){
+		q = llr[i] * scale;
+		q = (q > 127.) ? 127. : ((q < -127.) ? -127. : q);
+		L[i] = (short)(q + ((q < 0.) ? -0.5 : 0.5));
+	}
+	if(conv->period > 1)
+		for(t = 0; t < steps; t++){
+			for(i = 0; i < n; i++)
+				conv->llrQ[t*n + i] = conv->punc[i][ph] ? L[k++] : 0;
+			if(++ph == conv->period)
+				ph = 0;
+		}
+
+#ifdef __AVX512BW__
+	if(S >= 64)
+		convCode_acsRunAvx512(conv->dec, conv->llrQ, steps, conv);
+	else
+#endif
+		convCode_acsRunC(conv->dec, conv->llrQ, steps, conv);
+
+	/* trace back from the all-zero termination state */
+	s = 0;
+	if(W == 1)
+		for(t = steps - 1; t >= 0; t--){
+			if(t < steps - K + 1)
+				out[t] = s >> (K - 2);
+			s = ((s << 1) & (S - 1)) | (int)((conv->dec[t] >> s) & 1);
+		}
+	else
+		for(t = steps - 1; t >= 0; t--){
+			d = &conv->dec[(long)t*W];
+			if(t < steps - K + 1)
+				out[t] = s >> (K - 2);
+			s = ((s << 1) & (S - 1)) | (int)((d[s >> 6] >> (s & 63)) & 1);
+		}
+
+	*lenOut = steps - K + 1;
+	return 0;
+}
+
+#endif /* __CONVCODE_H__ */
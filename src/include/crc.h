@@ -0,0 +1,388 @@
+/* File: crc.h
+ *
+ * Description: Table driven CRC generation and check (slicing-by-8)
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The register is kept in a 32-bit word: left aligned for MSB first CRCs
+ * (the 3GPP ones), right aligned for reflected CRCs (CRC-32). Eight 256
+ * entry tables advance it by 8 bytes with 8 independent loads per step
+ * instead of a serial chain of 8 lookups. Bit arrays are packed into a
+ * small byte buffer in the bit order of the CRC first (16 bits per mask
+ * test with AVX-512), so a frame of int bits costs one pass of packing
+ * plus the byte kernel. Lengths that are not whole bytes finish bit by
+ * bit, which keeps the register exact for any split of the stream and
+ * lets blocks straddle frames.
+ */
+
+#ifndef __CRC_H__
+#define __CRC_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __AVX512F__
+#include <immintrin.h>
+#endif
+
+/* Defines */
+#define CRC_PACK_BYTES		256		/* bytes packed per pass over int bits */
+
+/* Presets */
+enum{
+	CRC_NONE = 0,
+	CRC_8,						// 3GPP gCRC8,   D^8+D^7+D^4+D^3+D+1
+	CRC_16,						// 3GPP gCRC16,  CCITT 0x1021
+	CRC_24A,					// 3GPP gCRC24A, 0x864CFB
+	CRC_24B,					// 3GPP gCRC24B, 0x800063
+	CRC_32,						// IEEE 802.3, reflected
+	NUM_CRC_TYPE,
+};
+
+typedef struct{
+	int width;					// CRC bits
+	unsigned int poly;			// generator without the x^width term
+	unsigned int init;			// initial register
+	unsigned int xorOut;		// final xor
+	int reflect;				// LSB first in and out
+	unsigned int tab[8][256];	// slicing tables, tab[k] advances k+1 bytes
+} crc_str;
+
+/* Functions */
+
+static inline unsigned int crc_reflect(unsigned int x, int width)
+{
+	unsigned int r = 0;
+	int b;
+
+	for(b = 0; b < width; b++, x >>= 1)
+		r = (r << 1) | (x & 1);
+
+	return r;
+}
+
+/* function crc_init()
+
+	Description: CRC of width bits with generator poly; the register starts
+	             at init and the result is xored with xorOut
+
+	Return indicator:
+		0					Success
+		-1					Unsupported width
+ */
+
+int crc_init(crc_str *crc, int width, unsigned int poly, unsigned int init,
+		unsigned int xorOut, int reflect)
+{
+	unsigned int mask, p, c;
+	int b, k, n;
+
+	if(width < 1 || width > 32){
+		printf("[crc] unsupported width %d\n", width);
+		return -1;
+	}
+
+	mask = (width == 32) ? 0xffffffffu : (1u << width) - 1;
+	memset(crc, 0, sizeof(crc_str));
+	crc->width = width;
+	crc->poly = poly & mask;
+	crc->init = init & mask;
+	crc->xorOut = xorOut & mask;
+	crc->reflect = reflect;
+
+	if(reflect){
+		p = crc_reflect(crc->poly, width);
+		for(n = 0; n < 256; n++){
+			for(c = n, b = 0; b < 8; b++)
+				c = (c & 1) ? (c >> 1) ^ p : c >> 1;
+			crc->tab[0][n] = c;
+		}
+		for(k = 1; k < 8; k++)
+			for(n = 0; n < 256; n++){
+				c = crc->tab[k-1][n];
+				crc->tab[k][n] = (c >> 8) ^ crc->tab[0][c & 0xff];
+			}
+	} else {
+		p = crc->poly << (32 - width);
+		for(n = 0; n < 256; n++){
+			for(c = (unsigned int)n << 24, b = 0; b < 8; b++)
+				c = (c & 0x80000000u) ? (c << 1) ^ p : c << 1;
+			crc->tab[0][n] = c;
+		}
+		for(k = 1; k < 8; k++)
+			for(n = 0; n < 256; n++){
+				c = crc->tab[k-1][n];
+				crc->tab[k][n] = (c << 8) ^ crc->tab[0][c >> 24];
+			}
+	}
+
+	return 0;
+}
+
+int crc_initPreset(crc_str *crc, int type)
+{
+	switch(type){
+		case CRC_8:
+			return crc_init(crc, 8, 0x9b, 0, 0, 0);
+		case CRC_16:
+			return crc_init(crc, 16, 0x1021, 0, 0, 0);
+		case CRC_24A:
+			return crc_init(crc, 24, 0x864cfb, 0, 0, 0);
+		case CRC_24B:
+			return crc_init(crc, 24, 0x800063, 0, 0, 0);
+		case CRC_32:
+			return crc_init(crc, 32, 0x04c11db7, 0xffffffffu, 0xffffffffu, 1);
+		default:
+			printf("[crc] unknown preset %d\n", type);
+			return -1;
+	}
+}
+
+/* function crc_get()
+
+	Description: preset tables generated once on first use
+
+	Return indicator:
+		!NULL				Cached CRC
+		NULL				Unknown preset
+
+	Caution:
+		first use of each preset is not thread safe; touch it before
+		spawning worker threads
+ */
+
+static crc_str *crcCache[NUM_CRC_TYPE];
+
+const crc_str *crc_get(int type)
+{
+	crc_str *crc;
+
+	if(type <= CRC_NONE || type >= NUM_CRC_TYPE)
+		return NULL;
+	if(crcCache[type] != NULL)
+		return crcCache[type];
+
+	if((crc = (crc_str *)malloc(sizeof(crc_str))) == NULL){
+		printf("[crc] fail to mem alloc\n");
+		return NULL;
+	}
+	if(crc_initPreset(crc, type) < 0){
+		free(crc);
+		return NULL;
+	}
+
+	return crcCache[type] = crc;
+}
+
+/* register before the first byte */
+static inline unsigned int crc_begin(const crc_str *crc)
+{
+	return crc->reflect ? crc->init : crc->init << (32 - crc->width);
+}
+
+/* CRC value of the register */
+static inline unsigned int crc_end(const crc_str *crc, unsigned int reg)
+{
+	return (crc->reflect ? reg : reg >> (32 - crc->width)) ^ crc->xorOut;
+}
+
+/* function crc_updateBytes()
+
+	Description: advance the register reg over len packed bytes
+
+	Return indicator:
+		updated register
+ */
+
+unsigned int crc_updateBytes(const crc_str *crc, unsigned int reg,
+		const unsigned char *buf, long len)
+{
+	const unsigned int (*t)[256] = crc->tab;
+	unsigned int x;
+
+	if(crc->reflect){
+		for(; len >= 8; len -= 8, buf += 8){
+			x = reg ^ ((unsigned int)buf[0] | (unsigned int)buf[1] << 8
+					| (unsigned int)buf[2] << 16 | (unsigned int)buf[3] << 24);
+			reg = t[7][x & 0xff] ^ t[6][(x >> 8) & 0xff]
+				^ t[5][(x >> 16) & 0xff] ^ t[4][x >> 24]
+				^ t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]];
+		}
+		for(; len > 0; len--)
+			reg = (reg >> 8) ^ t[0][(reg ^ *buf++) & 0xff];
+	} else {
+		for(; len >= 8; len -= 8, buf += 8){
+			x = reg ^ ((unsigned int)buf[0] << 24 | (unsigned int)buf[1] << 16
+					| (unsigned int)buf[2] << 8 | (unsigned int)buf[3]);
+			reg = t[7][x >> 24] ^ t[6][(x >> 16) & 0xff]
+				^ t[5][(x >> 8) & 0xff] ^ t[4][x & 0xff]
+				^ t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]];
+		}
+		for(; len > 0; len--)
+			reg = (reg << 8) ^ t[0][(reg >> 24) ^ *buf++];
+	}
+
+	return reg;
+}
+
+/* pack 8*n bits, one per int, into n bytes; first bit in the MSB, or in
+   the LSB when lsbFirst */
+static inline void crc_pack(unsigned char *buf, const int bit[], long n,
+		int lsbFirst)
+{
+	unsigned long long w[4], x;
+	long i = 0;
+#ifdef __AVX512F__
+	const __m512i rev = _mm512_set_epi32(8, 9, 10, 11, 12, 13, 14, 15,
+			0, 1, 2, 3, 4, 5, 6, 7);
+	__m512i v;
+	__mmask16 m;
+
+	/* 16 bits to a mask, lanes reversed per byte for MSB first */
+	for(; i + 2 <= n; i += 2){
+		v = _mm512_loadu_si512((const void *)(bit + 8*i));
+		if(!lsbFirst)
+			v = _mm512_permutexvar_epi32(rev, v);
+		m = _mm512_test_epi32_mask(v, v);
+		memcpy(buf + i, &m, 2);
+	}
+#endif
+
+	/* 0/1 ints read as words hold a bit at 0 and 32; interleave, then fold */
+	for(; i < n; i++){
+		memcpy(w, bit + 8*i, 32);
+		if(lsbFirst){
+			x = w[0] | w[1] << 2 | w[2] << 4 | w[3] << 6;
+			buf[i] = (unsigned char)(x | x >> 31);
+		} else {
+			x = w[0] << 7 | w[1] << 5 | w[2] << 3 | w[3] << 1;
+			buf[i] = (unsigned char)(x | x >> 33);
+		}
+	}
+}
+
+/* function crc_updateBits()
+
+	Description: advance the register reg over len bits, one bit per int
+
+	Return indicator:
+		updated register
+ */
+
+unsigned int crc_updateBits(const crc_str *crc, unsigned int reg,
+		const int bit[], long len)
+{
+	unsigned char buf[CRC_PACK_BYTES];
+	unsigned int p;
+	long n;
+	int b;
+
+	while(len >= 8){
+		n = (len >> 3 < CRC_PACK_BYTES) ? len >> 3 : CRC_PACK_BYTES;
+		crc_pack(buf, bit, n, crc->reflect);
+		reg = crc_updateBytes(crc, reg, buf, n);
+		bit += 8*n;
+		len -= 8*n;
+	}
+
+	/* tail of less than a byte */
+	if(crc->reflect){
+		p = crc_reflect(crc->poly, crc->width);
+		for(b = 0; b < len; b++){
+			reg ^= (unsigned int)bit[b];
+			reg = (reg & 1) ? (reg >> 1) ^ p : reg >> 1;
+		}
+	} else {
+		p = crc->poly << (32 - crc->width);
+		for(b = 0; b < len; b++){
+			reg ^= (unsigned int)bit[b] << 31;
+			reg = (reg & 0x80000000u) ? (reg << 1) ^ p : reg << 1;
+		}
+	}
+
+	return reg;
+}
+
+/* CRC of len packed bytes */
+unsigned int crc_calcBytes(const crc_str *crc, const unsigned char *buf, long len)
+{
+	return crc_end(crc, crc_updateBytes(crc, crc_begin(crc), buf, len));
+}
+
+/* CRC of len bits, one bit per int */
+unsigned int crc_calcBits(const crc_str *crc, const int bit[], long len)
+{
+	return crc_end(crc, crc_updateBits(crc, crc_begin(crc), bit, len));
+}
+
+/* bit k of the transmitted CRC; highest power first, which is the MSB of
+   an MSB first CRC and the LSB of a reflected one */
+static inline int crc_bit(const crc_str *crc, unsigned int val, int k)
+{
+	return (int)((crc->reflect ? val >> k : val >> (crc->width - 1 - k)) & 1);
+}
+
+/* function crc_attach()
+
+	Description: append the CRC of the first lenIn bits of bit[] to them
+
+	Output parameters:
+		bit[lenIn .. lenIn+width-1]	CRC bits
+
+	Return indicator:
+		lenIn + width
+ */
+
+int crc_attach(int bit[], int lenIn, const crc_str *crc)
+{
+	unsigned int val = crc_calcBits(crc, bit, lenIn);
+	int k;
+
+	for(k = 0; k < crc->width; k++)
+		bit[lenIn + k] = crc_bit(crc, val, k);
+
+	return lenIn + crc->width;
+}
+
+/* function crc_check()
+
+	Description: check len bits whose last width bits are the CRC of the
+	             bits before them
+
+	Return indicator:
+		0					CRC passes
+		1					CRC fails
+ */
+
+int crc_check(const int bit[], int len, const crc_str *crc)
+{
+	unsigned int val;
+	int k, lenIn = len - crc->width, fail = 0;
+
+	if(lenIn < 0)
+		return 1;
+
+	val = crc_calcBits(crc, bit, lenIn);
+	for(k = 0; k < crc->width; k++)
+		fail |= bit[lenIn + k] ^ crc_bit(crc, val, k);
+
+	return fail;
+}
+
+#endif /* __CRC_H__ */
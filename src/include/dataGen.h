@@ -2,7 +2,7 @@
  *
  * Description: Random source data generation
  * Copyright (C) 2011-2014, Jonghun John Park
- * Last updated on Dec. 16, 2014
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -24,48 +24,82 @@
 #define __DATAGEN_H__
 
 #include <math.h>
-#include <time.h>
+#include "rng.h"
+#include "bitGroup.h"
 
-int genBitSource(int *Out, int lenSrc){
+/* stream of genBitSource(), seed 1 until genBitSourceSeed() */
+static rng_str genBitRng;
+static int genBitSeeded;
+
+void genBitSourceSeed(unsigned long long seed)
+{
+	rng_init(&genBitRng, seed, 0);
+	genBitSeeded = 1;
+}
 
-	int index;
-	srand((unsigned)time(NULL));	//randomize
-	for (index = 0; index < lenSrc; index++)
-		Out[index] = rand()%2;
+/* Bit source drawn from a counter-based stream, 64 bits per draw, so a
+   frame is reproducible from (seed, stream id) alone */
+int genBitSourceRng(int *Out, int lenSrc, rng_str *rng){
+
+	unsigned long long word;
+	unsigned int lo, hi;
+	int index, b;
+
+	/* 32-bit halves, so the unpacking runs in 32-bit vector lanes */
+	for (index = 0; index + 64 <= lenSrc; index += 64){
+		word = rng_u64(rng);
+		lo = (unsigned int)word;
+		hi = (unsigned int)(word >> 32);
+		for (b = 0; b < 32; b++){
+			Out[index + b] = (int)((lo >> b) & 1);
+			Out[index + 32 + b] = (int)((hi >> b) & 1);
+		}
+	}
+	if (index < lenSrc){
+		word = rng_u64(rng);
+		for (; index < lenSrc; index++, word >>= 1)
+			Out[index] = (int)(word & 1);
+	}
 
 	return 0;
 }
 
+/* Bit source continuing one process wide stream from call to call, so
+   successive frames differ and a run repeats with the same seed */
+int genBitSource(int *Out, int lenSrc){
+
+	if (!genBitSeeded)
+		genBitSourceSeed(1);
+
+	return genBitSourceRng(Out, lenSrc, &genBitRng);
+}
+
 /* Tranfrom binary array into decimal array with M bits groupping
    Func. Name : biA2decA
    Parameters : decOut -> a pointer to int array for output
                 bitIn -> a pointer to int array directing to input bit stream
                 lenIn -> length of bitIn array
-                M -> number of bits per decimal
+                M -> number of bits per decimal, 1 .. BITGROUP_MAX_M
 
    Return: 0 -> Success
            1 -> Dummy with last decimal
 
-   Caution : I suggest that lenIn should be a multiple of M, but there's
-             a dummy at the end of decOut array. Caller can ignore it.
+   Caution : I suggest that lenIn should be a multiple of M. Otherwise the
+             last decimal holds the lenIn%M leftover bits, MSB first and
+             padded with zeros, so decOut needs (lenIn + M - 1)/M entries.
 */
 
 int biA2decA(int *decOut, int *bitIn, int lenIn, int M)
 {
-	int *input = bitIn;
-	int *output = decOut;
-	int i, cnt = 0, cursor;
-
-	for(i = 0; i<lenIn; i=i+M){
-		cursor = M;
-		while(--cursor >= 0)
-			output[cnt] += (1<<cursor)*input[i+M-1-cursor];
-		cnt++;
-	}
+	int num = lenIn / M, rem = lenIn % M, b, lab;
+
+	bitGroup_fromBits(decOut, bitIn, num, M);
 
 	/* Return with Last Dec Error Indication*/
-	if(lenIn%M != 0){
-		output[cnt-1] = 0;
+	if(rem != 0){
+		for(lab = 0, b = 0; b < M; b++)
+			lab = (lab << 1) | ((b < rem) ? bitIn[num*M + b] : 0);
+		decOut[num] = lab;
 		return 1;
 	}
 
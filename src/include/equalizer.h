@@ -0,0 +1,549 @@
+/* File: equalizer.h
+ *
+ * Description: Adaptive LMS/NLMS/CMA/RLS equalizers and a frequency domain
+ *              ZF/MMSE equalizer
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The adaptive equalizer is a transversal filter of numTap taps h on sps
+ * (1 or 2) samples per symbol, one output per symbol, y = h^H u with u
+ * the numTap newest samples, oldest first. The taps start as a unit
+ * centre tap, so output k is symbol k - delay of the stream. The error
+ * is e = d - y against a training symbol while the training sequence
+ * lasts and against the hard decision of the constellation after it
+ * (decision directed); CMA is blind, e = y (R2 - |y|^2).
+ *
+ * Taps and samples are kept as split I/Q arrays. The tap update of one
+ * symbol is fused into the filter pass of the next, which sums in
+ * EQ_LANES partial sums; RLS keeps its inverse correlation matrix as
+ * split, cache line aligned rows updated by axpys.
+ *
+ * The frequency domain equalizer turns a known channel impulse response
+ * into the ZF or MMSE equalizer on an nFft grid, keeps lenG taps of its
+ * impulse response around the equalizer delay and applies them by
+ * overlap-save fast convolution through the batched FFT of fft.h.
+ */
+
+#ifndef __EQUALIZER_H__
+#define __EQUALIZER_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "constel.h"
+#include "fft.h"
+
+/* Defines */
+#define EQ_LANES			8		/* partial sums of the filter kernel */
+#define EQ_NLMS_EPS			1e-9	/* NLMS regulariser of the input power */
+#define EQ_RLS_LAMBDA		0.999	/* RLS forgetting factor */
+#define EQ_RLS_DELTA		1e-2	/* RLS initial P = I / delta */
+#define EQ_ALIGN			64		/* RLS rows, one cache line */
+#define EQ_RLS_SYM			32		/* RLS updates between Hermitian rebuilds of P */
+
+enum{
+	EQ_LMS = 0,
+	EQ_NLMS,
+	EQ_CMA,
+	EQ_RLS,
+	NUM_EQ_ALG
+};
+
+enum{
+	FDE_ZF = 0,
+	FDE_MMSE
+};
+
+typedef struct{
+	int alg;					// EQ_*
+	int numTap;
+	int sps;					// input samples per symbol, 1 or 2
+	int delay;					// symbols from input to output
+	double mu;					// step size (LMS, NLMS, CMA)
+	double lambda;				// forgetting factor (RLS)
+	double R2;					// CMA modulus
+	const constel_str *cons;	// decisions, NULL keeps the taps after training
+	double *hRe, *hIm;			// taps, oldest sample first
+	int ldP;					// RLS row stride, numTap rounded up to EQ_LANES
+	double *pRe, *pIm;			// RLS inverse correlation, zero past numTap
+	double *qRe, *qIm;			// RLS P u, in the block of pRe
+	int maxIn;
+	double *uRe, *uIm;			// unused samples of the last call, then the input
+	/* state */
+	int lenHist;				// samples kept from the last call
+	const complex *train;		// training symbols of stream symbols 0, 1, ..
+	long lenTrain;
+	long numSym;				// outputs so far
+	long numRls;				// RLS updates so far
+	double err;					// |e|^2 of the last update
+} eq_str;
+
+typedef struct{
+	const fftPlan_str *plan;
+	int nFft;
+	int lenG;					// equalizer taps, nFft - lenG + 1 outputs per block
+	int delay;					// samples from input to output
+	complex *G;					// spectrum of the lenG taps
+	int maxIn;
+	complex *work;				// lenG-1 history samples followed by the input
+	complex *blk;				// FFT blocks of one call
+} fde_str;
+
+/* Functions */
+
+/***********************************
+ * Adaptive equalizer              *
+ ***********************************/
+
+void eq_free(eq_str *eq)
+{
+	free(eq->hRe);
+	free(eq->hIm);
+	free(eq->pRe);
+	free(eq->uRe);
+	free(eq->uIm);
+	memset(eq, 0, sizeof(eq_str));
+}
+
+/* function eq_init()
+
+	Description: adaptive equalizer of numTap taps on sps samples per
+	             symbol; mu is the LMS/NLMS/CMA step size (RLS uses
+	             EQ_RLS_LAMBDA), cons gives the decisions after training
+	             and the CMA modulus; calls take up to maxIn samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+		-2					Memory allocation error
+ */
+
+int eq_init(eq_str *eq, int alg, int numTap, int sps, double mu,
+		const constel_str *cons, int maxIn)
+{
+	double m2 = 0., m4 = 0., p;
+	size_t len;
+	int k, c, ok;
+
+	memset(eq, 0, sizeof(eq_str));
+	if(alg < 0 || alg >= NUM_EQ_ALG || numTap < 1 || (sps != 1 && sps != 2)
+			|| maxIn < 1){
+		printf("[eq] unsupported equalizer(alg %d, numTap %d, sps %d)\n", alg, numTap, sps);
+		return -1;
+	}
+
+	eq->alg = alg;
+	eq->numTap = numTap;
+	eq->sps = sps;
+	eq->delay = (numTap - 1) / (2*sps);
+	eq->mu = mu;
+	eq->lambda = EQ_RLS_LAMBDA;
+	eq->cons = cons;
+	eq->maxIn = maxIn;
+
+	/* CMA modulus E|s|^4 / E|s|^2 */
+	eq->R2 = 1.;
+	if(cons != NULL){
+		for(k = 0; k < cons->order; k++){
+			p = cons->point[k].re*cons->point[k].re + cons->point[k].im*cons->point[k].im;
+			m2 += p;
+			m4 += p*p;
+		}
+		eq->R2 = m4 / m2;
+	}
+
+	eq->hRe = (double *)calloc(numTap, sizeof(double));
+	eq->hIm = (double *)calloc(numTap, sizeof(double));
+	eq->uRe = (double *)calloc(numTap + sps + maxIn + EQ_LANES, sizeof(double));
+	eq->uIm = (double *)calloc(numTap + sps + maxIn + EQ_LANES, sizeof(double));
+	ok = eq->hRe != NULL && eq->hIm != NULL && eq->uRe != NULL && eq->uIm != NULL;
+	if(ok && alg == EQ_RLS){
+		eq->ldP = (numTap + EQ_LANES-1) / EQ_LANES * EQ_LANES;
+		/* one block, rows on EQ_ALIGN boundaries */
+		len = (size_t)(2*numTap + 2) * eq->ldP;
+		ok = posix_memalign((void **)&eq->pRe, EQ_ALIGN, sizeof(double)*len) == 0;
+		if(ok){
+			memset(eq->pRe, 0, sizeof(double)*len);
+			eq->pIm = eq->pRe + (size_t)numTap*eq->ldP;
+			eq->qRe = eq->pIm + (size_t)numTap*eq->ldP;
+			eq->qIm = eq->qRe + eq->ldP;
+		}
+	}
+	if(!ok){
+		printf("[eq] fail to mem alloc\n");
+		eq_free(eq);
+		return -2;
+	}
+
+	/* unit tap at the sample of symbol k - delay */
+	c = numTap - 1 - eq->delay*sps;
+	eq->hRe[c] = 1.;
+	if(alg == EQ_RLS)
+		for(k = 0; k < numTap; k++)
+			eq->pRe[(size_t)k*eq->ldP + k] = 1. / EQ_RLS_DELTA;
+	eq->lenHist = numTap - 1;
+
+	return 0;
+}
+
+/* train on symbols train[0 .. lenTrain-1] of the stream from symbol 0 on */
+void eq_setTrain(eq_str *eq, const complex *train, long lenTrain)
+{
+	eq->train = train;
+	eq->lenTrain = lenTrain;
+}
+
+/* h += g conj(e) v, then y = h^H u and |u|^2, over n taps in EQ_LANES
+   lanes: the update of the last symbol rides on the filter pass of the
+   next, so the taps are not stored and reloaded in between */
+static inline void eq_filter(double *yRe, double *yIm, double *pow,
+		double * restrict hRe, double * restrict hIm,
+		const double *uRe, const double *uIm,
+		const double *vRe, const double *vIm, double gRe, double gIm, int n)
+{
+	double sRe[EQ_LANES] = {0.}, sIm[EQ_LANES] = {0.}, sP[EQ_LANES] = {0.};
+	double tRe = 0., tIm = 0., tP = 0., hr, hi;
+	int k, j;
+
+	for(k = 0; k + EQ_LANES <= n; k += EQ_LANES)
+		for(j = 0; j < EQ_LANES; j++){
+			hr = hRe[k+j] + gRe*vRe[k+j] + gIm*vIm[k+j];
+			hi = hIm[k+j] + gRe*vIm[k+j] - gIm*vRe[k+j];
+			hRe[k+j] = hr;
+			hIm[k+j] = hi;
+			sRe[j] += hr*uRe[k+j] + hi*uIm[k+j];
+			sIm[j] += hr*uIm[k+j] - hi*uRe[k+j];
+			sP[j] += uRe[k+j]*uRe[k+j] + uIm[k+j]*uIm[k+j];
+		}
+	for(; k < n; k++){
+		hr = hRe[k] + gRe*vRe[k] + gIm*vIm[k];
+		hi = hIm[k] + gRe*vIm[k] - gIm*vRe[k];
+		hRe[k] = hr;
+		hIm[k] = hi;
+		tRe += hr*uRe[k] + hi*uIm[k];
+		tIm += hr*uIm[k] - hi*uRe[k];
+		tP += uRe[k]*uRe[k] + uIm[k]*uIm[k];
+	}
+	for(j = 0; j < EQ_LANES; j++){
+		tRe += sRe[j];
+		tIm += sIm[j];
+		tP += sP[j];
+	}
+
+	*yRe = tRe;
+	*yIm = tIm;
+	*pow = tP;
+}
+
+/* RLS: q = P u, k = q / (lambda + u^H q), h += k conj(e),
+   P = (P - k q^H) / lambda. Rows of P and q are zero from numTap to
+   ldP, so the row loops have no remainder; the u window may read up to
+   ldP - numTap samples past the input, multiplied by zero. With P
+   Hermitian, q is summed from the rows of P conjugated and scaled by
+   u[c]: axpys rather than short dot products. Roundoff that leaves P
+   non-Hermitian grows by 1/lambda per symbol, so the upper triangle is
+   rebuilt from the lower one every EQ_RLS_SYM updates. */
+static void eq_rlsUpdate(eq_str *eq, const double *uRe, const double *uIm,
+		double eRe, double eIm)
+{
+	const int N = eq->numTap, L = eq->ldP;
+	const double il = 1. / eq->lambda;
+	double * restrict qRe = eq->qRe, * restrict qIm = eq->qIm;
+	double * restrict pr, * restrict pi;
+	double den, kr, ki, a, b;
+	int r, c;
+
+	memset(qRe, 0, sizeof(double)*L);
+	memset(qIm, 0, sizeof(double)*L);
+	for(c = 0; c < N; c++){
+		pr = eq->pRe + (size_t)c*L;
+		pi = eq->pIm + (size_t)c*L;
+		a = uRe[c];
+		b = uIm[c];
+		for(r = 0; r < L; r++){
+			qRe[r] += pr[r]*a + pi[r]*b;
+			qIm[r] += pr[r]*b - pi[r]*a;
+		}
+	}
+	den = eq->lambda;
+	for(r = 0; r < N; r++)
+		den += uRe[r]*qRe[r] + uIm[r]*qIm[r];
+	den = 1. / den;
+
+	/* h += k conj(e) */
+	kr = eRe * den;
+	ki = eIm * den;
+	for(r = 0; r < N; r++){
+		eq->hRe[r] += qRe[r]*kr + qIm[r]*ki;
+		eq->hIm[r] += qIm[r]*kr - qRe[r]*ki;
+	}
+
+	/* row r of P - k q^H, k[r] conj(q[c]) */
+	for(r = 0; r < N; r++){
+		kr = qRe[r] * den;
+		ki = qIm[r] * den;
+		pr = eq->pRe + (size_t)r*L;
+		pi = eq->pIm + (size_t)r*L;
+		for(c = 0; c < L; c++){
+			a = pr[c] - (kr*qRe[c] + ki*qIm[c]);
+			b = pi[c] - (ki*qRe[c] - kr*qIm[c]);
+			pr[c] = a * il;
+			pi[c] = b * il;
+		}
+	}
+
+	if(++eq->numRls % EQ_RLS_SYM)
+		return;
+	for(r = 0; r < N; r++){
+		eq->pIm[(size_t)r*L + r] = 0.;
+		for(c = r+1; c < N; c++){
+			eq->pRe[(size_t)r*L + c] = eq->pRe[(size_t)c*L + r];
+			eq->pIm[(size_t)r*L + c] = -eq->pIm[(size_t)c*L + r];
+		}
+	}
+}
+
+/* function eq_run()
+
+	Description: equalise the next lenX (<= maxIn) samples and adapt; the
+	             state carries over, so a stream cut into calls gives the
+	             output of one call
+
+	Output parameters:
+		y[]					one symbol per sps samples, up to lenX/sps + 1
+		*lenY				number of output symbols
+
+	Return indicator:
+		0					Success
+		-1					Too many input samples
+ */
+
+int eq_run(complex y[], int *lenY, const complex x[], int lenX, eq_str *eq)
+{
+	const int N = eq->numTap;
+	double * restrict hRe = eq->hRe, * restrict hIm = eq->hIm;
+	const double *uRe, *uIm, *vRe, *vIm;
+	double yRe, yIm, pow, eRe, eIm, gRe = 0., gIm = 0., g, r;
+	complex d;
+	long s;
+	int i, k, n = 0, pos, len;
+
+	*lenY = 0;
+	if(lenX > eq->maxIn){
+		printf("[eq] %d input samples exceed %d\n", lenX, eq->maxIn);
+		return -1;
+	}
+
+	for(i = 0; i < lenX; i++){
+		eq->uRe[eq->lenHist + i] = x[i].re;
+		eq->uIm[eq->lenHist + i] = x[i].im;
+	}
+	len = eq->lenHist + lenX;
+
+	/* gRe, gIm: update g conj(e) of the last symbol on window v, pending */
+	vRe = eq->uRe;
+	vIm = eq->uIm;
+	for(pos = 0; pos + N <= len; pos += eq->sps, n++){
+		uRe = eq->uRe + pos;
+		uIm = eq->uIm + pos;
+		eq_filter(&yRe, &yIm, &pow, hRe, hIm, uRe, uIm, vRe, vIm, gRe, gIm, N);
+		y[n].re = yRe;
+		y[n].im = yIm;
+		gRe = gIm = 0.;
+
+		/* desired symbol: training, decision or none */
+		s = eq->numSym++ - eq->delay;
+		if(s < 0)
+			continue;
+		if(eq->alg == EQ_CMA){
+			r = eq->R2 - (yRe*yRe + yIm*yIm);
+			eRe = yRe * r;
+			eIm = yIm * r;
+		} else {
+			if(s < eq->lenTrain)
+				d = eq->train[s];
+			else if(eq->cons != NULL)
+				d = eq->cons->point[constel_hdLabel(eq->cons, y[n])];
+			else
+				continue;
+			eRe = d.re - yRe;
+			eIm = d.im - yIm;
+		}
+		eq->err = eRe*eRe + eIm*eIm;
+
+		if(eq->alg == EQ_RLS){
+			eq_rlsUpdate(eq, uRe, uIm, eRe, eIm);
+			continue;
+		}
+
+		/* h += g conj(e) u, applied by the next filter pass */
+		g = (eq->alg == EQ_NLMS) ? eq->mu / (EQ_NLMS_EPS + pow) : eq->mu;
+		gRe = g * eRe;
+		gIm = g * eIm;
+		vRe = uRe;
+		vIm = uIm;
+	}
+	for(k = 0; k < N; k++){
+		hRe[k] += gRe*vRe[k] + gIm*vIm[k];
+		hIm[k] += gRe*vIm[k] - gIm*vRe[k];
+	}
+
+	/* keep the samples not yet consumed */
+	eq->lenHist = len - pos;
+	memmove(eq->uRe, eq->uRe + pos, sizeof(double)*eq->lenHist);
+	memmove(eq->uIm, eq->uIm + pos, sizeof(double)*eq->lenHist);
+	*lenY = n;
+
+	return 0;
+}
+
+/***********************************
+ * Frequency domain equalizer      *
+ ***********************************/
+
+void fde_free(fde_str *fde)
+{
+	free(fde->G);
+	free(fde->work);
+	free(fde->blk);
+	memset(fde, 0, sizeof(fde_str));
+}
+
+/* function fde_init()
+
+	Description: ZF (var ignored) or MMSE (noise to signal ratio var)
+	             equalizer of the channel h[0 .. lenH-1], truncated to lenG
+	             taps around a delay of lenG/2 samples and applied by
+	             overlap-save with nFft point FFTs; calls take up to maxIn
+	             samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported sizes
+		-2					Memory allocation error
+ */
+
+int fde_init(fde_str *fde, const complex h[], int lenH, double var, int mode,
+		int nFft, int lenG, int maxIn)
+{
+	complex *W;
+	double p, den;
+	int k, hop;
+
+	memset(fde, 0, sizeof(fde_str));
+	if((fde->plan = fft_getPlan(nFft)) == NULL)
+		return -1;
+	if(lenH < 1 || lenH > nFft || lenG < 1 || lenG >= nFft || maxIn < 1
+			|| (mode != FDE_ZF && mode != FDE_MMSE)){
+		printf("[fde] unsupported sizes(lenH %d, nFft %d, lenG %d)\n", lenH, nFft, lenG);
+		return -1;
+	}
+
+	hop = nFft - lenG + 1;
+	fde->nFft = nFft;
+	fde->lenG = lenG;
+	fde->delay = lenG / 2;
+	fde->maxIn = maxIn;
+	fde->G = (complex *)calloc(nFft, sizeof(complex));
+	fde->work = (complex *)calloc(lenG - 1 + maxIn + nFft, sizeof(complex));
+	fde->blk = (complex *)malloc(sizeof(complex) * nFft * ((maxIn + hop - 1) / hop));
+	if(fde->G == NULL || fde->work == NULL || fde->blk == NULL){
+		printf("[fde] fail to mem alloc\n");
+		fde_free(fde);
+		return -2;
+	}
+
+	/* W = conj(H) / (|H|^2 + var) on the grid, in the scratch blocks */
+	W = fde->blk;
+	memset(W, 0, sizeof(complex)*nFft);
+	memcpy(W, h, sizeof(complex)*lenH);
+	fft_exec(fde->plan, W, W, FFT_FORWARD);
+	for(k = 0; k < nFft; k++){
+		p = W[k].re*W[k].re + W[k].im*W[k].im;
+		den = p + ((mode == FDE_MMSE) ? var : 0.);
+		den = (den > 0.) ? 1. / den : 0.;
+		W[k].re *= den;
+		W[k].im *= -den;
+	}
+
+	/* impulse response, lenG taps from -delay on, and their spectrum */
+	fft_exec(fde->plan, W, W, FFT_INVERSE);
+	for(k = 0; k < lenG; k++)
+		fde->G[k] = W[(k - fde->delay + nFft) % nFft];
+	fft_exec(fde->plan, fde->G, fde->G, FFT_FORWARD);
+
+	return 0;
+}
+
+/* function fde_run()
+
+	Description: equalise the next lenX (<= maxIn) samples; output n of the
+	             stream is input sample n - delay. The blocks of a call go
+	             through two batched FFT calls.
+
+	Output parameters:
+		y[]					lenX samples
+
+	Return indicator:
+		0					Success
+		-1					Too many input samples or FFT failure
+ */
+
+int fde_run(complex y[], const complex x[], int lenX, fde_str *fde)
+{
+	const int N = fde->nFft, H = fde->lenG - 1, hop = N - H;
+	const complex *G = fde->G;
+	complex *b;
+	double re;
+	int numBlk, i, k;
+
+	if(lenX > fde->maxIn){
+		printf("[fde] %d input samples exceed %d\n", lenX, fde->maxIn);
+		return -1;
+	}
+
+	/* block i covers work[i hop .. i hop + N-1], zero past the input */
+	memcpy(fde->work + H, x, sizeof(complex)*lenX);
+	numBlk = (lenX + hop - 1) / hop;
+	memset(fde->work + H + lenX, 0, sizeof(complex)*((long)numBlk*hop + H - lenX));
+	if(fft_batch(fde->plan, fde->blk, N, fde->work, hop, numBlk, FFT_FORWARD, 1) < 0)
+		return -1;
+	for(i = 0; i < numBlk; i++){
+		b = fde->blk + (long)i*N;
+		for(k = 0; k < N; k++){
+			re = b[k].re;
+			b[k].re = re*G[k].re - b[k].im*G[k].im;
+			b[k].im = re*G[k].im + b[k].im*G[k].re;
+		}
+	}
+	if(fft_batch(fde->plan, fde->blk, N, fde->blk, N, numBlk, FFT_INVERSE, 1) < 0)
+		return -1;
+
+	/* the last hop outputs of each block are the linear convolution */
+	for(i = 0; i < numBlk; i++)
+		memcpy(y + (long)i*hop, fde->blk + (long)i*N + H,
+				sizeof(complex)*((lenX - i*hop < hop) ? lenX - i*hop : hop));
+	memmove(fde->work, fde->work + lenX, sizeof(complex)*H);
+
+	return 0;
+}
+
+#endif /* __EQUALIZER_H__ */
@@ -0,0 +1,384 @@
+/* File: fading.h
+ *
+ * Description: Rayleigh/Rician fading and tapped delay line channels
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Every tap fades with a sum of FADE_NUM_SIN sinusoids (equally spaced
+ * angles of arrival with a random offset and random phases, i.e. a Jakes
+ * spectrum). The sum is evaluated by phasor rotation on a coarse grid of
+ * FADE_GRID_PER_CYCLE points per period of the maximum Doppler frequency
+ * and linearly interpolated to the sample rate; the per-sample cost is then one interpolation and one
+ * complex multiply-accumulate per tap, independent of FADE_NUM_SIN. The
+ * taps vary in time, so the tap convolution is the blocked axpy kernel
+ * of compBuf_fir with a gain vector per tap in place of a constant.
+ */
+
+#ifndef __FADING_H__
+#define __FADING_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "compBuf.h"
+#include "rng.h"
+
+/* Defines */
+#define FADE_NUM_SIN		16		/* sinusoids per tap */
+#define FADE_MAX_TAPS		32
+#define FADE_GRID_PER_CYCLE	64		/* grid points per Doppler period */
+#define FADE_MAX_INTERP		4096	/* samples per grid step at most */
+#define FADE_RENORM			1024	/* grid steps between exact phasors */
+#define FADE_LOS_COS		0.7071067811865476	/* LOS arrives at 45 deg */
+
+/* Power delay profiles */
+enum{
+	FADE_FLAT = 0,
+	FADE_EPA,					// 3GPP TS 36.104 Extended Pedestrian A
+	FADE_EVA,					// Extended Vehicular A
+	FADE_ETU,					// Extended Typical Urban
+	FADE_TDLA,					// 3GPP TR 38.901 TDL-A, delays scaled by the delay spread
+	NUM_FADE_PROFILE,
+};
+
+typedef struct{
+	const char *name;
+	int numTap;
+	double delay[FADE_MAX_TAPS];	// ns, TDL-A: normalised to the delay spread
+	double pow[FADE_MAX_TAPS];		// dB
+} fadeProfile_str;
+
+/* One fading tap */
+typedef struct{
+	double w[FADE_NUM_SIN];		// phase step of each sinusoid per grid step
+	double ph[FADE_NUM_SIN];	// initial phase
+	double sr[FADE_NUM_SIN];	// phasors at grid index k
+	double si[FADE_NUM_SIN];
+	double cr[FADE_NUM_SIN];	// rotation per grid step
+	double ci[FADE_NUM_SIN];
+	double scale;				// sqrt(diffuse power / FADE_NUM_SIN)
+	double losAmp, losW, losPh;	// Rician line of sight
+	long k;						// grid index of the phasors
+	complex g0, g1;				// gains at the ends of the current grid step
+} fadeTap_str;
+
+typedef struct{
+	int numTap;
+	int delay[FADE_MAX_TAPS];	// samples
+	fadeTap_str tap[FADE_MAX_TAPS];
+	int interp;					// samples per grid step
+	int pos;					// sample position in the current grid step
+	int maxDelay;
+	compBuf_str work;			// maxDelay history samples + one block
+	double *gr, *gi;			// gain of one tap over one block
+} fade_str;
+
+/* Variables */
+static const fadeProfile_str fadeProfile[NUM_FADE_PROFILE] = {
+	{"flat", 1, {0.}, {0.}},
+	{"EPA", 7,
+		{0., 30., 70., 90., 110., 190., 410.},
+		{0., -1., -2., -3., -8., -17.2, -20.8}},
+	{"EVA", 9,
+		{0., 30., 150., 310., 370., 710., 1090., 1730., 2510.},
+		{0., -1.5, -1.4, -3.6, -0.6, -9.1, -7., -12., -16.9}},
+	{"ETU", 9,
+		{0., 50., 120., 200., 230., 500., 1600., 2300., 5000.},
+		{-1., -1., -1., 0., 0., 0., -3., -5., -7.}},
+	{"TDL-A", 23,
+		{0., 0.3819, 0.4025, 0.5868, 0.4610, 0.5375, 0.6708, 0.5750,
+		 0.7618, 1.5375, 1.8978, 2.2242, 2.1718, 2.4942, 2.5119, 3.0582,
+		 4.0810, 4.4579, 4.5695, 4.7966, 5.0066, 5.3043, 9.6586},
+		{-13.4, 0., -2.2, -4., -6., -8.2, -9.9, -10.5, -7.5, -15.9, -6.6,
+		 -16.7, -12.4, -15.2, -10.8, -11.3, -12.7, -16.2, -18.3, -18.9,
+		 -16.6, -19.9, -29.7}},
+};
+
+/* Functions */
+
+/* exact phasors at grid index k */
+static void fade_tapPhasor(fadeTap_str *tap, long k)
+{
+	int n;
+
+	for(n = 0; n < FADE_NUM_SIN; n++){
+		tap->sr[n] = cos(tap->w[n] * k + tap->ph[n]);
+		tap->si[n] = sin(tap->w[n] * k + tap->ph[n]);
+	}
+	tap->k = k;
+}
+
+/* gain at grid index tap->k, then advance one grid step */
+static complex fade_tapNext(fadeTap_str *tap)
+{
+	complex g = {0., 0.};
+	double r;
+	int n;
+
+	for(n = 0; n < FADE_NUM_SIN; n++){
+		g.re += tap->sr[n];
+		g.im += tap->si[n];
+	}
+	g.re = tap->scale * g.re + tap->losAmp * cos(tap->losW * tap->k + tap->losPh);
+	g.im = tap->scale * g.im + tap->losAmp * sin(tap->losW * tap->k + tap->losPh);
+
+	if((tap->k + 1) % FADE_RENORM == 0)
+		fade_tapPhasor(tap, tap->k + 1);
+	else {
+		for(n = 0; n < FADE_NUM_SIN; n++){
+			r = tap->sr[n] * tap->cr[n] - tap->si[n] * tap->ci[n];
+			tap->si[n] = tap->sr[n] * tap->ci[n] + tap->si[n] * tap->cr[n];
+			tap->sr[n] = r;
+		}
+		tap->k++;
+	}
+
+	return g;
+}
+
+/* function fade_initTdl()
+
+	Description: tapped delay line of numTap independently fading taps
+
+	input parameters:
+		delayNs[], powdB[]	tap delays (ns) and powers (dB); taps that fall
+							on the same sample are merged, the total power
+							is normalised to one
+		fs					sample rate (Hz)
+		fd					maximum Doppler frequency (Hz)
+		kFactor				Rician K of the first tap (linear), 0: Rayleigh
+		seed				rng.h seed of the angles and phases
+
+	Return indicator:
+		0					Success
+		-1					Invalid parameters or memory allocation error
+ */
+
+int fade_initTdl(fade_str *fade, int numTap, const double delayNs[],
+		const double powdB[], double fs, double fd, double kFactor,
+		unsigned long long seed)
+{
+	double tapPow[FADE_MAX_TAPS], total = 0., p, theta, stepDop;
+	fadeTap_str *tap;
+	rng_str rng;
+	int l, m, n, d;
+
+	memset(fade, 0, sizeof(fade_str));
+	if(numTap < 1 || numTap > FADE_MAX_TAPS || fs <= 0. || fd < 0.){
+		printf("[fade] invalid channel parameters\n");
+		return -1;
+	}
+
+	/* taps on the sample grid */
+	for(l = 0; l < numTap; l++){
+		d = (int)floor(delayNs[l] * 1e-9 * fs + 0.5);
+		p = pow(10., powdB[l] / 10.);
+		total += p;
+		for(m = 0; m < fade->numTap && fade->delay[m] != d; m++)
+			;
+		if(m == fade->numTap){
+			fade->delay[m] = d;
+			tapPow[m] = 0.;
+			fade->numTap++;
+		}
+		tapPow[m] += p;
+		if(d > fade->maxDelay)
+			fade->maxDelay = d;
+	}
+
+	/* grid of FADE_GRID_PER_CYCLE points per Doppler period */
+	fade->interp = (fd > 0.) ? (int)(fs / (fd * FADE_GRID_PER_CYCLE)) : FADE_MAX_INTERP;
+	if(fade->interp < 1)
+		fade->interp = 1;
+	if(fade->interp > FADE_MAX_INTERP)
+		fade->interp = FADE_MAX_INTERP;
+	stepDop = 2. * M_PI * fd * fade->interp / fs;
+
+	for(m = 0; m < fade->numTap; m++){
+		tap = &fade->tap[m];
+		rng_init(&rng, seed, m);
+		p = tapPow[m] / total;
+
+		if(m == 0 && kFactor > 0.){
+			tap->losAmp = sqrt(p * kFactor / (kFactor + 1.));
+			tap->losW = stepDop * FADE_LOS_COS;
+			tap->losPh = 2. * M_PI * rng_uniform(&rng);
+			p /= kFactor + 1.;
+		}
+		tap->scale = sqrt(p / FADE_NUM_SIN);
+
+		theta = 2. * M_PI * rng_uniform(&rng);
+		for(n = 0; n < FADE_NUM_SIN; n++){
+			tap->w[n] = stepDop * cos((2. * M_PI * n + theta) / FADE_NUM_SIN);
+			tap->ph[n] = 2. * M_PI * rng_uniform(&rng) - M_PI;
+			tap->cr[n] = cos(tap->w[n]);
+			tap->ci[n] = sin(tap->w[n]);
+		}
+
+		fade_tapPhasor(tap, 0);
+		tap->g0 = fade_tapNext(tap);
+		tap->g1 = fade_tapNext(tap);
+	}
+
+	if(compBuf_alloc(&fade->work, fade->maxDelay + COMPBUF_BLOCK) < 0)
+		return -1;
+	fade->gr = (double *)compBuf_alignedAlloc(sizeof(double)*COMPBUF_BLOCK);
+	fade->gi = (double *)compBuf_alignedAlloc(sizeof(double)*COMPBUF_BLOCK);
+	if(fade->gr == NULL || fade->gi == NULL){
+		printf("[fade] fail to mem alloc\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* function fade_init()
+
+	Description: channel of a fadeProfile[] entry; ds is the delay spread
+	             (ns) of TDL-A and ignored by the other profiles
+ */
+
+int fade_init(fade_str *fade, int profile, double fs, double fd, double ds,
+		double kFactor, unsigned long long seed)
+{
+	const fadeProfile_str *prf;
+	double delay[FADE_MAX_TAPS];
+	int l;
+
+	if(profile < 0 || profile >= NUM_FADE_PROFILE){
+		printf("[fade] unknown profile %d\n", profile);
+		return -1;
+	}
+
+	prf = &fadeProfile[profile];
+	for(l = 0; l < prf->numTap; l++)
+		delay[l] = (profile == FADE_TDLA) ? prf->delay[l] * ds : prf->delay[l];
+
+	return fade_initTdl(fade, prf->numTap, delay, prf->pow, fs, fd, kFactor, seed);
+}
+
+void fade_free(fade_str *fade)
+{
+	compBuf_free(&fade->work);
+	free(fade->gr);
+	free(fade->gi);
+	fade->gr = fade->gi = NULL;
+}
+
+/* gain of tap over len samples from grid position pos */
+static void fade_tapGain(fade_str *fade, fadeTap_str *tap, int len)
+{
+	double * restrict gr = fade->gr, * restrict gi = fade->gi;
+	double dr, di, r0, i0;
+	int pos = fade->pos, i = 0, cnt, j;
+
+	while(i < len){
+		cnt = (fade->interp - pos < len - i) ? fade->interp - pos : len - i;
+		dr = (tap->g1.re - tap->g0.re) / fade->interp;
+		di = (tap->g1.im - tap->g0.im) / fade->interp;
+		r0 = tap->g0.re + dr * pos;
+		i0 = tap->g0.im + di * pos;
+		for(j = 0; j < cnt; j++){
+			gr[i+j] = r0 + dr * j;
+			gi[i+j] = i0 + di * j;
+		}
+
+		i += cnt;
+		pos += cnt;
+		if(pos == fade->interp){
+			pos = 0;
+			tap->g0 = tap->g1;
+			tap->g1 = fade_tapNext(tap);
+		}
+	}
+}
+
+/* function fade_apply()
+
+	Description: y = faded x over len samples; the delay line and the
+	             fading processes continue across calls. y may equal x.
+
+	Return indicator:
+		0					Success
+		-1					Invalid length
+ */
+
+int fade_apply(fade_str *fade, compBuf_str *y, const compBuf_str *x, int len)
+{
+	int D = fade->maxDelay, n0, cnt, l, n, d, pos;
+	double * restrict wr = fade->work.re, * restrict wi = fade->work.im;
+	const double * restrict gr = fade->gr, * restrict gi = fade->gi;
+	double * restrict yr, * restrict yi;
+	double xr, xi;
+
+	if(y->len < len || x->len < len){
+		printf("[fade]Invalid length\n");
+		return -1;
+	}
+
+	for(n0 = 0; n0 < len; n0 += COMPBUF_BLOCK){
+		cnt = (len - n0 < COMPBUF_BLOCK) ? len - n0 : COMPBUF_BLOCK;
+		memcpy(&wr[D], &x->re[n0], sizeof(double)*cnt);
+		memcpy(&wi[D], &x->im[n0], sizeof(double)*cnt);
+		yr = &y->re[n0];
+		yi = &y->im[n0];
+		memset(yr, 0, sizeof(double)*cnt);
+		memset(yi, 0, sizeof(double)*cnt);
+
+		pos = fade->pos;
+		for(l = 0; l < fade->numTap; l++){
+			fade->pos = pos;
+			fade_tapGain(fade, &fade->tap[l], cnt);
+			d = D - fade->delay[l];
+			for(n = 0; n < cnt; n++){
+				xr = wr[d+n];
+				xi = wi[d+n];
+				yr[n] += gr[n] * xr - gi[n] * xi;
+				yi[n] += gr[n] * xi + gi[n] * xr;
+			}
+		}
+		fade->pos = (pos + cnt) % fade->interp;
+
+		memmove(wr, &wr[cnt], sizeof(double)*D);
+		memmove(wi, &wi[cnt], sizeof(double)*D);
+	}
+
+	return 0;
+}
+
+/* Faded interleaved complex signal in place, cf. ch_awgn_complex() */
+int ch_fading_complex(complex input[], int len, fade_str *fade)
+{
+	compBuf_str buf;
+	int ret;
+
+	if(compBuf_alloc(&buf, len) < 0)
+		return -1;
+
+	compBuf_fromComp(&buf, input, len);
+	ret = fade_apply(fade, &buf, &buf, len);
+	compBuf_toComp(input, &buf, len);
+	compBuf_free(&buf);
+
+	return ret;
+}
+
+#endif /* __FADING_H__ */
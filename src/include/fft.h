@@ -0,0 +1,543 @@
+/* File: fft.h
+ *
+ * Description: Radix-4/2 FFT with cached plans and batched execution
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Stockham autosort FFT: radix-4 stages, plus one radix-2 stage (whose
+ * twiddles are all one) when log2(n) is odd. Every stage reads one buffer
+ * and writes the other in natural order, so there is no bit reversal.
+ * A plan holds the twiddles of all stages and is built once per size.
+ *
+ * Batches run FFT_LANES transforms side by side: the group is split into
+ * re[] and im[] arrays with the transform index innermost, so the lanes
+ * of a butterfly share their twiddle and the innermost loop of every
+ * stage runs over stride * FFT_LANES contiguous doubles, long enough to
+ * vectorise from the first stage on. Groups are shared out over threads.
+ */
+
+#ifndef __FFT_H__
+#define __FFT_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#ifdef __AVX512F__
+#include <immintrin.h>
+#endif
+#include "comSim_types.h"
+
+/* Defines */
+#define FFT_MAX_LOG2		16
+#define FFT_LANES			8		/* transforms side by side, one zmm of doubles */
+#define FFT_MAX_THREADS		64
+#define FFT_ALIGN			64
+
+#ifndef M_PI
+#define M_PI				3.14159265358979323846
+#endif
+
+/* Directions */
+enum{
+	FFT_FORWARD = 0,			// X[k] = sum x[n] e^{-j2pi nk/N}
+	FFT_INVERSE,				// x[n] = 1/N sum X[k] e^{+j2pi nk/N}
+};
+
+typedef struct{
+	int n;						// transform size, a power of two
+	int log2n;
+	int numStage;
+	int radix[FFT_MAX_LOG2];	// radix of each stage, 4 or 2
+	long twOff[FFT_MAX_LOG2];	// first twiddle of each stage
+	double *twRe, *twIm;		// w^p, w^2p, w^3p of every radix-4 stage, < n
+	double *work;				// scratch of the calling thread's share,
+								// allocated by the first batch
+	pthread_mutex_t lock;		// held while a batch uses work
+} fftPlan_str;
+
+/* One thread's share of a batch */
+typedef struct{
+	const fftPlan_str *plan;
+	complex *out;
+	long outStride;
+	const complex *in;
+	long inStride;
+	int first, last;			// transforms [first, last)
+	int dir;
+	double *work;				// 4 * n * FFT_LANES doubles
+} fftJob_str;
+
+/* Functions */
+
+void fft_freePlan(fftPlan_str *plan)
+{
+	free(plan->twRe);
+	free(plan->twIm);
+	free(plan->work);
+	pthread_mutex_destroy(&plan->lock);
+	memset(plan, 0, sizeof(fftPlan_str));
+}
+
+/* function fft_initPlan()
+
+	Description: stages and twiddles of an n point transform
+
+	Return indicator:
+		0					Success
+		-1					n is not a power of two in [2, 2^FFT_MAX_LOG2]
+		-2					Memory allocation error
+ */
+
+int fft_initPlan(fftPlan_str *plan, int n)
+{
+	long off = 0;
+	int len, m, p, s;
+
+	memset(plan, 0, sizeof(fftPlan_str));
+	while((1 << plan->log2n) < n)
+		plan->log2n++;
+	if(n < 2 || (1 << plan->log2n) != n || plan->log2n > FFT_MAX_LOG2){
+		printf("[fft] unsupported size %d\n", n);
+		return -1;
+	}
+	plan->n = n;
+	pthread_mutex_init(&plan->lock, NULL);
+
+	/* radix-4 while it divides, the odd factor of two last */
+	for(len = n; len > 1; len /= plan->radix[plan->numStage++])
+		plan->radix[plan->numStage] = (len % 4 == 0) ? 4 : 2;
+
+	plan->twRe = (double *)malloc(sizeof(double)*n);
+	plan->twIm = (double *)malloc(sizeof(double)*n);
+	if(plan->twRe == NULL || plan->twIm == NULL){
+		printf("[fft] fail to mem alloc\n");
+		fft_freePlan(plan);
+		return -2;
+	}
+
+	for(len = n, s = 0; s < plan->numStage; len /= plan->radix[s++]){
+		plan->twOff[s] = off;
+		if(plan->radix[s] != 4)
+			continue;
+		for(m = len / 4, p = 0; p < m; p++, off += 3){
+			plan->twRe[off] = cos(2.*M_PI*p/len);
+			plan->twIm[off] = -sin(2.*M_PI*p/len);
+			plan->twRe[off+1] = cos(2.*M_PI*2*p/len);
+			plan->twIm[off+1] = -sin(2.*M_PI*2*p/len);
+			plan->twRe[off+2] = cos(2.*M_PI*3*p/len);
+			plan->twIm[off+2] = -sin(2.*M_PI*3*p/len);
+		}
+	}
+
+	return 0;
+}
+
+/* function fft_getPlan()
+
+	Description: plan of an n point transform, built once on first use
+
+	Return indicator:
+		!NULL				Cached plan
+		NULL				Unsupported size
+
+	Caution:
+		first use of each size is not thread safe; get the plan before
+		spawning worker threads
+ */
+
+static fftPlan_str *fftCache[FFT_MAX_LOG2+1];
+
+const fftPlan_str *fft_getPlan(int n)
+{
+	fftPlan_str *plan;
+	int m = 0;
+
+	while((1 << m) < n)
+		m++;
+	if(n < 2 || (1 << m) != n || m > FFT_MAX_LOG2){
+		printf("[fft] unsupported size %d\n", n);
+		return NULL;
+	}
+	if(fftCache[m] != NULL)
+		return fftCache[m];
+
+	if((plan = (fftPlan_str *)malloc(sizeof(fftPlan_str))) == NULL)
+		return NULL;
+	if(fft_initPlan(plan, n) < 0){
+		free(plan);
+		return NULL;
+	}
+
+	return fftCache[m] = plan;
+}
+
+/***********************************
+ * Kernels                         *
+ ***********************************/
+
+/* one radix-4 butterfly row: the four inputs x0..x3 and outputs y0..y3
+   are runs of len contiguous doubles */
+static inline void fft_bfly4(double * restrict y0r, double * restrict y0i,
+		double * restrict y1r, double * restrict y1i,
+		double * restrict y2r, double * restrict y2i,
+		double * restrict y3r, double * restrict y3i,
+		const double * restrict x0r, const double * restrict x0i,
+		const double * restrict x1r, const double * restrict x1i,
+		const double * restrict x2r, const double * restrict x2i,
+		const double * restrict x3r, const double * restrict x3i,
+		long len, const double *twRe, const double *twIm)
+{
+	const double w1r = twRe[0], w1i = twIm[0], w2r = twRe[1], w2i = twIm[1];
+	const double w3r = twRe[2], w3i = twIm[2];
+	double t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i, ur, ui;
+	long t;
+
+	for(t = 0; t < len; t++){
+		t0r = x0r[t] + x2r[t];
+		t0i = x0i[t] + x2i[t];
+		t1r = x0r[t] - x2r[t];
+		t1i = x0i[t] - x2i[t];
+		t2r = x1r[t] + x3r[t];
+		t2i = x1i[t] + x3i[t];
+		/* -j (x1 - x3) */
+		t3r = x1i[t] - x3i[t];
+		t3i = x3r[t] - x1r[t];
+
+		y0r[t] = t0r + t2r;
+		y0i[t] = t0i + t2i;
+		ur = t1r + t3r;
+		ui = t1i + t3i;
+		y1r[t] = ur*w1r - ui*w1i;
+		y1i[t] = ur*w1i + ui*w1r;
+		ur = t0r - t2r;
+		ui = t0i - t2i;
+		y2r[t] = ur*w2r - ui*w2i;
+		y2i[t] = ur*w2i + ui*w2r;
+		ur = t1r - t3r;
+		ui = t1i - t3i;
+		y3r[t] = ur*w3r - ui*w3i;
+		y3i[t] = ur*w3i + ui*w3r;
+	}
+}
+
+/* one radix-4 stage of length 4m; sL is the stride of the stage times the
+   number of lanes, i.e. the length of the contiguous runs */
+static void fft_radix4(double * restrict yr, double * restrict yi,
+		const double * restrict xr, const double * restrict xi, int m, long sL,
+		const double *twRe, const double *twIm)
+{
+	const long q = m * sL;
+	double t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i, ur, ui;
+	long a, b, t;
+	int p;
+
+	/* short runs (early stages of a lone transform): butterflies innermost */
+	if(sL < FFT_LANES){
+		for(t = 0; t < sL; t++)
+			for(p = 0; p < m; p++){
+				a = sL * p + t;
+				b = sL * 4 * p + t;
+				t0r = xr[a] + xr[a+2*q];
+				t0i = xi[a] + xi[a+2*q];
+				t1r = xr[a] - xr[a+2*q];
+				t1i = xi[a] - xi[a+2*q];
+				t2r = xr[a+q] + xr[a+3*q];
+				t2i = xi[a+q] + xi[a+3*q];
+				t3r = xi[a+q] - xi[a+3*q];
+				t3i = xr[a+3*q] - xr[a+q];
+
+				yr[b] = t0r + t2r;
+				yi[b] = t0i + t2i;
+				ur = t1r + t3r;
+				ui = t1i + t3i;
+				yr[b+sL] = ur*twRe[3*p] - ui*twIm[3*p];
+				yi[b+sL] = ur*twIm[3*p] + ui*twRe[3*p];
+				ur = t0r - t2r;
+				ui = t0i - t2i;
+				yr[b+2*sL] = ur*twRe[3*p+1] - ui*twIm[3*p+1];
+				yi[b+2*sL] = ur*twIm[3*p+1] + ui*twRe[3*p+1];
+				ur = t1r - t3r;
+				ui = t1i - t3i;
+				yr[b+3*sL] = ur*twRe[3*p+2] - ui*twIm[3*p+2];
+				yi[b+3*sL] = ur*twIm[3*p+2] + ui*twRe[3*p+2];
+			}
+		return;
+	}
+
+	for(p = 0; p < m; p++){
+		a = sL * p;
+		b = sL * 4 * p;
+		fft_bfly4(yr + b, yi + b, yr + b + sL, yi + b + sL,
+				yr + b + 2*sL, yi + b + 2*sL, yr + b + 3*sL, yi + b + 3*sL,
+				xr + a, xi + a, xr + a + q, xi + a + q,
+				xr + a + 2*q, xi + a + 2*q, xr + a + 3*q, xi + a + 3*q,
+				sL, twRe + 3*p, twIm + 3*p);
+	}
+}
+
+/* the last stage of an odd log2(n): length 2, twiddle one */
+static void fft_radix2(double * restrict yr, double * restrict yi,
+		const double * restrict xr, const double * restrict xi, long sL)
+{
+	long t;
+
+	for(t = 0; t < sL; t++){
+		yr[t] = xr[t] + xr[sL+t];
+		yi[t] = xi[t] + xi[sL+t];
+		yr[sL+t] = xr[t] - xr[sL+t];
+		yi[sL+t] = xi[t] - xi[sL+t];
+	}
+}
+
+#ifdef __AVX512F__
+/* in place 8x8 transpose of doubles */
+static inline void fft_transpose8(__m512d r[8])
+{
+	__m512d t[8], u[8];
+	int k;
+
+	for(k = 0; k < 4; k++){
+		t[2*k] = _mm512_unpacklo_pd(r[2*k], r[2*k+1]);
+		t[2*k+1] = _mm512_unpackhi_pd(r[2*k], r[2*k+1]);
+	}
+	for(k = 0; k < 2; k++){
+		u[4*k] = _mm512_shuffle_f64x2(t[4*k], t[4*k+2], 0x88);
+		u[4*k+1] = _mm512_shuffle_f64x2(t[4*k], t[4*k+2], 0xdd);
+		u[4*k+2] = _mm512_shuffle_f64x2(t[4*k+1], t[4*k+3], 0x88);
+		u[4*k+3] = _mm512_shuffle_f64x2(t[4*k+1], t[4*k+3], 0xdd);
+	}
+	r[0] = _mm512_shuffle_f64x2(u[0], u[4], 0x88);
+	r[4] = _mm512_shuffle_f64x2(u[0], u[4], 0xdd);
+	r[2] = _mm512_shuffle_f64x2(u[1], u[5], 0x88);
+	r[6] = _mm512_shuffle_f64x2(u[1], u[5], 0xdd);
+	r[1] = _mm512_shuffle_f64x2(u[2], u[6], 0x88);
+	r[5] = _mm512_shuffle_f64x2(u[2], u[6], 0xdd);
+	r[3] = _mm512_shuffle_f64x2(u[3], u[7], 0x88);
+	r[7] = _mm512_shuffle_f64x2(u[3], u[7], 0xdd);
+}
+#endif
+
+/* split L interleaved vectors into re[] and im[] with the transform index
+   innermost, im scaled by sgn */
+static void fft_split(double *xr, double *xi, const complex *in, long inStride,
+		int n, int L, double sgn)
+{
+	int e = 0, l, k;
+#ifdef __AVX512F__
+	const __m512d vs = _mm512_set1_pd(sgn);
+	__m512d r[8];
+
+	/* 8 vectors times 4 samples, one cache line each */
+	if(L == 8)
+		for(; e + 4 <= n; e += 4){
+			for(l = 0; l < 8; l++)
+				r[l] = _mm512_loadu_pd((const double *)(in + l*inStride + e));
+			fft_transpose8(r);
+			for(l = 0; l < 4; l++){
+				_mm512_storeu_pd(xr + (long)(e+l)*8, r[2*l]);
+				_mm512_storeu_pd(xi + (long)(e+l)*8, _mm512_mul_pd(r[2*l+1], vs));
+			}
+		}
+#endif
+
+	for(l = 0; l < L; l++)
+		for(k = e; k < n; k++){
+			xr[(long)k*L + l] = in[l*inStride + k].re;
+			xi[(long)k*L + l] = sgn * in[l*inStride + k].im;
+		}
+}
+
+/* inverse of fft_split, re scaled by scale and im by sgn*scale */
+static void fft_merge(complex *out, long outStride, const double *xr,
+		const double *xi, int n, int L, double scale, double sgn)
+{
+	int e = 0, l, k;
+#ifdef __AVX512F__
+	const __m512d vr = _mm512_set1_pd(scale), vi = _mm512_set1_pd(sgn*scale);
+	__m512d r[8];
+
+	if(L == 8)
+		for(; e + 4 <= n; e += 4){
+			for(l = 0; l < 4; l++){
+				r[2*l] = _mm512_mul_pd(_mm512_loadu_pd(xr + (long)(e+l)*8), vr);
+				r[2*l+1] = _mm512_mul_pd(_mm512_loadu_pd(xi + (long)(e+l)*8), vi);
+			}
+			fft_transpose8(r);
+			for(l = 0; l < 8; l++)
+				_mm512_storeu_pd((double *)(out + l*outStride + e), r[l]);
+		}
+#endif
+
+	for(l = 0; l < L; l++)
+		for(k = e; k < n; k++){
+			out[l*outStride + k].re = scale * xr[(long)k*L + l];
+			out[l*outStride + k].im = sgn * scale * xi[(long)k*L + l];
+		}
+}
+
+/* function fft_group()
+
+	Description: L <= FFT_LANES transforms, vector v at in[v*inStride],
+	             through the lanes of work
+
+	Output parameters:
+		out[v*outStride + k]	spectra (forward) or signals (inverse)
+ */
+
+static void fft_group(const fftPlan_str *plan, complex *out, long outStride,
+		const complex *in, long inStride, int L, int dir, double *work)
+{
+	const int n = plan->n;
+	double *xr = work, *xi = work + (long)n*L;
+	double *yr = work + 2L*n*L, *yi = work + 3L*n*L, *tmp;
+	double sgn = (dir == FFT_INVERSE) ? -1. : 1.;
+	long sL = L;
+	int s, len = n;
+
+	/* the inverse runs on conj(x) */
+	fft_split(xr, xi, in, inStride, n, L, sgn);
+
+	for(s = 0; s < plan->numStage; s++){
+		if(plan->radix[s] == 4)
+			fft_radix4(yr, yi, xr, xi, len / 4, sL,
+					plan->twRe + plan->twOff[s], plan->twIm + plan->twOff[s]);
+		else
+			fft_radix2(yr, yi, xr, xi, sL);
+		sL *= plan->radix[s];
+		len /= plan->radix[s];
+		tmp = xr; xr = yr; yr = tmp;
+		tmp = xi; xi = yi; yi = tmp;
+	}
+
+	fft_merge(out, outStride, xr, xi, n, L,
+			(dir == FFT_INVERSE) ? 1. / n : 1., sgn);
+}
+
+static void *fft_jobMain(void *arg)
+{
+	fftJob_str *job = (fftJob_str *)arg;
+	int v, L;
+
+	for(v = job->first; v < job->last; v += L){
+		L = (job->last - v < FFT_LANES) ? job->last - v : FFT_LANES;
+		fft_group(job->plan, job->out + v*job->outStride, job->outStride,
+				job->in + v*job->inStride, job->inStride, L, job->dir, job->work);
+	}
+
+	return NULL;
+}
+
+/* function fft_batch()
+
+	Description: numVec transforms of plan->n points; vector v is read from
+	             in[v*inStride] and written to out[v*outStride]. in == out
+	             with equal strides transforms in place.
+
+	input parameters:
+		dir					FFT_FORWARD or FFT_INVERSE (scaled by 1/n)
+		numThread			threads to share the batch, 1: inline
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation or thread error
+
+	Comment:
+		1. the calling thread works in the plan's scratch, so a steady
+		   stream of batches allocates nothing; a batch that finds the
+		   scratch in use by another thread, and the worker threads,
+		   allocate their own
+ */
+
+int fft_batch(const fftPlan_str *plan, complex out[], long outStride,
+		const complex in[], long inStride, int numVec, int dir, int numThread)
+{
+	/* the scratch and its lock are the only mutable state of a shared plan */
+	fftPlan_str *own = (fftPlan_str *)plan;
+	fftJob_str job[FFT_MAX_THREADS];
+	pthread_t tid[FFT_MAX_THREADS];
+	int numGroup = (numVec + FFT_LANES - 1) / FFT_LANES, t, ret = 0, locked = 0;
+	long workLen = 4L * plan->n * FFT_LANES;
+	double *work = NULL, *extra = NULL;
+
+	if(numVec <= 0)
+		return 0;
+	if(numThread > numGroup)
+		numThread = numGroup;
+	if(numThread > FFT_MAX_THREADS)
+		numThread = FFT_MAX_THREADS;
+	if(numThread < 1)
+		numThread = 1;
+
+	if(pthread_mutex_trylock(&own->lock) == 0){
+		locked = 1;
+		if(own->work == NULL && posix_memalign((void **)&own->work, FFT_ALIGN,
+					sizeof(double)*workLen) != 0)
+			own->work = NULL;
+		work = own->work;
+	}
+	if((work == NULL || numThread > 1) && posix_memalign((void **)&extra, FFT_ALIGN,
+				sizeof(double)*workLen*(numThread - (work != NULL))) != 0){
+		printf("[fft] fail to mem alloc\n");
+		if(locked)
+			pthread_mutex_unlock(&own->lock);
+		return -1;
+	}
+
+	/* whole groups of FFT_LANES per thread */
+	for(t = 0; t < numThread; t++){
+		job[t].plan = plan;
+		job[t].out = out;
+		job[t].outStride = outStride;
+		job[t].in = in;
+		job[t].inStride = inStride;
+		job[t].first = (int)((long)numGroup * t / numThread) * FFT_LANES;
+		job[t].last = (int)((long)numGroup * (t+1) / numThread) * FFT_LANES;
+		if(job[t].last > numVec)
+			job[t].last = numVec;
+		job[t].dir = dir;
+		job[t].work = (t == 0 && work != NULL) ? work
+			: extra + workLen*(t - (work != NULL));
+	}
+
+	for(t = 1; t < numThread; t++)
+		if(pthread_create(&tid[t], NULL, fft_jobMain, &job[t]) != 0){
+			printf("[fft] fail to create thread\n");
+			numThread = t;
+			ret = -1;
+			break;
+		}
+	fft_jobMain(&job[0]);
+	for(t = 1; t < numThread; t++)
+		pthread_join(tid[t], NULL);
+
+	free(extra);
+	if(locked)
+		pthread_mutex_unlock(&own->lock);
+	return ret;
+}
+
+/* single transform of plan->n points */
+int fft_exec(const fftPlan_str *plan, complex out[], const complex in[], int dir)
+{
+	return fft_batch(plan, out, plan->n, in, plan->n, 1, dir, 1);
+}
+
+#endif /* __FFT_H__ */
@@ -2,7 +2,7 @@
  *
  * Description: Functions for finite impulse response (FIR) filter
  * Copyright (C) 2011-2014, Jonghun John Park
- * Last updated on Jan. 18, 2014
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -18,14 +18,46 @@
  * You should have received a copy of the GNU Lesser General Public
  * License along with ComSim. If not, write to the Free Software
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Pulse shapes are designed in memory: span symbols of sps samples, i.e.
+ * span*sps + 1 taps, symmetric about the centre tap. pulse_get() keeps the
+ * designed taps, so a sweep asks for them by parameters instead of a tap
+ * file. The symmetric FIR folds h[k] and h[lenH-1-k] into one multiply:
+ * the decimating form adds the two input samples first, the interpolating
+ * form scatters each product of an input sample to both output positions.
  */
 
 #ifndef __FIR_H__
 #define __FIR_H__
 
 /* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
 
 /* Defines */
+#define FIR_BLOCK		256		/* decimator outputs per sweep over the taps */
+#define PULSE_CACHE		16		/* pulses kept by pulse_get() */
+
+enum{
+	PULSE_RRC = 0,				// root raised cosine, unit energy
+	PULSE_RC,					// raised cosine, unit centre tap
+	PULSE_GAUSS,				// Gaussian of bandwidth-time product BT, unit DC gain
+	NUM_PULSE
+};
+
+/* streaming linear phase FIR, interpolating by up or decimating by down */
+typedef struct{
+	const double *h;
+	int lenH;					// h[k] == h[lenH-1-k]
+	int up, down;				// one of them is 1
+	int maxIn;					// input samples per call
+	complex *work;				// decimator: lenH-1 history samples followed
+								// by the input; interpolator: overlap-add sums
+	int pos;					// decimator: work index of the next output
+} firSym_str;
 
 //using shared memory
 #define USE_SHMEM
@@ -35,6 +67,10 @@ static double sh_mem[LEN_SH_MEM];
 #endif
 
 /* Functions */
+int upSamp(double *y, int len_out, double*x, int rate);
+int fir(double *y, int len_y, const char *fltTapFile, int len_flt,
+		double *x, int len_x);
+int conv(double *y, int len_y, double *h, int len_h, double *x, int len_x);
 
 /* function intpl_fir()
 
@@ -260,4 +296,360 @@ err:
 	return ret - 1;
 }
 
+/***********************************
+ * Pulse shapes                    *
+ ***********************************/
+
+/* zeroth order modified Bessel function of the first kind */
+double fir_besselI0(double x)
+{
+	double sum = 1., term = 1., q = 0.25*x*x;
+	int k;
+
+	for(k = 1; k < 64 && term > 1e-17*sum; k++){
+		term *= q / ((double)k*k);
+		sum += term;
+	}
+
+	return sum;
+}
+
+/* Kaiser window shape beta for a stopband attenuation of attenDb */
+double fir_kaiserBeta(double attenDb)
+{
+	if(attenDb > 50.)
+		return 0.1102*(attenDb - 8.7);
+	if(attenDb > 21.)
+		return 0.5842*pow(attenDb - 21., 0.4) + 0.07886*(attenDb - 21.);
+	return 0.;
+}
+
+/* root raised cosine at t symbols, roll-off beta */
+static double pulse_rrc(double t, double beta)
+{
+	double a = 4.*beta*t;
+
+	if(fabs(t) < 1e-12)
+		return 1. - beta + 4.*beta/M_PI;
+	if(beta > 0. && fabs(fabs(a) - 1.) < 1e-9)
+		return beta/M_SQRT2 * ((1. + 2./M_PI)*sin(M_PI/(4.*beta))
+				+ (1. - 2./M_PI)*cos(M_PI/(4.*beta)));
+
+	return (sin(M_PI*t*(1. - beta)) + a*cos(M_PI*t*(1. + beta)))
+		/ (M_PI*t*(1. - a*a));
+}
+
+/* raised cosine at t symbols, roll-off beta */
+static double pulse_rc(double t, double beta)
+{
+	double a = 2.*beta*t, sinc;
+
+	sinc = (fabs(t) < 1e-12) ? 1. : sin(M_PI*t) / (M_PI*t);
+	if(beta > 0. && fabs(fabs(a) - 1.) < 1e-9)
+		return M_PI/4. * sin(M_PI/(2.*beta)) / (M_PI/(2.*beta));
+
+	return sinc * cos(M_PI*beta*t) / (1. - a*a);
+}
+
+/* function pulse_design()
+
+	Description: pulse shape of span symbols at sps samples per symbol
+
+	Output parameters:
+		h[]					span*sps + 1 taps
+	input parameters:
+		shape				PULSE_*
+		beta				roll-off (RRC, RC) or bandwidth-time product
+							(Gaussian)
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+ */
+
+int pulse_design(double h[], int shape, int sps, int span, double beta)
+{
+	const int len = span*sps + 1, mid = span*sps / 2;
+	double t, sum = 0.;
+	int k;
+
+	if(shape < 0 || shape >= NUM_PULSE || sps < 1 || span < 1 || (span*sps) % 2
+			|| beta < 0. || (shape != PULSE_GAUSS && beta > 1.)
+			|| (shape == PULSE_GAUSS && beta <= 0.)){
+		printf("[fir] unsupported pulse(shape %d, sps %d, span %d, beta %g)\n",
+				shape, sps, span, beta);
+		return -1;
+	}
+
+	for(k = 0; k <= mid; k++){
+		t = (double)(k - mid) / sps;
+		if(shape == PULSE_RRC)
+			h[k] = pulse_rrc(t, beta);
+		else if(shape == PULSE_RC)
+			h[k] = pulse_rc(t, beta);
+		else
+			h[k] = exp(-2.*M_PI*M_PI*beta*beta*t*t / M_LN2);
+	}
+
+	/* exact symmetry, so folding gives the unfolded result */
+	for(k = 0; k < mid; k++)
+		h[len-1-k] = h[k];
+
+	for(k = 0; k < len; k++)
+		sum += (shape == PULSE_RRC) ? h[k]*h[k] : h[k];
+	if(shape == PULSE_RRC)
+		sum = sqrt(sum);
+	else if(shape == PULSE_RC)
+		sum = h[mid];
+	for(k = 0; k < len; k++)
+		h[k] /= sum;
+
+	return 0;
+}
+
+/* function pulse_get()
+
+	Description: pulse_design() taps generated once per parameter set
+
+	Output parameters:
+		*lenH				span*sps + 1
+
+	Return indicator:
+		!NULL				Cached taps
+		NULL				Unsupported parameters or full cache
+
+	Caution:
+		first use of each parameter set is not thread safe; touch the
+		pulse before spawning worker threads
+ */
+
+static struct{
+	int shape, sps, span;
+	double beta;
+	double *h;
+} pulseCache[PULSE_CACHE];
+
+const double *pulse_get(int shape, int sps, int span, double beta, int *lenH)
+{
+	double *h;
+	int i;
+
+	*lenH = span*sps + 1;
+	for(i = 0; i < PULSE_CACHE && pulseCache[i].h != NULL; i++)
+		if(pulseCache[i].shape == shape && pulseCache[i].sps == sps
+				&& pulseCache[i].span == span && pulseCache[i].beta == beta)
+			return pulseCache[i].h;
+	if(i == PULSE_CACHE){
+		printf("[fir] pulse cache full\n");
+		return NULL;
+	}
+
+	if((h = (double *)malloc(sizeof(double) * *lenH)) == NULL){
+		printf("[fir] fail to mem alloc\n");
+		return NULL;
+	}
+	if(pulse_design(h, shape, sps, span, beta) < 0){
+		free(h);
+		return NULL;
+	}
+
+	pulseCache[i].shape = shape;
+	pulseCache[i].sps = sps;
+	pulseCache[i].span = span;
+	pulseCache[i].beta = beta;
+	return pulseCache[i].h = h;
+}
+
+/***********************************
+ * Linear phase FIR                *
+ ***********************************/
+
+/* h[k] == h[lenH-1-k] for all k */
+int fir_isSym(const double *h, int lenH)
+{
+	int k;
+
+	for(k = 0; k < lenH/2; k++)
+		if(h[k] != h[lenH-1-k])
+			return 0;
+
+	return 1;
+}
+
+/* function fir_sym()
+
+	Description: y[m] = sum_k h[k] w[m*down + lenH-1 - k], m = 0 .. len-1,
+	             with h symmetric: one multiply per tap pair on the sum of
+	             the two samples it weights
+
+	Output parameters:
+		y[]					len samples
+	input parameters:
+		w[]					(len-1)*down + lenH samples
+ */
+
+void fir_sym(complex * restrict y, const complex * restrict w, int len, int down,
+		const double *h, int lenH)
+{
+	const int half = lenH / 2;
+	double * restrict yd = (double *)y;
+	const double * restrict wd = (const double *)w;
+	int m0, m1, m, k, c;
+	double hk;
+
+	for(m0 = 0; m0 < len; m0 += FIR_BLOCK){
+		m1 = (m0 + FIR_BLOCK < len) ? m0 + FIR_BLOCK : len;
+
+		/* centre tap of an odd filter, then the folded pairs */
+		hk = (lenH & 1) ? h[half] : 0.;
+		for(m = m0; m < m1; m++)
+			for(c = 0; c < 2; c++)
+				yd[2*m+c] = hk * wd[2*(m*down + half) + c];
+
+		for(k = 0; k < half; k++){
+			hk = h[k];
+			if(down == 1){
+				for(m = 2*m0; m < 2*m1; m++)
+					yd[m] += hk * (wd[m + 2*(lenH-1-k)] + wd[m + 2*k]);
+			} else {
+				for(m = m0; m < m1; m++)
+					for(c = 0; c < 2; c++)
+						yd[2*m+c] += hk * (wd[2*(m*down + lenH-1-k) + c]
+								+ wd[2*(m*down + k) + c]);
+			}
+		}
+	}
+}
+
+/* function fir_symIntpl()
+
+	Description: acc[i*up + j] += h[j] x[i], i = 0 .. len-1, j = 0 .. lenH-1,
+	             with h symmetric: h[j] x[i] is computed once for j and
+	             lenH-1-j
+
+	Output parameters:
+		acc[]				(len-1)*up + lenH overlap-add sums
+ */
+
+void fir_symIntpl(complex * restrict acc, const complex *x, int len, int up,
+		const double *h, int lenH)
+{
+	const int half = lenH / 2;
+	double * restrict a;
+	double xr, xi, tr, ti;
+	int i, k;
+
+	for(i = 0; i < len; i++){
+		a = (double *)(acc + (long)i*up);
+		xr = x[i].re;
+		xi = x[i].im;
+		for(k = 0; k < half; k++){
+			tr = h[k] * xr;
+			ti = h[k] * xi;
+			a[2*k] += tr;
+			a[2*k+1] += ti;
+			a[2*(lenH-1-k)] += tr;
+			a[2*(lenH-1-k)+1] += ti;
+		}
+		if(lenH & 1){
+			a[2*half] += h[half] * xr;
+			a[2*half+1] += h[half] * xi;
+		}
+	}
+}
+
+/* function firSym_init()
+
+	Description: streaming symmetric FIR of lenH taps (h is not copied),
+	             interpolating by up or decimating by down; calls take up
+	             to maxIn input samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported rates or asymmetric taps
+		-2					Memory allocation error
+ */
+
+int firSym_init(firSym_str *fs, const double *h, int lenH, int up, int down, int maxIn)
+{
+	long lenWork;
+
+	memset(fs, 0, sizeof(firSym_str));
+	if(up < 1 || down < 1 || (up > 1 && down > 1) || lenH < 1 || maxIn < 1
+			|| !fir_isSym(h, lenH)){
+		printf("[fir] unsupported symmetric FIR(lenH %d, up %d, down %d)\n",
+				lenH, up, down);
+		return -1;
+	}
+
+	fs->h = h;
+	fs->lenH = lenH;
+	fs->up = up;
+	fs->down = down;
+	fs->maxIn = maxIn;
+	lenWork = (up > 1) ? (long)maxIn*up + lenH : (long)maxIn + lenH;
+	if((fs->work = (complex *)calloc(lenWork, sizeof(complex))) == NULL){
+		printf("[fir] fail to mem alloc\n");
+		return -2;
+	}
+
+	return 0;
+}
+
+void firSym_free(firSym_str *fs)
+{
+	free(fs->work);
+	memset(fs, 0, sizeof(firSym_str));
+}
+
+/* function firSym_run()
+
+	Description: filter the next lenX (<= maxIn) input samples; the filter
+	             state carries over, so the output of a stream cut into
+	             calls equals the output of one call. Outputs lag the
+	             input by the filter delay, (lenH-1)/2 samples at the
+	             higher of the two rates.
+
+	Output parameters:
+		y[]					lenX*up, or up to lenX/down rounded up, samples
+		*lenY				number of output samples
+
+	Return indicator:
+		0					Success
+		-1					Too many input samples
+ */
+
+int firSym_run(complex y[], int *lenY, const complex x[], int lenX, firSym_str *fs)
+{
+	const int L = fs->lenH;
+	complex *w = fs->work;
+	int n;
+
+	*lenY = 0;
+	if(lenX > fs->maxIn){
+		printf("[fir] %d input samples exceed %d\n", lenX, fs->maxIn);
+		return -1;
+	}
+
+	if(fs->up > 1){
+		n = lenX * fs->up;
+		fir_symIntpl(w, x, lenX, fs->up, fs->h, L);
+		memcpy(y, w, sizeof(complex)*n);
+		memmove(w, w + n, sizeof(complex)*(L - 1));
+		memset(w + L - 1, 0, sizeof(complex)*n);
+		*lenY = n;
+		return 0;
+	}
+
+	/* outputs whose last input sample is in this call */
+	memcpy(w + L - 1, x, sizeof(complex)*lenX);
+	n = (fs->pos < lenX) ? (lenX - fs->pos + fs->down - 1) / fs->down : 0;
+	fir_sym(y, w + fs->pos, n, fs->down, fs->h, L);
+	fs->pos += n*fs->down - lenX;
+	memmove(w, w + lenX, sizeof(complex)*(L - 1));
+	*lenY = n;
+
+	return 0;
+}
+
 #endif
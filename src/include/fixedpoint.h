@@ -2,7 +2,7 @@
  *
  * Description: Functions and macros for fixedpoint operation
  * Copyright (C) 2011-2012, Jonghun John Park
- * Last updated on Jan. 06, 2012
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -26,6 +26,12 @@
 /* Headers */
 
 /* Defines */
+
+/* Saturation trace hook, e.g. Dprintf(FXP, msg); silent unless defined */
+#ifndef Dprintf
+#define Dprintf(cat, ...)
+#endif
+
 typedef long long sfxp64_t;
 typedef int sfxp_t;
 typedef unsigned int ufxp_t;
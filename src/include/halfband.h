@@ -0,0 +1,463 @@
+/* File: halfband.h
+ *
+ * Description: Half-band 2x interpolation and decimation, cascadable
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * A half-band filter of 4K-1 taps has the centre tap 1/2, K nonzero taps
+ * c[j] = h[mid + 2j+1] on each side of it, and zeros at every other even
+ * offset. The kernels only touch the nonzero taps and fold the two sides:
+ *
+ *   decimate   y[m]    = x[2m - 2K+1] / 2
+ *                      + sum_j c[j] (x[2m - 2K+2 + 2j] + x[2m - 2K - 2j])
+ *   interpolate y[2n]   = sum_j 2c[j] (x[n - K+1 + j] + x[n - K - j])
+ *               y[2n+1] = x[n - K+1]
+ *
+ * i.e. K+1 multiplies per decimated output and K per interpolated output
+ * pair, where a full convolution takes 4K-1 per input sample and the zero
+ * stuffed interpolator 8K-2 per output pair. A cascade chains numStage
+ * stages for a rate change of 2^numStage, each stage writing straight
+ * into the input area of the next.
+ *
+ * Samples are complex (double), split float I/Q lanes (compBufF_str) or
+ * split fixed-point lanes (fixedpoint.h, coefficients in Q15).
+ */
+
+#ifndef __HALFBAND_H__
+#define __HALFBAND_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "fixedpoint.h"
+#include "fir.h"
+
+/* Defines */
+#define HB_MAX_K			32		/* nonzero taps per side */
+#define HB_MAX_STAGES		8		/* rate change up to 256 */
+#define HB_BLOCK			256		/* outputs per sweep over the taps */
+#define HB_COEF_FL			15		/* fixed-point coefficients */
+
+enum{
+	HB_DOUBLE = 0,				// complex samples
+	HB_FLOAT,					// split float lanes
+	HB_FXP,						// split fixed-point lanes
+	NUM_HB_TYPE
+};
+
+enum{
+	HB_DECIM = 0,
+	HB_INTERP
+};
+
+typedef struct{
+	int K;						// nonzero taps per side, 4K-1 taps
+	double c[HB_MAX_K];			// h[mid + 2j+1]
+	float cF[HB_MAX_K];
+	sfxp_t cFxp[HB_MAX_K];		// Q15
+} halfband_str;
+
+typedef struct{
+	const halfband_str *hb;
+	int type;					// HB_DOUBLE, HB_FLOAT or HB_FXP
+	int dir;					// HB_DECIM or HB_INTERP
+	int numStage;
+	int maxIn;					// input samples per call
+	int WL;						// fixed-point word length
+	int numLane;				// 1 complex lane or 2 split (I, Q) lanes
+	size_t elem;				// bytes per sample of a lane
+	int lenHist;				// history samples per stage
+	void *work[HB_MAX_STAGES][2];	// per stage and lane: history + input
+} hbCascade_str;
+
+/* Functions */
+
+/* function halfband_design()
+
+	Description: Kaiser windowed half-band low pass of 4K-1 taps for a
+	             stopband attenuation of attenDb; the taps sum to one
+
+	Return indicator:
+		0					Success
+		-1					Unsupported K
+ */
+
+int halfband_design(halfband_str *hb, int K, double attenDb)
+{
+	const int mid = 2*K - 1;
+	double beta, d, sum = 0.;
+	int j;
+
+	if(K < 1 || K > HB_MAX_K){
+		printf("[halfband] unsupported K(%d)\n", K);
+		return -1;
+	}
+
+	beta = fir_kaiserBeta(attenDb);
+	memset(hb, 0, sizeof(halfband_str));
+	hb->K = K;
+	for(j = 0; j < K; j++){
+		d = 2*j + 1;
+		hb->c[j] = 0.5 * sin(M_PI*d/2.) / (M_PI*d/2.)
+			* fir_besselI0(beta*sqrt(1. - (d/mid)*(d/mid))) / fir_besselI0(beta);
+		sum += 2.*hb->c[j];
+	}
+
+	/* DC gain one: the side taps sum to 1/2 like the centre tap */
+	for(j = 0; j < K; j++){
+		hb->c[j] *= 0.5 / sum;
+		hb->cF[j] = (float)hb->c[j];
+		hb->cFxp[j] = REAL2FXPROUND(hb->c[j], HB_COEF_FL);
+	}
+
+	return 0;
+}
+
+/* full 4K-1 tap impulse response, e.g. for conv() */
+void halfband_taps(double h[], const halfband_str *hb)
+{
+	const int mid = 2*hb->K - 1;
+	int j;
+
+	memset(h, 0, sizeof(double)*(4*hb->K - 1));
+	h[mid] = 0.5;
+	for(j = 0; j < hb->K; j++)
+		h[mid - 2*j - 1] = h[mid + 2*j + 1] = hb->c[j];
+}
+
+/***********************************
+ * Kernels                         *
+ ***********************************/
+
+/* function hb_decim2()
+
+	Description: lenY decimated outputs from w[], which holds 4K-2 history
+	             samples followed by 2 lenY input samples. The side taps
+	             only see even samples: a block of them is gathered first,
+	             so the tap loops run on contiguous data.
+ */
+
+void hb_decim2(complex * restrict y, const complex * restrict w, int lenY,
+		const halfband_str *hb)
+{
+	const int K = hb->K;
+	complex even[HB_BLOCK + 2*HB_MAX_K];
+	double * restrict yd = (double *)y;
+	const double * restrict ed = (const double *)even;
+	int m0, nb, m, i, j;
+	double c;
+
+	for(m0 = 0; m0 < lenY; m0 += HB_BLOCK){
+		nb = (lenY - m0 < HB_BLOCK) ? lenY - m0 : HB_BLOCK;
+		for(i = 0; i < nb + 2*K - 1; i++)
+			even[i] = w[2*(m0 + i)];
+		for(m = m0; m < m0 + nb; m++){
+			y[m].re = 0.5 * w[2*m + 2*K-1].re;
+			y[m].im = 0.5 * w[2*m + 2*K-1].im;
+		}
+		for(j = 0; j < K; j++){
+			c = hb->c[j];
+			for(m = 0; m < 2*nb; m++)
+				yd[2*m0 + m] += c * (ed[m + 2*(K-1 - j)] + ed[m + 2*(K + j)]);
+		}
+	}
+}
+
+/* function hb_interp2()
+
+	Description: 2 lenX interpolated outputs from w[], which holds 2K-1
+	             history samples followed by lenX input samples
+ */
+
+void hb_interp2(complex * restrict y, const complex * restrict w, int lenX,
+		const halfband_str *hb)
+{
+	const int K = hb->K;
+	complex odd[HB_BLOCK];
+	double * restrict od = (double *)odd;
+	const double * restrict wd = (const double *)w;
+	int n0, nb, n, j;
+	double c;
+
+	for(n0 = 0; n0 < lenX; n0 += HB_BLOCK){
+		nb = (lenX - n0 < HB_BLOCK) ? lenX - n0 : HB_BLOCK;
+		memset(odd, 0, sizeof(complex)*nb);
+		for(j = 0; j < K; j++){
+			c = 2.*hb->c[j];
+			for(n = 0; n < 2*nb; n++)
+				od[n] += c * (wd[2*(n0 + K + j) + n] + wd[2*(n0 + K-1 - j) + n]);
+		}
+		for(n = 0; n < nb; n++){
+			y[2*(n0 + n)] = odd[n];
+			y[2*(n0 + n) + 1] = w[n0 + n + K];
+		}
+	}
+}
+
+/* hb_decim2() on one float lane */
+void hbF_decim2(float * restrict y, const float * restrict w, int lenY,
+		const halfband_str *hb)
+{
+	const int K = hb->K;
+	float even[HB_BLOCK + 2*HB_MAX_K];
+	int m0, nb, m, i, j;
+	float c;
+
+	for(m0 = 0; m0 < lenY; m0 += HB_BLOCK){
+		nb = (lenY - m0 < HB_BLOCK) ? lenY - m0 : HB_BLOCK;
+		for(i = 0; i < nb + 2*K - 1; i++)
+			even[i] = w[2*(m0 + i)];
+		for(m = m0; m < m0 + nb; m++)
+			y[m] = 0.5f * w[2*m + 2*K-1];
+		for(j = 0; j < K; j++){
+			c = hb->cF[j];
+			for(m = 0; m < nb; m++)
+				y[m0 + m] += c * (even[m + K-1 - j] + even[m + K + j]);
+		}
+	}
+}
+
+/* hb_interp2() on one float lane */
+void hbF_interp2(float * restrict y, const float * restrict w, int lenX,
+		const halfband_str *hb)
+{
+	const int K = hb->K;
+	float odd[HB_BLOCK];
+	int n0, nb, n, j;
+	float c;
+
+	for(n0 = 0; n0 < lenX; n0 += HB_BLOCK){
+		nb = (lenX - n0 < HB_BLOCK) ? lenX - n0 : HB_BLOCK;
+		memset(odd, 0, sizeof(float)*nb);
+		for(j = 0; j < K; j++){
+			c = 2.f*hb->cF[j];
+			for(n = 0; n < nb; n++)
+				odd[n] += c * (w[n0 + n + K + j] + w[n0 + n + K-1 - j]);
+		}
+		for(n = 0; n < nb; n++){
+			y[2*(n0 + n)] = odd[n];
+			y[2*(n0 + n) + 1] = w[n0 + n + K];
+		}
+	}
+}
+
+/* round off sh fraction bits of the exact sum and saturate to WL */
+static inline sfxp_t hbFxp_round(sfxp64_t acc, int sh, int WL)
+{
+	acc = (acc + (1LL << (sh - 1))) >> sh;
+	return (sfxp_t)((acc > MAX_SFXP(WL)) ? MAX_SFXP(WL)
+			: (acc < MIN_SFXP(WL)) ? MIN_SFXP(WL) : acc);
+}
+
+/* hb_decim2() on one fixed-point lane of word length WL: Q15 products
+   summed exactly in 64 bits, rounded and saturated once per output */
+void hbFxp_decim2(sfxp_t * restrict y, const sfxp_t * restrict w, int lenY,
+		const halfband_str *hb, int WL)
+{
+	const int K = hb->K;
+	sfxp_t even[HB_BLOCK + 2*HB_MAX_K];
+	sfxp64_t acc[HB_BLOCK];
+	int m0, nb, m, i, j;
+	sfxp64_t c;
+
+	for(m0 = 0; m0 < lenY; m0 += HB_BLOCK){
+		nb = (lenY - m0 < HB_BLOCK) ? lenY - m0 : HB_BLOCK;
+		for(i = 0; i < nb + 2*K - 1; i++)
+			even[i] = w[2*(m0 + i)];
+		for(m = 0; m < nb; m++)
+			acc[m] = (sfxp64_t)w[2*(m0 + m) + 2*K-1] << (HB_COEF_FL - 1);
+		for(j = 0; j < K; j++){
+			c = hb->cFxp[j];
+			for(m = 0; m < nb; m++)
+				acc[m] += c * (sfxp64_t)(even[m + K-1 - j] + even[m + K + j]);
+		}
+		for(m = 0; m < nb; m++)
+			y[m0 + m] = hbFxp_round(acc[m], HB_COEF_FL, WL);
+	}
+}
+
+/* hb_interp2() on one fixed-point lane of word length WL */
+void hbFxp_interp2(sfxp_t * restrict y, const sfxp_t * restrict w, int lenX,
+		const halfband_str *hb, int WL)
+{
+	const int K = hb->K;
+	sfxp64_t acc[HB_BLOCK];
+	int n0, nb, n, j;
+	sfxp64_t c;
+
+	for(n0 = 0; n0 < lenX; n0 += HB_BLOCK){
+		nb = (lenX - n0 < HB_BLOCK) ? lenX - n0 : HB_BLOCK;
+		memset(acc, 0, sizeof(sfxp64_t)*nb);
+		for(j = 0; j < K; j++){
+			c = hb->cFxp[j];
+			for(n = 0; n < nb; n++)
+				acc[n] += c * (sfxp64_t)(w[n0 + n + K + j] + w[n0 + n + K-1 - j]);
+		}
+		for(n = 0; n < nb; n++){
+			y[2*(n0 + n)] = hbFxp_round(acc[n], HB_COEF_FL - 1, WL);
+			y[2*(n0 + n) + 1] = w[n0 + n + K];
+		}
+	}
+}
+
+/***********************************
+ * Cascade                         *
+ ***********************************/
+
+void hbCascade_free(hbCascade_str *hc)
+{
+	int s, l;
+
+	for(s = 0; s < HB_MAX_STAGES; s++)
+		for(l = 0; l < 2; l++)
+			free(hc->work[s][l]);
+	memset(hc, 0, sizeof(hbCascade_str));
+}
+
+/* function hbCascade_init()
+
+	Description: numStage half-band stages of hb (not copied) changing the
+	             rate by 2^numStage, calls take up to maxIn input samples;
+	             a decimating call takes a multiple of 2^numStage samples.
+	             WL is the fixed-point word length (2 .. 31), ignored
+	             otherwise.
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+		-2					Memory allocation error
+ */
+
+int hbCascade_init(hbCascade_str *hc, const halfband_str *hb, int type, int dir,
+		int numStage, int maxIn, int WL)
+{
+	long lenIn;
+	int s, l;
+
+	memset(hc, 0, sizeof(hbCascade_str));
+	if(type < 0 || type >= NUM_HB_TYPE || (dir != HB_DECIM && dir != HB_INTERP)
+			|| numStage < 1 || numStage > HB_MAX_STAGES || maxIn < 1
+			|| (dir == HB_DECIM && maxIn % (1 << numStage))
+			|| (type == HB_FXP && (WL < 2 || WL > 31))){
+		printf("[halfband] unsupported cascade(type %d, dir %d, stages %d, maxIn %d, WL %d)\n",
+				type, dir, numStage, maxIn, WL);
+		return -1;
+	}
+
+	hc->hb = hb;
+	hc->type = type;
+	hc->dir = dir;
+	hc->numStage = numStage;
+	hc->maxIn = maxIn;
+	hc->WL = WL;
+	hc->numLane = (type == HB_DOUBLE) ? 1 : 2;
+	hc->elem = (type == HB_DOUBLE) ? sizeof(complex)
+		: (type == HB_FLOAT) ? sizeof(float) : sizeof(sfxp_t);
+	hc->lenHist = (dir == HB_DECIM) ? 4*hb->K - 2 : 2*hb->K - 1;
+
+	for(s = 0; s < numStage; s++){
+		lenIn = (dir == HB_DECIM) ? (long)maxIn >> s : (long)maxIn << s;
+		for(l = 0; l < hc->numLane; l++)
+			if((hc->work[s][l] = calloc(hc->lenHist + lenIn, hc->elem)) == NULL){
+				printf("[halfband] fail to mem alloc\n");
+				hbCascade_free(hc);
+				return -2;
+			}
+	}
+
+	return 0;
+}
+
+/* one stage of one lane: w holds the history and lenIn input samples */
+static void hbCascade_stage(hbCascade_str *hc, void *out, void *w, int lenIn)
+{
+	if(hc->dir == HB_DECIM){
+		if(hc->type == HB_DOUBLE)
+			hb_decim2((complex *)out, (const complex *)w, lenIn/2, hc->hb);
+		else if(hc->type == HB_FLOAT)
+			hbF_decim2((float *)out, (const float *)w, lenIn/2, hc->hb);
+		else
+			hbFxp_decim2((sfxp_t *)out, (const sfxp_t *)w, lenIn/2, hc->hb, hc->WL);
+	} else {
+		if(hc->type == HB_DOUBLE)
+			hb_interp2((complex *)out, (const complex *)w, lenIn, hc->hb);
+		else if(hc->type == HB_FLOAT)
+			hbF_interp2((float *)out, (const float *)w, lenIn, hc->hb);
+		else
+			hbFxp_interp2((sfxp_t *)out, (const sfxp_t *)w, lenIn, hc->hb, hc->WL);
+	}
+}
+
+/* function hbCascade_lane()
+
+	Description: run the cascade on lane l; the state carries over, so the
+	             output of a stream cut into calls equals that of one call
+
+	Output parameters:
+		y					lenX * 2^numStage or lenX / 2^numStage samples
+		*lenY				number of output samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported input length
+ */
+
+int hbCascade_lane(hbCascade_str *hc, int l, void *y, int *lenY, const void *x, int lenX)
+{
+	const size_t e = hc->elem, hist = hc->lenHist * hc->elem;
+	char *w;
+	int s, len = lenX;
+
+	*lenY = 0;
+	if(lenX > hc->maxIn || (hc->dir == HB_DECIM && lenX % (1 << hc->numStage))){
+		printf("[halfband] unsupported input length(%d)\n", lenX);
+		return -1;
+	}
+
+	memcpy((char *)hc->work[0][l] + hist, x, e*lenX);
+	for(s = 0; s < hc->numStage; s++){
+		w = (char *)hc->work[s][l];
+		hbCascade_stage(hc, (s + 1 < hc->numStage)
+				? (char *)hc->work[s+1][l] + hist : y, w, len);
+		memmove(w, w + e*len, hist);
+		len = (hc->dir == HB_DECIM) ? len/2 : len*2;
+	}
+	*lenY = len;
+
+	return 0;
+}
+
+/* complex samples of an HB_DOUBLE cascade */
+int hbCascade_run(complex y[], int *lenY, const complex x[], int lenX, hbCascade_str *hc)
+{
+	return hbCascade_lane(hc, 0, y, lenY, x, lenX);
+}
+
+/* split I/Q lanes of an HB_FLOAT or HB_FXP cascade */
+int hbCascade_runSplit(void *yRe, void *yIm, int *lenY, const void *xRe,
+		const void *xIm, int lenX, hbCascade_str *hc)
+{
+	if(hbCascade_lane(hc, 0, yRe, lenY, xRe, lenX) < 0)
+		return -1;
+	return hbCascade_lane(hc, 1, yIm, lenY, xIm, lenX);
+}
+
+#endif /* __HALFBAND_H__ */
@@ -0,0 +1,670 @@
+/* File: iqFile.h
+ *
+ * Description: I/Q capture files: memory mapped source, write-behind sink
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Files are raw little endian interleaved I/Q: int16 (SigMF ci16_le),
+ * float (cf32_le) or double (cf64_le), the last one being the in-memory
+ * layout of complex. A file named *.sigmf-data comes with a *.sigmf-meta
+ * JSON file that holds the sample format and the sample rate.
+ *
+ * The source maps the file a window of IQ_WINDOW samples at a time, so a
+ * capture larger than RAM is walked in chunks. Only the two most recent
+ * windows are mapped, and their pages are clean and can be reclaimed.
+ * cf64 chunks are handed out as pointers into the mapping, with no copy.
+ * The mapping is private, so a stage may work on a chunk in place
+ * without touching the file. Other formats are converted into a buffer.
+ *
+ * The sink converts into one of two buffers while a writer thread writes
+ * the other, so the simulation does not wait for the disk.
+ */
+
+#ifndef __IQFILE_H__
+#define __IQFILE_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "comSim_types.h"
+
+/* Defines */
+#define IQ_WINDOW			(1 << 20)	/* samples per source mapping window */
+#define IQ_SINK_BUF			(1 << 16)	/* samples per write-behind buffer */
+#define IQ_CI16_SCALE		8192.		/* int16 full scale: 12 dB over unit power */
+#define IQ_MAX_NAME			512
+
+enum{
+	IQ_AUTO = -1,				// source: format from the .sigmf-meta file
+	IQ_CI16,
+	IQ_CF32,
+	IQ_CF64,
+	NUM_IQ_FMT
+};
+
+typedef struct{
+	int fd;
+	int fmt;
+	int bytesPerSamp;
+	double scale;				// samples are file values / scale
+	double sampleRate;			// from the metadata, 0 when unknown
+	long numSamp;				// samples in the file
+	long pos;					// next sample
+	int maxChunk;				// longest chunk of one call
+	size_t page;
+	unsigned char *map;			// current window
+	size_t mapOff, mapLen;		// file bytes of the current window
+	unsigned char *prev;		// previous window, still mapped
+	size_t prevLen;
+	complex *buf;				// converted chunk of ci16/cf32 files
+} iqSrc_str;
+
+typedef struct{
+	int fd;
+	int fmt;
+	int bytesPerSamp;
+	double scale;				// file values are samples * scale
+	double sampleRate;
+	char name[IQ_MAX_NAME];
+	long numSamp;				// samples handed to the sink
+	unsigned char *buf[2];		// IQ_SINK_BUF samples each, file format
+	int cur;					// buffer being filled
+	int fill;					// samples in buf[cur]
+	int async;					// writer thread running
+	int pending;				// buffer queued for the writer, -1 none
+	size_t pendLen;
+	int stop;
+	int err;
+	pthread_t tid;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} iqSink_str;
+
+/* Functions */
+
+/***********************************
+ * Formats and Metadata            *
+ ***********************************/
+
+static const char *iq_fmtName[NUM_IQ_FMT] = {"ci16_le", "cf32_le", "cf64_le"};
+static const int iq_fmtBytes[NUM_IQ_FMT] = {4, 8, 16};
+
+/* IQ_* format of a SigMF datatype string, -1 if unsupported */
+int iq_fmtParse(const char *name)
+{
+	int f;
+
+	for(f = 0; f < NUM_IQ_FMT; f++)
+		if(!strcmp(name, iq_fmtName[f]))
+			return f;
+
+	return -1;
+}
+
+/* fName ends in .sigmf-data: meta[] gets the .sigmf-meta name */
+static int iq_metaName(char meta[], const char *fName)
+{
+	const char *ext = ".sigmf-data";
+	size_t len = strlen(fName), lenExt = strlen(ext);
+
+	if(len <= lenExt || strcmp(fName + len - lenExt, ext) != 0
+			|| len - lenExt + strlen(".sigmf-meta") >= IQ_MAX_NAME)
+		return 0;
+
+	memcpy(meta, fName, len - lenExt);
+	strcpy(meta + len - lenExt, ".sigmf-meta");
+
+	return 1;
+}
+
+/* function iq_readMeta()
+
+	Description: sample format and rate of fName from its .sigmf-meta file;
+	             only the "global" keys core:datatype and core:sample_rate
+	             are read
+
+	Return indicator:
+		IQ_*				Format of the data file
+		-1					No metadata or unsupported datatype
+ */
+
+int iq_readMeta(const char *fName, double *sampleRate)
+{
+	char meta[IQ_MAX_NAME], text[4096], type[32], *p;
+	size_t len;
+	FILE *file;
+	int fmt;
+
+	*sampleRate = 0.;
+	if(!iq_metaName(meta, fName) || (file = fopen(meta, "r")) == NULL){
+		printf("[iqFile] no metadata for %s\n", fName);
+		return -1;
+	}
+	len = fread(text, 1, sizeof(text) - 1, file);
+	text[len] = '\0';
+	fclose(file);
+
+	if((p = strstr(text, "\"core:sample_rate\"")) != NULL)
+		sscanf(p + strlen("\"core:sample_rate\""), " : %lf", sampleRate);
+
+	if((p = strstr(text, "\"core:datatype\"")) == NULL
+			|| sscanf(p + strlen("\"core:datatype\""), " : \"%31[^\"]\"", type) != 1
+			|| (fmt = iq_fmtParse(type)) < 0){
+		printf("[iqFile] unsupported datatype in %s\n", meta);
+		return -1;
+	}
+
+	return fmt;
+}
+
+/* function iq_writeMeta()
+
+	Description: .sigmf-meta file of the data file fName, nothing if fName
+	             does not end in .sigmf-data
+
+	Return indicator:
+		0					Success or no metadata needed
+		-1					Unable to write the file
+ */
+
+int iq_writeMeta(const char *fName, int fmt, double sampleRate)
+{
+	char meta[IQ_MAX_NAME];
+	FILE *file;
+
+	if(!iq_metaName(meta, fName))
+		return 0;
+	if((file = fopen(meta, "w")) == NULL){
+		printf("Unable to open metadata file(%s)\n", meta);
+		return -1;
+	}
+
+	fprintf(file, "{\n  \"global\": {\n");
+	fprintf(file, "    \"core:datatype\": \"%s\",\n", iq_fmtName[fmt]);
+	if(sampleRate > 0.)
+		fprintf(file, "    \"core:sample_rate\": %.17g,\n", sampleRate);
+	fprintf(file, "    \"core:version\": \"1.0.0\",\n");
+	fprintf(file, "    \"core:recorder\": \"ComSim\"\n  },\n");
+	fprintf(file, "  \"captures\": [\n    { \"core:sample_start\": 0 }\n  ],\n");
+	fprintf(file, "  \"annotations\": []\n}\n");
+
+	return fclose(file) == 0 ? 0 : -1;
+}
+
+/* file values of len samples to complex, out[i] = in[i] / scale */
+static void iq_fromFile(complex out[], const void *in, int len, int fmt, double scale)
+{
+	const short *s16 = (const short *)in;
+	const float *f32 = (const float *)in;
+	double g = 1. / scale;
+	int i;
+
+	if(fmt == IQ_CI16){
+		for(i = 0; i < len; i++){
+			out[i].re = g * s16[2*i];
+			out[i].im = g * s16[2*i+1];
+		}
+	} else if(fmt == IQ_CF32){
+		for(i = 0; i < len; i++){
+			out[i].re = g * f32[2*i];
+			out[i].im = g * f32[2*i+1];
+		}
+	} else {
+		memcpy(out, in, sizeof(complex)*len);
+		if(scale != 1.)
+			for(i = 0; i < len; i++){
+				out[i].re *= g;
+				out[i].im *= g;
+			}
+	}
+}
+
+/* complex to file values, rounded and saturated for ci16 */
+static void iq_toFile(void *out, const complex in[], int len, int fmt, double scale)
+{
+	short *s16 = (short *)out;
+	float *f32 = (float *)out;
+	double *f64 = (double *)out, re, im;
+	int i;
+
+	if(fmt == IQ_CI16){
+		for(i = 0; i < len; i++){
+			re = nearbyint(scale * in[i].re);
+			im = nearbyint(scale * in[i].im);
+			re = (re > 32767.) ? 32767. : (re < -32768.) ? -32768. : re;
+			im = (im > 32767.) ? 32767. : (im < -32768.) ? -32768. : im;
+			s16[2*i] = (short)re;
+			s16[2*i+1] = (short)im;
+		}
+	} else if(fmt == IQ_CF32){
+		for(i = 0; i < len; i++){
+			f32[2*i] = (float)(scale * in[i].re);
+			f32[2*i+1] = (float)(scale * in[i].im);
+		}
+	} else {
+		for(i = 0; i < len; i++){
+			f64[2*i] = scale * in[i].re;
+			f64[2*i+1] = scale * in[i].im;
+		}
+	}
+}
+
+/***********************************
+ * Source                          *
+ ***********************************/
+
+void iqSrc_close(iqSrc_str *src)
+{
+	if(src->map != NULL)
+		munmap(src->map, src->mapLen);
+	if(src->prev != NULL)
+		munmap(src->prev, src->prevLen);
+	if(src->fd >= 0)
+		close(src->fd);
+	free(src->buf);
+	memset(src, 0, sizeof(iqSrc_str));
+	src->fd = -1;
+}
+
+/* function iqSrc_open()
+
+	Description: open the capture fName for chunks of up to maxChunk samples
+
+	input parameters:
+		fmt					IQ_* format of the file, IQ_AUTO to read it
+							from the .sigmf-meta file
+		scale				samples are file values / scale; 0 for the
+							default, IQ_CI16_SCALE for ci16 and 1 otherwise
+
+	Return indicator:
+		0					Success
+		-1					Unable to open the file or unknown format
+		-2					Memory allocation error
+ */
+
+int iqSrc_open(iqSrc_str *src, const char *fName, int fmt, double scale, int maxChunk)
+{
+	struct stat st;
+
+	memset(src, 0, sizeof(iqSrc_str));
+	src->fd = -1;
+
+	if(fmt == IQ_AUTO)
+		fmt = iq_readMeta(fName, &src->sampleRate);
+	if(fmt < 0 || fmt >= NUM_IQ_FMT || maxChunk < 1)
+		return -1;
+
+	if((src->fd = open(fName, O_RDONLY)) < 0 || fstat(src->fd, &st) != 0){
+		printf("Unable to open I/Q file(%s)\n", fName);
+		iqSrc_close(src);
+		return -1;
+	}
+
+	src->fmt = fmt;
+	src->bytesPerSamp = iq_fmtBytes[fmt];
+	src->scale = (scale != 0.) ? scale : (fmt == IQ_CI16) ? IQ_CI16_SCALE : 1.;
+	src->numSamp = (long)(st.st_size / src->bytesPerSamp);
+	src->maxChunk = maxChunk;
+	src->page = (size_t)sysconf(_SC_PAGESIZE);
+
+	if(fmt != IQ_CF64 || src->scale != 1.){
+		if((src->buf = (complex *)malloc(sizeof(complex)*maxChunk)) == NULL){
+			printf("[iqFile] fail to mem alloc\n");
+			iqSrc_close(src);
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+/* map the window holding bytes [off, off + len) of the file; the window
+   before stays mapped, the one before that goes */
+static int iqSrc_slide(iqSrc_str *src, size_t off, size_t len)
+{
+	size_t fileLen = (size_t)src->numSamp * src->bytesPerSamp, mapOff, mapLen;
+	void *map;
+
+	mapOff = off / src->page * src->page;
+	mapLen = (size_t)IQ_WINDOW * src->bytesPerSamp + (off - mapOff) + len;
+	if(mapOff + mapLen > fileLen)
+		mapLen = fileLen - mapOff;
+
+	map = mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE, src->fd, (off_t)mapOff);
+	if(map == MAP_FAILED){
+		printf("[iqFile] fail to map %zu bytes at %zu\n", mapLen, mapOff);
+		return -1;
+	}
+	madvise(map, mapLen, MADV_SEQUENTIAL);
+
+	if(src->prev != NULL)
+		munmap(src->prev, src->prevLen);
+	src->prev = src->map;
+	src->prevLen = src->mapLen;
+	src->map = (unsigned char *)map;
+	src->mapOff = mapOff;
+	src->mapLen = mapLen;
+
+	return 0;
+}
+
+/* function iqSrc_next()
+
+	Description: next chunk of up to len (<= maxChunk) samples. A cf64
+	             chunk of scale 1 points into the mapping and stays valid
+	             until IQ_WINDOW samples further on; other formats are
+	             converted into a buffer that the next call reuses.
+
+	Output parameters:
+		*out				first sample of the chunk
+
+	Return indicator:
+		n > 0				Samples in the chunk
+		0					End of file
+		-1					Mapping failure
+ */
+
+int iqSrc_next(iqSrc_str *src, complex **out, int len)
+{
+	size_t off, bytes;
+	unsigned char *p;
+
+	if(len > src->maxChunk)
+		len = src->maxChunk;
+	if(len > src->numSamp - src->pos)
+		len = (int)(src->numSamp - src->pos);
+	if(len <= 0)
+		return 0;
+
+	off = (size_t)src->pos * src->bytesPerSamp;
+	bytes = (size_t)len * src->bytesPerSamp;
+	if(src->map == NULL || off < src->mapOff || off + bytes > src->mapOff + src->mapLen)
+		if(iqSrc_slide(src, off, (size_t)src->maxChunk * src->bytesPerSamp) < 0)
+			return -1;
+
+	p = src->map + (off - src->mapOff);
+	src->pos += len;
+
+	if(src->buf == NULL){
+		*out = (complex *)p;
+		return len;
+	}
+	iq_fromFile(src->buf, p, len, src->fmt, src->scale);
+	*out = src->buf;
+
+	return len;
+}
+
+/* function iqSrc_read()
+
+	Description: next len samples converted into out[], any length
+
+	Return indicator:
+		n >= 0				Samples read, less than len at the end of file
+		-1					Mapping failure
+ */
+
+long iqSrc_read(iqSrc_str *src, complex out[], long len)
+{
+	size_t off, bytes;
+	long done = 0;
+	int n;
+
+	while(done < len && src->pos < src->numSamp){
+		n = (len - done < src->maxChunk) ? (int)(len - done) : src->maxChunk;
+		if(n > src->numSamp - src->pos)
+			n = (int)(src->numSamp - src->pos);
+
+		off = (size_t)src->pos * src->bytesPerSamp;
+		bytes = (size_t)n * src->bytesPerSamp;
+		if(src->map == NULL || off < src->mapOff || off + bytes > src->mapOff + src->mapLen)
+			if(iqSrc_slide(src, off, (size_t)src->maxChunk * src->bytesPerSamp) < 0)
+				return -1;
+
+		iq_fromFile(out + done, src->map + (off - src->mapOff), n, src->fmt, src->scale);
+		src->pos += n;
+		done += n;
+	}
+
+	return done;
+}
+
+/* restart at sample pos */
+void iqSrc_seek(iqSrc_str *src, long pos)
+{
+	src->pos = (pos < 0) ? 0 : (pos > src->numSamp) ? src->numSamp : pos;
+}
+
+/***********************************
+ * Sink                            *
+ ***********************************/
+
+/* write all of buf, 0 on success */
+static int iqSink_put(int fd, const unsigned char *buf, size_t len)
+{
+	ssize_t n;
+
+	while(len > 0){
+		if((n = write(fd, buf, len)) <= 0)
+			return -1;
+		buf += n;
+		len -= (size_t)n;
+	}
+
+	return 0;
+}
+
+static void *iqSink_writer(void *arg)
+{
+	iqSink_str *sink = (iqSink_str *)arg;
+	int b, ret;
+
+	pthread_mutex_lock(&sink->lock);
+	for(;;){
+		while(sink->pending < 0 && !sink->stop)
+			pthread_cond_wait(&sink->cond, &sink->lock);
+		if(sink->pending < 0)
+			break;
+
+		b = sink->pending;
+		pthread_mutex_unlock(&sink->lock);
+		ret = iqSink_put(sink->fd, sink->buf[b], sink->pendLen);
+		pthread_mutex_lock(&sink->lock);
+
+		/* err is shared with iqSink_write(), set and read under the lock */
+		if(ret < 0)
+			sink->err = -1;
+		sink->pending = -1;
+		pthread_cond_broadcast(&sink->cond);
+	}
+	pthread_mutex_unlock(&sink->lock);
+
+	return NULL;
+}
+
+/* queue the filled buffer for the writer and switch to the other one */
+static void iqSink_handOver(iqSink_str *sink)
+{
+	size_t len = (size_t)sink->fill * sink->bytesPerSamp;
+
+	if(sink->fill == 0)
+		return;
+
+	if(!sink->async){
+		if(iqSink_put(sink->fd, sink->buf[sink->cur], len) < 0)
+			sink->err = -1;
+		sink->fill = 0;
+		return;
+	}
+
+	pthread_mutex_lock(&sink->lock);
+	while(sink->pending >= 0)
+		pthread_cond_wait(&sink->cond, &sink->lock);
+	sink->pending = sink->cur;
+	sink->pendLen = len;
+	pthread_cond_broadcast(&sink->cond);
+	pthread_mutex_unlock(&sink->lock);
+
+	sink->cur ^= 1;
+	sink->fill = 0;
+}
+
+/* function iqSink_open()
+
+	Description: create the capture fName, and its .sigmf-meta file on
+	             close if the name ends in .sigmf-data
+
+	input parameters:
+		scale				file values are samples * scale; 0 for the
+							default, IQ_CI16_SCALE for ci16 and 1 otherwise
+		sampleRate			for the metadata, 0 when not known
+
+	Return indicator:
+		0					Success
+		-1					Unable to create the file or unknown format
+		-2					Memory allocation error
+ */
+
+int iqSink_open(iqSink_str *sink, const char *fName, int fmt, double scale,
+		double sampleRate)
+{
+	memset(sink, 0, sizeof(iqSink_str));
+	sink->fd = -1;
+	sink->pending = -1;
+
+	if(fmt < 0 || fmt >= NUM_IQ_FMT || strlen(fName) >= IQ_MAX_NAME)
+		return -1;
+	if((sink->fd = open(fName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+		printf("Unable to open I/Q file(%s)\n", fName);
+		return -1;
+	}
+
+	strcpy(sink->name, fName);
+	sink->fmt = fmt;
+	sink->bytesPerSamp = iq_fmtBytes[fmt];
+	sink->scale = (scale != 0.) ? scale : (fmt == IQ_CI16) ? IQ_CI16_SCALE : 1.;
+	sink->sampleRate = sampleRate;
+
+	sink->buf[0] = (unsigned char *)malloc((size_t)IQ_SINK_BUF * sink->bytesPerSamp);
+	sink->buf[1] = (unsigned char *)malloc((size_t)IQ_SINK_BUF * sink->bytesPerSamp);
+	if(sink->buf[0] == NULL || sink->buf[1] == NULL){
+		printf("[iqFile] fail to mem alloc\n");
+		free(sink->buf[0]);
+		free(sink->buf[1]);
+		close(sink->fd);
+		return -2;
+	}
+
+	/* without a writer thread the buffers are written inline */
+	pthread_mutex_init(&sink->lock, NULL);
+	pthread_cond_init(&sink->cond, NULL);
+	sink->async = (pthread_create(&sink->tid, NULL, iqSink_writer, sink) == 0);
+
+	return 0;
+}
+
+/* function iqSink_write()
+
+	Description: append len samples; they are converted into the current
+	             buffer, full buffers go to the writer thread
+
+	Return indicator:
+		0					Success
+		-1					An earlier write failed
+ */
+
+int iqSink_write(iqSink_str *sink, const complex in[], long len)
+{
+	long done = 0;
+	int n, err;
+
+	while(done < len){
+		n = (len - done < IQ_SINK_BUF - sink->fill) ? (int)(len - done)
+			: IQ_SINK_BUF - sink->fill;
+		iq_toFile(sink->buf[sink->cur] + (size_t)sink->fill * sink->bytesPerSamp,
+				in + done, n, sink->fmt, sink->scale);
+		sink->fill += n;
+		done += n;
+
+		if(sink->fill == IQ_SINK_BUF)
+			iqSink_handOver(sink);
+	}
+	sink->numSamp += len;
+
+	if(!sink->async)
+		return sink->err;
+	pthread_mutex_lock(&sink->lock);
+	err = sink->err;
+	pthread_mutex_unlock(&sink->lock);
+
+	return err;
+}
+
+/* function iqSink_close()
+
+	Description: write out the buffers, stop the writer and add the
+	             metadata file
+
+	Return indicator:
+		0					Success
+		-1					A write failed
+ */
+
+int iqSink_close(iqSink_str *sink)
+{
+	int ret;
+
+	if(sink->fd < 0)
+		return -1;
+
+	iqSink_handOver(sink);
+	if(sink->async){
+		pthread_mutex_lock(&sink->lock);
+		sink->stop = 1;
+		pthread_cond_broadcast(&sink->cond);
+		pthread_mutex_unlock(&sink->lock);
+		pthread_join(sink->tid, NULL);
+	}
+	pthread_mutex_destroy(&sink->lock);
+	pthread_cond_destroy(&sink->cond);
+
+	if(close(sink->fd) != 0)
+		sink->err = -1;
+	if(sink->err == 0)
+		sink->err = iq_writeMeta(sink->name, sink->fmt, sink->sampleRate);
+	if(sink->err < 0)
+		printf("Unable to write I/Q file(%s)\n", sink->name);
+
+	free(sink->buf[0]);
+	free(sink->buf[1]);
+	ret = sink->err;
+	memset(sink, 0, sizeof(iqSink_str));
+	sink->fd = -1;
+
+	return ret;
+}
+
+#endif /* __IQFILE_H__ */
@@ -0,0 +1,542 @@
+/* File: ldpc.h
+ *
+ * Description: Quasi-cyclic LDPC encoder and layered min-sum decoder
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * A code is an mb x nb base matrix of cyclic shifts (-1: zero block) and
+ * the lifting size Z: block (r, c) with shift s connects check r*Z + j to
+ * bit c*Z + (j + s) % Z. The last mb block columns carry the parity bits.
+ * The encoder solves the parity part with its dense GF(2) inverse, so it
+ * does not depend on a particular parity structure.
+ *
+ * The decoder is layered (one base row per layer) normalised/offset
+ * min-sum on int8 messages. The Z checks of a layer are independent: a
+ * block of a-posteriori LLRs is rotated by its shift into a contiguous
+ * row, and every check node operation is one flat loop over Z x batch
+ * int8 lanes. Codewords of a batch are interleaved bit by bit, so small
+ * liftings still fill the vectors. Decoding stops as soon as every
+ * codeword of the batch satisfies the syndrome.
+ *
+ * Only the 802.11n (648, 324) code is tabulated. ldpc_init() takes any
+ * base matrix, and shifts are reduced mod Z as NR lifting does, but the
+ * 5G NR base graphs need their shift tables, filler and punctured
+ * systematic columns and rate matching, and DVB-S2 is an IRA code given
+ * by address tables. The dense parity inverse of the encoder also grows
+ * with M^2: at NR BG1 Z = 384 or DVB-S2 n = 64800 the encoder has to use
+ * the double diagonal or accumulator parity structure instead.
+ */
+
+#ifndef __LDPC_H__
+#define __LDPC_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Defines */
+#define LDPC_MAX_BATCH		16		/* codewords decoded side by side */
+#define LDPC_MAX_ITER		10
+#define LDPC_LLR_Q			12.		/* int8 level of the mean |LLR| */
+#define LDPC_LLR_MAX		63		/* channel LLR clip, leaves APP headroom */
+#define LDPC_MSG_MAX		127
+#define LDPC_LANES			64		/* layer rows padded to whole vectors */
+
+/* Preset codes */
+enum{
+	LDPC_NONE = 0,
+	LDPC_WIFI_648_R12,			// IEEE 802.11n, n = 648, R = 1/2, Z = 27
+	NUM_LDPC_PRESET,
+};
+
+typedef struct{
+	int Z;						// lifting size
+	int mb, nb;					// base matrix rows and columns
+	int N, M, K;				// code bits, checks, information bits
+	int numEdge;				// non-zero blocks
+	int maxDeg;					// largest row degree
+	int *rowStart;				// edges of base row r: rowStart[r] ..
+	int *edgeCol;				// base column of every edge, row by row
+	int *edgeShift;
+	int W;						// 64-bit words of a column of inv
+	unsigned long long *inv;	// inverse of the parity part, column by column
+	/* decoder */
+	int maxIter;
+	int Vmax;					// padded lanes of a layer row at full batch
+	int alpha;					// normalisation in eighths, 8: none
+	int offset;					// subtracted after normalisation
+	signed char *app;			// a-posteriori LLRs, [bit][codeword]
+	signed char *msg;			// check to bit messages, [edge][check][codeword]
+	signed char *rot;			// rotated APP blocks of one layer
+	unsigned char *work;		// min1, min2, argmin, sign of one layer
+	long numCw;					// decoded codewords
+	long numIterSum;			// iterations spent on them
+} ldpc_str;
+
+/* Variables */
+
+/* IEEE 802.11n-2009 Table R.1, n = 648, R = 1/2 */
+static const short ldpcWifi648R12[12*24] = {
+	 0, -1, -1, -1,  0,  0, -1, -1,  0, -1, -1,  0,  1,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	22,  0, -1, -1, 17, -1,  0,  0, 12, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 6, -1,  0, -1, 10, -1, -1, -1, 24, -1,  0, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1,
+	 2, -1, -1,  0, 20, -1, -1, -1, 25,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1,
+	23, -1, -1, -1,  3, -1, -1, -1,  0, -1,  9, 11, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1,
+	24, -1, 23,  1, 17, -1,  3, -1, 10, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1,
+	25, -1, -1, -1,  8, -1, -1, -1,  7, 18, -1, -1,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1,
+	13, 24, -1, -1,  0, -1,  8, -1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1,
+	 7, 20, -1, 16, 22, 10, -1, -1, 23, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1,
+	11, -1, -1, -1, 19, -1, -1, -1, 13, -1,  3, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1,
+	25, -1,  8, -1, 23, 18, -1, 14,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0,
+	 3, -1, -1, -1, 16, -1, -1,  2, 25,  5, -1, -1,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,
+};
+
+/* Functions */
+
+void ldpc_free(ldpc_str *ldpc)
+{
+	free(ldpc->rowStart);
+	free(ldpc->edgeCol);
+	free(ldpc->edgeShift);
+	free(ldpc->inv);
+	free(ldpc->app);
+	free(ldpc->msg);
+	free(ldpc->rot);
+	free(ldpc->work);
+	memset(ldpc, 0, sizeof(ldpc_str));
+}
+
+/* Gauss-Jordan inverse of the parity part of H; 0 on success */
+static int ldpc_invParity(ldpc_str *ldpc)
+{
+	int M = ldpc->M, Z = ldpc->Z, W = ldpc->W, W2 = 2*W;
+	int r, e, j, row, col, piv, i;
+	unsigned long long *a, tmp, bit;
+
+	if((a = (unsigned long long *)calloc((size_t)M * W2, sizeof(unsigned long long))) == NULL)
+		return -1;
+
+	/* [Hp | I] */
+	for(r = 0; r < ldpc->mb; r++)
+		for(e = ldpc->rowStart[r]; e < ldpc->rowStart[r+1]; e++){
+			if(ldpc->edgeCol[e] < ldpc->nb - ldpc->mb)
+				continue;
+			for(j = 0; j < Z; j++){
+				row = r*Z + j;
+				col = (ldpc->edgeCol[e] - (ldpc->nb - ldpc->mb))*Z
+					+ (j + ldpc->edgeShift[e]) % Z;
+				a[(long)row*W2 + (col >> 6)] ^= 1ULL << (col & 63);
+			}
+		}
+	for(row = 0; row < M; row++)
+		a[(long)row*W2 + W + (row >> 6)] |= 1ULL << (row & 63);
+
+	for(col = 0; col < M; col++){
+		bit = 1ULL << (col & 63);
+		for(piv = col; piv < M && !(a[(long)piv*W2 + (col >> 6)] & bit); piv++)
+			;
+		if(piv == M){
+			free(a);
+			return -1;
+		}
+		if(piv != col)
+			for(i = 0; i < W2; i++){
+				tmp = a[(long)piv*W2 + i];
+				a[(long)piv*W2 + i] = a[(long)col*W2 + i];
+				a[(long)col*W2 + i] = tmp;
+			}
+		for(row = 0; row < M; row++)
+			if(row != col && (a[(long)row*W2 + (col >> 6)] & bit))
+				for(i = 0; i < W2; i++)
+					a[(long)row*W2 + i] ^= a[(long)col*W2 + i];
+	}
+
+	/* keep the columns: parity = XOR of the columns of the set syndrome bits */
+	memset(ldpc->inv, 0, sizeof(unsigned long long)*M*W);
+	for(row = 0; row < M; row++)
+		for(col = 0; col < M; col++)
+			if((a[(long)row*W2 + W + (col >> 6)] >> (col & 63)) & 1)
+				ldpc->inv[(long)col*W + (row >> 6)] |= 1ULL << (row & 63);
+	free(a);
+
+	return 0;
+}
+
+/* function ldpc_init()
+
+	Description: build a quasi-cyclic code and its decoder workspace
+
+	input parameters:
+		base[]				mb x nb shifts, row major, -1 for a zero block
+		Z					lifting size
+		maxIter				decoder iterations, 0 for LDPC_MAX_ITER
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error or singular parity part
+ */
+
+int ldpc_init(ldpc_str *ldpc, const short base[], int mb, int nb, int Z, int maxIter)
+{
+	int r, c, e;
+
+	memset(ldpc, 0, sizeof(ldpc_str));
+	ldpc->Z = Z;
+	ldpc->mb = mb;
+	ldpc->nb = nb;
+	ldpc->N = nb * Z;
+	ldpc->M = mb * Z;
+	ldpc->K = ldpc->N - ldpc->M;
+	ldpc->W = (ldpc->M + 63) / 64;
+	ldpc->maxIter = (maxIter > 0) ? maxIter : LDPC_MAX_ITER;
+	ldpc->alpha = 6;
+	ldpc->offset = 0;
+
+	for(r = 0; r < mb*nb; r++)
+		ldpc->numEdge += (base[r] >= 0);
+
+	ldpc->rowStart = (int *)malloc(sizeof(int)*(mb + 1));
+	ldpc->edgeCol = (int *)malloc(sizeof(int)*ldpc->numEdge);
+	ldpc->edgeShift = (int *)malloc(sizeof(int)*ldpc->numEdge);
+	ldpc->inv = (unsigned long long *)malloc(sizeof(unsigned long long)*ldpc->M*ldpc->W);
+	if(ldpc->rowStart == NULL || ldpc->edgeCol == NULL || ldpc->edgeShift == NULL
+			|| ldpc->inv == NULL)
+		goto error;
+
+	for(e = 0, r = 0; r < mb; r++){
+		ldpc->rowStart[r] = e;
+		for(c = 0; c < nb; c++)
+			if(base[r*nb + c] >= 0){
+				ldpc->edgeCol[e] = c;
+				ldpc->edgeShift[e++] = base[r*nb + c] % Z;
+			}
+		if(e - ldpc->rowStart[r] > ldpc->maxDeg)
+			ldpc->maxDeg = e - ldpc->rowStart[r];
+	}
+	ldpc->rowStart[mb] = e;
+
+	/* the pad lanes are never read back, calloc keeps them defined */
+	ldpc->Vmax = (Z * LDPC_MAX_BATCH + LDPC_LANES - 1) / LDPC_LANES * LDPC_LANES;
+	ldpc->app = (signed char *)malloc((size_t)ldpc->N * LDPC_MAX_BATCH);
+	ldpc->msg = (signed char *)calloc((size_t)ldpc->numEdge * ldpc->Vmax, 1);
+	ldpc->rot = (signed char *)calloc((size_t)ldpc->maxDeg * ldpc->Vmax, 1);
+	ldpc->work = (unsigned char *)calloc((size_t)4 * ldpc->Vmax, 1);
+	if(ldpc->app == NULL || ldpc->msg == NULL || ldpc->rot == NULL || ldpc->work == NULL)
+		goto error;
+
+	if(ldpc_invParity(ldpc) < 0){
+		printf("[ldpc] parity part is singular\n");
+		ldpc_free(ldpc);
+		return -1;
+	}
+
+	return 0;
+
+error:
+	printf("[ldpc] fail to mem alloc\n");
+	ldpc_free(ldpc);
+	return -1;
+}
+
+int ldpc_initPreset(ldpc_str *ldpc, int preset)
+{
+	switch(preset){
+		case LDPC_WIFI_648_R12:	return ldpc_init(ldpc, ldpcWifi648R12, 12, 24, 27, 0);
+		default:
+			printf("[ldpc] unknown preset %d\n", preset);
+			return -1;
+	}
+}
+
+/* function ldpc_enc()
+
+	Description: encode lenIn / K codewords, systematic bits first
+
+	Output parameters:
+		*lenOut				lenIn / K * N coded bits
+
+	Return indicator:
+		0					Success
+		-1					lenIn is not a multiple of K
+ */
+
+int ldpc_enc(int *lenOut, int out[], int lenIn, const int in[], const ldpc_str *ldpc)
+{
+	unsigned long long par[(ldpc->M + 63) / 64];
+	unsigned char synB[ldpc->M];
+	int Z = ldpc->Z, K = ldpc->K, M = ldpc->M, W = ldpc->W;
+	int cw, r, e, j, i, c, s, *cOut;
+	const int *u;
+
+	if(lenIn % K != 0){
+		printf("[ldpc] %d bits are not whole codewords of %d\n", lenIn, K);
+		return -1;
+	}
+
+	for(cw = 0; cw < lenIn / K; cw++){
+		u = &in[cw*K];
+		cOut = &out[cw*ldpc->N];
+
+		/* syndrome of the systematic part, one byte per check, then packed */
+		memset(synB, 0, M);
+		for(r = 0; r < ldpc->mb; r++)
+			for(e = ldpc->rowStart[r]; e < ldpc->rowStart[r+1]; e++){
+				c = ldpc->edgeCol[e];
+				if(c >= ldpc->nb - ldpc->mb)
+					continue;
+				s = ldpc->edgeShift[e];
+				for(j = 0; j < Z - s; j++)
+					synB[r*Z + j] ^= (unsigned char)u[c*Z + s + j];
+				for(j = Z - s; j < Z; j++)
+					synB[r*Z + j] ^= (unsigned char)u[c*Z + s + j - Z];
+			}
+		/* parity = inv * syndrome */
+		memset(par, 0, sizeof(unsigned long long)*W);
+		for(i = 0; i < M; i++)
+			if(synB[i] & 1)
+				for(j = 0; j < W; j++)
+					par[j] ^= ldpc->inv[(long)i*W + j];
+
+		for(i = 0; i < K; i++)
+			cOut[i] = u[i] & 1;
+		for(i = 0; i < M; i++)
+			cOut[K + i] = (int)((par[i >> 6] >> (i & 63)) & 1);
+	}
+
+	*lenOut = lenIn / K * ldpc->N;
+	return 0;
+}
+
+static inline signed char ldpc_sat(int x)
+{
+	return (signed char)((x > LDPC_MSG_MAX) ? LDPC_MSG_MAX
+			: ((x < -LDPC_MSG_MAX) ? -LDPC_MSG_MAX : x));
+}
+
+/* APP block of edge e rotated by its shift into dst (L elements per check) */
+static inline void ldpc_gather(signed char *dst, const ldpc_str *ldpc, int e, int L)
+{
+	const signed char *src = &ldpc->app[(long)ldpc->edgeCol[e] * ldpc->Z * L];
+	int s = ldpc->edgeShift[e], Z = ldpc->Z;
+
+	memcpy(dst, &src[s*L], (size_t)(Z - s) * L);
+	memcpy(&dst[(Z - s)*L], src, (size_t)s * L);
+}
+
+static inline void ldpc_scatter(ldpc_str *ldpc, const signed char *src, int e, int L)
+{
+	signed char *dst = &ldpc->app[(long)ldpc->edgeCol[e] * ldpc->Z * L];
+	int s = ldpc->edgeShift[e], Z = ldpc->Z;
+
+	memcpy(&dst[s*L], src, (size_t)(Z - s) * L);
+	memcpy(dst, &src[(Z - s)*L], (size_t)s * L);
+}
+
+/* bit to check messages of one edge: t = APP - old message, tracking the
+   two smallest magnitudes, the edge of the smallest and the sign product;
+   the narrow types let the loop run on byte lanes */
+static inline void ldpc_cnIn(signed char * restrict t, const signed char * restrict m,
+		unsigned char * restrict mn1, unsigned char * restrict mn2,
+		unsigned char * restrict idx, unsigned char * restrict sgn, int V,
+		unsigned char e)
+{
+	unsigned char a, hi;
+	signed char x;
+	short d;
+	int i;
+
+	for(i = 0; i < V; i++){
+		d = (short)(t[i] - m[i]);
+		d = (d > LDPC_MSG_MAX) ? LDPC_MSG_MAX : d;
+		d = (d < -LDPC_MSG_MAX) ? -LDPC_MSG_MAX : d;
+		x = (signed char)d;
+		t[i] = x;
+		a = (unsigned char)((x < 0) ? -x : x);
+		hi = (a > mn1[i]) ? a : mn1[i];
+		mn2[i] = (hi < mn2[i]) ? hi : mn2[i];
+		idx[i] = (a < mn1[i]) ? e : idx[i];
+		mn1[i] = (a < mn1[i]) ? a : mn1[i];
+		sgn[i] ^= (unsigned char)(x < 0);
+	}
+}
+
+/* check to bit messages of one edge and the updated APPs */
+static inline void ldpc_cnOut(signed char * restrict t, signed char * restrict m,
+		const unsigned char * restrict mn1, const unsigned char * restrict mn2,
+		const unsigned char * restrict idx, const unsigned char * restrict sgn,
+		int V, unsigned char e, short alpha, short offset)
+{
+	signed char v;
+	short w, d;
+	int i;
+
+	for(i = 0; i < V; i++){
+		w = (idx[i] == e) ? mn2[i] : mn1[i];
+		w = (short)(((w * alpha) >> 3) - offset);
+		v = (signed char)((w < 0) ? 0 : w);
+		v = (sgn[i] ^ (unsigned char)(t[i] < 0)) ? (signed char)-v : v;
+		m[i] = v;
+		d = (short)(t[i] + v);
+		d = (d > LDPC_MSG_MAX) ? LDPC_MSG_MAX : d;
+		d = (d < -LDPC_MSG_MAX) ? -LDPC_MSG_MAX : d;
+		t[i] = (signed char)d;
+	}
+}
+
+/* padded lanes of a layer row of L codewords */
+static inline int ldpc_lanes(const ldpc_str *ldpc, int L)
+{
+	return (ldpc->Z * L + LDPC_LANES - 1) / LDPC_LANES * LDPC_LANES;
+}
+
+/* one layer: base row r over all Z checks and L = batch codewords */
+static void ldpc_layer(ldpc_str *ldpc, int r, int L)
+{
+	int V = ldpc_lanes(ldpc, L), e0 = ldpc->rowStart[r];
+	int deg = ldpc->rowStart[r+1] - e0, e;
+	unsigned char *mn1 = ldpc->work, *mn2 = &ldpc->work[V];
+	unsigned char *idx = &ldpc->work[2*V], *sgn = &ldpc->work[3*V];
+
+	memset(mn1, LDPC_MSG_MAX, V);
+	memset(mn2, LDPC_MSG_MAX, V);
+	memset(idx, 0, V);
+	memset(sgn, 0, V);
+
+	for(e = 0; e < deg; e++){
+		ldpc_gather(&ldpc->rot[(long)e*V], ldpc, e0 + e, L);
+		ldpc_cnIn(&ldpc->rot[(long)e*V], &ldpc->msg[(long)(e0 + e)*V],
+				mn1, mn2, idx, sgn, V, (unsigned char)e);
+	}
+
+	for(e = 0; e < deg; e++){
+		ldpc_cnOut(&ldpc->rot[(long)e*V], &ldpc->msg[(long)(e0 + e)*V],
+				mn1, mn2, idx, sgn, V, (unsigned char)e,
+				(short)ldpc->alpha, (short)ldpc->offset);
+		ldpc_scatter(ldpc, &ldpc->rot[(long)e*V], e0 + e, L);
+	}
+}
+
+/* 1 when every codeword of the batch satisfies all checks */
+static int ldpc_syndromeOk(ldpc_str *ldpc, int L)
+{
+	int V = ldpc->Z * L, Vp = ldpc_lanes(ldpc, L), r, e, i;
+	unsigned char *par = ldpc->work, bad = 0;
+	signed char *t = ldpc->rot;
+
+	for(r = 0; r < ldpc->mb && !bad; r++){
+		memset(par, 0, Vp);
+		for(e = ldpc->rowStart[r]; e < ldpc->rowStart[r+1]; e++){
+			ldpc_gather(t, ldpc, e, L);
+			for(i = 0; i < Vp; i++)
+				par[i] ^= (unsigned char)(t[i] < 0);
+		}
+		for(i = 0; i < V; i++)
+			bad |= par[i];
+	}
+
+	return !bad;
+}
+
+/* function ldpc_decBatch()
+
+	Description: decode L <= LDPC_MAX_BATCH codewords side by side
+
+	Output parameters:
+		out[]				L x K information bits
+
+	Input parameters:
+		llr[]				L x N LLRs, log(P(b=0)/P(b=1))
+
+	Return indicator:
+		>0					Iterations run
+ */
+
+int ldpc_decBatch(int out[], const double llr[], int L, ldpc_str *ldpc)
+{
+	int N = ldpc->N, K = ldpc->K, i, f, it, r;
+	double acc[4] = {0., 0., 0., 0.}, scale, q;
+
+	/* int8 quantisation, the mean |LLR| maps to LDPC_LLR_Q */
+	for(i = 0; i + 4 <= L*N; i += 4)
+		for(f = 0; f < 4; f++)
+			acc[f] += fabs(llr[i + f]);
+	for(; i < L*N; i++)
+		acc[0] += fabs(llr[i]);
+	q = acc[0] + acc[1] + acc[2] + acc[3];
+	scale = (q > 0.) ? LDPC_LLR_Q * L * N / q : 0.;
+
+	for(f = 0; f < L; f++)
+		for(i = 0; i < N; i++){
+			q = llr[f*N + i] * scale;
+			q = (q > LDPC_LLR_MAX) ? LDPC_LLR_MAX : ((q < -LDPC_LLR_MAX) ? -LDPC_LLR_MAX : q);
+			ldpc->app[i*L + f] = (signed char)(q + ((q < 0.) ? -0.5 : 0.5));
+		}
+	memset(ldpc->msg, 0, (size_t)ldpc->numEdge * ldpc_lanes(ldpc, L));
+
+	for(it = 1; it <= ldpc->maxIter; it++){
+		for(r = 0; r < ldpc->mb; r++)
+			ldpc_layer(ldpc, r, L);
+		if(ldpc_syndromeOk(ldpc, L))
+			break;
+	}
+	if(it > ldpc->maxIter)
+		it = ldpc->maxIter;
+
+	for(f = 0; f < L; f++)
+		for(i = 0; i < K; i++)
+			out[f*K + i] = (ldpc->app[i*L + f] < 0);
+
+	ldpc->numCw += L;
+	ldpc->numIterSum += (long)it * L;
+
+	return it;
+}
+
+/* function ldpc_dec()
+
+	Description: decode lenLlr / N codewords in batches of LDPC_MAX_BATCH
+
+	Output parameters:
+		*lenOut				lenLlr / N * K information bits
+
+	Return indicator:
+		0					Success
+		-1					lenLlr is not a multiple of N
+ */
+
+int ldpc_dec(int *lenOut, int out[], int lenLlr, const double llr[], ldpc_str *ldpc)
+{
+	int numCw = lenLlr / ldpc->N, cw, L;
+
+	if(lenLlr % ldpc->N != 0){
+		printf("[ldpc] %d LLRs are not whole codewords of %d\n", lenLlr, ldpc->N);
+		return -1;
+	}
+
+	for(cw = 0; cw < numCw; cw += L){
+		L = (numCw - cw < LDPC_MAX_BATCH) ? numCw - cw : LDPC_MAX_BATCH;
+		ldpc_decBatch(&out[cw*ldpc->K], &llr[(long)cw*ldpc->N], L, ldpc);
+	}
+
+	*lenOut = numCw * ldpc->K;
+	return 0;
+}
+
+#endif /* __LDPC_H__ */
@@ -1,7 +1,7 @@
 /* File: linkSim.h
  * Description: A header file for the link level simulator
  * Copyright (C) 2011-2014, Jonghun John Park
- * Last updated on Dec. 12, 2014
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -23,9 +23,11 @@
 #define __LINKSIM_H__
 
 /* Defines */
+#define LINK_MAX_BATCH		64		/* frames of one frmBatch block */
 
 /* Headers */
 #include "comSim_types.h"
+#include "sweep.h"
 
 /* Data Structures */
 /* extern simParm_str linkSimParam;
@@ -39,6 +41,12 @@ char *param_file_default = "param_linkSim.dat";
 int linkSim_init();
 int linkSim_update(double snr);
 int linkSim_countErr();
+int linkSim_updateBatch(double snr, int numFrm);
+int linkSim_countErrBatch(int numFrm, int numErr[]);
 int linkSim_summary(double snr);
+int linkSim_semiAnalytic(double expErr[]);
+int linkSim_pipeline(int p);
+int linkSim_sweep(sweep_str *sw, const char *ckptFile, int ckptSec);
+int linkSim_merge(int num, char *fName[]);
 
 #endif /* __LINKSIM_H__ */
@@ -0,0 +1,356 @@
+/* File: linkSimProf.h
+ *
+ * Description: Per-stage hot path instrumentation of the link simulator
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Build with -DLINKSIM_PROF to enable. PROF_BEGIN()/PROF_END() then cost
+ * two time stamp counter reads and a few thread-local adds; without the
+ * define they expand to nothing. Allocations are attributed to the
+ * running stage when the binary is also linked with
+ *   -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=posix_memalign
+ * and LINKSIM_PROF_ALLOC is defined (see CMakeLists.txt).
+ */
+
+#ifndef __LINKSIMPROF_H__
+#define __LINKSIMPROF_H__
+
+/* Stages of the link simulation pipeline */
+enum{
+	PROF_SOURCE = 0,
+	PROF_ENCODER,
+	PROF_MAPPER,
+	PROF_CHANNEL,
+	PROF_DEMAPPER,
+	PROF_DECODER,
+	PROF_COUNTERR,
+	PROF_STATS,
+	PROF_TWIN,
+	NUM_PROF_STAGE,
+};
+
+#ifdef LINKSIM_PROF
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "comSim_types.h"
+
+/* Defines */
+#define PROF_MAX_THREADS	256
+#define PROF_BEGIN(stg)		prof_begin(stg)
+#define PROF_END(stg, n)	prof_end(stg, n)
+
+/* Per-stage counters */
+typedef struct{
+	unsigned long long cycles;
+	unsigned long long samples;
+	unsigned long long calls;
+	unsigned long long allocs;
+} profStage_str;
+
+/* One row of the dump: a stage at an SNR point */
+typedef struct{
+	double snrdB;
+	int stage;
+	profStage_str cnt;
+} profRow_str;
+
+/* Variables */
+static const char *profStageName[NUM_PROF_STAGE] = {
+	"source", "encoder", "mapper", "channel", "demapper", "decoder", "countErr",
+	"stats", "twin"};
+
+static _Thread_local profStage_str profTls[NUM_PROF_STAGE];
+static _Thread_local unsigned long long profStart[NUM_PROF_STAGE];
+static _Thread_local int profActive = -1;
+static _Thread_local int profRegistered = 0;
+
+static profStage_str *profThreads[PROF_MAX_THREADS];
+static int profNumThreads = 0;
+static profStage_str profRetired[NUM_PROF_STAGE];	// threads that have exited
+static pthread_mutex_t profLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t profKey;
+static pthread_once_t profKeyOnce = PTHREAD_ONCE_INIT;
+
+static profRow_str profRows[MAX_SNR_POINTS * NUM_PROF_STAGE];
+static int profNumRows = 0;
+
+/* Functions */
+
+static inline unsigned long long prof_tsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/* add the counters of src to dst */
+static void prof_add(profStage_str dst[NUM_PROF_STAGE], const profStage_str src[NUM_PROF_STAGE])
+{
+	int s;
+
+	for(s = 0; s < NUM_PROF_STAGE; s++){
+		dst[s].cycles += src[s].cycles;
+		dst[s].samples += src[s].samples;
+		dst[s].calls += src[s].calls;
+		dst[s].allocs += src[s].allocs;
+	}
+}
+
+/* thread exit: fold the counters of the thread into profRetired and drop
+   it from the list before its thread-local block goes away */
+static void prof_unregister(void *tls)
+{
+	int t;
+
+	pthread_mutex_lock(&profLock);
+	for(t = 0; t < profNumThreads; t++)
+		if(profThreads[t] == (profStage_str *)tls){
+			prof_add(profRetired, profThreads[t]);
+			profThreads[t] = profThreads[--profNumThreads];
+			break;
+		}
+	pthread_mutex_unlock(&profLock);
+}
+
+static void prof_keyInit(void)
+{
+	pthread_key_create(&profKey, prof_unregister);
+}
+
+/* make the counters of this thread visible to prof_collect() until the
+   thread exits */
+static void prof_register(void)
+{
+	pthread_once(&profKeyOnce, prof_keyInit);
+
+	pthread_mutex_lock(&profLock);
+	if(profNumThreads < PROF_MAX_THREADS){
+		profThreads[profNumThreads++] = profTls;
+		pthread_setspecific(profKey, profTls);
+	}
+	pthread_mutex_unlock(&profLock);
+	profRegistered = 1;
+}
+
+static inline void prof_begin(int stg)
+{
+	if(__builtin_expect(!profRegistered, 0))
+		prof_register();
+
+	profActive = stg;
+	profStart[stg] = prof_tsc();
+}
+
+static inline void prof_end(int stg, long samples)
+{
+	profTls[stg].cycles += prof_tsc() - profStart[stg];
+	profTls[stg].samples += samples;
+	profTls[stg].calls++;
+	profActive = -1;
+}
+
+/* function prof_collect()
+
+	Description: sum the counters of every thread, running or exited, into
+	             cnt[] and restart them; the caller must make sure no stage
+	             is running
+ */
+
+void prof_collect(profStage_str cnt[NUM_PROF_STAGE])
+{
+	int t;
+
+	pthread_mutex_lock(&profLock);
+	memcpy(cnt, profRetired, sizeof(profStage_str)*NUM_PROF_STAGE);
+	memset(profRetired, 0, sizeof(profRetired));
+	for(t = 0; t < profNumThreads; t++){
+		prof_add(cnt, profThreads[t]);
+		memset(profThreads[t], 0, sizeof(profStage_str)*NUM_PROF_STAGE);
+	}
+	pthread_mutex_unlock(&profLock);
+}
+
+/* time stamp counter ticks per ns, measured once */
+double prof_tscPerNs(void)
+{
+	static double ratio = 0.;
+	struct timespec ts0, ts1;
+	unsigned long long c0, c1;
+
+	if(ratio > 0.)
+		return ratio;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts0);
+	c0 = prof_tsc();
+	do
+		clock_gettime(CLOCK_MONOTONIC, &ts1);
+	while((ts1.tv_sec - ts0.tv_sec) * 1e9 + (ts1.tv_nsec - ts0.tv_nsec) < 2e7);
+	c1 = prof_tsc();
+
+	ratio = (c1 - c0) / ((ts1.tv_sec - ts0.tv_sec) * 1e9
+			+ (ts1.tv_nsec - ts0.tv_nsec));
+	return ratio;
+}
+
+/* function prof_summary()
+
+	Description: print the per-stage breakdown collected since the last
+	             call and keep it for prof_dump()
+ */
+
+void prof_summary(double snrdB)
+{
+	profStage_str cnt[NUM_PROF_STAGE];
+	unsigned long long total = 0;
+	double tscNs = prof_tscPerNs();
+	int s;
+
+	prof_collect(cnt);
+	for(s = 0; s < NUM_PROF_STAGE; s++)
+		total += cnt[s].cycles;
+
+	for(s = 0; s < NUM_PROF_STAGE; s++){
+		if(cnt[s].calls == 0)
+			continue;
+		printf("    %-9s %5.1f%%  %8.2f cyc/smp  %8.2f ns/smp  %llu calls  %llu allocs\n",
+				profStageName[s], total ? 100. * cnt[s].cycles / total : 0.,
+				cnt[s].samples ? (double)cnt[s].cycles / cnt[s].samples : 0.,
+				cnt[s].samples ? cnt[s].cycles / tscNs / cnt[s].samples : 0.,
+				cnt[s].calls, cnt[s].allocs);
+
+		if(profNumRows < MAX_SNR_POINTS * NUM_PROF_STAGE){
+			profRows[profNumRows].snrdB = snrdB;
+			profRows[profNumRows].stage = s;
+			profRows[profNumRows].cnt = cnt[s];
+			profNumRows++;
+		}
+	}
+}
+
+/* function prof_dump()
+
+	Description: write every row kept by prof_summary(); JSON if the file
+	             name ends with ".json", CSV otherwise
+
+	Return indicator:
+		0					Success
+		-1					Unable to open the file
+ */
+
+int prof_dump(const char *fName)
+{
+	const char *ext = strrchr(fName, '.');
+	int json = (ext != NULL && !strcmp(ext, ".json"));
+	double tscNs = prof_tscPerNs();
+	profRow_str *row;
+	FILE *file;
+	int r;
+
+	if((file = fopen(fName, "w")) == NULL){
+		printf("Unable to open profile dump file(%s)\n", fName);
+		return -1;
+	}
+
+	if(json)
+		fprintf(file, "{\n  \"tsc_per_ns\": %.6f,\n  \"stages\": [\n", tscNs);
+	else
+		fprintf(file, "snr_db,stage,cycles,samples,calls,allocs,cycles_per_sample,ns_per_sample\n");
+
+	for(r = 0; r < profNumRows; r++){
+		row = &profRows[r];
+		if(json)
+			fprintf(file, "    {\"snr_db\": %.3f, \"stage\": \"%s\", \"cycles\": %llu, "
+					"\"samples\": %llu, \"calls\": %llu, \"allocs\": %llu, "
+					"\"cycles_per_sample\": %.4f, \"ns_per_sample\": %.4f}%s\n",
+					row->snrdB, profStageName[row->stage], row->cnt.cycles,
+					row->cnt.samples, row->cnt.calls, row->cnt.allocs,
+					row->cnt.samples ? (double)row->cnt.cycles / row->cnt.samples : 0.,
+					row->cnt.samples ? row->cnt.cycles / tscNs / row->cnt.samples : 0.,
+					(r + 1 < profNumRows) ? "," : "");
+		else
+			fprintf(file, "%.3f,%s,%llu,%llu,%llu,%llu,%.4f,%.4f\n",
+					row->snrdB, profStageName[row->stage], row->cnt.cycles,
+					row->cnt.samples, row->cnt.calls, row->cnt.allocs,
+					row->cnt.samples ? (double)row->cnt.cycles / row->cnt.samples : 0.,
+					row->cnt.samples ? row->cnt.cycles / tscNs / row->cnt.samples : 0.);
+	}
+
+	if(json)
+		fprintf(file, "  ]\n}\n");
+	fclose(file);
+
+	return 0;
+}
+
+#ifdef LINKSIM_PROF_ALLOC
+/* Allocation counting through the linker's --wrap of the allocators */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int __real_posix_memalign(void **ptr, size_t align, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	if(profActive >= 0)
+		profTls[profActive].allocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+	if(profActive >= 0)
+		profTls[profActive].allocs++;
+	return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	if(profActive >= 0)
+		profTls[profActive].allocs++;
+	return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t align, size_t size)
+{
+	if(profActive >= 0)
+		profTls[profActive].allocs++;
+	return __real_posix_memalign(ptr, align, size);
+}
+#endif /* LINKSIM_PROF_ALLOC */
+
+#else /* !LINKSIM_PROF */
+
+#define PROF_BEGIN(stg)		((void)0)
+#define PROF_END(stg, n)	((void)0)
+
+#endif /* LINKSIM_PROF */
+
+#endif /* __LINKSIMPROF_H__ */
@@ -2,7 +2,7 @@
  *
  * Description: macros and routines for NCO
  * Copyright (C) 2011-2012, Jonghun John Park
- * Last updated on Jan. 25, 2012
+ * Last updated on Oct. 18, 2026
  *
  * This file is part of ComSim.
  * ComSim is free software: you can redistribute it and/or modify it
@@ -24,11 +24,15 @@
 #define __NCO_H__
 
 /* Headers */
+#include <stdio.h>
 #include <math.h>
+#include "comSim_types.h"
+#include "rng.h"
 
 /* Defines */
 #define PHASE_ACC_BITS	32
 #define	QT_PHASE_ACC_BITS	18
+#define NCO_2POW_M32		(1.0 / 4294967296.0)
 
 /* Static Values */
 //phase accumulator
@@ -145,6 +149,52 @@ int nco_complex(
 		phaseAcc &= (unsigned int)(pow(2, PHASE_ACC_BITS) - 1);
 		phaseAcc += (unsigned int)offset;
 	}
+
+	return 0;
+}
+
+/* phase increment of a frequency in cycles per sample, |freq| < 0.5;
+   negative frequencies wrap modulo 2^PHASE_ACC_BITS */
+static inline unsigned int nco_freq2inc(double freq)
+{
+	return (unsigned int)llround(freq * 4294967296.);
+}
+
+/* function nco_mix()
+
+	Description: multiply the samples in place by the NCO output
+	             exp(j 2 pi phase / 2^PHASE_ACC_BITS), the phase advancing
+	             by phaseInc per sample; one pass over x[] with no sine or
+	             cosine buffers. The phase of sample i is computed from
+	             *phase directly, so the loop vectorises.
+
+	Output parameters:
+		*x					mixed signal
+		*phase				phase accumulator at the next sample
+	input parameters:
+		len					signal length
+		phaseInc			phase increment, nco_freq2inc(); derotate by
+							mixing with -phaseInc from -(*phase)
+
+	Return indicator:
+		0					Success
+ */
+
+int nco_mix(complex *x, int len, unsigned int *phase, unsigned int phaseInc)
+{
+	const unsigned int p0 = *phase;
+	double sn, cs, re;
+	int i;
+
+	for(i = 0; i < len; i++){
+		rng_sincos2pi((double)(p0 + (unsigned int)i * phaseInc) * NCO_2POW_M32, &sn, &cs);
+		re = x[i].re;
+		x[i].re = re*cs - x[i].im*sn;
+		x[i].im = re*sn + x[i].im*cs;
+	}
+	*phase = p0 + (unsigned int)len * phaseInc;
+
+	return 0;
 }
 
 #endif
@@ -0,0 +1,298 @@
+/* File: ofdm.h
+ *
+ * Description: OFDM modulator/demodulator on the batched FFT of fft.h
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * An OFDM symbol carries numData mapper outputs (symMapper.h/constel.h)
+ * on the data subcarriers of an nFft point IFFT, followed by a cyclic
+ * prefix of lenCp samples taken from its tail. Unused bins, DC included,
+ * are zero. Time samples are scaled so that their mean power equals the
+ * mean power of the data symbols; after the demodulator a subcarrier then
+ * sees the sample noise variance times numData / nFft.
+ *
+ * Symbols are transformed OFDM_CHUNK at a time through one fft_batch()
+ * call each, so a frame of thousands of symbols costs a handful of calls
+ * and the per-call setup is spread over many transforms. The chunk of
+ * bins is the only buffer of the modem.
+ */
+
+#ifndef __OFDM_H__
+#define __OFDM_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "fft.h"
+
+/* Defines */
+#define OFDM_CHUNK			64		/* OFDM symbols per batched FFT call */
+
+typedef struct{
+	const fftPlan_str *plan;
+	int nFft;
+	int lenCp;
+	int lenSym;					// nFft + lenCp samples per OFDM symbol
+	int numData;				// data subcarriers per OFDM symbol
+	int *carrier;				// FFT bin of data subcarrier k
+	double gain;				// time domain gain after the 1/nFft IFFT
+	complex *freq;				// OFDM_CHUNK * nFft bins
+	int numThread;				// threads of every batched FFT call
+} ofdm_str;
+
+/* Functions */
+
+void ofdm_free(ofdm_str *ofdm)
+{
+	free(ofdm->carrier);
+	free(ofdm->freq);
+	memset(ofdm, 0, sizeof(ofdm_str));
+}
+
+/* function ofdm_init()
+
+	Description: nFft point OFDM with a cyclic prefix of lenCp samples and
+	             numData data subcarriers
+
+	input parameters:
+		carrier[]			FFT bins of the data subcarriers, numData of them;
+							NULL for the default layout: DC null, half of the
+							carriers on each side of it, guard bands at the
+							band edges
+		numThread			threads of the batched FFT calls
+
+	Return indicator:
+		0					Success
+		-1					Unsupported FFT size or layout
+		-2					Memory allocation error
+ */
+
+int ofdm_init(ofdm_str *ofdm, int nFft, int lenCp, int numData,
+		const int carrier[], int numThread)
+{
+	int k, half;
+
+	memset(ofdm, 0, sizeof(ofdm_str));
+	if((ofdm->plan = fft_getPlan(nFft)) == NULL)
+		return -1;
+	if(lenCp < 0 || lenCp > nFft || numData < 1 || numData > nFft
+			|| (carrier == NULL && numData > nFft - 1)){
+		printf("[ofdm] unsupported layout(nFft %d, lenCp %d, numData %d)\n",
+				nFft, lenCp, numData);
+		return -1;
+	}
+
+	ofdm->nFft = nFft;
+	ofdm->lenCp = lenCp;
+	ofdm->lenSym = nFft + lenCp;
+	ofdm->numData = numData;
+	ofdm->gain = nFft / sqrt((double)numData);
+	ofdm->numThread = (numThread < 1) ? 1 : numThread;
+
+	ofdm->carrier = (int *)malloc(sizeof(int)*numData);
+	ofdm->freq = (complex *)calloc((size_t)OFDM_CHUNK * nFft, sizeof(complex));
+	if(ofdm->carrier == NULL || ofdm->freq == NULL){
+		printf("[ofdm] fail to mem alloc\n");
+		ofdm_free(ofdm);
+		return -2;
+	}
+
+	if(carrier != NULL){
+		for(k = 0; k < numData; k++){
+			if(carrier[k] < 0 || carrier[k] >= nFft){
+				printf("[ofdm] subcarrier %d out of range\n", carrier[k]);
+				ofdm_free(ofdm);
+				return -1;
+			}
+			ofdm->carrier[k] = carrier[k];
+		}
+	} else {
+		/* negative frequencies first, so carrier[] runs low to high */
+		half = numData / 2;
+		for(k = 0; k < half; k++)
+			ofdm->carrier[k] = nFft - half + k;
+		for(k = half; k < numData; k++)
+			ofdm->carrier[k] = k - half + 1;
+	}
+
+	return 0;
+}
+
+/* function ofdm_mod()
+
+	Description: numSym OFDM symbols from numSym * numData mapper outputs
+
+	Output parameters:
+		out[]				numSym * lenSym samples, cyclic prefix first
+
+	Return indicator:
+		0					Success
+		-1					FFT failure
+ */
+
+int ofdm_mod(complex out[], const complex in[], int numSym, ofdm_str *ofdm)
+{
+	const int N = ofdm->nFft, D = ofdm->numData, cp = ofdm->lenCp;
+	const double g = ofdm->gain;
+	complex *f, *o;
+	int s, c, num, k;
+
+	for(s = 0; s < numSym; s += num){
+		num = (numSym - s < OFDM_CHUNK) ? numSym - s : OFDM_CHUNK;
+
+		for(c = 0; c < num; c++){
+			f = ofdm->freq + (long)c*N;
+			memset(f, 0, sizeof(complex)*N);
+			for(k = 0; k < D; k++){
+				f[ofdm->carrier[k]].re = g * in[(long)(s+c)*D + k].re;
+				f[ofdm->carrier[k]].im = g * in[(long)(s+c)*D + k].im;
+			}
+		}
+
+		/* IFFT straight behind each prefix, then copy the tail in front */
+		o = out + (long)s*ofdm->lenSym;
+		if(fft_batch(ofdm->plan, o + cp, ofdm->lenSym, ofdm->freq, N, num,
+					FFT_INVERSE, ofdm->numThread) < 0)
+			return -1;
+		for(c = 0; c < num; c++)
+			memcpy(o + (long)c*ofdm->lenSym, o + (long)c*ofdm->lenSym + N,
+					sizeof(complex)*cp);
+	}
+
+	return 0;
+}
+
+/* function ofdm_demod()
+
+	Description: drop the cyclic prefix of numSym OFDM symbols starting at
+	             in[0], FFT and pick the data subcarriers
+
+	Output parameters:
+		out[]				numSym * numData data subcarriers
+
+	Return indicator:
+		0					Success
+		-1					FFT failure
+ */
+
+int ofdm_demod(complex out[], const complex in[], int numSym, ofdm_str *ofdm)
+{
+	const int N = ofdm->nFft, D = ofdm->numData;
+	const double g = 1. / ofdm->gain;
+	const complex *f;
+	int s, c, num, k;
+
+	for(s = 0; s < numSym; s += num){
+		num = (numSym - s < OFDM_CHUNK) ? numSym - s : OFDM_CHUNK;
+
+		if(fft_batch(ofdm->plan, ofdm->freq, N,
+					in + (long)s*ofdm->lenSym + ofdm->lenCp, ofdm->lenSym,
+					num, FFT_FORWARD, ofdm->numThread) < 0)
+			return -1;
+
+		for(c = 0; c < num; c++){
+			f = ofdm->freq + (long)c*N;
+			for(k = 0; k < D; k++){
+				out[(long)(s+c)*D + k].re = g * f[ofdm->carrier[k]].re;
+				out[(long)(s+c)*D + k].im = g * f[ofdm->carrier[k]].im;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* function ofdm_freqResp()
+
+	Description: response of the data subcarriers to the channel impulse
+	             response h[0 .. lenH-1], in samples; lenH - 1 <= lenCp
+	             keeps the subcarriers orthogonal
+
+	Output parameters:
+		H[]					numData subcarrier gains
+
+	Return indicator:
+		0					Success
+		-1					Impulse response longer than the FFT
+ */
+
+int ofdm_freqResp(complex H[], const complex h[], int lenH, ofdm_str *ofdm)
+{
+	complex *f = ofdm->freq;
+	int k;
+
+	if(lenH > ofdm->nFft){
+		printf("[ofdm] impulse response longer than the FFT(%d)\n", lenH);
+		return -1;
+	}
+
+	memcpy(f, h, sizeof(complex)*lenH);
+	memset(f + lenH, 0, sizeof(complex)*(ofdm->nFft - lenH));
+	fft_exec(ofdm->plan, f, f, FFT_FORWARD);
+	for(k = 0; k < ofdm->numData; k++)
+		H[k] = f[ofdm->carrier[k]];
+
+	return 0;
+}
+
+/* function ofdm_equalize()
+
+	Description: one tap equaliser per subcarrier on numSym demodulated
+	             symbols, in place; zero forcing conj(H) / |H|^2 for
+	             var = 0, MMSE conj(H) / (|H|^2 + var) otherwise
+
+	input parameters:
+		H[]					numData subcarrier gains, constant over the symbols
+		var					noise variance per subcarrier (the sample noise
+							variance times numData / nFft)
+
+	Output parameters:
+		csi[]				|H|^2 per subcarrier, NULL to skip; after zero
+							forcing subcarrier k has noise variance var/csi[k]
+ */
+
+int ofdm_equalize(complex sym[], int numSym, const complex H[], double var,
+		double csi[], ofdm_str *ofdm)
+{
+	const int D = ofdm->numData;
+	complex *w = ofdm->freq, *y;
+	double p, re;
+	long s;
+	int k;
+
+	/* weights in the scratch bins, numData <= nFft */
+	for(k = 0; k < D; k++){
+		p = H[k].re*H[k].re + H[k].im*H[k].im;
+		w[k].re = (p + var > 0.) ? H[k].re / (p + var) : 0.;
+		w[k].im = (p + var > 0.) ? -H[k].im / (p + var) : 0.;
+		if(csi != NULL)
+			csi[k] = p;
+	}
+
+	for(s = 0; s < numSym; s++){
+		y = sym + s*D;
+		for(k = 0; k < D; k++){
+			re = y[k].re;
+			y[k].re = re*w[k].re - y[k].im*w[k].im;
+			y[k].im = re*w[k].im + y[k].im*w[k].re;
+		}
+	}
+
+	return 0;
+}
+
+#endif /* __OFDM_H__ */
@@ -0,0 +1,661 @@
+/* File: pipeline.h
+ *
+ * Description: Block dataflow scheduler for TX -> channel -> RX chains
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * A pipeline is a chain of stages. The stream is cut into blocks of a few
+ * thousand symbols that are small enough to stay in L2; a block carries
+ * its source bits, samples and decisions and visits every stage in turn,
+ * so a long frame is no longer streamed through memory once per stage.
+ * With one thread the blocks run through the whole chain one by one. With
+ * more threads the chain is split into contiguous groups of stages, one
+ * thread each, connected by bounded single-producer single-consumer rings;
+ * the last group hands the block back to the first through the free ring,
+ * which bounds the memory in flight to PIPE_NUM_BLOCKS blocks.
+ */
+
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "comSim_types.h"
+#include "constel.h"
+#include "compBuf.h"
+#include "awgn.h"
+#include "fir.h"
+#include "crc.h"
+#include "dataGen.h"
+#include "prbs.h"
+#include "iqFile.h"
+#include "carrier.h"
+#include "stats.h"
+#include "linkSimProf.h"
+
+/* Defines */
+#define PIPE_MAX_STAGES		16
+#define PIPE_BLOCK_SYM		2048	/* default block, ~100 KiB in flight per block */
+#define PIPE_NUM_BLOCKS		8		/* blocks in flight, power of two */
+#define PIPE_SPIN			64		/* busy polls before yielding the core */
+#define PIPE_NO_PROF		-1
+
+/* One block of the stream */
+typedef struct{
+	long seq;					// block number
+	long offset;				// first symbol of the block in the stream
+	int lenSym;					// symbols in this block
+	int lenBit;					// source bits in this block
+	int *bit;					// source bits
+	complex *sym;				// samples, transformed in place stage by stage
+	int *dec;					// decided bits
+	complex *symBuf;			// the block's own samples; a source stage may
+								// point sym at a mapped capture chunk instead
+} pipeBlk_str;
+
+/* A stage works in place on a block; < 0 aborts the run */
+typedef int (*pipeProc_t)(void *ctx, pipeBlk_str *blk);
+
+typedef struct{
+	const char *name;
+	pipeProc_t proc;
+	void *ctx;
+	int profId;					// PROF_* stage or PIPE_NO_PROF
+} pipeStage_str;
+
+/* Bounded single-producer single-consumer ring of blocks */
+typedef struct{
+	_Alignas(64) atomic_size_t head;	// next write, producer side
+	_Alignas(64) atomic_size_t tail;	// next read, consumer side
+	_Alignas(64) pipeBlk_str *slot[PIPE_NUM_BLOCKS];
+} pipeRing_str;
+
+typedef struct{
+	int numStage;
+	pipeStage_str stage[PIPE_MAX_STAGES];
+	int blkSym;					// symbols per block
+	int maxBits;				// bits per symbol the blocks are sized for
+	pipeBlk_str blk[PIPE_NUM_BLOCKS];
+	pipeRing_str ring[PIPE_MAX_STAGES];	// ring[g] feeds group g, ring[0] is the free ring
+	long totalSym;
+	long numBlk;
+	atomic_int status;
+	atomic_int go;				// 1 start, -1 abandon the workers
+} pipe_str;
+
+/* Work of one thread: stages [first, last) */
+typedef struct{
+	pipe_str *pipe;
+	int group, numGroup;
+	int first, last;
+} pipeGroup_str;
+
+/* Functions */
+
+/***********************************
+ * Rings                           *
+ ***********************************/
+
+static void pipe_wait(int *spin)
+{
+	if(++(*spin) >= PIPE_SPIN){
+		sched_yield();
+		*spin = 0;
+	}
+}
+
+static void pipeRing_push(pipeRing_str *ring, pipeBlk_str *blk)
+{
+	size_t h = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	int spin = 0;
+
+	while(h - atomic_load_explicit(&ring->tail, memory_order_acquire) >= PIPE_NUM_BLOCKS)
+		pipe_wait(&spin);
+
+	ring->slot[h % PIPE_NUM_BLOCKS] = blk;
+	atomic_store_explicit(&ring->head, h + 1, memory_order_release);
+}
+
+static pipeBlk_str *pipeRing_pop(pipeRing_str *ring)
+{
+	size_t t = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	pipeBlk_str *blk;
+	int spin = 0;
+
+	while(atomic_load_explicit(&ring->head, memory_order_acquire) == t)
+		pipe_wait(&spin);
+
+	blk = ring->slot[t % PIPE_NUM_BLOCKS];
+	atomic_store_explicit(&ring->tail, t + 1, memory_order_release);
+
+	return blk;
+}
+
+/***********************************
+ * Pipeline                        *
+ ***********************************/
+
+/* function pipe_init()
+
+	Description: allocate the blocks of an empty pipeline
+
+	input parameters:
+		blkSym				symbols per block, 0 for PIPE_BLOCK_SYM
+		maxBits				largest bits per symbol of the chain
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+ */
+
+int pipe_init(pipe_str *pipe, int blkSym, int maxBits)
+{
+	int b;
+
+	memset(pipe, 0, sizeof(pipe_str));
+	pipe->blkSym = blkSym > 0 ? blkSym : PIPE_BLOCK_SYM;
+	pipe->maxBits = maxBits;
+
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++){
+		pipe->blk[b].bit = (int *)compBuf_alignedAlloc(sizeof(int)*pipe->blkSym*maxBits);
+		pipe->blk[b].dec = (int *)compBuf_alignedAlloc(sizeof(int)*pipe->blkSym*maxBits);
+		pipe->blk[b].symBuf = (complex *)compBuf_alignedAlloc(sizeof(complex)*pipe->blkSym);
+		pipe->blk[b].sym = pipe->blk[b].symBuf;
+
+		if(pipe->blk[b].bit == NULL || pipe->blk[b].dec == NULL
+				|| pipe->blk[b].symBuf == NULL){
+			printf("[pipe] fail to mem alloc\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void pipe_free(pipe_str *pipe)
+{
+	int b;
+
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++){
+		free(pipe->blk[b].bit);
+		free(pipe->blk[b].dec);
+		free(pipe->blk[b].symBuf);
+	}
+	memset(pipe, 0, sizeof(pipe_str));
+}
+
+/* function pipe_addStage()
+
+	Description: append a stage to the chain; stages run in the order added
+
+	Return indicator:
+		0					Success
+		-1					Too many stages
+ */
+
+int pipe_addStage(pipe_str *pipe, const char *name, pipeProc_t proc, void *ctx,
+		int profId)
+{
+	pipeStage_str *stg;
+
+	if(pipe->numStage >= PIPE_MAX_STAGES){
+		printf("[pipe] too many stages(%s)\n", name);
+		return -1;
+	}
+
+	stg = &pipe->stage[pipe->numStage++];
+	stg->name = name;
+	stg->proc = proc;
+	stg->ctx = ctx;
+	stg->profId = profId;
+
+	return 0;
+}
+
+/* run stages [first, last) on one block */
+static void pipe_process(pipe_str *pipe, pipeBlk_str *blk, int first, int last)
+{
+	pipeStage_str *stg;
+	int s, ret;
+
+	for(s = first; s < last; s++){
+		if(atomic_load_explicit(&pipe->status, memory_order_relaxed) < 0)
+			return;
+
+		stg = &pipe->stage[s];
+		if(stg->profId >= 0)
+			PROF_BEGIN(stg->profId);
+		ret = stg->proc(stg->ctx, blk);
+		if(stg->profId >= 0)
+			PROF_END(stg->profId, blk->lenSym);
+
+		if(ret < 0){
+			printf("[pipe] stage(%s) failed at block %ld\n", stg->name, blk->seq);
+			atomic_store(&pipe->status, -1);
+		}
+	}
+}
+
+/* the first group numbers the blocks, every group sees them in order */
+static void *pipe_groupMain(void *arg)
+{
+	pipeGroup_str *grp = (pipeGroup_str *)arg;
+	pipe_str *pipe = grp->pipe;
+	pipeRing_str *in = &pipe->ring[grp->group];
+	pipeRing_str *out = &pipe->ring[(grp->group + 1) % grp->numGroup];
+	pipeBlk_str *blk;
+	long n;
+	int spin = 0;
+
+	while(grp->group > 0 && atomic_load(&pipe->go) == 0)
+		pipe_wait(&spin);
+	if(atomic_load(&pipe->go) < 0)
+		return NULL;
+
+	for(n = 0; n < pipe->numBlk; n++){
+		blk = pipeRing_pop(in);
+
+		if(grp->group == 0){
+			blk->seq = n;
+			blk->offset = n * pipe->blkSym;
+			blk->lenSym = (pipe->totalSym - blk->offset < pipe->blkSym) ?
+				(int)(pipe->totalSym - blk->offset) : pipe->blkSym;
+			blk->lenBit = 0;
+			blk->sym = blk->symBuf;
+		}
+
+		pipe_process(pipe, blk, grp->first, grp->last);
+		pipeRing_push(out, blk);
+	}
+
+	return NULL;
+}
+
+/* function pipe_run()
+
+	Description: push totalSym symbols through the chain in blocks
+
+	input parameters:
+		totalSym			symbols of the whole stream
+		numThread			threads, at most one per stage; 1 runs inline
+
+	Return indicator:
+		0					Success
+		-1					A stage failed or a thread could not start
+ */
+
+int pipe_run(pipe_str *pipe, long totalSym, int numThread)
+{
+	pipeGroup_str grp[PIPE_MAX_STAGES];
+	pthread_t tid[PIPE_MAX_STAGES];
+	pipeBlk_str *blk;
+	int g, b, numGroup;
+	long n;
+
+	pipe->totalSym = totalSym;
+	pipe->numBlk = (totalSym + pipe->blkSym - 1) / pipe->blkSym;
+	atomic_store(&pipe->status, 0);
+
+	numGroup = numThread < 1 ? 1 : numThread;
+	if(numGroup > pipe->numStage)
+		numGroup = pipe->numStage;
+
+	if(numGroup <= 1){
+		for(n = 0; n < pipe->numBlk; n++){
+			blk = &pipe->blk[n % PIPE_NUM_BLOCKS];
+			blk->seq = n;
+			blk->offset = n * pipe->blkSym;
+			blk->lenSym = (totalSym - blk->offset < pipe->blkSym) ?
+				(int)(totalSym - blk->offset) : pipe->blkSym;
+			blk->lenBit = 0;
+			blk->sym = blk->symBuf;
+			pipe_process(pipe, blk, 0, pipe->numStage);
+		}
+		return atomic_load(&pipe->status);
+	}
+
+	for(g = 0; g < numGroup; g++){
+		atomic_init(&pipe->ring[g].head, 0);
+		atomic_init(&pipe->ring[g].tail, 0);
+		grp[g].pipe = pipe;
+		grp[g].group = g;
+		grp[g].numGroup = numGroup;
+		grp[g].first = g * pipe->numStage / numGroup;
+		grp[g].last = (g + 1) * pipe->numStage / numGroup;
+	}
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++)
+		pipeRing_push(&pipe->ring[0], &pipe->blk[b]);
+
+	/* the workers wait for go so a failed start can fall back to inline */
+	atomic_store(&pipe->go, 0);
+	for(g = 1; g < numGroup; g++)
+		if(pthread_create(&tid[g], NULL, pipe_groupMain, &grp[g]) != 0){
+			printf("[pipe] fail to start thread %d, running inline\n", g);
+			atomic_store(&pipe->go, -1);
+			while(--g >= 1)
+				pthread_join(tid[g], NULL);
+			return pipe_run(pipe, totalSym, 1);
+		}
+	atomic_store(&pipe->go, 1);
+	pipe_groupMain(&grp[0]);
+
+	for(g = 1; g < numGroup; g++)
+		pthread_join(tid[g], NULL);
+
+	return atomic_load(&pipe->status);
+}
+
+/***********************************
+ * Stages                          *
+ ***********************************/
+
+/* uniform source bits of genBitSource(); ctx is the constel_str of the
+   mapper */
+int pipeStage_source(void *ctx, pipeBlk_str *blk)
+{
+	const constel_str *cons = (const constel_str *)ctx;
+
+	blk->lenBit = blk->lenSym * cons->bitsPerSym;
+
+	return genBitSource(blk->bit, blk->lenBit);
+}
+
+/* PRBS source bits, block offset times bitsPerSym into the sequence */
+typedef struct{
+	prbs_str prbs;
+	int bitsPerSym;
+} pipePrbs_str;
+
+int pipeStage_prbs(void *ctx, pipeBlk_str *blk)
+{
+	pipePrbs_str *pp = (pipePrbs_str *)ctx;
+
+	blk->lenBit = blk->lenSym * pp->bitsPerSym;
+	prbs_seek(&pp->prbs, (unsigned long long)blk->offset * pp->bitsPerSym);
+	prbs_bits(&pp->prbs, blk->bit, blk->lenBit);
+
+	return 0;
+}
+
+/* ctx is the constel_str */
+int pipeStage_mapper(void *ctx, pipeBlk_str *blk)
+{
+	int len;
+
+	return mapConstel(&len, blk->sym, blk->lenBit, blk->bit, (const constel_str *)ctx);
+}
+
+/* Exact noise of ch_awgn_complexRng(); block seq draws from the rng.h
+   stream stream + seq of seed, so the noise of a block does not depend on
+   the thread that runs it or on the blocks before it */
+typedef struct{
+	double var;					// complex noise variance
+	unsigned long long seed;
+	unsigned long long stream;	// stream of block 0
+} pipeAwgn_str;
+
+int pipeStage_awgn(void *ctx, pipeBlk_str *blk)
+{
+	const pipeAwgn_str *aw = (const pipeAwgn_str *)ctx;
+	rng_str rng;
+
+	rng_init(&rng, aw->seed, aw->stream + (unsigned long long)blk->seq);
+
+	return ch_awgn_complexRng(blk->sym, blk->lenSym, aw->var, &rng);
+}
+
+/* Pool noise of ch_awgn_complexPool(), offsets drawn from rng block by
+   block; touch awgn_poolGet() before a threaded run */
+typedef struct{
+	double var;					// complex noise variance
+	rng_str rng;
+} pipeAwgnPool_str;
+
+int pipeStage_awgnPool(void *ctx, pipeBlk_str *blk)
+{
+	pipeAwgnPool_str *ap = (pipeAwgnPool_str *)ctx;
+
+	return ch_awgn_complexPool(blk->sym, blk->lenSym, ap->var, &ap->rng);
+}
+
+/* ctx is the constel_str */
+int pipeStage_hd(void *ctx, pipeBlk_str *blk)
+{
+	int len;
+
+	return ConstelHd(&len, blk->dec, blk->lenSym, blk->sym, (const constel_str *)ctx);
+}
+
+/* ctx is a stats_str initialised with the constellation; compares the
+   symbols of the block with the ones its bits map to */
+int pipeStage_stats(void *ctx, pipeBlk_str *blk)
+{
+	stats_runBits((stats_str *)ctx, blk->sym, blk->bit, blk->lenSym);
+
+	return 0;
+}
+
+/* samples of a capture opened with iqSrc_open(.., maxChunk >= block);
+   cf64 blocks point into the mapping when all blocks in flight fit in
+   the mapped windows, the rest is converted into the block */
+int pipeStage_iqSource(void *ctx, pipeBlk_str *blk)
+{
+	iqSrc_str *src = (iqSrc_str *)ctx;
+	complex *chunk;
+	long n;
+
+	if(src->buf == NULL && (long)blk->lenSym * PIPE_NUM_BLOCKS <= IQ_WINDOW){
+		n = iqSrc_next(src, &chunk, blk->lenSym);
+		blk->sym = chunk;
+	} else
+		n = iqSrc_read(src, blk->sym, blk->lenSym);
+
+	return (n == blk->lenSym) ? 0 : -1;
+}
+
+/* ctx is an iqSink_str; appends the samples of the block */
+int pipeStage_iqSink(void *ctx, pipeBlk_str *blk)
+{
+	return iqSink_write((iqSink_str *)ctx, blk->sym, blk->lenSym);
+}
+
+/* ctx is the carrierImp_str; blocks rotate in order, so the phase walk
+   continues across them */
+int pipeStage_carrierImpair(void *ctx, pipeBlk_str *blk)
+{
+	return carrier_impair(blk->sym, blk->lenSym, (carrierImp_str *)ctx);
+}
+
+/* ctx is the costas_str; symbols are derotated in place */
+int pipeStage_costas(void *ctx, pipeBlk_str *blk)
+{
+	return costas_run(blk->sym, blk->lenSym, (costas_str *)ctx);
+}
+
+/* Streaming real-tap FIR, the history carries over block boundaries;
+   symmetric taps, e.g. a pulse_get() matched filter, go through the
+   folded fir_sym() */
+typedef struct{
+	const double *h;
+	int lenH;
+	int sym;					// h[k] == h[lenH-1-k]
+	complex *work;				// lenH-1 history samples followed by the block
+} pipeFir_str;
+
+int pipeFir_init(pipeFir_str *fir, const double *h, int lenH, int blkSym)
+{
+	fir->h = h;
+	fir->lenH = lenH;
+	fir->sym = fir_isSym(h, lenH);
+	fir->work = (complex *)compBuf_alignedAlloc(sizeof(complex)*(lenH - 1 + blkSym));
+	if(fir->work == NULL){
+		printf("[pipe] fail to mem alloc\n");
+		return -1;
+	}
+	memset(fir->work, 0, sizeof(complex)*(lenH - 1));
+
+	return 0;
+}
+
+void pipeFir_free(pipeFir_str *fir)
+{
+	free(fir->work);
+	fir->work = NULL;
+}
+
+int pipeStage_fir(void *ctx, pipeBlk_str *blk)
+{
+	pipeFir_str *fir = (pipeFir_str *)ctx;
+	const double *h = fir->h;
+	complex *w = fir->work, *y = blk->sym;
+	int lenH = fir->lenH, n, k;
+	double re, im;
+
+	memcpy(w + lenH - 1, blk->sym, sizeof(complex)*blk->lenSym);
+	if(fir->sym){
+		fir_sym(y, w, blk->lenSym, 1, h, lenH);
+		memmove(w, w + blk->lenSym, sizeof(complex)*(lenH - 1));
+		return 0;
+	}
+	for(n = 0; n < blk->lenSym; n++){
+		re = im = 0.;
+		for(k = 0; k < lenH; k++){
+			re += h[k] * w[n + lenH - 1 - k].re;
+			im += h[k] * w[n + lenH - 1 - k].im;
+		}
+		y[n].re = re;
+		y[n].im = im;
+	}
+	memmove(w, w + blk->lenSym, sizeof(complex)*(lenH - 1));
+
+	return 0;
+}
+
+/* Error counter, frames of lenFrm bits may straddle blocks */
+typedef struct{
+	long lenFrm;
+	long pos;					// bit position in the current frame
+	int frmErr;					// current frame has an error
+	long numBit;
+	long numBitErr;
+	long numFrmErr;
+} pipeErr_str;
+
+void pipeErr_init(pipeErr_str *err, long lenFrm)
+{
+	memset(err, 0, sizeof(pipeErr_str));
+	err->lenFrm = lenFrm;
+}
+
+int pipeStage_countErr(void *ctx, pipeBlk_str *blk)
+{
+	pipeErr_str *err = (pipeErr_str *)ctx;
+	int i, e;
+
+	for(i = 0; i < blk->lenBit; i++){
+		e = blk->bit[i] ^ blk->dec[i];
+		err->numBitErr += e;
+		err->frmErr |= e;
+		if(++err->pos == err->lenFrm){
+			err->numFrmErr += err->frmErr;
+			err->frmErr = 0;
+			err->pos = 0;
+		}
+	}
+	err->numBit += blk->lenBit;
+
+	return 0;
+}
+
+/* CRC of frames of lenFrm bits whose last width bits carry the CRC of the
+   bits before them; frames may straddle blocks. One context per stage. */
+typedef struct{
+	const crc_str *crc;
+	long lenFrm;
+	long pos;					// bit position in the current frame
+	unsigned int reg;			// register over the payload so far
+	unsigned int val;			// CRC of the payload, once complete
+	int fail;					// current frame fails the check
+	long numFrm;
+	long numFrmFail;			// frames failing the check
+} pipeCrc_str;
+
+void pipeCrc_init(pipeCrc_str *pc, const crc_str *crc, long lenFrm)
+{
+	memset(pc, 0, sizeof(pipeCrc_str));
+	pc->crc = crc;
+	pc->lenFrm = lenFrm;
+	pc->reg = crc_begin(crc);
+}
+
+/* walk the block: payload runs go through the byte kernel, CRC positions
+   are written (attach) or compared (check) */
+static void pipeCrc_run(pipeCrc_str *pc, int bit[], int len, int attach)
+{
+	const crc_str *crc = pc->crc;
+	long lenIn = pc->lenFrm - crc->width, n;
+	int i = 0, k;
+
+	while(i < len){
+		if(pc->pos < lenIn){
+			n = (lenIn - pc->pos < len - i) ? lenIn - pc->pos : len - i;
+			pc->reg = crc_updateBits(crc, pc->reg, bit + i, n);
+			pc->pos += n;
+			i += n;
+			if(pc->pos == lenIn)
+				pc->val = crc_end(crc, pc->reg);
+			continue;
+		}
+
+		k = (int)(pc->pos - lenIn);
+		if(attach)
+			bit[i] = crc_bit(crc, pc->val, k);
+		else
+			pc->fail |= bit[i] ^ crc_bit(crc, pc->val, k);
+		i++;
+		if(++pc->pos == pc->lenFrm){
+			pc->numFrm++;
+			pc->numFrmFail += pc->fail;
+			pc->fail = 0;
+			pc->pos = 0;
+			pc->reg = crc_begin(crc);
+		}
+	}
+}
+
+/* ctx is a pipeCrc_str; overwrites the tail of every frame of source bits */
+int pipeStage_crcAttach(void *ctx, pipeBlk_str *blk)
+{
+	pipeCrc_run((pipeCrc_str *)ctx, blk->bit, blk->lenBit, 1);
+	return 0;
+}
+
+/* ctx is a pipeCrc_str; counts the frames of decided bits failing the CRC,
+   no reference bits needed */
+int pipeStage_crcCheck(void *ctx, pipeBlk_str *blk)
+{
+	pipeCrc_run((pipeCrc_str *)ctx, blk->dec, blk->lenBit, 0);
+	return 0;
+}
+
+#endif /* __PIPELINE_H__ */
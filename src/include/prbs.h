@@ -0,0 +1,285 @@
+/* File: prbs.h
+ *
+ * Description: Word-parallel PRBS / LFSR bit sources with jump-ahead
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * A Fibonacci LFSR of degree deg <= 32 with generator 1 + sum x^k emits
+ * s(n) = xor of s(n-k) over the taps k; the register holds the last deg
+ * bits, s(n-1-j) in bit j. Both the next 64 output bits and the register
+ * 64 steps later are linear in the register, so they are the xor of
+ * one table entry per register byte: a 64-bit step costs eight loads
+ * instead of 64 shifts. The register pos bits later is the register
+ * times A^pos, applied with the tabulated powers A^(2^k) of the one step
+ * matrix, so any offset is reached in at most 64 matrix-vector products.
+ *
+ * The presets are the ITU-T O.150 generators, not inverted. Bits come
+ * out LSB first: bit i of a word is the i-th bit in time.
+ */
+
+#ifndef __PRBS_H__
+#define __PRBS_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Defines */
+#define PRBS_MAX_DEG		32		/* register bits */
+
+/* Presets */
+enum{
+	PRBS_NONE = 0,
+	PRBS_7,						// x^7 + x^6 + 1
+	PRBS_9,						// x^9 + x^5 + 1
+	PRBS_15,					// x^15 + x^14 + 1
+	PRBS_23,					// x^23 + x^18 + 1
+	PRBS_31,					// x^31 + x^28 + 1
+	NUM_PRBS_TYPE,
+};
+
+/* Generator tables, shared read only by any number of sources */
+typedef struct{
+	int deg;
+	unsigned int taps;				// bit k-1 for the x^k term, k = 1 .. deg
+	unsigned int mask;				// deg register bits
+	unsigned long long out[4][256];	// next 64 bits, per register byte
+	unsigned int next[4][256];		// register 64 steps later, per byte
+	unsigned int jump[64][PRBS_MAX_DEG];	// column j of A^(2^k)
+} prbsGen_str;
+
+typedef struct{
+	const prbsGen_str *gen;
+	unsigned int init;			// register at bit 0
+	unsigned int state;			// register at the next bit
+	unsigned long long pos;		// position of the next bit
+} prbs_str;
+
+/* Functions */
+
+/* one step of the register, the new bit in bit 0 */
+static inline unsigned int prbs_step(const prbsGen_str *gen, unsigned int reg)
+{
+	unsigned int b = (unsigned int)__builtin_parity(reg & gen->taps);
+
+	return ((reg << 1) | b) & gen->mask;
+}
+
+/* register times a matrix of PRBS_MAX_DEG columns, the ones beyond deg
+   zero; masked rather than branched on, so it vectorises */
+static inline unsigned int prbs_apply(const unsigned int col[], unsigned int reg)
+{
+	unsigned int r = 0;
+	int j;
+
+	for(j = 0; j < PRBS_MAX_DEG; j++)
+		r ^= col[j] & (0u - ((reg >> j) & 1));
+
+	return r;
+}
+
+/* function prbsGen_init()
+
+	Description: tables of the LFSR with generator 1 + sum of x^k over the
+	             bits k of poly, k = 1 .. deg; bit deg must be set, except
+	             for deg 32, whose x^32 term does not fit and is implied
+
+	Return indicator:
+		0					Success
+		-1					Unsupported generator
+ */
+
+int prbsGen_init(prbsGen_str *gen, int deg, unsigned int poly)
+{
+	unsigned long long o;
+	unsigned int r;
+	int j, k, v;
+
+	if(deg < 2 || deg > PRBS_MAX_DEG
+			|| (deg < 32 && (poly >> deg) != 1)){
+		printf("[prbs] unsupported generator, degree %d poly 0x%x\n", deg, poly);
+		return -1;
+	}
+
+	memset(gen, 0, sizeof(prbsGen_str));
+	gen->deg = deg;
+	gen->taps = (poly >> 1) | (1u << (deg - 1));
+	gen->mask = (deg == 32) ? 0xffffffffu : (1u << deg) - 1;
+
+	/* unit registers through 64 steps: output word and final register;
+	   bytes above deg keep all-zero tables, indexed by 0 only */
+	for(j = 0; j < deg; j++){
+		r = 1u << j;
+		for(o = 0, k = 0; k < 64; k++){
+			r = prbs_step(gen, r);
+			o |= (unsigned long long)(r & 1) << k;
+		}
+		for(v = 0; v < 256; v++)
+			if((v >> (j & 7)) & 1){
+				gen->out[j >> 3][v] ^= o;
+				gen->next[j >> 3][v] ^= r;
+			}
+		gen->jump[0][j] = prbs_step(gen, 1u << j);
+	}
+
+	/* A^(2^k) = A^(2^(k-1)) A^(2^(k-1)) */
+	for(k = 1; k < 64; k++)
+		for(j = 0; j < deg; j++)
+			gen->jump[k][j] = prbs_apply(gen->jump[k-1], gen->jump[k-1][j]);
+
+	return 0;
+}
+
+int prbsGen_initPreset(prbsGen_str *gen, int type)
+{
+	switch(type){
+		case PRBS_7:
+			return prbsGen_init(gen, 7, (1u << 7) | (1u << 6));
+		case PRBS_9:
+			return prbsGen_init(gen, 9, (1u << 9) | (1u << 5));
+		case PRBS_15:
+			return prbsGen_init(gen, 15, (1u << 15) | (1u << 14));
+		case PRBS_23:
+			return prbsGen_init(gen, 23, (1u << 23) | (1u << 18));
+		case PRBS_31:
+			return prbsGen_init(gen, 31, (1u << 31) | (1u << 28));
+		default:
+			printf("[prbs] unknown preset %d\n", type);
+			return -1;
+	}
+}
+
+/* function prbs_getGen()
+
+	Description: preset tables generated once on first use
+
+	Return indicator:
+		!NULL				Cached generator
+		NULL				Unknown preset
+
+	Caution:
+		first use of each preset is not thread safe; touch it before
+		spawning worker threads
+ */
+
+static prbsGen_str *prbsCache[NUM_PRBS_TYPE];
+
+const prbsGen_str *prbs_getGen(int type)
+{
+	prbsGen_str *gen;
+
+	if(type <= PRBS_NONE || type >= NUM_PRBS_TYPE)
+		return NULL;
+	if(prbsCache[type] != NULL)
+		return prbsCache[type];
+
+	if((gen = (prbsGen_str *)malloc(sizeof(prbsGen_str))) == NULL){
+		printf("[prbs] fail to mem alloc\n");
+		return NULL;
+	}
+	if(prbsGen_initPreset(gen, type) < 0){
+		free(gen);
+		return NULL;
+	}
+
+	return prbsCache[type] = gen;
+}
+
+/* source at bit 0 of the sequence from register seed, all ones for 0 */
+void prbs_init(prbs_str *pr, const prbsGen_str *gen, unsigned int seed)
+{
+	pr->gen = gen;
+	pr->init = seed & gen->mask;
+	if(pr->init == 0)
+		pr->init = gen->mask;
+	pr->state = pr->init;
+	pr->pos = 0;
+}
+
+/* jump to bit pos of the sequence, forward from the current bit when
+   that is shorter; a source read frame after frame does not move */
+void prbs_seek(prbs_str *pr, unsigned long long pos)
+{
+	unsigned long long n = pos;
+	unsigned int r = pr->init;
+	int k;
+
+	if(pos == pr->pos)
+		return;
+	if(pos > pr->pos && pos - pr->pos < pos){
+		n = pos - pr->pos;
+		r = pr->state;
+	}
+	for(k = 0; n != 0; k++, n >>= 1)
+		if(n & 1)
+			r = prbs_apply(pr->gen->jump[k], r);
+	pr->state = r;
+	pr->pos = pos;
+}
+
+/* next 64 bits, the first in bit 0 */
+static inline unsigned long long prbs_u64(prbs_str *pr)
+{
+	const prbsGen_str *gen = pr->gen;
+	unsigned int s = pr->state;
+
+	pr->pos += 64;
+	pr->state = gen->next[0][s & 0xff] ^ gen->next[1][(s >> 8) & 0xff]
+		^ gen->next[2][(s >> 16) & 0xff] ^ gen->next[3][s >> 24];
+
+	return gen->out[0][s & 0xff] ^ gen->out[1][(s >> 8) & 0xff]
+		^ gen->out[2][(s >> 16) & 0xff] ^ gen->out[3][s >> 24];
+}
+
+/* function prbs_bits()
+
+	Description: next len bits of the sequence, one per int
+
+	Output parameters:
+		out[]				bits, 0 or 1
+ */
+
+void prbs_bits(prbs_str *pr, int out[], long len)
+{
+	const long lenW = len & ~63L;
+	unsigned long long w;
+	unsigned int lo, hi;
+	long i;
+	int b;
+
+	/* 32-bit halves, so the unpacking runs in 32-bit vector lanes */
+	for(i = 0; i < lenW; i += 64){
+		w = prbs_u64(pr);
+		lo = (unsigned int)w;
+		hi = (unsigned int)(w >> 32);
+		for(b = 0; b < 32; b++){
+			out[i + b] = (int)((lo >> b) & 1);
+			out[i + 32 + b] = (int)((hi >> b) & 1);
+		}
+	}
+
+	/* the register stops right after the last bit handed out */
+	for(i = lenW; i < len; i++){
+		pr->state = prbs_step(pr->gen, pr->state);
+		out[i] = (int)(pr->state & 1);
+	}
+	pr->pos += len - lenW;
+}
+
+#endif /* __PRBS_H__ */
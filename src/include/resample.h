@@ -0,0 +1,341 @@
+/* File: resample.h
+ *
+ * Description: Rational L/M polyphase resampler and Farrow resampler
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * Resampling by L/M is filtering at L times the input rate and keeping
+ * every M-th sample. The polyphase resampler never forms that rate: the
+ * prototype low pass is split into L phases of P taps, and output m is
+ * the dot product of phase (m M) mod L with the P newest input samples up
+ * to (m M) / L. Phase and input advance per output come from tables of L
+ * entries, so a call reads its input once and writes its output once.
+ *
+ * Ratios without a small L/M go through the cubic Farrow interpolator of
+ * timing.h at a fixed step of input samples per output. The interpolator
+ * does not band limit, so a rate reduction first goes through the
+ * polyphase resampler above by L/M = RESAMP_FRAC_L / ceil(RESAMP_FRAC_L
+ * step), just below fsOut / fsIn, whose prototype cuts off at the lower
+ * Nyquist rate; the interpolator then only raises the rate. Less than
+ * 1 / RESAMP_FRAC_L of the output band is lost with it.
+ */
+
+#ifndef __RESAMPLE_H__
+#define __RESAMPLE_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "fir.h"
+#include "timing.h"
+
+/* Defines */
+#define RESAMP_ZEROS		16		/* default zero crossings per side of the prototype */
+#define RESAMP_ATTEN		80.		/* prototype stopband attenuation, dB */
+#define RESAMP_FRAC_L		8		/* L of the anti-alias stage of the Farrow path */
+
+typedef struct{
+	int L, M;					// reduced ratio
+	int P;						// taps per phase
+	double *bank;				// phase p at bank + p*P, oldest sample first
+	int *next;					// phase after phase p
+	int *adv;					// input samples advanced after phase p
+	int maxIn;					// input samples per call
+	complex *work;				// P-1 history samples followed by the input
+	/* state */
+	int phase;					// phase of the next output
+	int pos;					// newest input of the next output, from the
+								// first input sample of the call on
+} resamp_str;
+
+typedef struct{
+	double step;				// interpolator input samples per output sample
+	double c[TIMING_TAPS][4];	// cubic Farrow coefficients
+	int maxIn;
+	int numPre;					// output of the anti-alias stage for maxIn
+								// input samples, 0 for no stage
+	resamp_str pre;				// anti-alias resampler, numPre > 0 only
+	complex *mid;				// anti-alias output of a call
+	complex *work;				// TIMING_TAPS-1 history samples and the input
+	/* state */
+	double pos;					// next output, in input samples of the call
+} resampFrac_str;
+
+/* Functions */
+
+static int resamp_gcd(int a, int b)
+{
+	int t;
+
+	while(b != 0){
+		t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+void resamp_free(resamp_str *rs)
+{
+	free(rs->bank);
+	free(rs->next);
+	free(rs->adv);
+	free(rs->work);
+	memset(rs, 0, sizeof(resamp_str));
+}
+
+/* function resamp_init()
+
+	Description: resampler by L/M (reduced internally) with a Kaiser
+	             windowed sinc prototype of numZero zero crossings per side
+	             at the lower of the two rates, RESAMP_ZEROS for 0; calls
+	             take up to maxIn input samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+		-2					Memory allocation error
+ */
+
+int resamp_init(resamp_str *rs, int L, int M, int numZero, int maxIn)
+{
+	const double beta = fir_kaiserBeta(RESAMP_ATTEN);
+	double fc, t, half, r;
+	int g, N, p, k, i;
+
+	memset(rs, 0, sizeof(resamp_str));
+	if(L < 1 || M < 1 || maxIn < 1 || numZero < 0){
+		printf("[resamp] unsupported ratio %d/%d\n", L, M);
+		return -1;
+	}
+	if(numZero == 0)
+		numZero = RESAMP_ZEROS;
+
+	g = resamp_gcd(L, M);
+	rs->L = L /= g;
+	rs->M = M /= g;
+	rs->maxIn = maxIn;
+
+	/* cutoff at the lower Nyquist rate, in cycles per sample at L fs */
+	N = 2 * numZero * ((L > M) ? L : M);
+	rs->P = (N + L - 1) / L;
+	fc = 0.5 / ((L > M) ? L : M);
+	half = 0.5 * (rs->P * L - 1);
+
+	rs->bank = (double *)malloc(sizeof(double) * rs->P * L);
+	rs->next = (int *)malloc(sizeof(int) * L);
+	rs->adv = (int *)malloc(sizeof(int) * L);
+	rs->work = (complex *)calloc(rs->P - 1 + maxIn, sizeof(complex));
+	if(rs->bank == NULL || rs->next == NULL || rs->adv == NULL || rs->work == NULL){
+		printf("[resamp] fail to mem alloc\n");
+		resamp_free(rs);
+		return -2;
+	}
+
+	/* tap i = p + k L of the prototype, gain L for the L-1 stuffed zeros */
+	for(p = 0; p < L; p++){
+		for(k = 0; k < rs->P; k++){
+			i = p + k*L;
+			t = i - half;
+			r = t / (half + 1.);
+			rs->bank[p*rs->P + rs->P-1 - k] = L * 2.*fc
+				* ((fabs(t) < 1e-12) ? 1. : sin(2.*M_PI*fc*t) / (2.*M_PI*fc*t))
+				* fir_besselI0(beta*sqrt((r*r < 1.) ? 1. - r*r : 0.)) / fir_besselI0(beta);
+		}
+		rs->next[p] = (p + M) % L;
+		rs->adv[p] = (p + M) / L;
+	}
+
+	return 0;
+}
+
+/* function resamp_run()
+
+	Description: resample the next lenX (<= maxIn) input samples; the state
+	             carries over, so the output of a stream cut into calls
+	             equals the output of one call
+
+	Output parameters:
+		y[]					up to lenX L / M + 1 samples
+		*lenY				number of output samples
+
+	Return indicator:
+		0					Success
+		-1					Too many input samples
+ */
+
+int resamp_run(complex y[], int *lenY, const complex x[], int lenX, resamp_str *rs)
+{
+	const int P = rs->P;
+	const complex *w;
+	const double *h;
+	double re[4], im[4];
+	int n = 0, k, j, p = rs->phase, pos = rs->pos;
+
+	*lenY = 0;
+	if(lenX > rs->maxIn){
+		printf("[resamp] %d input samples exceed %d\n", lenX, rs->maxIn);
+		return -1;
+	}
+
+	memcpy(rs->work + P - 1, x, sizeof(complex)*lenX);
+	for(; pos < lenX; n++){
+		/* window work[pos .. pos + P-1], four partial sums per lane */
+		w = rs->work + pos;
+		h = rs->bank + p*P;
+		for(j = 0; j < 4; j++)
+			re[j] = im[j] = 0.;
+		for(k = 0; k + 4 <= P; k += 4)
+			for(j = 0; j < 4; j++){
+				re[j] += h[k+j] * w[k+j].re;
+				im[j] += h[k+j] * w[k+j].im;
+			}
+		for(; k < P; k++){
+			re[0] += h[k] * w[k].re;
+			im[0] += h[k] * w[k].im;
+		}
+		y[n].re = (re[0] + re[1]) + (re[2] + re[3]);
+		y[n].im = (im[0] + im[1]) + (im[2] + im[3]);
+
+		pos += rs->adv[p];
+		p = rs->next[p];
+	}
+
+	memmove(rs->work, rs->work + lenX, sizeof(complex)*(P - 1));
+	rs->phase = p;
+	rs->pos = pos - lenX;
+	*lenY = n;
+
+	return 0;
+}
+
+/***********************************
+ * Farrow resampler                *
+ ***********************************/
+
+void resampFrac_free(resampFrac_str *rf)
+{
+	if(rf->numPre > 0)
+		resamp_free(&rf->pre);
+	free(rf->mid);
+	free(rf->work);
+	memset(rf, 0, sizeof(resampFrac_str));
+}
+
+/* function resampFrac_init()
+
+	Description: resampler from rate fsIn to rate fsOut by cubic Farrow
+	             interpolation, behind a polyphase anti-alias resampler
+	             when fsOut < fsIn; calls take up to maxIn input samples
+
+	Return indicator:
+		0					Success
+		-1					Unsupported rates
+		-2					Memory allocation error
+ */
+
+int resampFrac_init(resampFrac_str *rf, double fsIn, double fsOut, int maxIn)
+{
+	int L, M;
+
+	memset(rf, 0, sizeof(resampFrac_str));
+	if(!(fsIn > 0.) || !(fsOut > 0.) || maxIn < 1){
+		printf("[resamp] unsupported rates %g -> %g\n", fsIn, fsOut);
+		return -1;
+	}
+
+	rf->step = fsIn / fsOut;
+	rf->maxIn = maxIn;
+	timing_farrowCoef(rf->c, FARROW_CUBIC);
+
+	/* band limit to the rate fsIn L / M <= fsOut, then interpolate */
+	if(rf->step > 1.){
+		L = RESAMP_FRAC_L;
+		M = (int)ceil(L * rf->step);
+		if(resamp_init(&rf->pre, L, M, 0, maxIn) < 0)
+			return -2;
+		rf->step *= (double)L / M;
+		rf->numPre = maxIn = (int)((long)maxIn * L / M) + 1;
+		rf->mid = (complex *)malloc(sizeof(complex)*maxIn);
+	}
+
+	if((rf->numPre > 0 && rf->mid == NULL)
+			|| (rf->work = (complex *)calloc(TIMING_TAPS - 1 + maxIn, sizeof(complex))) == NULL){
+		printf("[resamp] fail to mem alloc\n");
+		resampFrac_free(rf);
+		return -2;
+	}
+
+	return 0;
+}
+
+/* function resampFrac_run()
+
+	Description: Farrow resampler counterpart of resamp_run(); output n of
+	             the stream interpolates the input, after the anti-alias
+	             stage, at sample n step
+
+	Output parameters:
+		y[]					up to lenX fsOut / fsIn + 2 samples
+		*lenY				number of output samples
+
+	Return indicator:
+		0					Success
+		-1					Too many input samples
+ */
+
+int resampFrac_run(complex y[], int *lenY, const complex x[], int lenX, resampFrac_str *rf)
+{
+	const int H = TIMING_TAPS - 1;
+	double pos = rf->pos, mu;
+	int n = 0, m;
+
+	*lenY = 0;
+	if(lenX > rf->maxIn){
+		printf("[resamp] %d input samples exceed %d\n", lenX, rf->maxIn);
+		return -1;
+	}
+
+	if(rf->numPre > 0){
+		resamp_run(rf->mid, &lenX, x, lenX, &rf->pre);
+		x = rf->mid;
+	}
+
+	/* x(i) of the call at work[i + H]; x(m-1) .. x(m+2) around pos */
+	memcpy(rf->work + H, x, sizeof(complex)*lenX);
+	for(;; n++){
+		m = (int)floor(pos);
+		if(m + 2 >= lenX)
+			break;
+		mu = pos - m;
+		y[n] = timing_farrow(rf->c, rf->work + m + H - 1, mu);
+		pos += rf->step;
+	}
+
+	memmove(rf->work, rf->work + lenX, sizeof(complex)*H);
+	rf->pos = pos - lenX;
+	*lenY = n;
+
+	return 0;
+}
+
+#endif /* __RESAMPLE_H__ */
@@ -0,0 +1,181 @@
+/* File: rng.h
+ *
+ * Description: Counter-based random number streams
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The n-th output of a stream is a SplitMix64 finalizer of key + n*gamma,
+ * so any position of any stream is reachable in O(1): a stream is named
+ * by (seed, stream id), and its whole state is the 64-bit draw counter.
+ * Simulations give every frame its own stream, which makes results
+ * independent of how frames are scheduled, checkpointed or sharded.
+ *
+ * Gaussian pairs are Box-Muller with polynomial log and sincos (about one
+ * ulp off libm): branch free, so a loop drawing a pair per sample, or per
+ * frame of a batch, vectorises, and every lane computes exactly what the
+ * scalar code computes.
+ */
+
+#ifndef __RNG_H__
+#define __RNG_H__
+
+/* Headers */
+#include <string.h>
+#include <math.h>
+
+/* Defines */
+#define RNG_GAMMA		0x9e3779b97f4a7c15ULL
+#define RNG_2POW_M53	(1.0 / 9007199254740992.0)
+#define RNG_LN2_HI		6.93147180369123816490e-01
+#define RNG_LN2_LO		1.90821492927058770002e-10
+#define RNG_SQRT2		1.41421356237309504880
+
+#ifndef M_PI
+#define M_PI			3.14159265358979323846
+#endif
+
+typedef struct{
+	unsigned long long key;		// stream key from (seed, stream id)
+	unsigned long long ctr;		// draws taken so far
+} rng_str;
+
+/* Functions */
+
+static inline unsigned long long rng_mix(unsigned long long z)
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline void rng_init(rng_str *rng, unsigned long long seed,
+		unsigned long long stream)
+{
+	rng->key = rng_mix(rng_mix(seed + RNG_GAMMA) ^ (stream * RNG_GAMMA + 1));
+	rng->ctr = 0;
+}
+
+/* jump to draw number pos of the stream */
+static inline void rng_seek(rng_str *rng, unsigned long long pos)
+{
+	rng->ctr = pos;
+}
+
+static inline unsigned long long rng_u64(rng_str *rng)
+{
+	return rng_mix(rng->key + (++rng->ctr) * RNG_GAMMA);
+}
+
+/* uniform in (0, 1] */
+static inline double rng_uniform(rng_str *rng)
+{
+	return ((rng_u64(rng) >> 11) + 1) * RNG_2POW_M53;
+}
+
+/* natural log of a normal x > 0: x = 2^e m, m in [1/sqrt2, sqrt2),
+   log m = 2 atanh((m-1)/(m+1)) by its series up to the 17th power */
+static inline double rng_log(double x)
+{
+	unsigned long long bits;
+	double m, f, s, p, e;
+	int big;
+
+	memcpy(&bits, &x, sizeof(bits));
+	e = (double)((long long)((bits >> 52) & 0x7ff) - 1023);
+	bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+	memcpy(&m, &bits, sizeof(m));
+	big = m > RNG_SQRT2;
+	m = big ? 0.5*m : m;
+	e = big ? e + 1. : e;
+
+	f = (m - 1.) / (m + 1.);
+	s = f*f;
+	p = 1./17;
+	p = p*s + 1./15;
+	p = p*s + 1./13;
+	p = p*s + 1./11;
+	p = p*s + 1./9;
+	p = p*s + 1./7;
+	p = p*s + 1./5;
+	p = p*s + 1./3;
+	p = p*s + 1.;
+
+	return e*RNG_LN2_HI + (2.*f*p + e*RNG_LN2_LO);
+}
+
+/* sin and cos of 2 pi v, v >= 0: quadrant by rounding 4v (a truncating
+   conversion, floor() keeps the loop scalar), Taylor on |x| <= pi/4 */
+static inline void rng_sincos2pi(double v, double *sn, double *cs)
+{
+	long long iq = (long long)(4.*v + 0.5);
+	double q = (double)iq, x, x2, s, c, ts, tc;
+
+	x = 2.*M_PI*(v - 0.25*q);
+	x2 = x*x;
+
+	s = -1./1307674368000.;
+	s = s*x2 + 1./6227020800.;
+	s = s*x2 - 1./39916800.;
+	s = s*x2 + 1./362880.;
+	s = s*x2 - 1./5040.;
+	s = s*x2 + 1./120.;
+	s = s*x2 - 1./6.;
+	s = x + x*x2*s;
+
+	c = 1./20922789888000.;
+	c = c*x2 - 1./87178291200.;
+	c = c*x2 + 1./479001600.;
+	c = c*x2 - 1./3628800.;
+	c = c*x2 + 1./40320.;
+	c = c*x2 - 1./720.;
+	c = c*x2 + 1./24.;
+	c = c*x2 - 0.5;
+	c = 1. + x2*c;
+
+	/* rotate by iq quarter turns */
+	iq &= 3;
+	ts = (iq & 1) ? c : s;
+	tc = (iq & 1) ? s : c;
+	*sn = (iq & 2) ? -ts : ts;
+	*cs = ((iq + 1) & 2) ? -tc : tc;
+}
+
+/* N(0,1) pair from draws ctr+1 and ctr+2 of the stream key (Box-Muller);
+   no state, so draws of many samples or streams are independent lanes */
+static inline void rng_gaussAt(unsigned long long key, unsigned long long ctr,
+		double *g0, double *g1)
+{
+	double u0 = (double)((rng_mix(key + (ctr + 1) * RNG_GAMMA) >> 11) + 1)
+		* RNG_2POW_M53;
+	double u1 = (double)((rng_mix(key + (ctr + 2) * RNG_GAMMA) >> 11) + 1)
+		* RNG_2POW_M53;
+	double r = sqrt(-2. * rng_log(u0)), sn, cs;
+
+	rng_sincos2pi(u1, &sn, &cs);
+	*g0 = r * cs;
+	*g1 = r * sn;
+}
+
+/* two independent N(0,1) samples, the next two draws of the stream */
+static inline void rng_gauss2(rng_str *rng, double *g0, double *g1)
+{
+	rng_gaussAt(rng->key, rng->ctr, g0, g1);
+	rng->ctr += 2;
+}
+
+#endif /* __RNG_H__ */
@@ -0,0 +1,522 @@
+/* File: stats.h
+ *
+ * Description: Streaming link quality statistics: EVM, MER, SNR estimates,
+ *              per-point error vectors and an I/Q histogram
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * One pass over received symbols r and their references s, e = r - s,
+ * accumulates
+ *   - EVM and MER from sum |e|^2 and sum |s|^2, and the peak |e|^2,
+ *   - the mean and variance of e per axis (I/Q offset and spread),
+ *   - the data aided SNR and the blind M2M4 SNR estimate from the moments
+ *     of |r|^2, with the kurtosis of the references,
+ *   - count, mean error vector and |e|^2 per constellation point,
+ *   - a STATS_BINS x STATS_BINS histogram of r.
+ *
+ * Symbols go in blocks of STATS_BLOCK: the sums of a block run in
+ * STATS_LANES partial sums and vectorise, the block total goes into a
+ * Kahan (Neumaier) compensated sum and the per-axis moments into Welford
+ * accumulators by Chan's merge, then the histogram and the per-point
+ * counts are scattered from the block while it is in cache. Partial
+ * statistics of threads, blocks or shards add up with stats_merge().
+ * The sums alone, without the per-point entries and the histogram, go to
+ * and from a text file with stats_writeSums() and stats_readSums().
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "constel.h"
+
+/* Defines */
+#define STATS_BLOCK			256		/* symbols per block */
+#define STATS_LANES			8		/* partial sums of the block loop */
+#define STATS_BINS			64		/* histogram bins per axis */
+#define STATS_RANGE			1.5		/* histogram half width, times the largest point */
+#define STATS_CLIP			(STATS_BINS*STATS_BINS)	/* histogram entry of r outside */
+
+/* Compensated sum, the value is sum + c */
+typedef struct{
+	double sum;
+	double c;
+} kahan_str;
+
+/* Running mean and sum of squared deviations */
+typedef struct{
+	long n;
+	double mean;
+	double m2;
+} welford_str;
+
+typedef struct{
+	const constel_str *cons;	// labels of stats_runBits(), NULL for none
+	int numPoint;				// per-point entries, cons->order or 0
+	double range;				// histogram covers [-range, range) per axis
+	/* accumulators */
+	long numSym;
+	kahan_str sigPow;			// sum |s|^2
+	kahan_str sig4;				// sum |s|^4
+	kahan_str errPow;			// sum |e|^2
+	kahan_str rxPow;			// sum |r|^2
+	kahan_str rx4;				// sum |r|^4
+	double peakErr;				// max |e|^2
+	welford_str errI, errQ;		// e per axis
+	long *pointNum;				// symbols per point
+	complex *pointErr;			// sum e per point
+	double *pointPow;			// sum |e|^2 per point
+	long *hist;					// hist[i*STATS_BINS + q] of r, hist[STATS_CLIP]
+								// counts r outside the histogram
+} stats_str;
+
+/* Functions */
+
+static inline void kahan_add(kahan_str *k, double x)
+{
+	double t = k->sum + x;
+
+	if(fabs(k->sum) >= fabs(x))
+		k->c += (k->sum - t) + x;
+	else
+		k->c += (x - t) + k->sum;
+	k->sum = t;
+}
+
+static inline double kahan_value(const kahan_str *k)
+{
+	return k->sum + k->c;
+}
+
+/* Chan's merge of n samples of mean mean and deviation sum m2 */
+static inline void welford_merge(welford_str *w, long n, double mean, double m2)
+{
+	double d = mean - w->mean;
+	long t = w->n + n;
+
+	if(n == 0)
+		return;
+	w->mean += d * n / t;
+	w->m2 += m2 + d*d * ((double)w->n * n / t);
+	w->n = t;
+}
+
+void stats_free(stats_str *st)
+{
+	free(st->pointNum);
+	free(st->pointErr);
+	free(st->pointPow);
+	free(st->hist);
+	memset(st, 0, sizeof(stats_str));
+}
+
+/* clear the accumulators, keep the configuration */
+void stats_reset(stats_str *st)
+{
+	st->numSym = 0;
+	memset(&st->sigPow, 0, sizeof(kahan_str));
+	memset(&st->sig4, 0, sizeof(kahan_str));
+	memset(&st->errPow, 0, sizeof(kahan_str));
+	memset(&st->rxPow, 0, sizeof(kahan_str));
+	memset(&st->rx4, 0, sizeof(kahan_str));
+	st->peakErr = 0.;
+	memset(&st->errI, 0, sizeof(welford_str));
+	memset(&st->errQ, 0, sizeof(welford_str));
+	if(st->numPoint > 0){
+		memset(st->pointNum, 0, sizeof(long)*st->numPoint);
+		memset(st->pointErr, 0, sizeof(complex)*st->numPoint);
+		memset(st->pointPow, 0, sizeof(double)*st->numPoint);
+	}
+	memset(st->hist, 0, sizeof(long)*(STATS_CLIP + 1));
+}
+
+/* function stats_init()
+
+	Description: statistics of symbols of the constellation cons (NULL:
+	             references only, no per-point entries); the histogram
+	             spans +-range per axis, 0 for STATS_RANGE times the
+	             largest point (1 without cons)
+
+	Return indicator:
+		0					Success
+		-2					Memory allocation error
+ */
+
+int stats_init(stats_str *st, const constel_str *cons, double range)
+{
+	double a, amax = 0.;
+	int k, n;
+
+	memset(st, 0, sizeof(stats_str));
+	st->cons = cons;
+	st->numPoint = n = (cons != NULL) ? cons->order : 0;
+
+	if(range <= 0.){
+		for(k = 0; k < n; k++){
+			a = cons->point[k].re*cons->point[k].re + cons->point[k].im*cons->point[k].im;
+			amax = (a > amax) ? a : amax;
+		}
+		range = STATS_RANGE * ((n > 0) ? sqrt(amax) : 1.);
+	}
+	st->range = range;
+
+	st->hist = (long *)malloc(sizeof(long)*(STATS_CLIP + 1));
+	if(n > 0){
+		st->pointNum = (long *)malloc(sizeof(long)*n);
+		st->pointErr = (complex *)malloc(sizeof(complex)*n);
+		st->pointPow = (double *)malloc(sizeof(double)*n);
+	}
+	if(st->hist == NULL || (n > 0 && (st->pointNum == NULL || st->pointErr == NULL
+					|| st->pointPow == NULL))){
+		printf("[stats] fail to mem alloc\n");
+		stats_free(st);
+		return -2;
+	}
+	stats_reset(st);
+
+	return 0;
+}
+
+/* one block of len <= STATS_BLOCK symbols, reference labels optional */
+static void stats_block(stats_str *st, const complex * restrict r,
+		const complex * restrict s, const int *label, int len)
+{
+	const double scale = STATS_BINS / (2. * st->range);
+	double sP[STATS_LANES] = {0.}, s4[STATS_LANES] = {0.}, eP[STATS_LANES] = {0.};
+	double rP[STATS_LANES] = {0.}, r4[STATS_LANES] = {0.};
+	double eI[STATS_LANES] = {0.}, eQ[STATS_LANES] = {0.};
+	double eI2[STATS_LANES] = {0.}, eQ2[STATS_LANES] = {0.};
+	double eRe[STATS_BLOCK], eIm[STATS_BLOCK];
+	union{ double val; long bits; } e2[STATS_BLOCK];
+	int bin[STATS_BLOCK];
+	long *hist = st->hist;
+	double a, b, c, d, x, y, mean;
+	long pk;
+	int i, j, k, lab;
+
+	/* per symbol error, |e|^2 and histogram bin for the scatter below */
+	for(i = 0; i < len; i++){
+		a = r[i].re - s[i].re;
+		b = r[i].im - s[i].im;
+		x = (r[i].re + st->range) * scale;
+		y = (r[i].im + st->range) * scale;
+		eRe[i] = a;
+		eIm[i] = b;
+		e2[i].val = a*a + b*b;
+		bin[i] = ((x >= 0.) & (x < STATS_BINS) & (y >= 0.) & (y < STATS_BINS))
+			? (int)x*STATS_BINS + (int)y : STATS_CLIP;
+	}
+
+	for(i = 0; i + STATS_LANES <= len; i += STATS_LANES)
+		for(j = 0; j < STATS_LANES; j++){
+			k = i + j;
+			c = s[k].re*s[k].re + s[k].im*s[k].im;
+			d = r[k].re*r[k].re + r[k].im*r[k].im;
+			sP[j] += c;
+			s4[j] += c*c;
+			eP[j] += e2[k].val;
+			rP[j] += d;
+			r4[j] += d*d;
+			eI[j] += eRe[k];
+			eQ[j] += eIm[k];
+			eI2[j] += eRe[k]*eRe[k];
+			eQ2[j] += eIm[k]*eIm[k];
+		}
+	for(; i < len; i++){
+		c = s[i].re*s[i].re + s[i].im*s[i].im;
+		d = r[i].re*r[i].re + r[i].im*r[i].im;
+		sP[0] += c;
+		s4[0] += c*c;
+		eP[0] += e2[i].val;
+		rP[0] += d;
+		r4[0] += d*d;
+		eI[0] += eRe[i];
+		eQ[0] += eIm[i];
+		eI2[0] += eRe[i]*eRe[i];
+		eQ2[0] += eIm[i]*eIm[i];
+	}
+	for(j = 1; j < STATS_LANES; j++){
+		sP[0] += sP[j];
+		s4[0] += s4[j];
+		eP[0] += eP[j];
+		rP[0] += rP[j];
+		r4[0] += r4[j];
+		eI[0] += eI[j];
+		eQ[0] += eQ[j];
+		eI2[0] += eI2[j];
+		eQ2[0] += eQ2[j];
+	}
+
+	memcpy(&pk, &st->peakErr, sizeof(double));
+	st->numSym += len;
+	kahan_add(&st->sigPow, sP[0]);
+	kahan_add(&st->sig4, s4[0]);
+	kahan_add(&st->errPow, eP[0]);
+	kahan_add(&st->rxPow, rP[0]);
+	kahan_add(&st->rx4, r4[0]);
+	mean = eI[0] / len;
+	welford_merge(&st->errI, len, mean, fmax(eI2[0] - mean*eI[0], 0.));
+	mean = eQ[0] / len;
+	welford_merge(&st->errQ, len, mean, fmax(eQ2[0] - mean*eQ[0], 0.));
+
+	/* peak and scatter while the block is in cache; |e|^2 >= 0 orders as
+	   its bit pattern, so the peak is an integer max reduction */
+	for(i = 0; i < len; i++)
+		pk = (e2[i].bits > pk) ? e2[i].bits : pk;
+	memcpy(&st->peakErr, &pk, sizeof(double));
+	for(i = 0; i < len; i++)
+		hist[bin[i]]++;
+	if(label != NULL && st->numPoint > 0)
+		for(i = 0; i < len; i++){
+			lab = label[i];
+			st->pointNum[lab]++;
+			st->pointErr[lab].re += eRe[i];
+			st->pointErr[lab].im += eIm[i];
+			st->pointPow[lab] += e2[i].val;
+		}
+}
+
+/* function stats_run()
+
+	Description: add len received symbols r[] against their references
+	             s[]; label[] gives the constellation point of s[i] for the
+	             per-point entries, NULL to skip them
+ */
+
+void stats_run(stats_str *st, const complex r[], const complex s[], const int label[],
+		long len)
+{
+	long i;
+	int n;
+
+	for(i = 0; i < len; i += n){
+		n = (len - i < STATS_BLOCK) ? (int)(len - i) : STATS_BLOCK;
+		stats_block(st, r + i, s + i, (label != NULL) ? label + i : NULL, n);
+	}
+}
+
+/* function stats_runBits()
+
+	Description: stats_run() with the references mapped from the bits
+	             that were sent, bitsPerSym of cons per symbol, as
+	             mapConstel() does; needs stats_init() with cons
+ */
+
+void stats_runBits(stats_str *st, const complex r[], const int bits[], long lenSym)
+{
+	const constel_str *cons = st->cons;
+	const int m = cons->bitsPerSym;
+	complex s[STATS_BLOCK];
+	int label[STATS_BLOCK];
+	long i;
+	int k, n;
+
+	for(i = 0; i < lenSym; i += n){
+		n = (lenSym - i < STATS_BLOCK) ? (int)(lenSym - i) : STATS_BLOCK;
+		bitGroup_fromBits(label, bits + i*m, n, m);
+		for(k = 0; k < n; k++)
+			s[k] = cons->point[label[k]];
+		stats_block(st, r + i, s, label, n);
+	}
+}
+
+/* function stats_merge()
+
+	Description: add the statistics of src (another thread, block or
+	             shard, same constellation and range) to dst; a src
+	             without per-point entries or histogram adds the sums
+ */
+
+void stats_merge(stats_str *dst, const stats_str *src)
+{
+	int k;
+
+	dst->numSym += src->numSym;
+	kahan_add(&dst->sigPow, src->sigPow.sum);
+	kahan_add(&dst->sigPow, src->sigPow.c);
+	kahan_add(&dst->sig4, src->sig4.sum);
+	kahan_add(&dst->sig4, src->sig4.c);
+	kahan_add(&dst->errPow, src->errPow.sum);
+	kahan_add(&dst->errPow, src->errPow.c);
+	kahan_add(&dst->rxPow, src->rxPow.sum);
+	kahan_add(&dst->rxPow, src->rxPow.c);
+	kahan_add(&dst->rx4, src->rx4.sum);
+	kahan_add(&dst->rx4, src->rx4.c);
+	dst->peakErr = (src->peakErr > dst->peakErr) ? src->peakErr : dst->peakErr;
+	welford_merge(&dst->errI, src->errI.n, src->errI.mean, src->errI.m2);
+	welford_merge(&dst->errQ, src->errQ.n, src->errQ.mean, src->errQ.m2);
+
+	for(k = 0; k < dst->numPoint && k < src->numPoint; k++){
+		dst->pointNum[k] += src->pointNum[k];
+		dst->pointErr[k].re += src->pointErr[k].re;
+		dst->pointErr[k].im += src->pointErr[k].im;
+		dst->pointPow[k] += src->pointPow[k];
+	}
+	for(k = 0; src->hist != NULL && k <= STATS_CLIP; k++)
+		dst->hist[k] += src->hist[k];
+}
+
+/* the sums of src into dst, per-point entries and histogram untouched */
+void stats_copySums(stats_str *dst, const stats_str *src)
+{
+	dst->numSym = src->numSym;
+	dst->sigPow = src->sigPow;
+	dst->sig4 = src->sig4;
+	dst->errPow = src->errPow;
+	dst->rxPow = src->rxPow;
+	dst->rx4 = src->rx4;
+	dst->peakErr = src->peakErr;
+	dst->errI = src->errI;
+	dst->errQ = src->errQ;
+}
+
+/* function stats_writeSums()
+
+	Description: write the sums of st as one line, exactly, so that
+	             stats_readSums() restores them bit for bit
+ */
+
+void stats_writeSums(FILE *file, const stats_str *st)
+{
+	fprintf(file, "%ld %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g"
+			" %.17g %.17g %.17g %ld %.17g %.17g %ld %.17g %.17g\n",
+			st->numSym, st->sigPow.sum, st->sigPow.c, st->sig4.sum, st->sig4.c,
+			st->errPow.sum, st->errPow.c, st->rxPow.sum, st->rxPow.c,
+			st->rx4.sum, st->rx4.c, st->peakErr,
+			st->errI.n, st->errI.mean, st->errI.m2,
+			st->errQ.n, st->errQ.mean, st->errQ.m2);
+}
+
+/* function stats_readSums()
+
+	Return indicator:
+		0					Success
+		-1					No sums line
+ */
+
+int stats_readSums(FILE *file, stats_str *st)
+{
+	if(fscanf(file, " %ld %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf"
+			" %ld %lf %lf %ld %lf %lf",
+			&st->numSym, &st->sigPow.sum, &st->sigPow.c, &st->sig4.sum, &st->sig4.c,
+			&st->errPow.sum, &st->errPow.c, &st->rxPow.sum, &st->rxPow.c,
+			&st->rx4.sum, &st->rx4.c, &st->peakErr,
+			&st->errI.n, &st->errI.mean, &st->errI.m2,
+			&st->errQ.n, &st->errQ.mean, &st->errQ.m2) != 18)
+		return -1;
+
+	return 0;
+}
+
+/***********************************
+ * Figures                         *
+ ***********************************/
+
+/* rms EVM relative to the rms reference, as a ratio */
+double stats_evm(const stats_str *st)
+{
+	return sqrt(kahan_value(&st->errPow) / kahan_value(&st->sigPow));
+}
+
+/* peak EVM relative to the rms reference, as a ratio */
+double stats_evmPeak(const stats_str *st)
+{
+	return sqrt(st->peakErr * st->numSym / kahan_value(&st->sigPow));
+}
+
+/* MER, the data aided SNR estimate, in dB */
+double stats_merDb(const stats_str *st)
+{
+	return 10.*log10(kahan_value(&st->sigPow) / kahan_value(&st->errPow));
+}
+
+/* function stats_snrM2M4Db()
+
+	Description: blind SNR estimate from M2 = E|r|^2 and M4 = E|r|^4 alone,
+	             S = sqrt((2 M2^2 - M4) / (2 - ka)), N = M2 - S, with ka the
+	             kurtosis E|s|^4 / E|s|^2^2 of the references
+
+	Return indicator:
+		SNR in dB, NAN when the moments do not fit the model
+ */
+
+double stats_snrM2M4Db(const stats_str *st)
+{
+	double n = (double)st->numSym, m2, m4, ka, S;
+
+	m2 = kahan_value(&st->rxPow) / n;
+	m4 = kahan_value(&st->rx4) / n;
+	ka = kahan_value(&st->sig4) * n / (kahan_value(&st->sigPow) * kahan_value(&st->sigPow));
+	if(!(ka < 2.) || 2.*m2*m2 - m4 <= 0.)
+		return NAN;
+	S = sqrt((2.*m2*m2 - m4) / (2. - ka));
+	if(!(m2 - S > 0.))
+		return NAN;
+
+	return 10.*log10(S / (m2 - S));
+}
+
+/* one summary line, indented as the rest of the linkSim summary */
+void stats_print(const stats_str *st)
+{
+	if(st->numSym == 0)
+		return;
+	printf("    EVM %.3f %% rms, %.3f %% peak  MER %.2f dB  SNR M2M4 %.2f dB"
+			"  IQ offset %.2e %+.2e\n",
+			100.*stats_evm(st), 100.*stats_evmPeak(st), stats_merDb(st),
+			stats_snrM2M4Db(st), st->errI.mean, st->errQ.mean);
+}
+
+/* function stats_writeHist()
+
+	Description: write the I/Q histogram as STATS_BINS lines of STATS_BINS
+	             counts, I bin along the lines, with a comment line giving
+	             the range
+
+	Return indicator:
+		0					Success
+		-1					Unable to open the file
+ */
+
+int stats_writeHist(const stats_str *st, const char *fName)
+{
+	FILE *file;
+	int i, q;
+
+	if((file = fopen(fName, "w")) == NULL){
+		printf("Unable to open histogram file(%s)\n", fName);
+		return -1;
+	}
+
+	fprintf(file, "# %d x %d bins over [%g, %g), %ld symbols outside\n",
+			STATS_BINS, STATS_BINS, -st->range, st->range, st->hist[STATS_CLIP]);
+	for(i = 0; i < STATS_BINS; i++)
+		for(q = 0; q < STATS_BINS; q++)
+			fprintf(file, "%ld%c", st->hist[i*STATS_BINS + q],
+					(q == STATS_BINS-1) ? '\n' : ' ');
+
+	fclose(file);
+	return 0;
+}
+
+#endif /* __STATS_H__ */
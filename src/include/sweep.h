@@ -0,0 +1,348 @@
+/* File: sweep.h
+ *
+ * Description: SNR sweep state: checkpoint/resume and shard merging
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * A sweep is numPoint SNR points times numIter frames. Frame it of point p
+ * draws all its randomness from the rng.h stream sweep_stream(p, it), so
+ * the result of a frame does not depend on which process runs it or when.
+ * A shard owns a contiguous range of the flattened (point, frame) index
+ * space; its state is the number of frames done, the error counters and
+ * the stats.h sums of every point, saved as a small text file. Resuming
+ * restarts at the first frame not done, merging adds the counters and
+ * sums of all shards.
+ */
+
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "comSim_types.h"
+#include "comMath.h"
+#include "stats.h"
+
+/* Defines */
+#define SWEEP_VERSION		8
+#define SWEEP_MAX_SHARDS	1024
+
+/* One SNR point of a shard */
+typedef struct{
+	double snrdB;
+	long itBegin;				// first frame of this shard
+	long itEnd;					// one past the last frame of this shard
+	long itDone;				// frames done from itBegin on
+	long numBitErr;
+	long numFrmErr;
+	long numCrcFail;
+	long numCrcMiss;
+	stats_str stats;			// sums of the channel output statistics,
+								// no per-point entries or histogram
+} sweepPoint_str;
+
+typedef struct{
+	/* run configuration, identical across shards */
+	unsigned long long seed;
+	int modFamily;
+	int modType;
+	int codeType;
+	int ldpcType;
+	int crcType;
+	int noisePool;
+	int prbsType;
+	int stats;
+	int twin;
+	int lenSrc;
+	long numIter;
+	double snrMin, snrMax, snrStep;
+	/* this shard */
+	int shard;
+	int numShard;
+	int numPoint;
+	sweepPoint_str pt[MAX_SNR_POINTS];
+} sweep_str;
+
+/* Functions */
+
+/* stream id of frame it at point p */
+static inline unsigned long long sweep_stream(int p, long it)
+{
+	return ((unsigned long long)p << 40) | (unsigned long long)it;
+}
+
+/* function sweep_init()
+
+	Description: empty state of shard (0 .. numShard-1) of the sweep prm
+
+	Return indicator:
+		0					Success
+		-1					Invalid shard
+ */
+
+int sweep_init(sweep_str *sw, const simParam_str *prm, int shard, int numShard)
+{
+	snr_str snr = prm->snr;
+	long total, lo, hi, base;
+	int p;
+
+	if(numShard < 1 || numShard > SWEEP_MAX_SHARDS || shard < 0 || shard >= numShard){
+		printf("[sweep] invalid shard %d/%d\n", shard, numShard);
+		return -1;
+	}
+
+	memset(sw, 0, sizeof(sweep_str));
+	sw->seed = prm->seed;
+	sw->modFamily = prm->modFamily;
+	sw->modType = prm->modType;
+	sw->codeType = prm->codeType;
+	sw->ldpcType = prm->ldpcType;
+	sw->crcType = prm->crcType;
+	sw->noisePool = prm->noisePool;
+	sw->prbsType = prm->prbsType;
+	sw->stats = prm->stats;
+	sw->twin = prm->twin;
+	sw->lenSrc = prm->lenSrc;
+	sw->numIter = prm->numIter;
+	sw->snrMin = prm->snr.min;
+	sw->snrMax = prm->snr.max;
+	sw->snrStep = prm->snr.step;
+	sw->shard = shard;
+	sw->numShard = numShard;
+	sw->numPoint = snr_numPoints(&snr);
+
+	total = sw->numPoint * sw->numIter;
+	lo = total * shard / numShard;
+	hi = total * (shard + 1) / numShard;
+
+	for(p = 0; p < sw->numPoint; p++){
+		base = p * sw->numIter;
+		sw->pt[p].snrdB = snr_setPoint(&snr, p);
+		sw->pt[p].itBegin = (lo > base) ? lo - base : 0;
+		sw->pt[p].itEnd = (hi < base + sw->numIter) ? hi - base : sw->numIter;
+		if(sw->pt[p].itBegin > sw->numIter)
+			sw->pt[p].itBegin = sw->numIter;
+		if(sw->pt[p].itEnd < sw->pt[p].itBegin)
+			sw->pt[p].itEnd = sw->pt[p].itBegin;
+	}
+
+	return 0;
+}
+
+/* same sweep configuration, shards may differ */
+int sweep_sameRun(const sweep_str *a, const sweep_str *b)
+{
+	return a->seed == b->seed && a->modFamily == b->modFamily
+		&& a->modType == b->modType && a->codeType == b->codeType
+		&& a->ldpcType == b->ldpcType && a->crcType == b->crcType
+		&& a->noisePool == b->noisePool && a->prbsType == b->prbsType
+		&& a->stats == b->stats && a->twin == b->twin
+		&& a->lenSrc == b->lenSrc
+		&& a->numIter == b->numIter && a->snrMin == b->snrMin
+		&& a->snrMax == b->snrMax && a->snrStep == b->snrStep
+		&& a->numPoint == b->numPoint;
+}
+
+/* function sweep_save()
+
+	Description: write the state to fName; the file is replaced atomically
+	             so an interrupted save keeps the previous checkpoint
+
+	Return indicator:
+		0					Success
+		-1					Unable to write the file
+ */
+
+int sweep_save(const sweep_str *sw, const char *fName)
+{
+	char tmpName[512];
+	FILE *file;
+	int p;
+
+	snprintf(tmpName, sizeof(tmpName), "%s.tmp", fName);
+	if((file = fopen(tmpName, "w")) == NULL){
+		printf("Unable to open checkpoint file(%s)\n", tmpName);
+		return -1;
+	}
+
+	fprintf(file, "comSimSweep %d\n", SWEEP_VERSION);
+	fprintf(file, "seed %llu\n", sw->seed);
+	fprintf(file, "mod %d %d\n", sw->modFamily, sw->modType);
+	fprintf(file, "code %d %d %d\n", sw->codeType, sw->ldpcType, sw->crcType);
+	fprintf(file, "noisePool %d\n", sw->noisePool);
+	fprintf(file, "prbsType %d\n", sw->prbsType);
+	fprintf(file, "stats %d\n", sw->stats);
+	fprintf(file, "twin %d\n", sw->twin);
+	fprintf(file, "lenSrc %d\n", sw->lenSrc);
+	fprintf(file, "numIter %ld\n", sw->numIter);
+	fprintf(file, "snr %.17g %.17g %.17g\n", sw->snrMin, sw->snrMax, sw->snrStep);
+	fprintf(file, "shard %d %d\n", sw->shard, sw->numShard);
+	fprintf(file, "points %d\n", sw->numPoint);
+	for(p = 0; p < sw->numPoint; p++)
+		fprintf(file, "%d %.17g %ld %ld %ld %ld %ld %ld %ld\n", p, sw->pt[p].snrdB,
+				sw->pt[p].itBegin, sw->pt[p].itEnd, sw->pt[p].itDone,
+				sw->pt[p].numBitErr, sw->pt[p].numFrmErr,
+				sw->pt[p].numCrcFail, sw->pt[p].numCrcMiss);
+	for(p = 0; p < sw->numPoint; p++)
+		stats_writeSums(file, &sw->pt[p].stats);
+
+	if(fclose(file) != 0 || rename(tmpName, fName) != 0){
+		printf("Unable to write checkpoint file(%s)\n", fName);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* function sweep_load()
+
+	Return indicator:
+		0					Success
+		-1					Unable to open the file
+		-2					Not a sweep state file
+ */
+
+int sweep_load(sweep_str *sw, const char *fName)
+{
+	FILE *file;
+	int ver, p, idx, ok;
+
+	if((file = fopen(fName, "r")) == NULL)
+		return -1;
+
+	memset(sw, 0, sizeof(sweep_str));
+	ok = fscanf(file, " comSimSweep %d", &ver) == 1 && ver == SWEEP_VERSION
+		&& fscanf(file, " seed %llu", &sw->seed) == 1
+		&& fscanf(file, " mod %d %d", &sw->modFamily, &sw->modType) == 2
+		&& fscanf(file, " code %d %d %d", &sw->codeType, &sw->ldpcType,
+				&sw->crcType) == 3
+		&& fscanf(file, " noisePool %d", &sw->noisePool) == 1
+		&& fscanf(file, " prbsType %d", &sw->prbsType) == 1
+		&& fscanf(file, " stats %d", &sw->stats) == 1
+		&& fscanf(file, " twin %d", &sw->twin) == 1
+		&& fscanf(file, " lenSrc %d", &sw->lenSrc) == 1
+		&& fscanf(file, " numIter %ld", &sw->numIter) == 1
+		&& fscanf(file, " snr %lf %lf %lf", &sw->snrMin, &sw->snrMax, &sw->snrStep) == 3
+		&& fscanf(file, " shard %d %d", &sw->shard, &sw->numShard) == 2
+		&& fscanf(file, " points %d", &sw->numPoint) == 1
+		&& sw->numPoint >= 0 && sw->numPoint <= MAX_SNR_POINTS;
+
+	for(p = 0; ok && p < sw->numPoint; p++)
+		ok = fscanf(file, " %d %lf %ld %ld %ld %ld %ld %ld %ld", &idx,
+				&sw->pt[p].snrdB, &sw->pt[p].itBegin, &sw->pt[p].itEnd,
+				&sw->pt[p].itDone, &sw->pt[p].numBitErr, &sw->pt[p].numFrmErr,
+				&sw->pt[p].numCrcFail, &sw->pt[p].numCrcMiss) == 9 && idx == p;
+	for(p = 0; ok && p < sw->numPoint; p++)
+		ok = stats_readSums(file, &sw->pt[p].stats) == 0;
+	fclose(file);
+
+	if(!ok){
+		printf("Invalid checkpoint file(%s)\n", fName);
+		return -2;
+	}
+
+	return 0;
+}
+
+/* function sweep_merge()
+
+	Description: add up the shard states in fName[]; the result is the
+	             state of a single process run over the frames they cover
+
+	Return indicator:
+		0					Success, every frame of the sweep is covered
+		1					Merged, but frames are missing
+		-1					Unreadable or mismatching shard files
+ */
+
+int sweep_merge(sweep_str *out, char *fName[], int num)
+{
+	sweep_str *sw;
+	char seen[SWEEP_MAX_SHARDS] = {0};
+	int f, p, missing = 0;
+
+	if(num < 1)
+		return -1;
+	if((sw = (sweep_str *)malloc(sizeof(sweep_str))) == NULL){
+		printf("[sweep] fail to mem alloc\n");
+		return -1;
+	}
+
+	for(f = 0; f < num; f++){
+		if(sweep_load(sw, fName[f]) < 0){
+			printf("Unable to read shard file(%s)\n", fName[f]);
+			goto error;
+		}
+
+		if(f == 0){
+			*out = *sw;
+			out->shard = 0;
+			out->numShard = 1;
+			for(p = 0; p < out->numPoint; p++){
+				out->pt[p].itBegin = 0;
+				out->pt[p].itEnd = out->numIter;
+				out->pt[p].itDone = 0;
+				out->pt[p].numBitErr = 0;
+				out->pt[p].numFrmErr = 0;
+				out->pt[p].numCrcFail = 0;
+				out->pt[p].numCrcMiss = 0;
+				memset(&out->pt[p].stats, 0, sizeof(stats_str));
+			}
+			out->numShard = sw->numShard;
+		} else if(!sweep_sameRun(out, sw) || sw->numShard != out->numShard){
+			printf("Shard file(%s) belongs to another sweep\n", fName[f]);
+			goto error;
+		}
+
+		if(sw->numShard > SWEEP_MAX_SHARDS || sw->shard < 0
+				|| sw->shard >= sw->numShard || seen[sw->shard]){
+			printf("Shard %d/%d given twice or out of range(%s)\n",
+					sw->shard, sw->numShard, fName[f]);
+			goto error;
+		}
+		seen[sw->shard] = 1;
+
+		for(p = 0; p < sw->numPoint; p++){
+			out->pt[p].itDone += sw->pt[p].itDone;
+			out->pt[p].numBitErr += sw->pt[p].numBitErr;
+			out->pt[p].numFrmErr += sw->pt[p].numFrmErr;
+			out->pt[p].numCrcFail += sw->pt[p].numCrcFail;
+			out->pt[p].numCrcMiss += sw->pt[p].numCrcMiss;
+			stats_merge(&out->pt[p].stats, &sw->pt[p].stats);
+		}
+	}
+	free(sw);
+	out->numShard = 1;
+
+	for(p = 0; p < out->numPoint; p++)
+		if(out->pt[p].itDone < out->numIter){
+			printf("SNR %6.2f dB: %ld of %ld frames merged\n", out->pt[p].snrdB,
+					out->pt[p].itDone, out->numIter);
+			missing = 1;
+		}
+
+	return missing;
+
+error:
+	free(sw);
+	return -1;
+}
+
+#endif /* __SWEEP_H__ */
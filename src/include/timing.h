@@ -0,0 +1,467 @@
+/* File: timing.h
+ *
+ * Description: Symbol timing recovery with a Farrow interpolator
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The loop works on sps samples per symbol (matched filter output). The
+ * next strobe is kept as a position in input samples: its integer part
+ * picks the base sample m, its fraction is the interval mu of the Farrow
+ * interpolator between x(m) and x(m+1). Each strobe advances the position
+ * by sps (half of it for the Gardner midpoint) minus the loop filter
+ * output, so the work is per strobe, not per input sample, and there is
+ * no division. As in a pipelined hardware loop the correction of a symbol
+ * moves the strobe after next, which keeps the interpolation and the TED
+ * off the feedback path from one strobe position to the next. A Gardner TED needs the midpoint strobe; Mueller-Muller
+ * uses sign decisions of I and Q, which suits BPSK and QPSK.
+ *
+ * The fixed-point variant runs on split I/Q samples of fixedpoint.h with
+ * the position in 32.32 format, mu and the Farrow coefficients in Q15.
+ */
+
+#ifndef __TIMING_H__
+#define __TIMING_H__
+
+/* Headers */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "comSim_types.h"
+#include "fixedpoint.h"
+
+/* Defines */
+#define TIMING_TAPS			4		/* Farrow taps x(m-1) .. x(m+2) */
+#define TIMING_FARROW_ALPHA	0.5		/* piecewise parabolic free parameter */
+#define TIMING_COEF_FL		15		/* fixed-point Farrow coefficients and mu */
+#define TIMING_POS_FL		32		/* fixed-point strobe position */
+
+enum{
+	TIMING_GARDNER = 0,
+	TIMING_MM,
+	NUM_TIMING_TED
+};
+
+enum{
+	FARROW_CUBIC = 0,			// cubic Lagrange
+	FARROW_PARABOLIC,			// piecewise parabolic, TIMING_FARROW_ALPHA
+	NUM_FARROW
+};
+
+typedef struct{
+	double sps;					// nominal samples per symbol
+	int ted;					// TIMING_*
+	int interp;					// FARROW_*
+	double c[TIMING_TAPS][4];	// Farrow coefficient of tap i, power p of mu
+	double kp, ki;				// PI loop filter, in samples per unit error
+	/* state */
+	double pos;					// next strobe, in samples of the current call
+	double integ;				// loop integrator
+	int mid;					// next strobe is the Gardner midpoint
+	complex hist[TIMING_TAPS-1];	// last input samples of the previous call
+	complex prev, half;			// last symbol strobe and the midpoint after it
+	complex prevDec;			// decision of the last symbol strobe
+	double err;					// last TED output
+	double adj;					// loop filter output, applied at the next symbol
+	long numSym;
+} timing_str;
+
+typedef struct{
+	int sps;
+	int ted;
+	int interp;
+	int WL, FL;					// word and fraction length of the samples
+	sfxp_t c[TIMING_TAPS][4];	// Q15 Farrow coefficients
+	sfxp64_t step;				// sps in 32.32
+	sfxp64_t kp, ki;			// loop gains, 32.32 per unit (FL) error
+	/* state */
+	sfxp64_t pos;
+	sfxp64_t integ;
+	int mid;
+	sfxp_t histRe[TIMING_TAPS-1], histIm[TIMING_TAPS-1];
+	sfxp_t prevRe, prevIm, halfRe, halfIm;
+	sfxp_t prevDecRe, prevDecIm;
+	sfxp_t err;
+	sfxp64_t adj;
+	long numSym;
+} timingFxp_str;
+
+/* Functions */
+
+/***********************************
+ * Farrow coefficients             *
+ ***********************************/
+
+/* c[i][p]: weight of x(m-1+i) in the coefficient of mu^p */
+static void timing_farrowCoef(double c[TIMING_TAPS][4], int interp)
+{
+	const double a = TIMING_FARROW_ALPHA;
+	static const double cubic[TIMING_TAPS][4] = {
+		{0., -1./3, 0.5, -1./6},
+		{1., -0.5, -1., 0.5},
+		{0., 1., 0.5, -0.5},
+		{0., -1./6, 0., 1./6},
+	};
+	const double parabolic[TIMING_TAPS][4] = {
+		{0., -a, a, 0.},
+		{1., a - 1., -a, 0.},
+		{0., a + 1., -a, 0.},
+		{0., -a, a, 0.},
+	};
+
+	memcpy(c, (interp == FARROW_PARABOLIC) ? parabolic : cubic,
+			sizeof(double)*TIMING_TAPS*4);
+}
+
+/* PI gains of a second order loop of noise bandwidth bnT (per symbol) and
+   damping zeta, for a TED of slope kTed per symbol of timing error; the
+   output is in samples */
+static void timing_loopGain(double *kp, double *ki, double sps, double bnT,
+		double zeta, double kTed)
+{
+	double th = bnT / (zeta + 0.25/zeta), d = 1. + 2.*zeta*th + th*th;
+
+	*kp = sps * 4.*zeta*th / (d * kTed);
+	*ki = sps * 4.*th*th / (d * kTed);
+}
+
+/***********************************
+ * Floating point                  *
+ ***********************************/
+
+/* function timing_setLoop()
+
+	Description: loop noise bandwidth bnT (normalised to the symbol rate),
+	             damping zeta and TED slope kTed (error per symbol of
+	             timing offset at the loop's signal level)
+ */
+
+void timing_setLoop(timing_str *tr, double bnT, double zeta, double kTed)
+{
+	timing_loopGain(&tr->kp, &tr->ki, tr->sps, bnT, zeta, kTed);
+}
+
+/* function timing_init()
+
+	Description: timing recovery on sps (>= 2) samples per symbol; the loop
+	             starts with bnT 0.005, zeta 1/sqrt(2) and a unit TED slope,
+	             see timing_setLoop()
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+ */
+
+int timing_init(timing_str *tr, double sps, int ted, int interp)
+{
+	if(sps < 2. || ted < 0 || ted >= NUM_TIMING_TED || interp < 0 || interp >= NUM_FARROW){
+		printf("[timing] unsupported setup(sps %g, ted %d, interp %d)\n", sps, ted, interp);
+		return -1;
+	}
+
+	memset(tr, 0, sizeof(timing_str));
+	tr->sps = sps;
+	tr->ted = ted;
+	tr->interp = interp;
+	timing_farrowCoef(tr->c, interp);
+	timing_setLoop(tr, 0.005, M_SQRT1_2, 1.);
+
+	/* x(m-1) of the first strobe is the last history sample */
+	tr->pos = 0.;
+	tr->mid = 0;
+
+	return 0;
+}
+
+/* Farrow interpolation at x(m + mu) from x(m-1) .. x(m+2) */
+static inline complex timing_farrow(const double c[TIMING_TAPS][4], const complex x[],
+		double mu)
+{
+	complex y;
+	double vRe[4], vIm[4];
+	int p;
+
+	/* pairwise sums, a shorter dependency chain than a running sum */
+	for(p = 0; p < 4; p++){
+		vRe[p] = (c[0][p]*x[0].re + c[1][p]*x[1].re) + (c[2][p]*x[2].re + c[3][p]*x[3].re);
+		vIm[p] = (c[0][p]*x[0].im + c[1][p]*x[1].im) + (c[2][p]*x[2].im + c[3][p]*x[3].im);
+	}
+	y.re = ((vRe[3]*mu + vRe[2])*mu + vRe[1])*mu + vRe[0];
+	y.im = ((vIm[3]*mu + vIm[2])*mu + vIm[1])*mu + vIm[0];
+
+	return y;
+}
+
+/* function timing_run()
+
+	Description: streaming timing recovery; consumes lenIn samples and
+	             writes the symbol strobes they complete
+
+	Output parameters:
+		out[]				symbol strobes, at most lenIn / sps + 1
+		*lenOut				number of strobes
+
+	Return indicator:
+		0					Success
+ */
+
+int timing_run(complex out[], int *lenOut, const complex in[], int lenIn, timing_str *tr)
+{
+	complex win[TIMING_TAPS], y, d;
+	const complex *x;
+	double mu;
+	int m, i, n = 0;
+
+	/* strobe at pos needs x(m-1) .. x(m+2), m = floor(pos) >= -2 */
+	while(tr->pos + 2. < lenIn){
+		m = (int)floor(tr->pos);
+		mu = tr->pos - m;
+		if(m >= 1)
+			x = in + m - 1;
+		else {
+			for(i = 0; i < TIMING_TAPS; i++)
+				win[i] = (m - 1 + i < 0) ? tr->hist[TIMING_TAPS - 1 + m - 1 + i]
+					: in[m - 1 + i];
+			x = win;
+		}
+		y = timing_farrow(tr->c, x, mu);
+
+		if(tr->mid){
+			tr->half = y;
+			tr->mid = 0;
+			tr->pos += 0.5 * tr->sps;
+			continue;
+		}
+
+		if(tr->ted == TIMING_GARDNER){
+			/* Re{ y(k-1/2) (y(k) - y(k-1))* } */
+			tr->err = tr->half.re * (y.re - tr->prev.re)
+				+ tr->half.im * (y.im - tr->prev.im);
+		} else {
+			/* Re{ d(k)* y(k-1) - d(k-1)* y(k) } */
+			d.re = (y.re >= 0.) ? 1. : -1.;
+			d.im = (y.im >= 0.) ? 1. : -1.;
+			tr->err = d.re * tr->prev.re + d.im * tr->prev.im
+				- tr->prevDec.re * y.re - tr->prevDec.im * y.im;
+			tr->prevDec = d;
+		}
+
+		/* a late strobe gives a positive error */
+		if(tr->ted == TIMING_GARDNER){
+			tr->mid = 1;
+			tr->pos += 0.5 * tr->sps - tr->adj;
+		} else
+			tr->pos += tr->sps - tr->adj;
+		tr->integ += tr->ki * tr->err;
+		tr->adj = tr->kp * tr->err + tr->integ;
+
+		tr->prev = y;
+		out[n++] = y;
+		tr->numSym++;
+	}
+
+	/* keep the tail for the next call, positions relative to it */
+	for(i = 0; i < TIMING_TAPS - 1; i++)
+		tr->hist[i] = (lenIn - (TIMING_TAPS - 1) + i >= 0)
+			? in[lenIn - (TIMING_TAPS - 1) + i]
+			: tr->hist[i + lenIn];
+	tr->pos -= lenIn;
+	*lenOut = n;
+
+	return 0;
+}
+
+/***********************************
+ * Fixed point                     *
+ ***********************************/
+
+/* function timingFxp_init()
+
+	Description: fixed-point timing recovery on integer sps (>= 2) samples
+	             per symbol of WL (<= 29, the detector keeps two guard
+	             bits) bit samples with FL fraction bits; loop gains as
+	             timing_setLoop(), see timingFxp_setLoop()
+
+	Return indicator:
+		0					Success
+		-1					Unsupported parameters
+ */
+
+void timingFxp_setLoop(timingFxp_str *tr, double bnT, double zeta, double kTed)
+{
+	double kp, ki;
+
+	timing_loopGain(&kp, &ki, tr->sps, bnT, zeta, kTed);
+	tr->kp = (sfxp64_t)llround(kp * 4294967296.);
+	tr->ki = (sfxp64_t)llround(ki * 4294967296.);
+}
+
+int timingFxp_init(timingFxp_str *tr, int sps, int ted, int interp, int WL, int FL)
+{
+	double c[TIMING_TAPS][4];
+	int i, p;
+
+	if(sps < 2 || ted < 0 || ted >= NUM_TIMING_TED || interp < 0 || interp >= NUM_FARROW
+			|| WL < 2 || WL > 29 || FL < 0 || FL >= WL){
+		printf("[timing] unsupported setup(sps %d, ted %d, interp %d, WL %d, FL %d)\n",
+				sps, ted, interp, WL, FL);
+		return -1;
+	}
+
+	memset(tr, 0, sizeof(timingFxp_str));
+	tr->sps = sps;
+	tr->ted = ted;
+	tr->interp = interp;
+	tr->WL = WL;
+	tr->FL = FL;
+	tr->step = (sfxp64_t)sps << TIMING_POS_FL;
+
+	timing_farrowCoef(c, interp);
+	for(i = 0; i < TIMING_TAPS; i++)
+		for(p = 0; p < 4; p++)
+			tr->c[i][p] = REAL2FXPROUND(c[i][p], TIMING_COEF_FL);
+	timingFxp_setLoop(tr, 0.005, M_SQRT1_2, 1.);
+
+	return 0;
+}
+
+/* Farrow interpolation, Q15 coefficients and mu, WL bit samples */
+static inline void timingFxp_farrow(sfxp_t *yRe, sfxp_t *yIm, const timingFxp_str *tr,
+		const sfxp_t xRe[], const sfxp_t xIm[], sfxp_t mu)
+{
+	const int WL = tr->WL + 2;	// the polynomial terms get two guard bits
+	sfxp_t vRe[4], vIm[4], accRe, accIm;
+	sfxp64_t sRe, sIm;
+	int i, p;
+
+	/* wide accumulator, one rounding and range check per coefficient */
+	for(p = 0; p < 4; p++){
+		sRe = sIm = 0;
+		for(i = 0; i < TIMING_TAPS; i++){
+			sRe += (sfxp64_t)tr->c[i][p] * xRe[i];
+			sIm += (sfxp64_t)tr->c[i][p] * xIm[i];
+		}
+		vRe[p] = (sfxp_t)(sRe >> TIMING_COEF_FL);
+		vIm[p] = (sfxp_t)(sIm >> TIMING_COEF_FL);
+		RANGECHECK(vRe[p], WL);
+		RANGECHECK(vIm[p], WL);
+	}
+
+	accRe = vRe[3];
+	accIm = vIm[3];
+	for(p = 2; p >= 0; p--){
+		accRe = fxpAdd(fxpMul(accRe, mu, WL, TIMING_COEF_FL), vRe[p], WL);
+		accIm = fxpAdd(fxpMul(accIm, mu, WL, TIMING_COEF_FL), vIm[p], WL);
+	}
+
+	*yRe = accRe;
+	*yIm = accIm;
+	RANGECHECK(*yRe, tr->WL);
+	RANGECHECK(*yIm, tr->WL);
+}
+
+/* function timingFxp_run()
+
+	Description: timing_run() on split fixed-point I/Q samples
+
+	Output parameters:
+		outRe[], outIm[]	symbol strobes, at most lenIn / sps + 1
+		*lenOut				number of strobes
+
+	Return indicator:
+		0					Success
+ */
+
+int timingFxp_run(sfxp_t outRe[], sfxp_t outIm[], int *lenOut,
+		const sfxp_t inRe[], const sfxp_t inIm[], int lenIn, timingFxp_str *tr)
+{
+	const sfxp64_t one = (sfxp64_t)1 << TIMING_POS_FL;
+	sfxp_t wRe[TIMING_TAPS], wIm[TIMING_TAPS], yRe, yIm, dRe, dIm, mu;
+	const sfxp_t *xRe, *xIm;
+	int m, i, n = 0;
+
+	while(tr->pos + 2*one < (sfxp64_t)lenIn << TIMING_POS_FL){
+		m = (int)(tr->pos >> TIMING_POS_FL);
+		mu = (sfxp_t)((tr->pos & (one - 1)) >> (TIMING_POS_FL - TIMING_COEF_FL));
+		if(m >= 1){
+			xRe = inRe + m - 1;
+			xIm = inIm + m - 1;
+		} else {
+			for(i = 0; i < TIMING_TAPS; i++){
+				wRe[i] = (m - 1 + i < 0) ? tr->histRe[TIMING_TAPS - 1 + m - 1 + i]
+					: inRe[m - 1 + i];
+				wIm[i] = (m - 1 + i < 0) ? tr->histIm[TIMING_TAPS - 1 + m - 1 + i]
+					: inIm[m - 1 + i];
+			}
+			xRe = wRe;
+			xIm = wIm;
+		}
+		timingFxp_farrow(&yRe, &yIm, tr, xRe, xIm, mu);
+
+		if(tr->mid){
+			tr->halfRe = yRe;
+			tr->halfIm = yIm;
+			tr->mid = 0;
+			tr->pos += tr->step >> 1;
+			continue;
+		}
+
+		if(tr->ted == TIMING_GARDNER)
+			tr->err = fxpAdd(fxpMul(tr->halfRe, yRe - tr->prevRe, tr->WL + 1, tr->FL),
+					fxpMul(tr->halfIm, yIm - tr->prevIm, tr->WL + 1, tr->FL), tr->WL + 1);
+		else {
+			dRe = (yRe >= 0) ? ONE(tr->FL) : -ONE(tr->FL);
+			dIm = (yIm >= 0) ? ONE(tr->FL) : -ONE(tr->FL);
+			tr->err = fxpAdd(
+					fxpSub(fxpMul(dRe, tr->prevRe, tr->WL + 2, tr->FL),
+						fxpMul(tr->prevDecRe, yRe, tr->WL + 2, tr->FL), tr->WL + 2),
+					fxpSub(fxpMul(dIm, tr->prevIm, tr->WL + 2, tr->FL),
+						fxpMul(tr->prevDecIm, yIm, tr->WL + 2, tr->FL), tr->WL + 2),
+					tr->WL + 2);
+			tr->prevDecRe = dRe;
+			tr->prevDecIm = dIm;
+		}
+
+		/* gains are 32.32 per unit error, the error has FL fraction bits */
+		if(tr->ted == TIMING_GARDNER){
+			tr->mid = 1;
+			tr->pos += (tr->step >> 1) - tr->adj;
+		} else
+			tr->pos += tr->step - tr->adj;
+		tr->integ += (tr->ki * tr->err) >> tr->FL;
+		tr->adj = ((tr->kp * tr->err) >> tr->FL) + tr->integ;
+
+		tr->prevRe = yRe;
+		tr->prevIm = yIm;
+		outRe[n] = yRe;
+		outIm[n++] = yIm;
+		tr->numSym++;
+	}
+
+	for(i = 0; i < TIMING_TAPS - 1; i++){
+		tr->histRe[i] = (lenIn - (TIMING_TAPS - 1) + i >= 0)
+			? inRe[lenIn - (TIMING_TAPS - 1) + i] : tr->histRe[i + lenIn];
+		tr->histIm[i] = (lenIn - (TIMING_TAPS - 1) + i >= 0)
+			? inIm[lenIn - (TIMING_TAPS - 1) + i] : tr->histIm[i + lenIn];
+	}
+	tr->pos -= (sfxp64_t)lenIn << TIMING_POS_FL;
+	*lenOut = n;
+
+	return 0;
+}
+
+#endif /* __TIMING_H__ */
@@ -0,0 +1,419 @@
+/* File: twin.h
+ *
+ * Description: Fixed-point twin of the uncoded link: SQNR per stage and
+ *              BER against the floating-point chain
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ *
+ * The twin replays a block of the floating-point chain in fixed point
+ * (fixedpoint.h, WL bits, FL fractional, rounded and saturated) from what
+ * that chain already produced: its source bits, channel output and hard
+ * decisions. Nothing is drawn twice.
+ *   - mapper: the constellation table in fixed point,
+ *   - channel: the fixed-point symbols plus the noise the float chain
+ *     added (channel output minus its mapped symbol), then quantised as
+ *     an ADC would,
+ *   - demapper: the slicer on the quantised samples.
+ * The first two accumulate the SQNR and the largest error per axis
+ * against their float twins; the decisions give the BER of both chains
+ * and the bits they decide differently.
+ *
+ * twin_push() copies a block into one of PIPE_NUM_BLOCKS slots and hands
+ * it to a worker thread over the single-producer single-consumer rings of
+ * pipeline.h, so the twin runs beside the float chain; twin_sync() waits
+ * for the slots to come back before the results are read.
+ */
+
+#ifndef __TWIN_H__
+#define __TWIN_H__
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "comSim_types.h"
+#include "constel.h"
+#include "bitGroup.h"
+#include "fixedpoint.h"
+#include "stats.h"
+#include "pipeline.h"
+
+/* Defines */
+#define TWIN_BLOCK			256		/* symbols per pass over the stages */
+#define TWIN_LANES			8		/* partial sums of the block loop */
+
+/* Stages with a float reference signal */
+enum{
+	TWIN_MAPPER = 0,
+	TWIN_CHANNEL,
+	NUM_TWIN_STAGE,
+};
+
+typedef struct{
+	kahan_str sigPow;			// sum |x|^2 of the float signal
+	kahan_str errPow;			// sum |x_fxp - x|^2
+	double maxErr;				// max |x_fxp - x| per axis
+} twinAcc_str;
+
+typedef struct{
+	const constel_str *cons;
+	int WL, FL;
+	complex *point;				// fixed-point constellation, as values
+	/* accumulators */
+	twinAcc_str acc[NUM_TWIN_STAGE];
+	long numSym;
+	long numSat;				// saturated ADC samples, I and Q apart
+	long numBit;
+	long numErrFlt;				// bit errors of the float decisions
+	long numErrFxp;				// bit errors of the fixed-point decisions
+	long numDiff;				// bits decided differently
+	/* worker */
+	int threaded;
+	pthread_t tid;
+	long maxSym;				// symbols per slot
+	pipeBlk_str blk[PIPE_NUM_BLOCKS];
+	pipeRing_str free;			// slots the producer may fill
+	pipeRing_str full;			// slots for the worker, lenSym < 0 stops it
+} twin_str;
+
+/* Functions */
+
+/* one value rounded half away from zero and saturated, as SREAL2FXPROUND() */
+static inline double twin_quant(const twin_str *tw, double x, long *numSat)
+{
+	sfxp_t v = REAL2FXPROUND(x, tw->FL);
+
+	*numSat += (v > MAX_SFXP(tw->WL)) | (v < MIN_SFXP(tw->WL));
+	RANGECHECK(v, tw->WL);
+
+	return FXP2DOUBLE(v, tw->FL);
+}
+
+/* bit pattern of the larger of |a| and |b|; non-negative doubles order as
+   their bit patterns, so the max of a block is an integer reduction */
+static inline long twin_absMax(double a, double b)
+{
+	union{ double val; long bits; } x, y;
+
+	x.val = fabs(a);
+	y.val = fabs(b);
+
+	return (x.bits > y.bits) ? x.bits : y.bits;
+}
+
+void twin_reset(twin_str *tw)
+{
+	memset(tw->acc, 0, sizeof(tw->acc));
+	tw->numSym = tw->numSat = 0;
+	tw->numBit = tw->numErrFlt = tw->numErrFxp = tw->numDiff = 0;
+}
+
+/* function twin_run()
+
+	Description: the fixed-point twin of lenSym symbols of the float
+	             chain, inline
+
+	Input parameters:
+		bits[]				source bits, bitsPerSym per symbol
+		rx[]				float channel output
+		dec[]				float hard decisions
+ */
+
+void twin_run(twin_str *tw, const int bits[], const complex rx[], const int dec[],
+		long lenSym)
+{
+	const constel_str *cons = tw->cons;
+	const int m = cons->bitsPerSym;
+	const double scale = ONE(tw->FL), lsb = 1. / ONE(tw->FL);
+	const double hi = MAX_SFXP(tw->WL), lo = MIN_SFXP(tw->WL);
+	double sig[NUM_TWIN_STAGE][TWIN_LANES], err[NUM_TWIN_STAGE][TWIN_LANES];
+	double sP[NUM_TWIN_STAGE][TWIN_BLOCK], eP[NUM_TWIN_STAGE][TWIN_BLOCK];
+	long mx[NUM_TWIN_STAGE][TWIN_BLOCK], pk[NUM_TWIN_STAGE];
+	double rqI[TWIN_BLOCK], rqQ[TWIN_BLOCK];
+	int lab[TWIN_BLOCK], decFxp[TWIN_BLOCK*MAX_CONSTEL_BITS];
+	double a, b, c, d, vI, vQ;
+	complex tx, txq;
+	long i;
+	int j, k, n, s, numSat, numErrFlt, numErrFxp, numDiff;
+	const int *bt, *dc;
+
+	for(s = 0; s < NUM_TWIN_STAGE; s++)
+		memcpy(&pk[s], &tw->acc[s].maxErr, sizeof(double));
+
+	for(i = 0; i < lenSym; i += n){
+		n = (lenSym - i < TWIN_BLOCK) ? (int)(lenSym - i) : TWIN_BLOCK;
+		bitGroup_fromBits(lab, bits + i*m, n, m);
+
+		/* mapper, then the float chain's noise on the fixed-point symbol
+		   through the ADC; branch free so it vectorises */
+		numSat = 0;
+		for(k = 0; k < n; k++){
+			tx = cons->point[lab[k]];
+			txq = tw->point[lab[k]];
+			a = txq.re - tx.re;
+			b = txq.im - tx.im;
+			sP[TWIN_MAPPER][k] = tx.re*tx.re + tx.im*tx.im;
+			eP[TWIN_MAPPER][k] = a*a + b*b;
+			mx[TWIN_MAPPER][k] = twin_absMax(a, b);
+
+			vI = (txq.re + (rx[i+k].re - tx.re)) * scale;
+			vQ = (txq.im + (rx[i+k].im - tx.im)) * scale;
+			vI = trunc(vI + copysign(0.5, vI));
+			vQ = trunc(vQ + copysign(0.5, vQ));
+			numSat += (vI > hi) + (vI < lo) + (vQ > hi) + (vQ < lo);
+			vI = (vI > hi) ? hi : (vI < lo) ? lo : vI;
+			vQ = (vQ > hi) ? hi : (vQ < lo) ? lo : vQ;
+			rqI[k] = vI * lsb;
+			rqQ[k] = vQ * lsb;
+			c = rqI[k] - rx[i+k].re;
+			d = rqQ[k] - rx[i+k].im;
+			sP[TWIN_CHANNEL][k] = rx[i+k].re*rx[i+k].re + rx[i+k].im*rx[i+k].im;
+			eP[TWIN_CHANNEL][k] = c*c + d*d;
+			mx[TWIN_CHANNEL][k] = twin_absMax(c, d);
+		}
+
+		for(s = 0; s < NUM_TWIN_STAGE; s++){
+			for(j = 0; j < TWIN_LANES; j++)
+				sig[s][j] = err[s][j] = 0.;
+			for(k = 0; k + TWIN_LANES <= n; k += TWIN_LANES)
+				for(j = 0; j < TWIN_LANES; j++){
+					sig[s][j] += sP[s][k+j];
+					err[s][j] += eP[s][k+j];
+				}
+			for(; k < n; k++){
+				sig[s][0] += sP[s][k];
+				err[s][0] += eP[s][k];
+			}
+			for(j = 1; j < TWIN_LANES; j++){
+				sig[s][0] += sig[s][j];
+				err[s][0] += err[s][j];
+			}
+			kahan_add(&tw->acc[s].sigPow, sig[s][0]);
+			kahan_add(&tw->acc[s].errPow, err[s][0]);
+			for(k = 0; k < n; k++)
+				pk[s] = (mx[s][k] > pk[s]) ? mx[s][k] : pk[s];
+		}
+
+		/* demapper on the quantised samples */
+		for(k = 0; k < n; k++)
+			lab[k] = constel_hdLabel(cons, genComp(rqI[k], rqQ[k]));
+		bitGroup_toBits(decFxp, lab, n, m);
+
+		bt = bits + i*m;
+		dc = dec + i*m;
+		numErrFlt = numErrFxp = numDiff = 0;
+		for(k = 0; k < n*m; k++){
+			numErrFlt += bt[k] ^ dc[k];
+			numErrFxp += bt[k] ^ decFxp[k];
+			numDiff += dc[k] ^ decFxp[k];
+		}
+		tw->numErrFlt += numErrFlt;
+		tw->numErrFxp += numErrFxp;
+		tw->numDiff += numDiff;
+		tw->numSat += numSat;
+	}
+
+	for(s = 0; s < NUM_TWIN_STAGE; s++)
+		memcpy(&tw->acc[s].maxErr, &pk[s], sizeof(double));
+	tw->numSym += lenSym;
+	tw->numBit += lenSym * m;
+}
+
+static void *twin_main(void *arg)
+{
+	twin_str *tw = (twin_str *)arg;
+	pipeBlk_str *blk;
+
+	while((blk = pipeRing_pop(&tw->full))->lenSym >= 0){
+		PROF_BEGIN(PROF_TWIN);
+		twin_run(tw, blk->bit, blk->sym, blk->dec, blk->lenSym);
+		PROF_END(PROF_TWIN, blk->lenSym);
+		pipeRing_push(&tw->free, blk);
+	}
+	pipeRing_push(&tw->free, blk);
+
+	return NULL;
+}
+
+void twin_free(twin_str *tw)
+{
+	pipeBlk_str *blk;
+	int b;
+
+	if(tw->threaded){
+		blk = pipeRing_pop(&tw->free);
+		blk->lenSym = -1;
+		pipeRing_push(&tw->full, blk);
+		pthread_join(tw->tid, NULL);
+		tw->threaded = 0;
+	}
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++){
+		free(tw->blk[b].bit);
+		free(tw->blk[b].dec);
+		free(tw->blk[b].symBuf);
+	}
+	free(tw->point);
+	memset(tw, 0, sizeof(twin_str));
+}
+
+/* function twin_init()
+
+	Description: fixed-point twin of the chain of cons, WL bit words with
+	             FL fractional bits
+
+	Input parameters:
+		maxSym				largest block of twin_push()
+		threaded			1 runs the twin on a worker thread, 0 inline
+
+	Return indicator:
+		0					Success
+		-1					Unsupported word length
+		-2					Memory allocation error
+ */
+
+int twin_init(twin_str *tw, const constel_str *cons, int WL, int FL, long maxSym,
+		int threaded)
+{
+	long numSat = 0;
+	int k, b;
+
+	memset(tw, 0, sizeof(twin_str));
+	if(WL < 2 || WL > 31 || FL < 0 || FL >= WL){
+		printf("[twin] unsupported word length %d, %d fractional bits\n", WL, FL);
+		return -1;
+	}
+	tw->cons = cons;
+	tw->WL = WL;
+	tw->FL = FL;
+	tw->maxSym = maxSym;
+
+	if((tw->point = (complex *)malloc(sizeof(complex)*cons->order)) == NULL)
+		goto fail;
+	for(k = 0; k < cons->order; k++){
+		tw->point[k].re = twin_quant(tw, cons->point[k].re, &numSat);
+		tw->point[k].im = twin_quant(tw, cons->point[k].im, &numSat);
+	}
+	if(numSat > 0)
+		printf("[twin] constellation saturates at %d bits, %d fractional\n", WL, FL);
+
+	atomic_init(&tw->free.head, 0);
+	atomic_init(&tw->free.tail, 0);
+	atomic_init(&tw->full.head, 0);
+	atomic_init(&tw->full.tail, 0);
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++){
+		tw->blk[b].bit = (int *)malloc(sizeof(int)*maxSym*cons->bitsPerSym);
+		tw->blk[b].dec = (int *)malloc(sizeof(int)*maxSym*cons->bitsPerSym);
+		tw->blk[b].symBuf = (complex *)malloc(sizeof(complex)*maxSym);
+		tw->blk[b].sym = tw->blk[b].symBuf;
+		if(tw->blk[b].bit == NULL || tw->blk[b].dec == NULL || tw->blk[b].symBuf == NULL)
+			goto fail;
+		pipeRing_push(&tw->free, &tw->blk[b]);
+	}
+	twin_reset(tw);
+
+	if(threaded){
+		if(pthread_create(&tw->tid, NULL, twin_main, tw) != 0)
+			printf("[twin] fail to start thread, running inline\n");
+		else
+			tw->threaded = 1;
+	}
+
+	return 0;
+
+fail:
+	printf("[twin] fail to mem alloc\n");
+	twin_free(tw);
+	return -2;
+}
+
+/* function twin_push()
+
+	Description: twin_run() of a block of at most maxSym symbols, on the
+	             worker thread when there is one; the inputs are copied,
+	             so the caller may reuse them on return
+ */
+
+void twin_push(twin_str *tw, const int bits[], const complex rx[], const int dec[],
+		long lenSym)
+{
+	const int m = tw->cons->bitsPerSym;
+	pipeBlk_str *blk;
+
+	if(!tw->threaded){
+		PROF_BEGIN(PROF_TWIN);
+		twin_run(tw, bits, rx, dec, lenSym);
+		PROF_END(PROF_TWIN, lenSym);
+		return;
+	}
+
+	blk = pipeRing_pop(&tw->free);
+	memcpy(blk->bit, bits, sizeof(int)*lenSym*m);
+	memcpy(blk->dec, dec, sizeof(int)*lenSym*m);
+	memcpy(blk->symBuf, rx, sizeof(complex)*lenSym);
+	blk->lenSym = (int)lenSym;
+	pipeRing_push(&tw->full, blk);
+}
+
+/* wait until the worker has run every block pushed so far */
+void twin_sync(twin_str *tw)
+{
+	pipeBlk_str *blk[PIPE_NUM_BLOCKS];
+	int b;
+
+	if(!tw->threaded)
+		return;
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++)
+		blk[b] = pipeRing_pop(&tw->free);
+	for(b = 0; b < PIPE_NUM_BLOCKS; b++)
+		pipeRing_push(&tw->free, blk[b]);
+}
+
+/* signal to quantisation noise ratio of a stage in dB */
+double twin_sqnrDb(const twin_str *tw, int stage)
+{
+	double e = kahan_value(&tw->acc[stage].errPow);
+
+	return (e > 0.) ? 10.*log10(kahan_value(&tw->acc[stage].sigPow) / e) : HUGE_VAL;
+}
+
+void twin_print(const twin_str *tw)
+{
+	double numBit = (double)tw->numBit;
+
+	if(tw->numSym == 0)
+		return;
+	printf("    fixed point WL %d FL %d: mapper SQNR %.2f dB (max err %.2e)"
+			"  channel SQNR %.2f dB (max err %.2e, %ld saturated)\n",
+			tw->WL, tw->FL, twin_sqnrDb(tw, TWIN_MAPPER), tw->acc[TWIN_MAPPER].maxErr,
+			twin_sqnrDb(tw, TWIN_CHANNEL), tw->acc[TWIN_CHANNEL].maxErr, tw->numSat);
+	printf("    fixed point BER %.4e  float %.4e  delta %+.3e  (%ld bits decided"
+			" differently)\n", tw->numErrFxp / numBit, tw->numErrFlt / numBit,
+			(tw->numErrFxp - tw->numErrFlt) / numBit, tw->numDiff);
+}
+
+/* ctx is a twin_str; after the hard decision, pushes the block to the twin */
+int pipeStage_twin(void *ctx, pipeBlk_str *blk)
+{
+	twin_push((twin_str *)ctx, blk->bit, blk->sym, blk->dec, blk->lenSym);
+
+	return 0;
+}
+
+#endif /* __TWIN_H__ */
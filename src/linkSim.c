@@ -0,0 +1,905 @@
+/* File: linkSim.c
+ * Description: Link level simulator
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+/* Headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "comSim_types.h"
+#include "comMath.h"
+#include "constel.h"
+#include "convCode.h"
+#include "crc.h"
+#include "ldpc.h"
+#include "dataGen.h"
+#include "prbs.h"
+#include "iqFile.h"
+#include "awgn.h"
+#include "berAnalytic.h"
+#include "linkSim.h"
+#include "linkSimProf.h"
+#include "pipeline.h"
+#include "rng.h"
+#include "stats.h"
+#include "sweep.h"
+#include "twin.h"
+
+/* Global Variables */
+simParam_str linkSimParam;
+dataPath_str dataPath;
+
+static constel_str *linkCons;
+static conv_str linkConv;
+static ldpc_str linkLdpc;
+static const crc_str *linkCrc;	// closes every source frame, NULL for none
+static int lenSym;
+static int lenCoded;			// coded bits per frame, padded to whole symbols
+static rng_str linkRng;
+static prbs_str linkPrbs;		// source of prbsType, frame k at k*lenSrc bits
+
+static pipe_str linkPipe;
+static pipeErr_str linkPipeErr;
+static pipeAwgn_str linkPipeAwgn;
+static pipeAwgnPool_str linkPipePool;
+static pipeCrc_str linkPipeCrcTx, linkPipeCrcRx;
+static pipePrbs_str linkPipePrbs;
+
+static char *linkIqFile;		// channel output capture, NULL for none
+static iqSink_str linkIqSink;
+
+static stats_str linkStats;		// channel output against the mapped bits
+static char *linkHistFile;		// I/Q histogram per SNR point, NULL for none
+
+static twin_str linkTwin;		// fixed-point twin of the uncoded chain
+
+/* frmBatch frames back to back: frame k at k*lenSrc bits, k*lenSym symbols */
+static struct{
+	int *src;
+	int *dec;
+	complex *mapperOut;
+	complex *chanOut;
+	rng_str rng[LINK_MAX_BATCH];	// stream of frame k, set by the caller
+} linkBatch;
+
+/* Functions */
+
+/* function linkSim_init()
+
+	Description: read "name value" pairs from param_file_default; missing
+	             file or names keep their defaults
+
+	Return indicator:
+		0					Success
+		-1					Unsupported modulation
+ */
+
+int linkSim_init()
+{
+	simParam_str *prm = &linkSimParam;
+	char line[256], name[64];
+	double val;
+	FILE *file;
+
+	prm->numIter = 1000;
+	prm->modType = 4;
+	prm->modFamily = CONSTEL_QAM;
+	prm->lenSrc = 1000;
+	prm->lenFrm = 1000;
+	prm->snr.min = 0.;
+	prm->snr.max = 10.;
+	prm->snr.step = 1.;
+	prm->simMode = SIM_MONTECARLO;
+	prm->crossCheck = 0;
+	prm->pipeBlk = 0;
+	prm->pipeThreads = 1;
+	prm->seed = 1;
+	prm->codeType = CONV_NONE;
+	prm->ldpcType = LDPC_NONE;
+	prm->crcType = CRC_NONE;
+	prm->frmBatch = 1;
+	prm->noisePool = 0;
+	prm->stats = 0;
+	prm->prbsType = PRBS_NONE;
+	prm->twin = 0;
+	prm->twinWL = 12;
+	prm->twinFL = 9;
+
+	if((file = fopen(param_file_default, "r")) == NULL)
+		printf("Unable to open parameter file(%s), using defaults\n",
+				param_file_default);
+	else {
+		while(fgets(line, sizeof(line), file) != NULL){
+			if(line[0] == '#' || sscanf(line, "%63s %lf", name, &val) != 2)
+				continue;
+
+			if(!strcmp(name, "numIter"))			prm->numIter = (int)val;
+			else if(!strcmp(name, "modType"))		prm->modType = (int)val;
+			else if(!strcmp(name, "modFamily"))		prm->modFamily = (int)val;
+			else if(!strcmp(name, "lenSrc"))		prm->lenSrc = (int)val;
+			else if(!strcmp(name, "lenFrm"))		prm->lenFrm = (int)val;
+			else if(!strcmp(name, "snrMin"))		prm->snr.min = val;
+			else if(!strcmp(name, "snrMax"))		prm->snr.max = val;
+			else if(!strcmp(name, "snrStep"))		prm->snr.step = val;
+			else if(!strcmp(name, "simMode"))		prm->simMode = (int)val;
+			else if(!strcmp(name, "crossCheck"))	prm->crossCheck = (int)val;
+			else if(!strcmp(name, "pipeBlk"))		prm->pipeBlk = (int)val;
+			else if(!strcmp(name, "pipeThreads"))	prm->pipeThreads = (int)val;
+			else if(!strcmp(name, "seed"))			prm->seed = (unsigned long long)val;
+			else if(!strcmp(name, "codeType"))		prm->codeType = (int)val;
+			else if(!strcmp(name, "ldpcType"))		prm->ldpcType = (int)val;
+			else if(!strcmp(name, "crcType"))		prm->crcType = (int)val;
+			else if(!strcmp(name, "frmBatch"))		prm->frmBatch = (int)val;
+			else if(!strcmp(name, "noisePool"))		prm->noisePool = (int)val;
+			else if(!strcmp(name, "stats"))			prm->stats = (int)val;
+			else if(!strcmp(name, "prbsType"))		prm->prbsType = (int)val;
+			else if(!strcmp(name, "twin"))			prm->twin = (int)val;
+			else if(!strcmp(name, "twinWL"))		prm->twinWL = (int)val;
+			else if(!strcmp(name, "twinFL"))		prm->twinFL = (int)val;
+			else
+				printf("Unknown parameter(%s) is ignored\n", name);
+		}
+		fclose(file);
+	}
+
+	if((linkCons = constel_get(prm->modFamily, prm->modType)) == NULL)
+		return -1;
+
+	/* every frame at a fixed offset of the sequence, like a BER tester */
+	genBitSourceSeed(prm->seed);
+	if(prm->prbsType != PRBS_NONE){
+		if(prbs_getGen(prm->prbsType) == NULL)
+			return -1;
+		prbs_init(&linkPrbs, prbs_getGen(prm->prbsType), 0);
+		linkPipePrbs.prbs = linkPrbs;
+		linkPipePrbs.bitsPerSym = linkCons->bitsPerSym;
+	}
+
+	if((prm->codeType != CONV_NONE || prm->ldpcType != LDPC_NONE)
+			&& (prm->simMode == SIM_SEMIANALYTIC || prm->pipeBlk > 0)){
+		printf("Semi-analytic and pipeline runs are uncoded, "
+				"codeType and ldpcType are ignored\n");
+		prm->codeType = CONV_NONE;
+		prm->ldpcType = LDPC_NONE;
+	}
+	if(prm->codeType != CONV_NONE && prm->ldpcType != LDPC_NONE){
+		printf("ldpcType is set, codeType is ignored\n");
+		prm->codeType = CONV_NONE;
+	}
+
+	/* whole symbols only, within the data path buffers */
+	if(prm->lenSrc > MAX_SRC_LENGTH)
+		prm->lenSrc = MAX_SRC_LENGTH;
+	if(prm->ldpcType != LDPC_NONE){
+		/* whole codewords, at least one */
+		if(ldpc_initPreset(&linkLdpc, prm->ldpcType) < 0)
+			return -1;
+		prm->lenSrc = (prm->lenSrc < linkLdpc.K) ? linkLdpc.K
+			: prm->lenSrc - prm->lenSrc % linkLdpc.K;
+		lenCoded = prm->lenSrc / linkLdpc.K * linkLdpc.N;
+	} else if(prm->codeType != CONV_NONE){
+		if(convCode_initPreset(&linkConv, prm->codeType) < 0)
+			return -1;
+		lenCoded = convCode_lenCoded(&linkConv, prm->lenSrc);
+	} else {
+		prm->lenSrc -= prm->lenSrc % linkCons->bitsPerSym;
+		lenCoded = prm->lenSrc;
+	}
+	lenCoded += (linkCons->bitsPerSym - lenCoded % linkCons->bitsPerSym)
+		% linkCons->bitsPerSym;
+	lenSym = lenCoded / linkCons->bitsPerSym;
+
+	/* the last width source bits of a frame are the CRC of the others */
+	if(prm->crcType != CRC_NONE && prm->simMode != SIM_SEMIANALYTIC){
+		if((linkCrc = crc_get(prm->crcType)) == NULL)
+			return -1;
+		if(prm->lenSrc <= linkCrc->width){
+			printf("lenSrc %d leaves no room for the CRC, crcType is ignored\n",
+					prm->lenSrc);
+			prm->crcType = CRC_NONE;
+			linkCrc = NULL;
+		}
+	}
+
+	/* cf32, the usual capture format; the SigMF name adds the metadata */
+	if(linkIqFile != NULL && prm->simMode == SIM_SEMIANALYTIC){
+		printf("Semi-analytic runs have no channel samples, -iq is ignored\n");
+		linkIqFile = NULL;
+	}
+	if(linkIqFile != NULL && iqSink_open(&linkIqSink, linkIqFile, IQ_CF32, 1., 0.) < 0)
+		linkIqFile = NULL;
+
+	/* EVM, MER and SNR estimates of the channel output, Monte Carlo only */
+	if(prm->simMode == SIM_SEMIANALYTIC)
+		prm->stats = 0;
+	if(prm->stats && stats_init(&linkStats, linkCons, 0.) < 0)
+		return -1;
+
+	/* the pool is shared read only, built before any thread starts */
+	if(prm->noisePool && prm->simMode != SIM_SEMIANALYTIC && awgn_poolGet() == NULL)
+		return -1;
+
+	if(snr_numPoints(&prm->snr) > MAX_SNR_POINTS)
+		prm->snr.max = prm->snr.min + (MAX_SNR_POINTS - 1) * prm->snr.step;
+
+	/* uncoded Monte Carlo frames can run frmBatch at a time */
+	if(prm->frmBatch > LINK_MAX_BATCH)
+		prm->frmBatch = LINK_MAX_BATCH;
+	if(prm->frmBatch < 1)
+		prm->frmBatch = 1;
+	if(prm->frmBatch > 1 && (prm->codeType != CONV_NONE || prm->ldpcType != LDPC_NONE)){
+		printf("Coded frames run one by one, frmBatch is ignored\n");
+		prm->frmBatch = 1;
+	}
+	if(prm->frmBatch > 1){
+		linkBatch.src = (int *)malloc(sizeof(int) * prm->frmBatch * prm->lenSrc);
+		linkBatch.dec = (int *)malloc(sizeof(int) * prm->frmBatch * prm->lenSrc);
+		linkBatch.mapperOut = (complex *)malloc(sizeof(complex) * prm->frmBatch * lenSym);
+		linkBatch.chanOut = (complex *)malloc(sizeof(complex) * prm->frmBatch * lenSym);
+		if(linkBatch.src == NULL || linkBatch.dec == NULL
+				|| linkBatch.mapperOut == NULL || linkBatch.chanOut == NULL){
+			printf("[linkSim] fail to mem alloc\n");
+			return -1;
+		}
+	}
+
+	/* the twin replays the hard decision chain from its bits, noise and
+	   decisions, on its own thread unless twin is 2 */
+	if(prm->twin && (prm->simMode == SIM_SEMIANALYTIC
+				|| prm->codeType != CONV_NONE || prm->ldpcType != LDPC_NONE)){
+		printf("The fixed-point twin covers uncoded Monte Carlo runs, twin is ignored\n");
+		prm->twin = 0;
+	}
+	if(prm->twin && twin_init(&linkTwin, linkCons, prm->twinWL, prm->twinFL,
+				(prm->pipeBlk > prm->frmBatch * lenSym) ? prm->pipeBlk
+				: prm->frmBatch * lenSym, prm->twin != 2) < 0)
+		return -1;
+
+	if(prm->pipeBlk > 0){
+		if(pipe_init(&linkPipe, prm->pipeBlk, linkCons->bitsPerSym) < 0)
+			return -1;
+		if(prm->prbsType != PRBS_NONE)
+			pipe_addStage(&linkPipe, "source", pipeStage_prbs, &linkPipePrbs, PROF_SOURCE);
+		else
+			pipe_addStage(&linkPipe, "source", pipeStage_source, linkCons, PROF_SOURCE);
+		if(linkCrc != NULL)
+			pipe_addStage(&linkPipe, "crcAttach", pipeStage_crcAttach,
+					&linkPipeCrcTx, PIPE_NO_PROF);
+		pipe_addStage(&linkPipe, "mapper", pipeStage_mapper, linkCons, PROF_MAPPER);
+		if(prm->noisePool){
+			/* one stream of pool offsets across all SNR points */
+			rng_init(&linkPipePool.rng, prm->seed, sweep_stream(MAX_SNR_POINTS, 0));
+			pipe_addStage(&linkPipe, "channel", pipeStage_awgnPool, &linkPipePool,
+					PROF_CHANNEL);
+		} else
+			pipe_addStage(&linkPipe, "channel", pipeStage_awgn, &linkPipeAwgn,
+					PROF_CHANNEL);
+		if(linkIqFile != NULL)
+			pipe_addStage(&linkPipe, "iqSink", pipeStage_iqSink, &linkIqSink,
+					PIPE_NO_PROF);
+		if(prm->stats)
+			pipe_addStage(&linkPipe, "stats", pipeStage_stats, &linkStats, PROF_STATS);
+		pipe_addStage(&linkPipe, "demapper", pipeStage_hd, linkCons, PROF_DEMAPPER);
+		if(prm->twin)
+			pipe_addStage(&linkPipe, "twin", pipeStage_twin, &linkTwin, PIPE_NO_PROF);
+		if(linkCrc != NULL)
+			pipe_addStage(&linkPipe, "crcCheck", pipeStage_crcCheck,
+					&linkPipeCrcRx, PIPE_NO_PROF);
+		pipe_addStage(&linkPipe, "countErr", pipeStage_countErr, &linkPipeErr,
+				PROF_COUNTERR);
+	}
+
+	return 0;
+}
+
+/* one frame of source -> [encoder] -> mapper -> AWGN -> hard decision, or
+   soft demapper -> Viterbi or LDPC decoder when coded, snr in dB; the
+   randomness comes from linkRng, set to the frame's stream by the caller */
+int linkSim_update(double snr)
+{
+	simParam_str *prm = &linkSimParam;
+	double var = linkCons->avePow / pow(10., snr/10.);
+	int *bits = dataPath.src, len, i, ret;
+
+	PROF_BEGIN(PROF_SOURCE);
+	if(prm->prbsType != PRBS_NONE)
+		prbs_bits(&linkPrbs, dataPath.src, prm->lenSrc);
+	else
+		genBitSourceRng(dataPath.src, prm->lenSrc, &linkRng);
+	if(linkCrc != NULL)
+		crc_attach(dataPath.src, prm->lenSrc - linkCrc->width, linkCrc);
+	PROF_END(PROF_SOURCE, prm->lenSrc);
+
+	if(prm->codeType != CONV_NONE || prm->ldpcType != LDPC_NONE){
+		PROF_BEGIN(PROF_ENCODER);
+		if(prm->ldpcType != LDPC_NONE)
+			ldpc_enc(&len, dataPath.coded, prm->lenSrc, dataPath.src, &linkLdpc);
+		else
+			convCode_enc(&len, dataPath.coded, prm->lenSrc, dataPath.src, &linkConv);
+		for(i = len; i < lenCoded; i++)
+			dataPath.coded[i] = 0;
+		bits = dataPath.coded;
+		PROF_END(PROF_ENCODER, prm->lenSrc);
+	}
+
+	PROF_BEGIN(PROF_MAPPER);
+	mapConstel(&len, dataPath.mapperOut, lenCoded, bits, linkCons);
+	PROF_END(PROF_MAPPER, lenSym);
+
+	PROF_BEGIN(PROF_CHANNEL);
+	memcpy(dataPath.chanOut, dataPath.mapperOut, sizeof(complex)*lenSym);
+	if(prm->noisePool)
+		ch_awgn_complexPool(dataPath.chanOut, lenSym, var, &linkRng);
+	else
+		ch_awgn_complexRng(dataPath.chanOut, lenSym, var, &linkRng);
+	PROF_END(PROF_CHANNEL, lenSym);
+	if(linkIqFile != NULL)
+		iqSink_write(&linkIqSink, dataPath.chanOut, lenSym);
+
+	if(prm->stats){
+		PROF_BEGIN(PROF_STATS);
+		stats_runBits(&linkStats, dataPath.chanOut, bits, lenSym);
+		PROF_END(PROF_STATS, lenSym);
+	}
+
+	if(prm->codeType == CONV_NONE && prm->ldpcType == LDPC_NONE){
+		PROF_BEGIN(PROF_DEMAPPER);
+		ConstelHd(&len, dataPath.dec, lenSym, dataPath.chanOut, linkCons);
+		PROF_END(PROF_DEMAPPER, lenSym);
+		if(prm->twin)
+			twin_push(&linkTwin, bits, dataPath.chanOut, dataPath.dec, lenSym);
+		return 0;
+	}
+
+	PROF_BEGIN(PROF_DEMAPPER);
+	ConstelSd(&len, dataPath.llr, lenSym, dataPath.chanOut, linkCons, var);
+	PROF_END(PROF_DEMAPPER, lenSym);
+
+	PROF_BEGIN(PROF_DECODER);
+	if(prm->ldpcType != LDPC_NONE)
+		ret = ldpc_dec(&len, dataPath.dec, prm->lenSrc / linkLdpc.K * linkLdpc.N,
+				dataPath.llr, &linkLdpc);
+	else
+		ret = convCode_dec(&len, dataPath.dec,
+				convCode_lenCoded(&linkConv, prm->lenSrc), dataPath.llr, &linkConv);
+	PROF_END(PROF_DECODER, prm->lenSrc);
+
+	return ret;
+}
+
+int linkSim_countErr()
+{
+	int numErr, fail;
+
+	PROF_BEGIN(PROF_COUNTERR);
+	numErr = xorInt(dataPath.src, dataPath.dec, linkSimParam.lenSrc);
+	if(linkCrc != NULL){
+		fail = crc_check(dataPath.dec, linkSimParam.lenSrc, linkCrc);
+		dataPath.numCrcFail += fail;
+		dataPath.numCrcMiss += (numErr > 0 && !fail);
+	}
+	PROF_END(PROF_COUNTERR, linkSimParam.lenSrc);
+
+	dataPath.numBitErr += numErr;
+	dataPath.numFrmErr += (numErr > 0);
+	dataPath.numFrm++;
+
+	return numErr;
+}
+
+/* function linkSim_updateBatch()
+
+	Description: linkSim_update() of numFrm (<= frmBatch) uncoded frames at
+	             once; frame k draws from linkBatch.rng[k] exactly what a
+	             frame by frame run draws from linkRng, so the decisions
+	             are the same. The mapper and the hard decision see one
+	             block of numFrm frames, the noise of all samples is drawn
+	             side by side in SIMD lanes.
+ */
+
+int linkSim_updateBatch(double snr, int numFrm)
+{
+	simParam_str *prm = &linkSimParam;
+	double var = linkCons->avePow / pow(10., snr/10.);
+	int len, k;
+
+	PROF_BEGIN(PROF_SOURCE);
+	if(prm->prbsType != PRBS_NONE)
+		prbs_bits(&linkPrbs, linkBatch.src, (long)numFrm * prm->lenSrc);
+	for(k = 0; k < numFrm; k++){
+		if(prm->prbsType == PRBS_NONE)
+			genBitSourceRng(linkBatch.src + k*prm->lenSrc, prm->lenSrc,
+					&linkBatch.rng[k]);
+		if(linkCrc != NULL)
+			crc_attach(linkBatch.src + k*prm->lenSrc, prm->lenSrc - linkCrc->width,
+					linkCrc);
+	}
+	PROF_END(PROF_SOURCE, numFrm * prm->lenSrc);
+
+	/* lenSrc is whole symbols, so frames stay apart in the symbol block */
+	PROF_BEGIN(PROF_MAPPER);
+	mapConstel(&len, linkBatch.mapperOut, numFrm * prm->lenSrc, linkBatch.src, linkCons);
+	PROF_END(PROF_MAPPER, numFrm * lenSym);
+
+	PROF_BEGIN(PROF_CHANNEL);
+	memcpy(linkBatch.chanOut, linkBatch.mapperOut, sizeof(complex) * numFrm * lenSym);
+	for(k = 0; k < numFrm; k++)
+		if(prm->noisePool)
+			ch_awgn_complexPool(linkBatch.chanOut + k*lenSym, lenSym, var,
+					&linkBatch.rng[k]);
+		else
+			ch_awgn_complexRng(linkBatch.chanOut + k*lenSym, lenSym, var,
+					&linkBatch.rng[k]);
+	PROF_END(PROF_CHANNEL, numFrm * lenSym);
+	if(linkIqFile != NULL)
+		iqSink_write(&linkIqSink, linkBatch.chanOut, (long)numFrm * lenSym);
+
+	if(prm->stats){
+		PROF_BEGIN(PROF_STATS);
+		stats_runBits(&linkStats, linkBatch.chanOut, linkBatch.src, (long)numFrm * lenSym);
+		PROF_END(PROF_STATS, numFrm * lenSym);
+	}
+
+	PROF_BEGIN(PROF_DEMAPPER);
+	ConstelHd(&len, linkBatch.dec, numFrm * lenSym, linkBatch.chanOut, linkCons);
+	PROF_END(PROF_DEMAPPER, numFrm * lenSym);
+
+	if(prm->twin)
+		twin_push(&linkTwin, linkBatch.src, linkBatch.chanOut, linkBatch.dec,
+				(long)numFrm * lenSym);
+
+	return 0;
+}
+
+/* function linkSim_countErrBatch()
+
+	Description: linkSim_countErr() of the numFrm frames of the last
+	             linkSim_updateBatch(), one frame at a time
+
+	Output parameters:
+		numErr[]			bit errors of frame k
+ */
+
+int linkSim_countErrBatch(int numFrm, int numErr[])
+{
+	const int lenSrc = linkSimParam.lenSrc;
+	int k, fail;
+
+	PROF_BEGIN(PROF_COUNTERR);
+	for(k = 0; k < numFrm; k++){
+		numErr[k] = xorInt(linkBatch.src + k*lenSrc, linkBatch.dec + k*lenSrc, lenSrc);
+		if(linkCrc != NULL){
+			fail = crc_check(linkBatch.dec + k*lenSrc, lenSrc, linkCrc);
+			dataPath.numCrcFail += fail;
+			dataPath.numCrcMiss += (numErr[k] > 0 && !fail);
+		}
+		dataPath.numBitErr += numErr[k];
+		dataPath.numFrmErr += (numErr[k] > 0);
+	}
+	PROF_END(PROF_COUNTERR, numFrm * lenSrc);
+
+	dataPath.numFrm += numFrm;
+
+	return 0;
+}
+
+/* function linkSim_pipeline()
+
+	Description: numIter frames of lenSrc bits at SNR point p through the
+	             block pipeline; the whole stream is one run of cache sized
+	             blocks instead of one pass over memory per stage and frame.
+	             Block k of the point draws its noise from the stream
+	             sweep_stream(p, k)
+
+	Return indicator:
+		0					Success
+		-1					A pipeline stage failed
+ */
+
+int linkSim_pipeline(int p)
+{
+	simParam_str *prm = &linkSimParam;
+
+	linkPipeAwgn.var = linkCons->avePow / pow(10., snr_setPoint(&prm->snr, p)/10.);
+	linkPipeAwgn.seed = prm->seed;
+	linkPipeAwgn.stream = sweep_stream(p, 0);
+	linkPipePool.var = linkPipeAwgn.var;
+	pipeErr_init(&linkPipeErr, prm->lenSrc);
+	if(linkCrc != NULL){
+		pipeCrc_init(&linkPipeCrcTx, linkCrc, prm->lenSrc);
+		pipeCrc_init(&linkPipeCrcRx, linkCrc, prm->lenSrc);
+	}
+
+	if(pipe_run(&linkPipe, (long)prm->numIter * lenSym, prm->pipeThreads) < 0)
+		return -1;
+
+	dataPath.numBitErr = linkPipeErr.numBitErr;
+	dataPath.numFrmErr = linkPipeErr.numFrmErr;
+	dataPath.numFrm = prm->numIter;
+	dataPath.numCrcFail = linkPipeCrcRx.numFrmFail;
+	dataPath.numCrcMiss = -1;
+
+	return 0;
+}
+
+int linkSim_summary(double snr)
+{
+	double numBit = (double)dataPath.numFrm * linkSimParam.lenSrc;
+	char histName[256];
+
+	if(linkSimParam.simMode == SIM_SEMIANALYTIC)
+		printf("SNR %6.2f dB  BER %.4e (semi-analytic)\n",
+				snr, dataPath.expBitErr / numBit);
+	else
+		printf("SNR %6.2f dB  BER %.4e  FER %.4e  (%ld bit errors)\n",
+				snr, dataPath.numBitErr / numBit,
+				(double)dataPath.numFrmErr / dataPath.numFrm,
+				dataPath.numBitErr);
+
+	if(linkSimParam.crcType != CRC_NONE && linkSimParam.simMode != SIM_SEMIANALYTIC){
+		printf("    CRC FER %.4e", (double)dataPath.numCrcFail / dataPath.numFrm);
+		if(dataPath.numCrcMiss >= 0)
+			printf("  (%ld frame errors undetected)", dataPath.numCrcMiss);
+		printf("\n");
+	}
+
+	if(linkLdpc.numCw > 0){
+		printf("    LDPC %.2f iterations per codeword\n",
+				(double)linkLdpc.numIterSum / linkLdpc.numCw);
+		linkLdpc.numCw = linkLdpc.numIterSum = 0;
+	}
+
+	/* a resumed or merged sweep has the sums of all frames, but the
+	   histogram of this process only */
+	if(linkStats.numSym > 0){
+		stats_print(&linkStats);
+		if(linkHistFile != NULL){
+			snprintf(histName, sizeof(histName), "%s_%.2fdB.txt", linkHistFile, snr);
+			stats_writeHist(&linkStats, histName);
+		}
+		stats_reset(&linkStats);
+	}
+
+	/* the twin may still be running the last blocks of the point */
+	if(linkSimParam.twin){
+		twin_sync(&linkTwin);
+		twin_print(&linkTwin);
+		twin_reset(&linkTwin);
+	}
+
+#ifdef LINKSIM_PROF
+	prof_summary(snr);
+#endif
+
+	return 0;
+}
+
+/* function linkSim_semiAnalytic()
+
+	Description: semi-analytic sweep; every frame is mapped once and its
+	             expected bit errors are accumulated for all SNR points
+
+	Output parameters:
+		expErr[]			expected bit errors per SNR point
+
+	Return indicator:
+		0					Success
+		-1					Memory allocation error
+ */
+
+int linkSim_semiAnalytic(double expErr[])
+{
+	simParam_str *prm = &linkSimParam;
+	double snrLin[MAX_SNR_POINTS];
+	int label[MAX_SRC_LENGTH];
+	int numSnr = snr_numPoints(&prm->snr), m = linkCons->bitsPerSym;
+	int it, i, b, len;
+
+	for(i = 0; i < numSnr; i++){
+		snr_setPoint(&prm->snr, i);
+		snrLin[i] = prm->snr.snrLin;
+		expErr[i] = 0.;
+	}
+
+	for(it = 0; it < prm->numIter; it++){
+		genBitSource(dataPath.src, prm->lenSrc);
+		mapConstel(&len, dataPath.mapperOut, prm->lenSrc, dataPath.src, linkCons);
+
+		for(i = 0; i < lenSym; i++)
+			for(label[i] = 0, b = 0; b < m; b++)
+				label[i] = (label[i] << 1) | dataPath.src[m*i+b];
+
+		if(semiAnalytic_errExp(expErr, numSnr, snrLin, dataPath.mapperOut,
+				label, lenSym, linkCons) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/* function linkSim_sweep()
+
+	Description: Monte Carlo frames of the shard sw; frame it of SNR point p
+	             uses the random stream sweep_stream(p, it), so a resumed or
+	             sharded sweep reproduces a single run exactly, frmBatch
+	             frames at a time or one by one
+
+	input parameters:
+		ckptFile			state file, saved every ckptSec seconds and after
+							every point; NULL for none
+ */
+
+int linkSim_sweep(sweep_str *sw, const char *ckptFile, int ckptSec)
+{
+	simParam_str *prm = &linkSimParam;
+	sweepPoint_str *pt;
+	time_t next = time(NULL) + ckptSec;
+	int numErr[LINK_MAX_BATCH];
+	long it;
+	int p, k, num;
+
+	for(p = 0; p < sw->numPoint; p++){
+		pt = &sw->pt[p];
+		if(pt->itBegin == pt->itEnd)
+			continue;
+
+		snr_setPoint(&prm->snr, p);
+		dataPath.numBitErr = pt->numBitErr;
+		dataPath.numFrmErr = pt->numFrmErr;
+		dataPath.numFrm = pt->itDone;
+		dataPath.numCrcFail = pt->numCrcFail;
+		dataPath.numCrcMiss = pt->numCrcMiss;
+		if(prm->stats)
+			stats_merge(&linkStats, &pt->stats);
+
+		for(it = pt->itBegin + pt->itDone; it < pt->itEnd; it += num){
+			if(prm->frmBatch > 1){
+				num = (pt->itEnd - it < prm->frmBatch) ? (int)(pt->itEnd - it)
+					: prm->frmBatch;
+				for(k = 0; k < num; k++)
+					rng_init(&linkBatch.rng[k], sw->seed, sweep_stream(p, it + k));
+				if(prm->prbsType != PRBS_NONE)
+					prbs_seek(&linkPrbs, (unsigned long long)it * prm->lenSrc);
+				linkSim_updateBatch(prm->snr.snrdB, num);
+				linkSim_countErrBatch(num, numErr);
+			} else {
+				num = 1;
+				rng_init(&linkRng, sw->seed, sweep_stream(p, it));
+				if(prm->prbsType != PRBS_NONE)
+					prbs_seek(&linkPrbs, (unsigned long long)it * prm->lenSrc);
+				linkSim_update(prm->snr.snrdB);
+				linkSim_countErr();
+			}
+
+			pt->itDone += num;
+			pt->numBitErr = dataPath.numBitErr;
+			pt->numFrmErr = dataPath.numFrmErr;
+			pt->numCrcFail = dataPath.numCrcFail;
+			pt->numCrcMiss = dataPath.numCrcMiss;
+			if(prm->stats)
+				stats_copySums(&pt->stats, &linkStats);
+
+			if(ckptFile != NULL && time(NULL) >= next){
+				sweep_save(sw, ckptFile);
+				next = time(NULL) + ckptSec;
+			}
+		}
+
+		if(ckptFile != NULL)
+			sweep_save(sw, ckptFile);
+		linkSim_summary(prm->snr.snrdB);
+	}
+
+	return 0;
+}
+
+/* function linkSim_merge()
+
+	Description: add up shard state files and print the summary of the
+	             whole sweep
+
+	Return indicator:
+		0					Success
+		1					Frames are missing from the shards
+		-1					Unreadable or mismatching shard files
+ */
+
+int linkSim_merge(int num, char *fName[])
+{
+	sweep_str *sw;
+	int p, ret;
+
+	if((sw = (sweep_str *)malloc(sizeof(sweep_str))) == NULL)
+		return -1;
+	if(stats_init(&linkStats, NULL, 0.) < 0){
+		free(sw);
+		return -1;
+	}
+
+	/* the shards keep no histogram */
+	linkHistFile = NULL;
+	if((ret = sweep_merge(sw, fName, num)) >= 0){
+		linkSimParam.simMode = SIM_MONTECARLO;
+		linkSimParam.lenSrc = sw->lenSrc;
+		linkSimParam.crcType = sw->crcType;
+		for(p = 0; p < sw->numPoint; p++){
+			dataPath.numBitErr = sw->pt[p].numBitErr;
+			dataPath.numFrmErr = sw->pt[p].numFrmErr;
+			dataPath.numFrm = sw->pt[p].itDone;
+			dataPath.numCrcFail = sw->pt[p].numCrcFail;
+			dataPath.numCrcMiss = sw->pt[p].numCrcMiss;
+			stats_merge(&linkStats, &sw->pt[p].stats);
+			if(dataPath.numFrm > 0)
+				linkSim_summary(sw->pt[p].snrdB);
+		}
+	}
+
+	stats_free(&linkStats);
+	free(sw);
+	return ret;
+}
+
+static void linkSim_usage(const char *name)
+{
+	printf("usage: %s [param_file] [-prof out.json|out.csv]\n"
+			"          [-ckpt state_file] [-ckptSec seconds] [-shard k/n]\n"
+			"          [-iq channel.sigmf-data] [-hist prefix]\n"
+			"       %s -merge state_file...\n", name, name);
+}
+
+int main(int argc, char *argv[])
+{
+	simParam_str *prm = &linkSimParam;
+	double expErr[MAX_SNR_POINTS], berSa[MAX_SNR_POINTS], berMc[MAX_SNR_POINTS];
+	char *profFile = NULL, *ckptFile = NULL, shardName[64];
+	int numSnr, p, a, shard = 0, numShard = 1, ckptSec = 60, ret = 0;
+	sweep_str *sw, *saved;
+
+	for(a = 1; a < argc; a++){
+		if(!strcmp(argv[a], "-merge"))
+			return linkSim_merge(argc - a - 1, &argv[a + 1]) < 0 ? -1 : 0;
+		else if(!strcmp(argv[a], "-prof") && a+1 < argc)
+			profFile = argv[++a];
+		else if(!strcmp(argv[a], "-ckpt") && a+1 < argc)
+			ckptFile = argv[++a];
+		else if(!strcmp(argv[a], "-iq") && a+1 < argc)
+			linkIqFile = argv[++a];
+		else if(!strcmp(argv[a], "-hist") && a+1 < argc)
+			linkHistFile = argv[++a];
+		else if(!strcmp(argv[a], "-ckptSec") && a+1 < argc)
+			ckptSec = atoi(argv[++a]);
+		else if(!strcmp(argv[a], "-shard") && a+1 < argc){
+			if(sscanf(argv[++a], "%d/%d", &shard, &numShard) != 2){
+				linkSim_usage(argv[0]);
+				return -1;
+			}
+		} else if(argv[a][0] != '-')
+			param_file_default = argv[a];
+		else {
+			linkSim_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	if(linkSim_init() < 0){
+		printf("Unsupported modulation(family %d, order %d)\n",
+				prm->modFamily, prm->modType);
+		return -1;
+	}
+	numSnr = snr_numPoints(&prm->snr);
+
+	if(prm->simMode == SIM_SEMIANALYTIC){
+		if(linkSim_semiAnalytic(expErr) < 0){
+			ret = -1;
+			goto done;
+		}
+		dataPath.numFrm = prm->numIter;
+		for(p = 0; p < numSnr; p++){
+			dataPath.expBitErr = expErr[p];
+			linkSim_summary(snr_setPoint(&prm->snr, p));
+		}
+
+		if(prm->crossCheck){
+			printf("Cross-check against Monte Carlo\n");
+			if(semiAnalytic_crossCheck(berSa, berMc, &prm->snr, linkCons,
+					lenSym, prm->numIter) < 0){
+				ret = -1;
+				goto done;
+			}
+			for(p = 0; p < numSnr; p++)
+				printf("SNR %6.2f dB  SA %.4e  MC %.4e\n",
+						snr_setPoint(&prm->snr, p), berSa[p], berMc[p]);
+		}
+		goto done;
+	}
+
+	if(prm->pipeBlk > 0 && ckptFile == NULL && numShard == 1){
+		for(p = 0; p < numSnr; p++){
+			if(linkSim_pipeline(p) < 0){
+				ret = -1;
+				break;
+			}
+			linkSim_summary(prm->snr.snrdB);
+		}
+		pipe_free(&linkPipe);
+		goto done;
+	}
+	if(prm->pipeBlk > 0){
+		printf("Checkpoints and shards run frame by frame, pipeBlk is ignored\n");
+		pipe_free(&linkPipe);
+	}
+
+	sw = (sweep_str *)malloc(sizeof(sweep_str));
+	saved = (sweep_str *)malloc(sizeof(sweep_str));
+	if(sw == NULL || saved == NULL || sweep_init(sw, prm, shard, numShard) < 0){
+		free(sw);
+		free(saved);
+		ret = -1;
+		goto done;
+	}
+
+	/* a shard always leaves its state behind for the merge */
+	if(ckptFile == NULL && numShard > 1){
+		snprintf(shardName, sizeof(shardName), "linkSim_shard%dof%d.ckpt",
+				shard, numShard);
+		ckptFile = shardName;
+	}
+
+	/* resume */
+	if(ckptFile != NULL && sweep_load(saved, ckptFile) == 0){
+		if(!sweep_sameRun(sw, saved) || saved->shard != shard
+				|| saved->numShard != numShard){
+			printf("Checkpoint file(%s) belongs to another sweep\n", ckptFile);
+			ret = -1;
+		} else {
+			printf("Resuming from %s\n", ckptFile);
+			*sw = *saved;
+		}
+	}
+
+	if(ret == 0)
+		ret = linkSim_sweep(sw, ckptFile, ckptSec);
+
+	free(sw);
+	free(saved);
+
+done:
+	free(linkBatch.src);
+	free(linkBatch.dec);
+	free(linkBatch.mapperOut);
+	free(linkBatch.chanOut);
+	convCode_free(&linkConv);
+	ldpc_free(&linkLdpc);
+	stats_free(&linkStats);
+	twin_free(&linkTwin);
+	if(linkIqFile != NULL && iqSink_close(&linkIqSink) < 0)
+		ret = -1;
+
+#ifdef LINKSIM_PROF
+	if(profFile != NULL)
+		prof_dump(profFile);
+#else
+	if(profFile != NULL)
+		printf("Built without LINKSIM_PROF, no profile to dump\n");
+#endif
+
+	return ret;
+}
@@ -0,0 +1,92 @@
+/* File: test_crc.c
+ *
+ * Description: CRC presets against the standard check values of
+ *              "123456789", on bytes and bits, split and attached
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "crc.h"
+
+#define LEN_FRAME	1000
+
+int main(void)
+{
+	/* CRC-8/LTE, CRC-16/XMODEM, CRC-24/LTE-A, CRC-24/LTE-B, CRC-32 */
+	static const unsigned int check[NUM_CRC_TYPE] = {0, 0xea, 0x31c3, 0xcde703,
+		0x23ef52, 0xcbf43926u};
+	static const char *name[NUM_CRC_TYPE] = {"", "CRC-8", "CRC-16", "CRC-24A",
+		"CRC-24B", "CRC-32"};
+	const unsigned char msg[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	static int bit[LEN_FRAME + 32];
+	const crc_str *crc;
+	unsigned int v, reg, x = 1;
+	int type, i, b, split, fail = 0;
+
+	for(type = CRC_NONE + 1; type < NUM_CRC_TYPE; type++){
+		if((crc = crc_get(type)) == NULL)
+			return 1;
+
+		/* bytes, then the same bytes as bits in the order of the CRC */
+		if((v = crc_calcBytes(crc, msg, 9)) != check[type]){
+			printf("%s: bytes give 0x%x, expected 0x%x\n", name[type], v, check[type]);
+			fail = 1;
+		}
+		for(i = 0; i < 9; i++)
+			for(b = 0; b < 8; b++)
+				bit[8*i + b] = (msg[i] >> (crc->reflect ? b : 7 - b)) & 1;
+		if((v = crc_calcBits(crc, bit, 72)) != check[type]){
+			printf("%s: bits give 0x%x, expected 0x%x\n", name[type], v, check[type]);
+			fail = 1;
+		}
+
+		/* a frame split anywhere, whole bytes or not, gives one register */
+		for(i = 0; i < LEN_FRAME; i++){
+			x = x*1103515245u + 12345u;
+			bit[i] = (int)(x >> 31);
+		}
+		v = crc_calcBits(crc, bit, LEN_FRAME);
+		for(split = 1; split < 80; split += 7){
+			reg = crc_updateBits(crc, crc_begin(crc), bit, split);
+			reg = crc_updateBits(crc, reg, bit + split, LEN_FRAME - split);
+			if(crc_end(crc, reg) != v){
+				printf("%s: split at %d differs\n", name[type], split);
+				fail = 1;
+			}
+		}
+
+		/* attached CRC passes, a single flipped bit fails */
+		if(crc_attach(bit, LEN_FRAME, crc) != LEN_FRAME + crc->width
+				|| crc_check(bit, LEN_FRAME + crc->width, crc) != 0){
+			printf("%s: attached frame fails the check\n", name[type]);
+			fail = 1;
+		}
+		for(i = 0; i < LEN_FRAME + crc->width; i += 97){
+			bit[i] ^= 1;
+			if(crc_check(bit, LEN_FRAME + crc->width, crc) == 0){
+				printf("%s: error at bit %d not detected\n", name[type], i);
+				fail = 1;
+			}
+			bit[i] ^= 1;
+		}
+	}
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
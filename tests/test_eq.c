@@ -0,0 +1,129 @@
+/* File: test_eq.c
+ *
+ * Description: LMS, NLMS and RLS equalizers trained on a fixed 3 tap
+ *              channel: residual MSE, decisions and combined response
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "equalizer.h"
+
+#define NUM_SYM		6000
+#define NUM_TAP		15
+#define MAX_CALL	61			/* calls of 1 .. MAX_CALL samples */
+
+static const complex chan[3] = {{1., 0.}, {0.35, 0.2}, {-0.15, 0.1}};
+static complex s[NUM_SYM], x[NUM_SYM], y[NUM_SYM + 1];
+
+/* symbols of the stream through the channel, noiseless */
+static void channel(const constel_str *cons)
+{
+	unsigned int u = 11;
+	int i, j;
+
+	for(i = 0; i < NUM_SYM; i++){
+		u = u*1103515245u + 12345u;
+		s[i] = cons->point[(u >> 16) % cons->order];
+	}
+	for(i = 0; i < NUM_SYM; i++){
+		x[i].re = x[i].im = 0.;
+		for(j = 0; j < 3 && j <= i; j++){
+			x[i].re += chan[j].re*s[i-j].re - chan[j].im*s[i-j].im;
+			x[i].im += chan[j].re*s[i-j].im + chan[j].im*s[i-j].re;
+		}
+	}
+}
+
+/* mean |y[n] - s[n - delay]|^2 over outputs from .. to-1, in dB */
+static double mse(int delay, int from, int to)
+{
+	double e = 0., re, im;
+	int n;
+
+	for(n = from; n < to; n++){
+		re = y[n].re - s[n - delay].re;
+		im = y[n].im - s[n - delay].im;
+		e += re*re + im*im;
+	}
+
+	return 10.*log10(e / (to - from));
+}
+
+/* train on lenTrain symbols, then decision directed; mseConv is reached
+   by symbol conv and kept to the end */
+static int check(const char *name, int alg, double mu, long lenTrain, int conv,
+		double mseConv, const constel_str *cons)
+{
+	eq_str eq;
+	double g, gRe, gIm, worst = 0., m1, m2;
+	int i, n, k, j, d, len, lenY = 0, fail = 0;
+
+	if(eq_init(&eq, alg, NUM_TAP, 1, mu, cons, MAX_CALL) < 0)
+		return 1;
+	eq_setTrain(&eq, s, lenTrain);
+	for(i = 0, n = 1; i < NUM_SYM; i += n, n = (5*n + 17) % MAX_CALL + 1){
+		n = (NUM_SYM - i < n) ? NUM_SYM - i : n;
+		eq_run(y + lenY, &len, x + i, n, &eq);
+		lenY += len;
+	}
+
+	/* combined response to s[n - d], y = h^H u with u ending at x[n] */
+	for(d = 0; d < NUM_TAP + 2; d++){
+		gRe = gIm = 0.;
+		for(j = 0; j < 3; j++){
+			k = NUM_TAP - 1 - d + j;
+			if(k < 0 || k >= NUM_TAP)
+				continue;
+			gRe += eq.hRe[k]*chan[j].re + eq.hIm[k]*chan[j].im;
+			gIm += eq.hRe[k]*chan[j].im - eq.hIm[k]*chan[j].re;
+		}
+		g = (d == eq.delay) ? hypot(gRe - 1., gIm) : hypot(gRe, gIm);
+		worst = fmax(worst, g);
+	}
+
+	m1 = mse(eq.delay, conv, conv + 500);
+	m2 = mse(eq.delay, NUM_SYM - 1000, NUM_SYM);
+	if(lenY != NUM_SYM || m1 > mseConv || m2 > mseConv || worst > 0.02){
+		printf("%s: %d outputs, MSE %.1f dB at %d and %.1f dB at the end, response off by %.2e\n",
+				name, lenY, m1, conv, m2, worst);
+		fail = 1;
+	}
+
+	eq_free(&eq);
+	return fail;
+}
+
+int main(void)
+{
+	constel_str cons;
+	int fail = 0;
+
+	if(constel_initPsk(&cons, 4, 1.) < 0)
+		return 1;
+	channel(&cons);
+
+	fail |= check("LMS", EQ_LMS, 0.01, 2000, 1500, -30., &cons);
+	fail |= check("NLMS", EQ_NLMS, 0.1, 2000, 1500, -30., &cons);
+	fail |= check("RLS", EQ_RLS, 0., 300, 100, -30., &cons);
+	fail |= check("RLS trained", EQ_RLS, 0., NUM_SYM, 100, -30., NULL);
+
+	constel_free(&cons);
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
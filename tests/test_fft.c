@@ -0,0 +1,104 @@
+/* File: test_fft.c
+ *
+ * Description: batched FFTs of every radix mix against a direct DFT,
+ *              strided, in place, partly filled and threaded
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "fft.h"
+
+#define MAX_LOG2	10
+#define NUM_VEC		13			/* one full group of FFT_LANES and a partial one */
+#define STRIDE_PAD	3			/* gap between vectors in memory */
+
+/* X[k] = sum x[n] e^{-+j2pi nk/N}, scaled by 1/N for the inverse */
+static void dft(complex y[], const complex x[], int n, int dir)
+{
+	double sgn = (dir == FFT_FORWARD) ? -1. : 1., sc = (dir == FFT_FORWARD) ? 1. : 1./n, a;
+	int k, t;
+
+	for(k = 0; k < n; k++){
+		y[k].re = y[k].im = 0.;
+		for(t = 0; t < n; t++){
+			a = sgn * 2.*M_PI * (double)((long)k*t % n) / n;
+			y[k].re += x[t].re*cos(a) - x[t].im*sin(a);
+			y[k].im += x[t].re*sin(a) + x[t].im*cos(a);
+		}
+		y[k].re *= sc;
+		y[k].im *= sc;
+	}
+}
+
+int main(void)
+{
+	static complex x[NUM_VEC*((1 << MAX_LOG2) + STRIDE_PAD)];
+	static complex y[NUM_VEC*((1 << MAX_LOG2) + STRIDE_PAD)];
+	static complex ref[NUM_VEC*((1 << MAX_LOG2) + STRIDE_PAD)];
+	const fftPlan_str *plan;
+	unsigned int u = 1;
+	double err, tol;
+	long st;
+	int m, n, v, k, dir, thr, fail = 0;
+
+	for(m = 1; m <= MAX_LOG2; m++){
+		n = 1 << m;
+		st = n + STRIDE_PAD;
+		if((plan = fft_getPlan(n)) == NULL)
+			return 1;
+		for(k = 0; k < NUM_VEC*st; k++){
+			u = u*1103515245u + 12345u;
+			x[k].re = (double)(u >> 8) / (1 << 24) - 0.5;
+			u = u*1103515245u + 12345u;
+			x[k].im = (double)(u >> 8) / (1 << 24) - 0.5;
+		}
+		tol = 1e-14 * m * n;
+
+		for(dir = FFT_FORWARD; dir <= FFT_INVERSE; dir++){
+			for(v = 0; v < NUM_VEC; v++)
+				dft(ref + v*st, x + v*st, n, dir);
+
+			/* out of place on 1 and 2 threads, then in place */
+			for(thr = 1; thr <= 3; thr++){
+				if(thr < 3){
+					if(fft_batch(plan, y, st, x, st, NUM_VEC, dir, thr) < 0)
+						return 1;
+				} else {
+					memcpy(y, x, sizeof(complex)*NUM_VEC*st);
+					if(fft_batch(plan, y, st, y, st, NUM_VEC, dir, 1) < 0)
+						return 1;
+				}
+				for(err = 0., v = 0; v < NUM_VEC; v++)
+					for(k = 0; k < n; k++)
+						err = fmax(err, fabs(y[v*st + k].re - ref[v*st + k].re)
+								+ fabs(y[v*st + k].im - ref[v*st + k].im));
+				if(err > tol){
+					printf("n %d %s %s: error %.3e\n", n,
+							(dir == FFT_FORWARD) ? "forward" : "inverse",
+							(thr < 3) ? ((thr == 1) ? "1 thread" : "2 threads") : "in place",
+							err);
+					fail = 1;
+				}
+			}
+		}
+	}
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
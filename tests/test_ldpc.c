@@ -0,0 +1,111 @@
+/* File: test_ldpc.c
+ *
+ * Description: 802.11n LDPC codewords against the base matrix, and
+ *              noiseless and noisy encode-decode round trips
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "ldpc.h"
+#include "rng.h"
+
+#define NUM_CW		(2*LDPC_MAX_BATCH + 3)	/* two full batches and a partial one */
+#define EBN0_DB		4.
+
+/* checks of H not satisfied by codeword c, from the base matrix alone */
+static int numFailedChecks(const int c[], const short base[], int mb, int nb, int Z)
+{
+	int r, b, j, p, s, fail = 0;
+
+	for(r = 0; r < mb; r++)
+		for(j = 0; j < Z; j++){
+			for(p = 0, b = 0; b < nb; b++)
+				if((s = base[r*nb + b]) >= 0)
+					p ^= c[b*Z + (j + s) % Z];
+			fail += p;
+		}
+
+	return fail;
+}
+
+int main(void)
+{
+	static ldpc_str ldpc;
+	static int info[NUM_CW*324], coded[NUM_CW*648], dec[NUM_CW*324], re[NUM_CW*648];
+	static double llr[NUM_CW*648];
+	const double sigma = sqrt(1. / (2. * 0.5 * pow(10., EBN0_DB / 10.)));
+	rng_str rng;
+	double g0, g1;
+	int len, i, cw, numBad = 0, numRaw = 0, numErr = 0, fail = 0;
+
+	if(ldpc_initPreset(&ldpc, LDPC_WIFI_648_R12) < 0 || ldpc.N != 648 || ldpc.K != 324)
+		return 1;
+
+	rng_init(&rng, 1, 0);
+	for(i = 0; i < NUM_CW*ldpc.K; i++)
+		info[i] = (int)(rng_u64(&rng) >> 63);
+	if(ldpc_enc(&len, coded, NUM_CW*ldpc.K, info, &ldpc) < 0 || len != NUM_CW*ldpc.N)
+		return 1;
+
+	/* every check of every codeword, systematic bits first */
+	for(cw = 0; cw < NUM_CW; cw++){
+		numBad += numFailedChecks(&coded[cw*ldpc.N], ldpcWifi648R12, 12, 24, 27);
+		for(i = 0; i < ldpc.K; i++)
+			numBad += coded[cw*ldpc.N + i] != info[cw*ldpc.K + i];
+	}
+	if(numBad > 0){
+		printf("encoder: %d unsatisfied checks or systematic bits\n", numBad);
+		fail = 1;
+	}
+
+	/* noiseless: decoded in the first iteration */
+	for(i = 0; i < NUM_CW*ldpc.N; i++)
+		llr[i] = coded[i] ? -8. : 8.;
+	ldpc_dec(&len, dec, NUM_CW*ldpc.N, llr, &ldpc);
+	for(i = 0; i < NUM_CW*ldpc.K; i++)
+		numErr += dec[i] != info[i];
+	if(len != NUM_CW*ldpc.K || numErr > 0 || ldpc.numIterSum != ldpc.numCw){
+		printf("noiseless: %d bit errors, %ld iterations for %ld codewords\n",
+				numErr, ldpc.numIterSum, ldpc.numCw);
+		fail = 1;
+	}
+
+	/* BPSK over AWGN at EBN0_DB, well into the waterfall */
+	for(i = 0; i < NUM_CW*ldpc.N; i += 2){
+		rng_gauss2(&rng, &g0, &g1);
+		llr[i] = 2. * ((coded[i] ? -1. : 1.) + sigma*g0) / (sigma*sigma);
+		llr[i+1] = 2. * ((coded[i+1] ? -1. : 1.) + sigma*g1) / (sigma*sigma);
+		numRaw += (llr[i] < 0.) != coded[i];
+		numRaw += (llr[i+1] < 0.) != coded[i+1];
+	}
+	ldpc_dec(&len, dec, NUM_CW*ldpc.N, llr, &ldpc);
+	ldpc_enc(&len, re, NUM_CW*ldpc.K, dec, &ldpc);
+	for(numErr = 0, i = 0; i < NUM_CW*ldpc.K; i++)
+		numErr += dec[i] != info[i];
+	for(numBad = 0, cw = 0; cw < NUM_CW; cw++)
+		numBad += numFailedChecks(&re[cw*ldpc.N], ldpcWifi648R12, 12, 24, 27);
+	if(numRaw == 0 || numErr > 0 || numBad > 0){
+		printf("noisy: %d channel errors, %d bit errors after decoding\n", numRaw, numErr);
+		fail = 1;
+	}
+
+	ldpc_free(&ldpc);
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
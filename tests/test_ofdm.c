@@ -0,0 +1,101 @@
+/* File: test_ofdm.c
+ *
+ * Description: OFDM modulator and demodulator round trip, sample power,
+ *              and a multipath channel within the cyclic prefix
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "ofdm.h"
+
+#define NFFT		64
+#define LEN_CP		16
+#define NUM_DATA	52
+#define NUM_SYM		150			/* two whole chunks of OFDM_CHUNK and a partial one */
+#define LEN_H		5
+
+int main(void)
+{
+	static complex in[NUM_SYM*NUM_DATA], out[NUM_SYM*NUM_DATA];
+	static complex tx[NUM_SYM*(NFFT + LEN_CP)], rx[NUM_SYM*(NFFT + LEN_CP)];
+	const complex h[LEN_H] = {{0.8, 0.1}, {0., 0.}, {-0.3, 0.25}, {0.1, -0.2}, {0.05, 0.05}};
+	complex H[NUM_DATA];
+	ofdm_str ofdm;
+	unsigned int u = 7;
+	double err = 0., pow = 0.;
+	long i, n;
+	int k, fail = 0;
+
+	if(ofdm_init(&ofdm, NFFT, LEN_CP, NUM_DATA, NULL, 1) < 0)
+		return 1;
+
+	/* QPSK of unit power */
+	for(i = 0; i < NUM_SYM*NUM_DATA; i++){
+		u = u*1103515245u + 12345u;
+		in[i].re = ((u >> 30) & 1) ? M_SQRT1_2 : -M_SQRT1_2;
+		in[i].im = ((u >> 31) & 1) ? M_SQRT1_2 : -M_SQRT1_2;
+	}
+
+	if(ofdm_mod(tx, in, NUM_SYM, &ofdm) < 0 || ofdm_demod(out, tx, NUM_SYM, &ofdm) < 0)
+		return 1;
+	for(i = 0; i < NUM_SYM*NUM_DATA; i++)
+		err = fmax(err, fabs(out[i].re - in[i].re) + fabs(out[i].im - in[i].im));
+	/* exact over the nFft samples behind each prefix */
+	for(i = 0; i < NUM_SYM; i++)
+		for(k = LEN_CP; k < NFFT + LEN_CP; k++){
+			n = i*(NFFT + LEN_CP) + k;
+			pow += tx[n].re*tx[n].re + tx[n].im*tx[n].im;
+		}
+	pow /= NUM_SYM*NFFT;
+	if(err > 1e-12 || fabs(pow - 1.) > 1e-12){
+		printf("round trip: error %.3e, sample power %.6f\n", err, pow);
+		fail = 1;
+	}
+
+	/* every prefix is a copy of its symbol's tail */
+	for(i = 0; i < NUM_SYM; i++)
+		if(memcmp(tx + i*(NFFT + LEN_CP), tx + i*(NFFT + LEN_CP) + NFFT,
+					sizeof(complex)*LEN_CP) != 0){
+			printf("symbol %ld: cyclic prefix differs from the tail\n", i);
+			fail = 1;
+			break;
+		}
+
+	/* linear convolution, the prefix absorbs it; zero forcing restores in[] */
+	for(n = 0; n < NUM_SYM*(NFFT + LEN_CP); n++){
+		rx[n].re = rx[n].im = 0.;
+		for(k = 0; k < LEN_H && k <= n; k++){
+			rx[n].re += h[k].re*tx[n-k].re - h[k].im*tx[n-k].im;
+			rx[n].im += h[k].re*tx[n-k].im + h[k].im*tx[n-k].re;
+		}
+	}
+	if(ofdm_demod(out, rx, NUM_SYM, &ofdm) < 0 || ofdm_freqResp(H, h, LEN_H, &ofdm) < 0)
+		return 1;
+	ofdm_equalize(out, NUM_SYM, H, 0., NULL, &ofdm);
+	for(err = 0., i = 0; i < NUM_SYM*NUM_DATA; i++)
+		err = fmax(err, fabs(out[i].re - in[i].re) + fabs(out[i].im - in[i].im));
+	if(err > 1e-10){
+		printf("multipath: error %.3e after zero forcing\n", err);
+		fail = 1;
+	}
+
+	ofdm_free(&ofdm);
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
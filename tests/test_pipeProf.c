@@ -0,0 +1,87 @@
+/* File: test_pipeProf.c
+ *
+ * Description: the per-stage counters of a threaded pipeline run many
+ *              times, each run on new worker threads
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#ifndef LINKSIM_PROF
+#define LINKSIM_PROF
+#endif
+
+#include <stdio.h>
+#include "pipeline.h"
+
+#define NUM_RUN		6
+#define TOTAL_SYM	10000L
+#define BLK_SYM		512
+
+static int stageNop(void *ctx, pipeBlk_str *blk)
+{
+	(void)ctx;
+	(void)blk;
+	return 0;
+}
+
+int main(void)
+{
+	static pipe_str pipe;
+	profStage_str cnt[NUM_PROF_STAGE];
+	long numBlk = (TOTAL_SYM + BLK_SYM - 1) / BLK_SYM;
+	int r, fail = 0;
+
+	if(pipe_init(&pipe, BLK_SYM, 1) < 0)
+		return 1;
+	pipe_addStage(&pipe, "source", stageNop, NULL, PROF_SOURCE);
+	pipe_addStage(&pipe, "mapper", stageNop, NULL, PROF_MAPPER);
+	pipe_addStage(&pipe, "channel", stageNop, NULL, PROF_CHANNEL);
+
+	for(r = 0; r < NUM_RUN; r++){
+		if(pipe_run(&pipe, TOTAL_SYM, 3) < 0){
+			printf("run %d failed\n", r);
+			fail = 1;
+			break;
+		}
+		prof_collect(cnt);
+
+		/* every block counted once per stage, no matter how many worker
+		   threads have come and gone */
+		if(cnt[PROF_SOURCE].calls != (unsigned long long)numBlk
+				|| cnt[PROF_MAPPER].calls != (unsigned long long)numBlk
+				|| cnt[PROF_CHANNEL].calls != (unsigned long long)numBlk
+				|| cnt[PROF_CHANNEL].samples != (unsigned long long)TOTAL_SYM){
+			printf("run %d: calls %llu %llu %llu, samples %llu, expected %ld and %ld\n",
+					r, cnt[PROF_SOURCE].calls, cnt[PROF_MAPPER].calls,
+					cnt[PROF_CHANNEL].calls, cnt[PROF_CHANNEL].samples,
+					numBlk, TOTAL_SYM);
+			fail = 1;
+		}
+
+		/* only the main thread stays registered */
+		if(profNumThreads != 1){
+			printf("run %d: %d threads registered\n", r, profNumThreads);
+			fail = 1;
+		}
+	}
+
+	pipe_free(&pipe);
+	printf("%s\n", fail ? "FAIL" : "PASS");
+
+	return fail;
+}
@@ -0,0 +1,105 @@
+/* File: test_prbs.c
+ *
+ * Description: PRBS words, bits and seeks of degree 7, 31 and 32
+ *              generators against a bit serial LFSR
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "prbs.h"
+
+#define NUM_BITS	5000
+
+/* s(n) = xor of s(n-k) over the taps k, s(n-1-j) in bit j of hist */
+static int refStep(unsigned long long *hist, const int tap[], int numTap)
+{
+	int b = 0, t;
+
+	for(t = 0; t < numTap; t++)
+		b ^= (int)((*hist >> (tap[t] - 1)) & 1);
+	*hist = (*hist << 1) | (unsigned long long)b;
+
+	return b;
+}
+
+static int check(int deg, unsigned int poly, const int tap[], int numTap)
+{
+	static prbsGen_str gen;
+	static int ref[NUM_BITS], out[NUM_BITS];
+	const unsigned int seed = 0x9e3779b9u;
+	unsigned long long hist, w;
+	prbs_str pr;
+	int i, b, fail = 0;
+
+	if(prbsGen_init(&gen, deg, poly) < 0){
+		printf("degree %d poly 0x%x rejected\n", deg, poly);
+		return 1;
+	}
+
+	prbs_init(&pr, &gen, seed);
+	hist = pr.init;
+	for(i = 0; i < NUM_BITS; i++)
+		ref[i] = refStep(&hist, tap, numTap);
+
+	/* words, then a tail that is not a whole word */
+	for(i = 0; i + 64 <= 640; i += 64){
+		w = prbs_u64(&pr);
+		for(b = 0; b < 64; b++)
+			fail |= (int)((w >> b) & 1) != ref[i + b];
+	}
+	prbs_bits(&pr, out, NUM_BITS - 640 - 13);
+	for(i = 0; i < NUM_BITS - 640 - 13; i++)
+		fail |= out[i] != ref[640 + i];
+	if(fail)
+		printf("degree %d: output differs from the LFSR\n", deg);
+
+	/* back, forward from the start, forward from the current bit */
+	prbs_seek(&pr, 1001);
+	prbs_bits(&pr, out, 100);
+	prbs_seek(&pr, 3333);
+	prbs_bits(&pr, out + 100, 100);
+	for(i = 0; i < 100; i++)
+		if(out[i] != ref[1001 + i] || out[100 + i] != ref[3333 + i]){
+			printf("degree %d: seek differs from the LFSR\n", deg);
+			fail = 1;
+			break;
+		}
+
+	return fail;
+}
+
+int main(void)
+{
+	static prbsGen_str gen;
+	const int t7[] = {7, 6}, t31[] = {31, 28}, t32[] = {32, 22, 2, 1};
+	int fail = 0;
+
+	fail |= check(7, (1u << 7) | (1u << 6), t7, 2);
+	fail |= check(31, (1u << 31) | (1u << 28), t31, 2);
+	/* x^32 + x^22 + x^2 + x + 1, the x^32 term implied */
+	fail |= check(32, (1u << 22) | (1u << 2) | (1u << 1), t32, 4);
+
+	if(prbsGen_init(&gen, 31, 1u << 28) == 0 || prbsGen_init(&gen, 15, (1u << 16) | 1u) == 0){
+		printf("generator without its x^deg term accepted\n");
+		fail = 1;
+	}
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
@@ -0,0 +1,150 @@
+/* File: test_pulse.c
+ *
+ * Description: pulse shapes and the folded symmetric FIR against a
+ *              direct convolution, streamed in uneven calls
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "fir.h"
+
+#define SPS			8
+#define SPAN		10
+#define BETA		0.35
+#define LEN_X		1000
+#define RATE		4
+
+/* y[n] = sum_k h[k] x[(n*down - k) / up] over the k that hit a sample */
+static void direct(complex y[], int lenY, const complex x[], int lenX,
+		const double h[], int lenH, int up, int down)
+{
+	int n, k, t;
+
+	for(n = 0; n < lenY; n++){
+		y[n].re = y[n].im = 0.;
+		for(k = 0; k < lenH; k++){
+			t = n*down - k;
+			if(t < 0 || t % up || t / up >= lenX)
+				continue;
+			y[n].re += h[k] * x[t / up].re;
+			y[n].im += h[k] * x[t / up].im;
+		}
+	}
+}
+
+/* up or down by RATE through firSym_run() in calls of 1 .. 67 samples */
+static int checkStream(const char *name, const double h[], int lenH, int up, int down)
+{
+	static complex x[LEN_X], y[LEN_X*RATE], ref[LEN_X*RATE];
+	firSym_str fs;
+	unsigned int u = 3;
+	double err = 0.;
+	int i, n, lenY = 0, len;
+
+	for(i = 0; i < LEN_X; i++){
+		u = u*1103515245u + 12345u;
+		x[i].re = (double)(u >> 8) / (1 << 24) - 0.5;
+		u = u*1103515245u + 12345u;
+		x[i].im = (double)(u >> 8) / (1 << 24) - 0.5;
+	}
+	if(firSym_init(&fs, h, lenH, up, down, 72) < 0)
+		return 1;
+	for(i = 0, n = 1; i < LEN_X; i += n, n = n % 61 + 7){
+		n = (LEN_X - i < n) ? LEN_X - i : n;
+		firSym_run(y + lenY, &len, x + i, n, &fs);
+		lenY += len;
+	}
+	firSym_free(&fs);
+
+	direct(ref, lenY, x, LEN_X, h, lenH, up, down);
+	for(i = 0; i < lenY; i++)
+		err = fmax(err, fabs(y[i].re - ref[i].re) + fabs(y[i].im - ref[i].im));
+	if(lenY != LEN_X*up / down || err > 1e-13){
+		printf("%s: %d outputs, error %.3e\n", name, lenY, err);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	static double rrc[SPAN*SPS + 1], rc[SPAN*SPS + 1], g[SPAN*SPS + 1];
+	const double even[6] = {0.1, -0.25, 0.6, 0.6, -0.25, 0.1};
+	const double *h;
+	double e, isi, peak, c;
+	int L = SPAN*SPS + 1, mid = SPAN*SPS / 2, n, k, lenH, fail = 0;
+
+	if(pulse_design(rrc, PULSE_RRC, SPS, SPAN, BETA) < 0
+			|| pulse_design(rc, PULSE_RC, SPS, SPAN, BETA) < 0
+			|| pulse_design(g, PULSE_GAUSS, SPS, SPAN, 0.3) < 0)
+		return 1;
+
+	/* RRC: unit energy, RRC * RRC is Nyquist up to the truncation to SPAN */
+	for(e = 0., k = 0; k < L; k++)
+		e += rrc[k]*rrc[k];
+	for(isi = 0., peak = 0., n = -SPAN/2 + 1; n < SPAN/2; n++){
+		for(c = 0., k = 0; k < L; k++)
+			if(k + n*SPS >= 0 && k + n*SPS < L)
+				c += rrc[k] * rrc[k + n*SPS];
+		if(n == 0)
+			peak = c;
+		else
+			isi = fmax(isi, fabs(c));
+	}
+	if(fabs(e - 1.) > 1e-12 || fabs(peak - 1.) > 1e-12 || isi > 2e-3
+			|| !fir_isSym(rrc, L)){
+		printf("RRC: energy %.6f, peak %.6f, ISI %.2e\n", e, peak, isi);
+		fail = 1;
+	}
+
+	/* RC: unit centre tap, zero crossings at the other symbol instants */
+	for(isi = 0., k = mid % SPS; k < L; k += SPS)
+		if(k != mid)
+			isi = fmax(isi, fabs(rc[k]));
+	if(rc[mid] != 1. || isi > 1e-12 || !fir_isSym(rc, L)){
+		printf("RC: centre %.6f, ISI %.2e\n", rc[mid], isi);
+		fail = 1;
+	}
+
+	/* Gaussian: unit DC gain */
+	for(e = 0., k = 0; k < L; k++)
+		e += g[k];
+	if(fabs(e - 1.) > 1e-12 || !fir_isSym(g, L)){
+		printf("Gaussian: DC gain %.6f\n", e);
+		fail = 1;
+	}
+
+	/* cached taps are the designed ones, and stay put */
+	h = pulse_get(PULSE_RRC, SPS, SPAN, BETA, &lenH);
+	if(h == NULL || lenH != L || memcmp(h, rrc, sizeof(double)*L) != 0
+			|| pulse_get(PULSE_RRC, SPS, SPAN, BETA, &lenH) != h){
+		printf("pulse_get: cached taps differ\n");
+		fail = 1;
+	}
+
+	fail |= checkStream("RRC decimator", rrc, L, 1, RATE);
+	fail |= checkStream("RRC interpolator", rrc, L, RATE, 1);
+	fail |= checkStream("RRC plain", rrc, L, 1, 1);
+	fail |= checkStream("even decimator", even, 6, 1, RATE);
+	fail |= checkStream("even interpolator", even, 6, RATE, 1);
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
@@ -0,0 +1,152 @@
+/* File: test_resample.c
+ *
+ * Description: polyphase and Farrow resamplers: streamed against one
+ *              shot, output lengths, passband gain and alias rejection
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "resample.h"
+
+#define LEN_X		3000
+#define MAX_CALL	97			/* calls of 1 .. MAX_CALL samples */
+
+static complex x[LEN_X], ya[4*LEN_X], yb[4*LEN_X];
+
+/* unit complex tone of f cycles per input sample */
+static void tone(double f)
+{
+	int i;
+
+	for(i = 0; i < LEN_X; i++){
+		x[i].re = cos(2.*M_PI*f*i);
+		x[i].im = sin(2.*M_PI*f*i);
+	}
+}
+
+/* mean power of y[from ..], past the filter transient */
+static double power(const complex y[], int from, int len)
+{
+	double p = 0.;
+	int i;
+
+	for(i = from; i < len; i++)
+		p += y[i].re*y[i].re + y[i].im*y[i].im;
+
+	return p / (len - from);
+}
+
+static int checkRatio(int L, int M)
+{
+	resamp_str a, b;
+	int len1, len2 = 0, len, i, n, g, fail = 0;
+	double p;
+
+	/* in-band tone, at 0.4 of the lower Nyquist rate */
+	tone(0.2 * ((L < M) ? (double)L / M : 1.));
+	if(resamp_init(&a, L, M, 0, LEN_X) < 0 || resamp_init(&b, L, M, 0, MAX_CALL) < 0)
+		return 1;
+	g = resamp_gcd(L, M);
+
+	resamp_run(ya, &len1, x, LEN_X, &a);
+	for(i = 0, n = 1; i < LEN_X; i += n, n = (7*n + 13) % MAX_CALL + 1){
+		n = (LEN_X - i < n) ? LEN_X - i : n;
+		resamp_run(yb + len2, &len, x + i, n, &b);
+		len2 += len;
+	}
+
+	if(a.L != L / g || a.M != M / g || len1 != (LEN_X*(L/g) + M/g - 1) / (M/g)
+			|| len2 != len1 || memcmp(ya, yb, sizeof(complex)*len1) != 0){
+		printf("%d/%d: %d one shot and %d streamed outputs, ratio %d/%d\n",
+				L, M, len1, len2, a.L, a.M);
+		fail = 1;
+	}
+	p = power(ya, len1 / 4, len1);
+	if(fabs(10.*log10(p)) > 0.01){
+		printf("%d/%d: passband gain %.4f dB\n", L, M, 10.*log10(p));
+		fail = 1;
+	}
+
+	resamp_free(&a);
+	resamp_free(&b);
+	return fail;
+}
+
+/* Farrow path: streamed against one shot, and a tone above the output
+   Nyquist rate stays out when decimating */
+static int checkFrac(double step)
+{
+	resampFrac_str a, b;
+	int len1, len2 = 0, len, i, n, fail = 0;
+	double err = 0., p;
+
+	tone(0.05 / fmax(step, 1.));
+	if(resampFrac_init(&a, step, 1., LEN_X) < 0 || resampFrac_init(&b, step, 1., MAX_CALL) < 0)
+		return 1;
+	resampFrac_run(ya, &len1, x, LEN_X, &a);
+	for(i = 0, n = 1; i < LEN_X; i += n, n = (7*n + 13) % MAX_CALL + 1){
+		n = (LEN_X - i < n) ? LEN_X - i : n;
+		resampFrac_run(yb + len2, &len, x + i, n, &b);
+		len2 += len;
+	}
+	for(i = 0; i < len1 && i < len2; i++)
+		err = fmax(err, fabs(ya[i].re - yb[i].re) + fabs(ya[i].im - yb[i].im));
+	p = power(ya, len1 / 4, len1);
+	if(abs(len2 - len1) > 1 || fabs(len1 - LEN_X / step) > 40 || err > 1e-9
+			|| fabs(10.*log10(p)) > 0.01){
+		printf("step %.2f: %d one shot and %d streamed outputs, error %.2e, gain %.3f dB\n",
+				step, len1, len2, err, 10.*log10(p));
+		fail = 1;
+	}
+	resampFrac_free(&a);
+
+	if(step > 1.){
+		tone(fmin(0.48, 0.75 / step));
+		resampFrac_init(&a, step, 1., LEN_X);
+		resampFrac_run(ya, &len1, x, LEN_X, &a);
+		p = power(ya, len1 / 4, len1);
+		if(10.*log10(p) > -60.){
+			printf("step %.2f: stopband tone at %.1f dB\n", step, 10.*log10(p));
+			fail = 1;
+		}
+		resampFrac_free(&a);
+	}
+	resampFrac_free(&b);
+
+	return fail;
+}
+
+int main(void)
+{
+	int fail = 0;
+
+	fail |= checkRatio(3, 2);
+	fail |= checkRatio(2, 3);
+	fail |= checkRatio(6, 4);
+	fail |= checkRatio(160, 147);
+	fail |= checkRatio(147, 160);
+	fail |= checkRatio(4, 1);
+	fail |= checkRatio(1, 4);
+	fail |= checkFrac(0.7);
+	fail |= checkFrac(1.37);
+	fail |= checkFrac(3.7);
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}
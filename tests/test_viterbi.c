@@ -0,0 +1,95 @@
+/* File: test_viterbi.c
+ *
+ * Description: Viterbi decoding of the K=7 (133, 171) code, and a K=5
+ *              code on the portable path, with errors within the free distance
+ * Copyright (C) 2026, Jonghun John Park
+ * Last updated on Oct. 18, 2026
+ *
+ * This file is part of ComSim.
+ * ComSim is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License,
+ * or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with ComSim. If not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <stdio.h>
+#include "convCode.h"
+
+#define LEN_INFO	2000
+#define CLUSTER		80			/* coded bits between error bursts */
+
+static int check(const char *name, conv_str *conv, int numFlip, int span)
+{
+	static int info[LEN_INFO], coded[2*LEN_INFO + 64], dec[LEN_INFO + 64];
+	static double llr[2*LEN_INFO + 64];
+	unsigned int x = 12345u;
+	int lenCoded, lenDec, i, k, numErr = 0, numFlipped = 0;
+
+	for(i = 0; i < LEN_INFO; i++){
+		x = x*1103515245u + 12345u;
+		info[i] = (int)(x >> 31);
+	}
+	convCode_enc(&lenCoded, coded, LEN_INFO, info, conv);
+	if(lenCoded != convCode_lenCoded(conv, LEN_INFO)){
+		printf("%s: %d coded bits, expected %d\n", name, lenCoded,
+				convCode_lenCoded(conv, LEN_INFO));
+		return 1;
+	}
+
+	/* numFlip errors within span bits at the start of every burst */
+	for(i = 0; i < lenCoded; i++)
+		llr[i] = coded[i] ? -4. : 4.;
+	for(i = 0; numFlip > 0 && i + span < lenCoded; i += CLUSTER)
+		for(k = 0; k < numFlip; k++){
+			x = x*1103515245u + 12345u;
+			llr[i + k*span/numFlip + (int)(x >> 30) % (span/numFlip)] *= -1.;
+			numFlipped++;
+		}
+
+	if(convCode_dec(&lenDec, dec, lenCoded, llr, conv) < 0 || lenDec != LEN_INFO){
+		printf("%s: decoding failed\n", name);
+		return 1;
+	}
+	for(i = 0; i < LEN_INFO; i++)
+		numErr += dec[i] != info[i];
+	if(numErr > 0)
+		printf("%s: %d flips in bursts of %d, %d bit errors\n", name, numFlipped,
+				numFlip, numErr);
+
+	return numErr > 0;
+}
+
+int main(void)
+{
+	static conv_str conv;
+	const int p5[2] = {023, 035};
+	int fail = 0;
+
+	/* free distance 10: any 4 errors within a burst are corrected */
+	if(convCode_initPreset(&conv, CONV_K7_R12) < 0)
+		return 1;
+	fail |= check("K7 noiseless", &conv, 0, 0);
+	fail |= check("K7 adjacent", &conv, 4, 4);
+	fail |= check("K7 spread", &conv, 4, 24);
+	convCode_free(&conv);
+
+	/* free distance 7: 3 errors */
+	if(convCode_init(&conv, 5, 2, p5, 1, NULL) < 0)
+		return 1;
+	fail |= check("K5 noiseless", &conv, 0, 0);
+	fail |= check("K5 adjacent", &conv, 3, 3);
+	fail |= check("K5 spread", &conv, 3, 15);
+	convCode_free(&conv);
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail;
+}